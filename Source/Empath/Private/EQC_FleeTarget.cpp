@@ -3,6 +3,7 @@
 #include "EQC_FleeTarget.h"
 #include "EnvironmentQuery/EnvQueryTypes.h"
 #include "EmpathAIController.h"
+#include "EmpathAIManager.h"
 #include "Runtime/Engine/Public/EngineUtils.h"
 #include "EnvironmentQuery/EQSTestingPawn.h"
 #include "EnvironmentQuery/Items/EnvQueryItemType_Actor.h"
@@ -14,6 +15,15 @@ void UEQC_FleeTarget::ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQuery
 	APawn* const QueryOwner = Cast<APawn>(QueryInstance.Owner.Get());
 	if (QueryOwner)
 	{
+		// Reuse the value from any other query the owner ran this frame
+		AEmpathAIManager* const AIManager = AEmpathAIManager::GetEQSContextCacheManager(QueryOwner);
+		FEmpathEQSContextCacheEntry CachedContext;
+		if (AIManager && AIManager->GetCachedEQSContext(GetClass(), QueryOwner, CachedContext))
+		{
+			UEnvQueryItemType_Actor::SetContextHelper(ContextData, CachedContext.Actor.Get());
+			return;
+		}
+
 		AEmpathAIController const* const AI = Cast<AEmpathAIController>(QueryOwner->GetController());
 		if (AI)
 		{
@@ -36,6 +46,11 @@ void UEQC_FleeTarget::ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQuery
 			}
 		}
 #endif
+
+		if (AIManager)
+		{
+			AIManager->CacheEQSContext(GetClass(), QueryOwner, FEmpathEQSContextCacheEntry(FleeTarget));
+		}
 	}
 
 	UEnvQueryItemType_Actor::SetContextHelper(ContextData, FleeTarget);
@@ -15,17 +15,22 @@ void UEQC_LastKnownPlayerLocation::ProvideContext(FEnvQueryInstance& QueryInstan
 	APawn* const QueryOwner = Cast<APawn>(QueryInstance.Owner.Get());
 	if (QueryOwner)
 	{
+		// Reuse the value from any other query the owner ran this frame
+		AEmpathAIManager* const AIManager = AEmpathAIManager::GetEQSContextCacheManager(QueryOwner);
+		FEmpathEQSContextCacheEntry CachedContext;
+		if (AIManager && AIManager->GetCachedEQSContext(GetClass(), QueryOwner, CachedContext))
+		{
+			UEnvQueryItemType_Point::SetContextHelper(ContextData, CachedContext.Location);
+			return;
+		}
+
 		bool bFoundTarget = false;
 		TargetLocation = QueryOwner->GetActorLocation(); // Fallback to self location if no target location.
 		AEmpathAIController const* const AI = Cast<AEmpathAIController>(QueryOwner->GetController());
-		if (AI)
+		if (AI && AIManager)
 		{
-			AEmpathAIManager const* const AIManager = AI->GetAIManager();
-			if (AIManager)
-			{
-				TargetLocation = AIManager->GetLastKnownPlayerLocation();
-				bFoundTarget = true;
-			}
+			TargetLocation = AIManager->GetLastKnownPlayerLocation();
+			bFoundTarget = true;
 		}
 
 #if WITH_EDITOR
@@ -44,6 +49,11 @@ void UEQC_LastKnownPlayerLocation::ProvideContext(FEnvQueryInstance& QueryInstan
 			}
 		}
 #endif
+
+		if (AIManager)
+		{
+			AIManager->CacheEQSContext(GetClass(), QueryOwner, FEmpathEQSContextCacheEntry(TargetLocation));
+		}
 	}
 
 	UEnvQueryItemType_Point::SetContextHelper(ContextData, TargetLocation);
@@ -4,6 +4,7 @@
 #include "EnvironmentQuery/EnvQueryTypes.h"
 #include "EnvironmentQuery/Items/EnvQueryItemType_Point.h"
 #include "EmpathCharacter.h"
+#include "EmpathAIManager.h"
 
 void UEQC_NavRecoveryStartLocation::ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQueryContextData& ContextData) const
 {
@@ -12,6 +13,15 @@ void UEQC_NavRecoveryStartLocation::ProvideContext(FEnvQueryInstance& QueryInsta
 	APawn* const QueryOwner = Cast<APawn>(QueryInstance.Owner.Get());
 	if (QueryOwner)
 	{
+		// Reuse the value from any other query the owner ran this frame
+		AEmpathAIManager* const AIManager = AEmpathAIManager::GetEQSContextCacheManager(QueryOwner);
+		FEmpathEQSContextCacheEntry CachedContext;
+		if (AIManager && AIManager->GetCachedEQSContext(GetClass(), QueryOwner, CachedContext))
+		{
+			UEnvQueryItemType_Point::SetContextHelper(ContextData, CachedContext.Location);
+			return;
+		}
+
 		TargetLocation = QueryOwner->GetActorLocation(); // Fallback to self location
 
 		AEmpathCharacter const* const EmpathChar = Cast<AEmpathCharacter>(QueryOwner);
@@ -22,6 +32,11 @@ void UEQC_NavRecoveryStartLocation::ProvideContext(FEnvQueryInstance& QueryInsta
 				TargetLocation = EmpathChar->NavRecoveryStartPathingLocation;
 			}
 		}
+
+		if (AIManager)
+		{
+			AIManager->CacheEQSContext(GetClass(), QueryOwner, FEmpathEQSContextCacheEntry(TargetLocation));
+		}
 	}
 
 	UEnvQueryItemType_Point::SetContextHelper(ContextData, TargetLocation);
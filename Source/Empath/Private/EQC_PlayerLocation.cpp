@@ -4,6 +4,7 @@
 #include "EnvironmentQuery/EnvQueryTypes.h"
 #include "EmpathAIController.h"
 #include "EmpathPlayerCharacter.h"
+#include "EmpathAIManager.h"
 #include "Runtime/Engine/Public/EngineUtils.h"
 #include "EnvironmentQuery/EQSTestingPawn.h"
 #include "EnvironmentQuery/Items/EnvQueryItemType_Point.h"
@@ -14,9 +15,18 @@ void UEQC_PlayerLocation::ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQ
 	APawn* const QueryOwner = Cast<APawn>(QueryInstance.Owner.Get());
 	if (QueryOwner)
 	{
+		// Reuse the value from any other query the owner ran this frame
+		AEmpathAIManager* const AIManager = AEmpathAIManager::GetEQSContextCacheManager(QueryOwner);
+		FEmpathEQSContextCacheEntry CachedContext;
+		if (AIManager && AIManager->GetCachedEQSContext(GetClass(), QueryOwner, CachedContext))
+		{
+			UEnvQueryItemType_Point::SetContextHelper(ContextData, CachedContext.Location);
+			return;
+		}
+
 		bool bFoundTarget = false;
 		TargetLocation = QueryOwner->GetActorLocation(); // Fallback to self location if no target location.
-		AController* PlayerCon = GetWorld()->GetFirstPlayerController();
+		AController* PlayerCon = QueryOwner->GetWorld()->GetFirstPlayerController();
 		if (PlayerCon)
 		{
 			APawn* PlayerPawn = PlayerCon->GetPawn();
@@ -51,6 +61,11 @@ void UEQC_PlayerLocation::ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQ
 			}
 		}
 #endif
+
+		if (AIManager)
+		{
+			AIManager->CacheEQSContext(GetClass(), QueryOwner, FEmpathEQSContextCacheEntry(TargetLocation));
+		}
 	}
 
 	UEnvQueryItemType_Point::SetContextHelper(ContextData, TargetLocation);
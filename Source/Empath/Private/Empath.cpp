@@ -3,4 +3,6 @@
 #include "Empath.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Empath, "Empath" );
\ No newline at end of file
+IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Empath, "Empath" );
+
+DEFINE_LOG_CATEGORY(LogEmpath);
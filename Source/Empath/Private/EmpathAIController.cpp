@@ -15,6 +15,7 @@
 #include "NavigationSystem/Public/NavLinkCustomComponent.h"
 #include "NavigationSystem/Public/NavigationSystem.h"
 #include "EmpathNavLinkProxy_Jump.h"
+#include "EnvironmentQuery/EnvQueryManager.h"
 
 // Log categories
 DEFINE_LOG_CATEGORY_STATIC(LogAIController, Log, All);
@@ -44,6 +45,7 @@ static const auto AIVisionDebugLifetime = IConsoleManager::Get().FindConsoleVari
 #define AIVISION_LOC_DURATION(_Loc, _Radius, _Color)						if (AIVisionDrawDebug->GetInt()) { DrawDebugSphere(GetWorld(), _Loc, _Radius, 16, _Color, false, AIVisionDebugLifetime->GetFloat(), 0, 3.0f); }
 #define AIVISION_LINE_DURATION(_Loc, _Dest, _Color)							if (AIVisionDrawDebug->GetInt()) { DrawDebugLine(GetWorld(), _Loc, _Dest, _Color, false, AIVisionDebugLifetime->GetFloat(), 0, 3.0f); }
 #define AIVISION_CONE_DURATION(_Loc, _Forward, _Dist, _Angle, _Color)		if (AIVisionDrawDebug->GetInt()) { DrawDebugCone(GetWorld(), _Loc, _Forward, _Dist, _Angle, _Angle, 12, _Color, false, AIVisionDebugLifetime->GetFloat(), 0, 3.0f);}
+#define AIVISION_STRING(_Loc, _Text, _Color, _Duration)						if (AIVisionDrawDebug->GetInt()) { DrawDebugString(GetWorld(), _Loc, _Text, nullptr, _Color, _Duration); }
 #else
 #define AIVISION_LOC(_Loc, _Radius, _Color)				/* nothing */
 #define AIVISION_LINE(_Loc, _Dest, _Color)				/* nothing */
@@ -51,6 +53,7 @@ static const auto AIVisionDebugLifetime = IConsoleManager::Get().FindConsoleVari
 #define AIVISION_LOC_DURATION(_Loc, _Radius, _Color)	/* nothing */
 #define AIVISION_LINE_DURATION(_Loc, _Dest, _Color)		/* nothing */
 #define AIVISION_CONE_DURATION(_Loc, _Dest, _Color)		/* nothing */
+#define AIVISION_STRING(_Loc, _Text, _Color, _Duration)	/* nothing */
 #endif
 
 // Stats for UE Profiler
@@ -80,6 +83,8 @@ AEmpathAIController::AEmpathAIController(const FObjectInitializer& ObjectInitial
 	// Target selection score weights
 	DistScoreWeight = 1.0f;
 	AngleScoreWeight = 0.5f;
+	TargetSelectionCurveSamples = 256;
+	TargetSelectionCurveMaxError = 0.01f;
 	TargetPrefScoreWeight = 1.0f;
 	CurrentTargetPreferenceWeight = 0.7f;
 	TargetingRatioBonusScoreWeight = 1.0f;
@@ -89,15 +94,27 @@ AEmpathAIController::AEmpathAIController(const FObjectInitializer& ObjectInitial
 	PeripheralVisionAngle = 85.0f;
 	PeripheralVisionDistance = 1500.0f;
 	AutoSeeDistance = 100.0f;
+
+	// Perception LOD is disabled by default, so every vision update is fully detailed unless tiers are set up
+	PerceptionLODPlayerViewAngle = 55.0f;
+	CurrentPerceptionLOD = INDEX_NONE;
+	LastVisionUpdateTime = -BIG_NUMBER;
+	bLastInVisionCone = false;
+	bHasVisionConeResult = false;
 	//bDrawDebugVision = false;
 	//bDrawDebugLOSBlockingHits = false;
 
-	// Bind events and delegates
-	OnLOSTraceCompleteDelegate.BindUObject(this, &AEmpathAIController::OnLOSTraceComplete);
-
 	// Navigation variables
 	bDetectStuckAgainstOtherAI = true;
 	MinCapsuleBumpsBeforeRepositioning = 10;
+	bHasRepositionQueryResult = false;
+	RepositionQueryResult = FVector::ZeroVector;
+	LastRepositionQueryTime = 0.0f;
+	RepositionQueryID = INDEX_NONE;
+	LastEQSQueueWaitTime = 0.0f;
+	TotalEQSQueueWaitTime = 0.0f;
+	MaxEQSQueueWaitTime = 0.0f;
+	NumEQSQueueWaits = 0;
 	MaxTimeBetweenConsecutiveBumps = 0.2f;
 	TimeOnPathUntilRepath = 15.0f;
 
@@ -113,9 +130,26 @@ AEmpathAIController::AEmpathAIController(const FObjectInitializer& ObjectInitial
 	}
 }
 
+void AEmpathAIController::PostInitProperties()
+{
+	Super::PostInitProperties();
+	UpdateVisionConeCosines();
+}
+
+#if WITH_EDITOR
+void AEmpathAIController::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	UpdateVisionConeCosines();
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+}
+#endif // WITH_EDITOR
+
 void AEmpathAIController::BeginPlay()
 {
 	Super::BeginPlay();
+
+	BakeTargetSelectionCurves();
+	UpdateVisionConeCosines();
 	
 	// Grab the AI Manager
 	AEmpathGameModeBase* EmpathGMD = GetWorld()->GetAuthGameMode<AEmpathGameModeBase>();
@@ -134,6 +168,12 @@ void AEmpathAIController::Possess(APawn* InPawn)
 {
 	CachedEmpathChar = Cast<AEmpathCharacter>(InPawn);
 	Super::Possess(InPawn);
+
+	// Be found near our new pawn right away rather than after the AI manager next ticks
+	if (AIManager)
+	{
+		AIManager->UpdateSpatialGridCell(this);
+	}
 }
 
 void AEmpathAIController::EndPlay(const EEndPlayReason::Type EndPlayReason)
@@ -157,6 +197,9 @@ void AEmpathAIController::RegisterAIManager(AEmpathAIManager* RegisteringAIManag
 	{
 		AIManager = RegisteringAIManager;
 		AIManagerIndex = AIManager->EmpathAICons.AddUnique(this);
+		AIManager->UpdateSpatialGridCell(this);
+		CountedAttackTarget = nullptr;
+		UpdateCountedAttackTarget();
 	}
 }
 
@@ -240,6 +283,16 @@ void AEmpathAIController::SetAttackTarget(AActor* NewTarget)
 			Blackboard->SetValueAsObject(FEmpathBBKeys::AttackTarget, NewTarget);
 			LastSawAttackTargetTeleportTime = 0.0f;
 
+			// Our last vision cone result was for the old target
+			bHasVisionConeResult = false;
+
+			// Update the number of AI targeting each target
+			UpdateCountedAttackTarget();
+			if (AIManager)
+			{
+				AIManager->InvalidateEQSContextCache(GetPawn());
+			}
+
 			// Update the target radius
 			if (AIManager && NewTarget)
 			{
@@ -284,6 +337,16 @@ AActor* AEmpathAIController::GetAttackTarget() const
 	return nullptr;
 }
 
+void AEmpathAIController::UpdateCountedAttackTarget()
+{
+	AActor* const AttackTarget = GetAttackTarget();
+	if (AIManager && CountedAttackTarget.Get() != AttackTarget)
+	{
+		AIManager->OnAIAttackTargetChanged(CountedAttackTarget.Get(), AttackTarget);
+		CountedAttackTarget = AttackTarget;
+	}
+}
+
 void AEmpathAIController::SetDefendTarget(AActor* NewDefendTarget)
 {
 	if (Blackboard)
@@ -291,6 +354,12 @@ void AEmpathAIController::SetDefendTarget(AActor* NewDefendTarget)
 		Blackboard->SetValueAsObject(FEmpathBBKeys::DefendTarget, NewDefendTarget);
 	}
 
+	// Queries run later this frame should see the new target
+	if (AIManager)
+	{
+		AIManager->InvalidateEQSContextCache(GetPawn());
+	}
+
 	return;
 }
 
@@ -311,6 +380,12 @@ void AEmpathAIController::SetFleeTarget(AActor* NewFleeTarget)
 		Blackboard->SetValueAsObject(FEmpathBBKeys::FleeTarget, NewFleeTarget);
 	}
 
+	// Queries run later this frame should see the new target
+	if (AIManager)
+	{
+		AIManager->InvalidateEQSContextCache(GetPawn());
+	}
+
 	return;
 }
 
@@ -529,6 +604,89 @@ bool AEmpathAIController::WantsToReposition(float DesiredMaxAttackDist, float De
 	return !CanSeeTarget();
 }
 
+void AEmpathAIController::RunRepositionQuery(UEnvQuery* Query)
+{
+	// Let the AI manager prioritize queries if it is scheduling them
+	if (AIManager && AIManager->IsEQSSchedulerEnabled())
+	{
+		AIManager->QueueEQSRequest(this, Query);
+		return;
+	}
+
+	StartRepositionQuery(Query);
+}
+
+bool AEmpathAIController::StartRepositionQuery(UEnvQuery* Query)
+{
+	AbortRepositionQuery();
+
+	APawn* const MyPawn = GetPawn();
+	UEnvQueryManager* const QueryManager = UEnvQueryManager::GetCurrent(GetWorld());
+	if (!Query || !MyPawn || !QueryManager)
+	{
+		return false;
+	}
+
+	FEnvQueryRequest QueryRequest(Query, MyPawn);
+	RepositionQueryID = QueryManager->RunQuery(QueryRequest, EEnvQueryRunMode::SingleResult, FQueryFinishedSignature::CreateUObject(this, &AEmpathAIController::OnRepositionQueryFinished));
+	return IsRepositionQueryRunning();
+}
+
+void AEmpathAIController::AbortRepositionQuery()
+{
+	if (IsRepositionQueryRunning())
+	{
+		// Clear the ID first, as aborting calls the finished delegate
+		int32 const QueryID = RepositionQueryID;
+		RepositionQueryID = INDEX_NONE;
+		UEnvQueryManager* const QueryManager = UEnvQueryManager::GetCurrent(GetWorld());
+		if (QueryManager)
+		{
+			QueryManager->AbortQuery(QueryID);
+		}
+	}
+}
+
+void AEmpathAIController::OnRepositionQueryFinished(TSharedPtr<FEnvQueryResult> Result)
+{
+	// Ignore queries we have since aborted or replaced
+	if (!Result.IsValid() || Result->QueryID != RepositionQueryID || Result->IsAborted())
+	{
+		return;
+	}
+
+	RepositionQueryID = INDEX_NONE;
+	LastRepositionQueryTime = GetWorld()->GetTimeSeconds();
+	bool const bSuccess = Result->IsSuccsessful() && Result->Items.Num() > 0;
+	if (bSuccess)
+	{
+		bHasRepositionQueryResult = true;
+		RepositionQueryResult = Result->GetItemAsLocation(0);
+	}
+
+	ReceiveRepositionQueryComplete(bSuccess, RepositionQueryResult, false);
+}
+
+void AEmpathAIController::UseStaleRepositionQueryResult()
+{
+	ReceiveRepositionQueryComplete(bHasRepositionQueryResult, RepositionQueryResult, true);
+}
+
+void AEmpathAIController::AddEQSQueueWaitTime(float WaitTime)
+{
+	LastEQSQueueWaitTime = WaitTime;
+	TotalEQSQueueWaitTime += WaitTime;
+	MaxEQSQueueWaitTime = FMath::Max(MaxEQSQueueWaitTime, WaitTime);
+	++NumEQSQueueWaits;
+}
+
+void AEmpathAIController::GetEQSQueueWaitStats(float& LastWait, float& AverageWait, float& MaxWait) const
+{
+	LastWait = LastEQSQueueWaitTime;
+	AverageWait = (NumEQSQueueWaits > 0 ? TotalEQSQueueWaitTime / NumEQSQueueWaits : 0.0f);
+	MaxWait = MaxEQSQueueWaitTime;
+}
+
 void AEmpathAIController::GetAimLocation(FVector& OutAimLocation, USceneComponent*& OutTargetComponent) const
 {
 	// Check for manually set override
@@ -644,7 +802,42 @@ void AEmpathAIController::OnTargetSeenForFirstTime()
 FPathFollowingRequestResult AEmpathAIController::MoveTo(const FAIMoveRequest& MoveRequest,
 	FNavPathSharedPtr* OutPath)
 {
-	FPathFollowingRequestResult const Result = Super::MoveTo(MoveRequest, OutPath);
+	FPathFollowingRequestResult Result;
+
+	// Hunting AIs follow the shared flow field towards the player when they can, rather than finding their own path.
+	// The field is built with the nav mesh's default filter, so moves with their own filter find their own path.
+	FNavPathSharedPtr FlowFieldPath;
+	if (AIManager 
+		&& AIManager->IsFlowFieldNavigationEnabled()
+		&& MoveRequest.IsUsingPathfinding()
+		&& !MoveRequest.GetNavigationFilter()
+		&& GetPawn()
+		&& GetBehaviorMode() == EEmpathBehaviorMode::SearchAndDestroy
+		&& AIManager->GetFlowFieldPath(GetPawn()->GetNavAgentLocation(), MoveRequest.GetDestination(), this, FlowFieldPath))
+	{
+		// Repath like any other path if the nav mesh changes under us, or the goal actor moves away
+		FlowFieldPath->EnableRecalculationOnInvalidation(true);
+		if (MoveRequest.IsMoveToActorRequest() && MoveRequest.GetGoalActor())
+		{
+			FlowFieldPath->SetGoalActorObservation(*MoveRequest.GetGoalActor(), 100.0f);
+		}
+
+		Result.MoveId = RequestMove(MoveRequest, FlowFieldPath);
+		Result.Code = (Result.MoveId.IsValid() ? EPathFollowingRequestResult::RequestSuccessful : EPathFollowingRequestResult::Failed);
+		if (OutPath)
+		{
+			*OutPath = FlowFieldPath;
+		}
+		AIManager->AddFrameCount(&FEmpathAIFrameTimings::NumFlowFieldPaths);
+	}
+	else
+	{
+		Result = Super::MoveTo(MoveRequest, OutPath);
+		if (AIManager)
+		{
+			AIManager->AddFrameCount(&FEmpathAIFrameTimings::NumPathRequests);
+		}
+	}
 
 	const FVector GoalLocation = MoveRequest.GetDestination();
 
@@ -764,7 +957,37 @@ void AEmpathAIController::OnCapsuleBumpDuringMove(UPrimitiveComponent* HitComp,
 	}
 }
 
+void AEmpathAIController::OnHeardNoise(FVector const& NoiseLocation)
+{
+	ReceiveInvestigateLocation(NoiseLocation);
+}
+
+bool AEmpathAIController::GetInvestigationLocation(FVector& OutLocation) const
+{
+	return AIManager ? AIManager->GetInvestigationPoint(this, OutLocation) : false;
+}
+
+void AEmpathAIController::ClearInvestigationLocation()
+{
+	if (AIManager)
+	{
+		AIManager->ClearInvestigationPoint(this);
+	}
+}
+
 void AEmpathAIController::UpdateTargetingAndVision()
+{
+	// Let the AI manager spread updates across frames if it is scheduling them
+	if (AIManager && AIManager->IsTargetingSchedulerEnabled())
+	{
+		AIManager->QueueTargetingUpdate(this);
+		return;
+	}
+
+	UpdateTargetingAndVisionImmediately();
+}
+
+void AEmpathAIController::UpdateTargetingAndVisionImmediately()
 {
 	UpdateAttackTarget();
 	UpdateVision();
@@ -775,7 +998,14 @@ void AEmpathAIController::UpdateAttackTarget()
 	// Track how long it takes to complete this function for the profiler
 	SCOPE_CYCLE_COUNTER(STAT_EMPATH_UpdateAttackTarget);
 
-	// If we auto target the player, then simply set them as the attack target
+	if (AIManager)
+	{
+		FEmpathScopedAIFrameTiming const AttackTargetTiming(AIManager, &FEmpathAIFrameTimings::AttackTargetMs);
+		SetAttackTarget(ChooseAttackTarget(AIManager->GetWorldSnapshot()));
+		return;
+	}
+
+	// Without a manager there is no snapshot or anything else to score, but we can still auto target the player
 	if (bAutoTargetPlayer)
 	{
 		AController* PlayerCon = GetWorld()->GetFirstPlayerController();
@@ -785,10 +1015,18 @@ void AEmpathAIController::UpdateAttackTarget()
 			if (PlayerPawn)
 			{
 				SetAttackTarget(PlayerPawn);
-				return;
 			}
 		}
 	}
+}
+
+AActor* AEmpathAIController::ChooseAttackTarget(FEmpathAIWorldSnapshot const& WorldSnapshot) const
+{
+	// If we auto target the player, then simply set them as the attack target
+	if (bAutoTargetPlayer && WorldSnapshot.PlayerPawn)
+	{
+		return WorldSnapshot.PlayerPawn;
+	}
 
 	// Initialize internal variables
 	AActor* const CurrAttackTarget = GetAttackTarget();
@@ -803,10 +1041,10 @@ void AEmpathAIController::UpdateAttackTarget()
 		if (bCanTargetSecondaryTargets)
 		{
 			// Ensure there are secondary targets
-			TArray<FSecondaryAttackTarget> const& SecondaryTargets = AIManager->GetSecondaryAttackTargets();
+			TArray<FSecondaryAttackTarget> const& SecondaryTargets = WorldSnapshot.SecondaryTargets;
 			if (SecondaryTargets.Num() > 0)
 			{
-				// Check each valid secondary target
+				// Check each valid secondary target. Secondary targets are always known.
 				for (FSecondaryAttackTarget const& CurrentTarget : SecondaryTargets)
 				{
 					if (CurrentTarget.IsValid())
@@ -814,7 +1052,8 @@ void AEmpathAIController::UpdateAttackTarget()
 						float const Score = GetTargetSelectionScore(CurrentTarget.TargetActor,
 							CurrentTarget.TargetingRatio,
 							CurrentTarget.TargetPreference,
-							CurrAttackTarget);
+							CurrAttackTarget,
+							true);
 
 						// If this is better than our current target, update accordingly
 						if (Score > BestScore)
@@ -829,32 +1068,33 @@ void AEmpathAIController::UpdateAttackTarget()
 
 		if (bIgnorePlayer == false)
 		{
-			// Check player score if player exists
-			APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
-			if (PlayerController)
+			// Check player score if player exists, is our VR Character, and is not dead
+			AEmpathPlayerCharacter* const PlayerTarget = WorldSnapshot.Player;
+			if (PlayerTarget && !WorldSnapshot.bPlayerDead)
 			{
-				// Ensure this is our VR Character and they are not dead
-				AEmpathPlayerCharacter* const PlayerTarget = Cast<AEmpathPlayerCharacter>(PlayerController->GetPawn());
-				if (PlayerTarget && !PlayerTarget->IsDead())
+				float const PlayerScore = GetTargetSelectionScore(PlayerTarget,
+					0.0f,
+					0.0f,
+					CurrAttackTarget,
+					AIManager->IsTargetLocationKnown(PlayerTarget));
+
+				// If the player is the best target, target them
+				if (PlayerScore > BestScore)
 				{
-					float const PlayerScore = GetTargetSelectionScore(PlayerTarget,
-						0.0f,
-						0.0f,
-						CurrAttackTarget);
-
-					// If the player is the best target, target them
-					if (PlayerScore > BestScore)
-					{
-						BestScore = PlayerScore;
-						BestAttackTarget = PlayerTarget;
-					}
+					BestScore = PlayerScore;
+					BestAttackTarget = PlayerTarget;
 				}
 			}
 		}
 	}
 
-	// Update attack target
-	SetAttackTarget(BestAttackTarget);
+	return BestAttackTarget;
+}
+
+void AEmpathAIController::CommitAttackTargetAndUpdateVision(AActor* NewAttackTarget)
+{
+	SetAttackTarget(NewAttackTarget);
+	UpdateVision();
 }
 
 void AEmpathAIController::UpdateVision(bool bTestImmediately)
@@ -862,6 +1102,9 @@ void AEmpathAIController::UpdateVision(bool bTestImmediately)
 	// Track how long it takes to complete this function for the profiler
 	SCOPE_CYCLE_COUNTER(STAT_EMPATH_UpdateVision);
 
+	// Add our time to the AI manager's frame timings for benchmarking
+	FEmpathScopedAIFrameTiming const VisionTiming(AIManager, &FEmpathAIFrameTimings::VisionMs);
+
 	// Check if we can see the target
 	UWorld* const World = GetWorld();
 	AActor* const AttackTarget = GetAttackTarget();
@@ -869,17 +1112,25 @@ void AEmpathAIController::UpdateVision(bool bTestImmediately)
 	if (World && AttackTarget && AIManager)
 	{
 		// Check is the player is teleporting to a new location. If so, we can't see them
-		AEmpathPlayerCharacter* const PlayerTarget = Cast<AEmpathPlayerCharacter>(AttackTarget);
-		if (PlayerTarget && PlayerTarget->GetTeleportState() == EEmpathTeleportState::TeleportingToLocation)
+		FEmpathAIWorldSnapshot const& WorldSnapshot = AIManager->GetWorldSnapshot();
+		if (WorldSnapshot.Player && AttackTarget == WorldSnapshot.Player && WorldSnapshot.PlayerTeleportState == EEmpathTeleportState::TeleportingToLocation)
 		{
 			SetCanSeeTarget(false);
 			return;
 		}
 
-		// Set up raycasting params
-		FCollisionQueryParams Params(AIVisionTraceTag);
-		Params.AddIgnoredActor(GetPawn());
-		Params.AddIgnoredActor(AttackTarget);
+		// Check whether the target's location is known or may be lost
+		bool const bAlreadyKnowsTargetLoc = AIManager->IsTargetLocationKnown(AttackTarget);
+		bool const bPlayerMayBeLost = AIManager->IsPlayerPotentiallyLost();
+
+		// Choose how detailed this update should be, or whether to skip it. 
+		// Immediate tests are always fully detailed, as are updates while the player may be lost, so that we find them again promptly.
+		bool const bUsePerceptionLOD = !bTestImmediately && !bPlayerMayBeLost;
+		if (bUsePerceptionLOD && !UpdatePerceptionLOD())
+		{
+			return;
+		}
+		FEmpathPerceptionLODSettings const* const LODSettings = (bUsePerceptionLOD && PerceptionLODTiers.IsValidIndex(CurrentPerceptionLOD)) ? &PerceptionLODTiers[CurrentPerceptionLOD] : nullptr;
 
 		// Get view location and rotation
 		FVector ViewLoc;
@@ -892,40 +1143,25 @@ void AEmpathAIController::UpdateVision(bool bTestImmediately)
 		USceneComponent* OutAimLocationComponent;
 		UEmpathFunctionLibrary::GetAimLocationOnActor(AttackTarget, ViewLoc, FRotationMatrix(ViewRotation).GetScaledAxis(EAxis::X), TraceEnd, OutAimLocationComponent);
 
-		// Check whether the target's location is known or may be lost
-		bool const bAlreadyKnowsTargetLoc = AIManager->IsTargetLocationKnown(AttackTarget);
-		bool const bPlayerMayBeLost = AIManager->IsPlayerPotentiallyLost();
-
 		// Only test the vision angle when the AI doesn't already know where the target is or the player might be lost
-		bool const bTestVisionCone = (bPlayerMayBeLost || !bAlreadyKnowsTargetLoc) && (!bIgnoreVisionCone);
+		bool const bNeedsVisionCone = (bPlayerMayBeLost || !bAlreadyKnowsTargetLoc) && (!bIgnoreVisionCone);
+
+		// Our perception LOD may skip the test, in which case we reuse our last result if we have one
+		bool const bReuseVisionCone = bNeedsVisionCone && bHasVisionConeResult && LODSettings && !LODSettings->bTestVisionCone;
+		bool const bTestVisionCone = bNeedsVisionCone && !bReuseVisionCone;
+
+		// When the AI manager will be tracing for us anyway, let it test our vision cone together with everyone else's
+		bool const bDeferVisionCone = bTestVisionCone && !bTestImmediately && !bIgnoreVisionBlockingHits && (!LODSettings || LODSettings->bTraceLineOfSight);
+		FVector const EyesForwardNorm = ViewRotation.Vector();
+		FEmpathVisionCone const VisionCone = GetVisionCone(EyesForwardNorm);
 
-		bool bInVisionCone = true;
+		bool bInVisionCone = bReuseVisionCone ? bLastInVisionCone : true;
 		if (bTestVisionCone)
 		{
-			// Cache distance to target
-			FVector const ToTarget = (TraceEnd - ViewLoc);
-			float ToTargetDist = ToTarget.Size();
-			FVector const ToTargetNorm = ToTarget.GetSafeNormal();
-			FVector const EyesForwardNorm = ViewRotation.Vector();
-
-			// Is the target within our auto see range?
-			if (ToTargetDist <= AutoSeeDistance)
+			if (!bDeferVisionCone)
 			{
-				// If so, automatically see them
-				bInVisionCone = true;
-			}
-
-			// Else, check the angle of the target to our vision
-			else
-			{
-				// Set the cos limit depending on distance from the target
-				float const AngleCos = FVector::DotProduct(ToTargetNorm, EyesForwardNorm);
-				float const CosLimit = ((ToTargetDist <= PeripheralVisionDistance) ? 
-					FMath::Cos(FMath::DegreesToRadians(PeripheralVisionAngle)) : 
-					FMath::Cos(FMath::DegreesToRadians(ForwardVisionAngle)));
-				
-				// Return whether we are in the vision cone
-				bInVisionCone = (AngleCos >= CosLimit);
+				bInVisionCone = VisionCone.IsInVisionCone(ViewLoc, TraceEnd);
+				SetVisionConeResult(bInVisionCone);
 			}
 
 			//// Draw debug shapes if appropriate
@@ -960,11 +1196,15 @@ void AEmpathAIController::UpdateVision(bool bTestImmediately)
 			}
 			else
 			{
-				FCollisionResponseParams const ResponseParams = FCollisionResponseParams::DefaultResponseParam;
-
 				// If we want to trace immediately, conduct the trace this frame
 				if (bTestImmediately)
 				{
+					// Set up raycasting params
+					FCollisionQueryParams Params(AIVisionTraceTag);
+					Params.AddIgnoredActor(GetPawn());
+					Params.AddIgnoredActor(AttackTarget);
+					FCollisionResponseParams const ResponseParams = FCollisionResponseParams::DefaultResponseParam;
+
 					bool bHasLOS = true;
 					FHitResult OutHit(0.f);
 					bool bHit = (World->LineTraceSingleByChannel(OutHit, TraceStart, TraceEnd,
@@ -1002,13 +1242,13 @@ void AEmpathAIController::UpdateVision(bool bTestImmediately)
 				}
 
 				// Most of the time, we don't mind getting the results a few frames late, so we'll
-				// conduct the trace asynchroniously for performance
-				else
+				// have the AI manager conduct the trace asynchroniously with everyone else's for performance
+				else if (!LODSettings || LODSettings->bTraceLineOfSight)
 				{
-					CurrentLOSTraceHandle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single,
-						TraceStart, TraceEnd, ECC_Visibility, Params, ResponseParams,
-						&OnLOSTraceCompleteDelegate);
+					AIManager->RequestVisionTrace(this, TraceStart, TraceEnd, AttackTarget, bDeferVisionCone, VisionCone);
 				}
+
+				// Otherwise, our perception LOD skips the trace and we keep our last line of sight result
 			}
 
 
@@ -1021,10 +1261,106 @@ void AEmpathAIController::UpdateVision(bool bTestImmediately)
 	}
 }
 
+FEmpathVisionCone AEmpathAIController::GetVisionCone(FVector const& EyesForward) const
+{
+	return FEmpathVisionCone(EyesForward,
+		AutoSeeDistance,
+		PeripheralVisionDistance,
+		PeripheralVisionCos,
+		ForwardVisionCos);
+}
+
+void AEmpathAIController::UpdateVisionConeCosines()
+{
+	PeripheralVisionCos = FMath::Cos(FMath::DegreesToRadians(PeripheralVisionAngle));
+	ForwardVisionCos = FMath::Cos(FMath::DegreesToRadians(ForwardVisionAngle));
+}
+
+bool AEmpathAIController::UpdatePerceptionLOD()
+{
+	// Passive and dead AIs don't need to see anything
+	if (IsPassive() || IsDead())
+	{
+		CurrentPerceptionLOD = INDEX_NONE;
+		return false;
+	}
+
+	// Perception LOD is disabled, or we have nothing to place, so always do a full update
+	APawn* const MyPawn = GetPawn();
+	if (PerceptionLODTiers.Num() == 0 || !MyPawn)
+	{
+		CurrentPerceptionLOD = INDEX_NONE;
+		return true;
+	}
+
+	// Find how far we are from the player, and whether they are looking at us
+	UWorld* const World = GetWorld();
+	FVector const MyLoc = MyPawn->GetActorLocation();
+	float DistToPlayer = BIG_NUMBER;
+	bool bInPlayerView = false;
+	FEmpathAIWorldSnapshot const* const WorldSnapshot = (AIManager ? &AIManager->GetWorldSnapshot() : nullptr);
+	if (WorldSnapshot && WorldSnapshot->bHasPlayerView)
+	{
+		FVector ToAIDir;
+		(MyLoc - WorldSnapshot->PlayerViewLocation).ToDirectionAndLength(ToAIDir, DistToPlayer);
+		bInPlayerView = (FVector::DotProduct(ToAIDir, WorldSnapshot->PlayerViewRotation.Vector()) >= FMath::Cos(FMath::DegreesToRadians(PerceptionLODPlayerViewAngle)));
+	}
+
+	// Check whether we are in combat
+	AActor* const AttackTarget = GetAttackTarget();
+	bool const bInCombat = CanSeeTarget() || (AttackTarget && AIManager && AIManager->IsTargetLocationKnown(AttackTarget));
+
+	// Use the first tier whose requirements we meet, falling back to the least detailed one
+	int32 NewLOD = PerceptionLODTiers.Num() - 1;
+	for (int32 Idx = 0; Idx < PerceptionLODTiers.Num(); ++Idx)
+	{
+		FEmpathPerceptionLODSettings const& Tier = PerceptionLODTiers[Idx];
+		if ((Tier.MaxDistanceToPlayer <= 0.0f || DistToPlayer <= Tier.MaxDistanceToPlayer)
+			&& (!Tier.bRequiresInPlayerView || bInPlayerView)
+			&& (!Tier.bRequiresCombat || bInCombat))
+		{
+			NewLOD = Idx;
+			break;
+		}
+	}
+	CurrentPerceptionLOD = NewLOD;
+
+	// Skip this update if it is too soon for our tier
+	float const UpdateInterval = PerceptionLODTiers[NewLOD].MinVisionUpdateInterval;
+	AIVISION_STRING(MyLoc + FVector(0.0f, 0.0f, 120.0f), FString::Printf(TEXT("Perception LOD %d"), NewLOD), FColor::Cyan, FMath::Max(UpdateInterval, 0.1f));
+	if (World->TimeSince(LastVisionUpdateTime) < UpdateInterval)
+	{
+		return false;
+	}
+
+	LastVisionUpdateTime = World->GetTimeSeconds();
+	return true;
+}
+
+void AEmpathAIController::BakeTargetSelectionCurves()
+{
+	// Curves that are too coarse to bake are evaluated directly
+	bool const bBakeCurves = (TargetSelectionCurveSamples >= 2);
+	TargetSelectionDistScoreLUT = bBakeCurves ? FEmpathCurveLUT::FindOrBake(TargetSelectionDistScoreCurve, TargetSelectionCurveSamples, false) : nullptr;
+	if (TargetSelectionDistScoreLUT.IsValid() && TargetSelectionDistScoreLUT->MaxError > TargetSelectionCurveMaxError)
+	{
+		UE_LOG(LogAIController, Warning, TEXT("%s: Baked %s differs from the curve by up to %f. Consider raising TargetSelectionCurveSamples."), 
+			*GetNameSafe(this), *GetNameSafe(TargetSelectionDistScoreCurve), TargetSelectionDistScoreLUT->MaxError);
+	}
+
+	TargetSelectionAngleScoreLUT = bBakeCurves ? FEmpathCurveLUT::FindOrBake(TargetSelectionAngleScoreCurve, TargetSelectionCurveSamples, true) : nullptr;
+	if (TargetSelectionAngleScoreLUT.IsValid() && TargetSelectionAngleScoreLUT->MaxError > TargetSelectionCurveMaxError)
+	{
+		UE_LOG(LogAIController, Warning, TEXT("%s: Baked %s differs from the curve by up to %f. Consider raising TargetSelectionCurveSamples."), 
+			*GetNameSafe(this), *GetNameSafe(TargetSelectionAngleScoreCurve), TargetSelectionAngleScoreLUT->MaxError);
+	}
+}
+
 float AEmpathAIController::GetTargetSelectionScore(AActor* CandidateTarget,
 	float DesiredCandidateTargetingRatio,
 	float CandidateTargetPreference,
-	AActor* CurrentTarget) const
+	AActor* CurrentTarget,
+	bool bCandidateLocationKnown) const
 {
 	// Ensure the target and controlled pawns are valid
 	ACharacter* const AIChar = Cast<ACharacter>(GetPawn());
@@ -1040,17 +1376,33 @@ float AEmpathAIController::GetTargetSelectionScore(AActor* CandidateTarget,
 		float AItoCandidateDist;
 		(CandidateLoc - AICharLoc).ToDirectionAndLength(AItoCandidateDir, AItoCandidateDist);
 
-		// Find angle
-		float const Angle = FMath::RadiansToDegrees(FMath::Acos(AItoCandidateDir | AIChar->GetActorForwardVector()));
+		// Find angle. The baked angle curve is keyed by cosine, so we only need the angle itself if it isn't baked.
+		float const AngleCos = AItoCandidateDir | AIChar->GetActorForwardVector();
 
 		// Find final score using the curves defined in editor
-		float const DistScore = DistScoreWeight * (TargetSelectionDistScoreCurve ? TargetSelectionDistScoreCurve->GetFloatValue(AItoCandidateDist) : 0.f);
-		float const AngleScore = AngleScoreWeight * (TargetSelectionAngleScoreCurve ? TargetSelectionAngleScoreCurve->GetFloatValue(Angle) : 0.f);
+		float DistScore = 0.f;
+		if (TargetSelectionDistScoreLUT.IsValid() && TargetSelectionDistScoreLUT->IsBaked())
+		{
+			DistScore = DistScoreWeight * TargetSelectionDistScoreLUT->Evaluate(AItoCandidateDist);
+		}
+		else if (TargetSelectionDistScoreCurve)
+		{
+			DistScore = DistScoreWeight * TargetSelectionDistScoreCurve->GetFloatValue(AItoCandidateDist);
+		}
+		float AngleScore = 0.f;
+		if (TargetSelectionAngleScoreLUT.IsValid() && TargetSelectionAngleScoreLUT->IsBaked())
+		{
+			AngleScore = AngleScoreWeight * TargetSelectionAngleScoreLUT->Evaluate(AngleCos);
+		}
+		else if (TargetSelectionAngleScoreCurve)
+		{
+			AngleScore = AngleScoreWeight * TargetSelectionAngleScoreCurve->GetFloatValue(FMath::RadiansToDegrees(FMath::Acos(AngleCos)));
+		}
 		float const CurrentTargetPrefScore = (CurrentTarget && CandidateTarget == CurrentTarget) ? CurrentTargetPreferenceWeight : 0.f;
 		float const CandidateTargetPrefScore = TargetPrefScoreWeight * CandidateTargetPreference;
 
 		// Apply a large penalty if we don't know the target location
-		float const CandidateIsLostPenalty = AIManager->IsTargetLocationKnown(CandidateTarget) ? 0.f : -10.f;
+		float const CandidateIsLostPenalty = bCandidateLocationKnown ? 0.f : -10.f;
 
 		// Calculate bonus or penalty depending on the ratio of AI targeting this target
 		float TargetingRatioBonusScore = 0.f;
@@ -1369,7 +1721,7 @@ void AEmpathAIController::OnAttackTargetTeleported(AActor* Target, FVector Origi
 			LOSTraceHandleToIgnore = CurrentLOSTraceHandle;
 		}
 		// Check again if we can see the target
-		UpdateTargetingAndVision();
+		UpdateTargetingAndVisionImmediately();
 
 		LastSawAttackTargetTeleportTime = GetWorld()->GetTimeSeconds();
 
@@ -1382,23 +1734,17 @@ int32 AEmpathAIController::GetNumAIsNearby(float Radius) const
 	int32 Count = 0;
 	APawn const* const MyPawn = GetPawn();
 
-	// Check how close each existing nearby AI is to this pawn
+	// Count the other AIs the AI manager finds in the radius
 	if (MyPawn && AIManager)
 	{
-		for (AEmpathAIController* CurrentAI : AIManager->EmpathAICons)
+		AIManager->ForEachAIInRadius(MyPawn->GetActorLocation(), Radius, [this, &Count](AEmpathAIController* CurrentAI)
 		{
 			if (CurrentAI != this)
 			{
-				APawn const* const CurrentPawn = CurrentAI->GetPawn();
-				if (CurrentPawn)
-				{
-					if (MyPawn->GetDistanceTo(CurrentPawn) <= Radius)
-					{
-						++Count;
-					}
-				}
+				++Count;
 			}
-		}
+			return true;
+		});
 	}
 	return Count;
 }
@@ -1431,6 +1777,16 @@ void AEmpathAIController::UnregisterAIManager()
 	{
 		// Remove us from the list of AI cons
 		AIManager->EmpathAICons.RemoveAtSwap(AIManagerIndex);
+		AIManager->RemoveFromSpatialGrid(this);
+		AIManager->CancelTargetingUpdate(this);
+		AIManager->CancelVisionTrace(this);
+		AIManager->CancelEQSRequest(this);
+		AbortRepositionQuery();
+		AIManager->ClearInvestigationPoint(this);
+		AIManager->CancelLostPlayerResponse(this);
+		AIManager->OnAIAttackTargetChanged(CountedAttackTarget.Get(), nullptr);
+		CountedAttackTarget = nullptr;
+		AIManager->InvalidateEQSContextCache(GetPawn());
 
 		// Update the index we swapped with
 		if (AIManagerIndex < AIManager->EmpathAICons.Num())
@@ -1501,9 +1857,17 @@ bool AEmpathAIController::DoJumpLaunch_Internal(FTransform const& Destination, f
 		FVector const StartLoc = AIChar->GetActorLocation();
 		FVector const DestLoc = Destination.GetLocation();
 
+		// If we're jumping from a jump link, it may have already baked this jump. It only matches if the offset from our feet to the destination is the baked one.
+		AEmpathNavLinkProxy_Jump const* const JumpLink = (InLaunchVel == nullptr ? Cast<AEmpathNavLinkProxy_Jump const>(JumpFromActor) : nullptr);
+		FEmpathJumpTrajectory const* const BakedJump = (JumpLink ? JumpLink->FindBakedJumpTrajectoryForJumper(AIChar, DestLoc, Arc) : nullptr);
+
 		// Calculation launch velocity if it was not passed to us
 		FVector LaunchVel;
-		if (InLaunchVel == nullptr)
+		if (BakedJump)
+		{
+			LaunchVel = BakedJump->LaunchVelocity;
+		}
+		else if (InLaunchVel == nullptr)
 		{
 			// Compute LaunchVel
 			if (!UEmpathFunctionLibrary::SuggestProjectileVelocity(AIChar, LaunchVel, StartLoc, DestLoc, Arc))
@@ -1521,7 +1885,15 @@ bool AEmpathAIController::DoJumpLaunch_Internal(FTransform const& Destination, f
 
 		// Launch the character and update out variables
 		AIChar->LaunchCharacter(LaunchVel, true, true);
-		UEmpathFunctionLibrary::CalculateJumpTimings(this, LaunchVel, StartLoc, DestLoc, OutAscendingTime, OutDescendingTime);
+		if (BakedJump)
+		{
+			OutAscendingTime = BakedJump->AscendingTime;
+			OutDescendingTime = BakedJump->DescendingTime;
+		}
+		else
+		{
+			UEmpathFunctionLibrary::CalculateJumpTimings(this, LaunchVel, StartLoc, DestLoc, OutAscendingTime, OutDescendingTime);
+		}
 		OnAIJumpTo.Broadcast(this, LaunchVel, StartLoc, DestLoc, JumpFromActor, OutAscendingTime, OutDescendingTime);
 		bSuccess = true;
 	}
@@ -1531,28 +1903,16 @@ bool AEmpathAIController::DoJumpLaunch_Internal(FTransform const& Destination, f
 
 void AEmpathAIController::ClaimAllNavLinksOnPath()
 {
-	UEmpathPathFollowingComponent* const PFC = Cast<UEmpathPathFollowingComponent>(GetPathFollowingComponent());
-	if (PFC)
+	// Loop through all nav links on the path and claim them
+	for (FEmpathPathNavLink const& PathNavLink : GetCurrentPathNavLinks())
 	{
-		// If the path is valid
-		UNavigationSystemV1* const NavSys = UNavigationSystemV1::GetCurrent(GetWorld());
-		const FNavPathSharedPtr& NewPath = PFC->GetPath();
-		if (NewPath.IsValid())
+		AEmpathNavLinkProxy* const EmpathNavLink = PathNavLink.NavLink.Get();
+
+		// The path may cross the same link more than once
+		if (EmpathNavLink && !EmpathNavLink->IsClaimedBy(this))
 		{
-			// Loop through all nav links on the path and claim them
-			TArray<FNavPathPoint>& PathPoints = NewPath->GetPathPoints();
-			for (int32 Idx = 0; Idx < PathPoints.Num(); ++Idx)		// note start at next idx -- only return true for upcoming jumps
-			{
-				FNavPathPoint const& PathPt = PathPoints[Idx];
-				INavLinkCustomInterface* const CustomNavLink = NavSys->GetCustomLink(PathPt.CustomLinkId);
-				UObject* const NavLinkComp = CustomNavLink ? CustomNavLink->GetLinkOwner() : nullptr;
-				AEmpathNavLinkProxy* const EmpathNavLink = NavLinkComp ? Cast<AEmpathNavLinkProxy>(NavLinkComp->GetOuter()) : nullptr;
-				if (EmpathNavLink)
-				{
-					EmpathNavLink->Claim(this);
-					ClaimedNavLinks.AddUnique(EmpathNavLink);
-				}
-			}
+			EmpathNavLink->Claim(this);
+			ClaimedNavLinks.Add(EmpathNavLink);
 		}
 	}
 }
@@ -1590,30 +1950,75 @@ bool AEmpathAIController::CurrentPathHasUpcomingJumpLink() const
 	return (GetUpcomingJumpLink() != nullptr);
 }
 
+TArray<FEmpathPathNavLink> const& AEmpathAIController::GetCurrentPathNavLinks() const
+{
+	UPathFollowingComponent const* const PFC = GetPathFollowingComponent();
+	FNavPathSharedPtr const CurrentPath = PFC ? PFC->GetPath() : nullptr;
+	if (!CurrentPath.IsValid())
+	{
+		CurrentPathNavLinks.Reset();
+		CurrentPathDistances.Reset();
+		CurrentPathNavLinksSource.Reset();
+		return CurrentPathNavLinks;
+	}
+
+	// Only look up the links when we get a new path
+	if (!CurrentPathNavLinksSource.HasSameObject(CurrentPath.Get()))
+	{
+		CurrentPathNavLinksSource = CurrentPath;
+		CurrentPathNavLinks.Reset();
+		CurrentPathDistances.Reset();
+
+		TArray<FNavPathPoint> const& PathPoints = CurrentPath->GetPathPoints();
+		CurrentPathDistances.Reserve(PathPoints.Num());
+		for (int32 Idx = 0; Idx < PathPoints.Num(); ++Idx)
+		{
+			CurrentPathDistances.Add(Idx > 0 ? CurrentPathDistances[Idx - 1] + (PathPoints[Idx].Location - PathPoints[Idx - 1].Location).Size() : 0.0f);
+
+			AEmpathNavLinkProxy* const EmpathNavLink = AEmpathNavLinkProxy::FindByCustomLinkId(PathPoints[Idx].CustomLinkId);
+			if (EmpathNavLink)
+			{
+				FEmpathPathNavLink& PathNavLink = CurrentPathNavLinks[CurrentPathNavLinks.Add(FEmpathPathNavLink(Idx))];
+				PathNavLink.NavLink = EmpathNavLink;
+				PathNavLink.JumpLink = Cast<AEmpathNavLinkProxy_Jump>(EmpathNavLink);
+
+				// Jump animations need to know how sharply we turn onto and off of the jump
+				if (PathNavLink.JumpLink.IsValid() && PathPoints.IsValidIndex(Idx + 1))
+				{
+					FVector const JumpSegmentDirNorm = (PathPoints[Idx + 1].Location - PathPoints[Idx].Location).GetSafeNormal2D();
+					FVector const PreJumpSegmentDirNorm = (Idx > 0 ?
+						(PathPoints[Idx].Location - PathPoints[Idx - 1].Location).GetSafeNormal2D()
+						: JumpSegmentDirNorm);
+					FVector const PostJumpSegmentDirNorm = (PathPoints.IsValidIndex(Idx + 2) ?
+						(PathPoints[Idx + 2].Location - PathPoints[Idx + 1].Location).GetSafeNormal2D()
+						: JumpSegmentDirNorm);
+					PathNavLink.EntryAngle = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(PreJumpSegmentDirNorm | JumpSegmentDirNorm, -1.0f, 1.0f)));
+					PathNavLink.ExitAngle = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(JumpSegmentDirNorm | PostJumpSegmentDirNorm, -1.0f, 1.0f)));
+				}
+			}
+		}
+	}
+
+	return CurrentPathNavLinks;
+}
+
+void AEmpathAIController::InvalidateCurrentPathNavLinks()
+{
+	CurrentPathNavLinksSource.Reset();
+}
+
 AEmpathNavLinkProxy_Jump* AEmpathAIController::GetUpcomingJumpLink() const
 {
 	UEmpathPathFollowingComponent* const PFC = Cast<UEmpathPathFollowingComponent>(GetPathFollowingComponent());
 	if (PFC)
 	{
-		// Check if the upcoming path is valid
+		// Return the first jump link we find at or after the next path point -- only return upcoming jumps
 		int32 const NextPathIndex = PFC->GetNextPathIndex();
-		UNavigationSystemV1* const NavSys = UNavigationSystemV1::GetCurrent(GetWorld());
-		const FNavPathSharedPtr& NewPath = PFC->GetPath();
-		if (NewPath.IsValid())
+		for (FEmpathPathNavLink const& PathNavLink : GetCurrentPathNavLinks())
 		{
-			// Iterate through the the path points and check for a jump link
-			TArray<FNavPathPoint>& PathPoints = NewPath->GetPathPoints();
-			for (int32 Idx = NextPathIndex; Idx < PathPoints.Num(); ++Idx)		// note start at next idx -- only return true for upcoming jumps
+			if (PathNavLink.PathIndex >= NextPathIndex && PathNavLink.JumpLink.IsValid())
 			{
-				FNavPathPoint const& PathPt = PathPoints[Idx];
-				INavLinkCustomInterface* const CustomNavLink = NavSys->GetCustomLink(PathPt.CustomLinkId);
-				UObject* const NavLinkComp = CustomNavLink ? CustomNavLink->GetLinkOwner() : nullptr;
-				AEmpathNavLinkProxy_Jump* const JumpLink = NavLinkComp ? Cast<AEmpathNavLinkProxy_Jump>(NavLinkComp->GetOuter()) : nullptr;
-				if (JumpLink)
-				{
-					// Return the first jump link we find.
-					return JumpLink;
-				}
+				return PathNavLink.JumpLink.Get();
 			}
 		}
 	}
@@ -1637,93 +2042,38 @@ bool AEmpathAIController::GetUpcomingJumpLinkAnimInfo(float& OutPathDistToJumpLi
 	UEmpathPathFollowingComponent* const PFC = Cast<UEmpathPathFollowingComponent>(GetPathFollowingComponent());
 	if (PFC)
 	{
-		// Initialize variables
-		FVector const CurrentPathLoc = PFC->GetLocationOnPath();
-		int32 NextPathIndex = PFC->GetNextPathIndex();
-		float PathDistBeforeJumpLink = 0.f;
-		float PathDistOnJumpLink = 0.f;
-		float PathDistAfterJumpLink = 0.f;
-
-		// Check that the path is valid
-		UNavigationSystemV1* const NavSys = UNavigationSystemV1::GetCurrent(GetWorld());
-		const FNavPathSharedPtr& NewPath = PFC->GetPath();
-		if (NewPath.IsValid())
+		// There could be multiple jump links on remaining path, but we only care about the next one
+		int32 const NextPathIndex = PFC->GetNextPathIndex();
+		FEmpathPathNavLink const* JumpNavLink = nullptr;
+		for (FEmpathPathNavLink const& PathNavLink : GetCurrentPathNavLinks())
 		{
-			// Iterate through the upcoming nav points for a jump link
-			TArray<FNavPathPoint>& PathPoints = NewPath->GetPathPoints();
-			FVector PrevLoc = CurrentPathLoc;
-			bool bAfterJumpLink = false;
-			bool bPrevWasJumpLink = false;
-			int32 JumpLinkIdx = INDEX_NONE;
-			for (int32 Idx = NextPathIndex; Idx < PathPoints.Num(); ++Idx)
+			if (PathNavLink.PathIndex >= NextPathIndex && PathNavLink.JumpLink.IsValid())
 			{
-				FNavPathPoint const& PathPt = PathPoints[Idx];
-
-				// If we found a jump link
-				AEmpathNavLinkProxy_Jump* JumpLink = nullptr;
-				if (JumpLinkIdx == INDEX_NONE)
-				{
-					// There could be  multiple jump links on remaining path,  but we only care about the next one
-					INavLinkCustomInterface* const CustomNavLink = NavSys->GetCustomLink(PathPt.CustomLinkId);
-					UObject* const NavLinkComp = CustomNavLink ? CustomNavLink->GetLinkOwner() : nullptr;
-					JumpLink = NavLinkComp ? Cast<AEmpathNavLinkProxy_Jump>(NavLinkComp->GetOuter()) : nullptr;
-					if (JumpLink)
-					{
-						JumpLinkIdx = Idx;
-					}
-				}
-
-				// Get the distance after the jump link
-				float const PathSegmentLength = (PathPt.Location - PrevLoc).Size();
-				if (bAfterJumpLink)
-				{
-					PathDistAfterJumpLink += PathSegmentLength;
-				}
-				else if (bPrevWasJumpLink)
-				{
-					bAfterJumpLink = true;
-					PathDistOnJumpLink = PathSegmentLength;
-				}
-				else
-				{
-					PathDistBeforeJumpLink += PathSegmentLength;
-				}
-
-				// Update variables for next loop
-				PrevLoc = PathPt.Location;
-				bPrevWasJumpLink = JumpLink != nullptr;
-			}
-
-			// If we didn't find a jump, return false
-			if (JumpLinkIdx == INDEX_NONE)
-			{
-				return false;
+				JumpNavLink = &PathNavLink;
+				break;
 			}
+		}
 
-			// Calculation directions pre, during, and post jump
-			FVector const PreJumpSegmentDirNorm = (PathPoints[JumpLinkIdx].Location - PathPoints[JumpLinkIdx - 1].Location).GetSafeNormal2D();
-			FVector const JumpSegmentDirNorm = (PathPoints[JumpLinkIdx + 1].Location - PathPoints[JumpLinkIdx].Location).GetSafeNormal2D();
-			FVector const PostJumpSegmentDirNorm = PathPoints.IsValidIndex(JumpLinkIdx + 2) ?
-				(PathPoints[JumpLinkIdx + 2].Location - PathPoints[JumpLinkIdx + 1].Location).GetSafeNormal2D()
-				: JumpSegmentDirNorm;
-
-			// Calculation entry angle
-			float EntryDot = PreJumpSegmentDirNorm | JumpSegmentDirNorm;
-			float ExitDot = JumpSegmentDirNorm | PostJumpSegmentDirNorm;
+		// If we didn't find a jump, return false
+		int32 const JumpLinkIdx = (JumpNavLink ? JumpNavLink->PathIndex : INDEX_NONE);
+		if (JumpLinkIdx == INDEX_NONE || !CurrentPathDistances.IsValidIndex(JumpLinkIdx + 1))
+		{
+			return false;
+		}
 
-			// Update out variables
-			OutPathDistToJumpLink = PathDistBeforeJumpLink;
-			OutEntryAngle = FMath::RadiansToDegrees(FMath::Acos(EntryDot));
-			OutJumpDistance = PathDistOnJumpLink;
-			OutPathDistAfterJumpLink = PathDistAfterJumpLink;
-			OutExitAngle = FMath::RadiansToDegrees(FMath::Acos(ExitDot));
+		// Path distances and angles are cached with the path, so we only need to account for where we are on it
+		FVector const CurrentPathLoc = PFC->GetLocationOnPath();
+		FVector const NextPathLoc = PFC->GetPath()->GetPathPoints()[NextPathIndex].Location;
+		OutPathDistToJumpLink = (NextPathLoc - CurrentPathLoc).Size() + CurrentPathDistances[JumpLinkIdx] - CurrentPathDistances[NextPathIndex];
+		OutEntryAngle = JumpNavLink->EntryAngle;
+		OutJumpDistance = CurrentPathDistances[JumpLinkIdx + 1] - CurrentPathDistances[JumpLinkIdx];
+		OutPathDistAfterJumpLink = CurrentPathDistances.Last() - CurrentPathDistances[JumpLinkIdx + 1];
+		OutExitAngle = JumpNavLink->ExitAngle;
 
-			return true;
-		}
+		return true;
 	}
 
 	return false;
-
 }
 
 FVector AEmpathAIController::GetNavRecoveryDestination() const
@@ -4,96 +4,1486 @@
 #include "EmpathAIController.h"
 #include "Runtime/Engine/Public/EngineUtils.h"
 #include "EmpathPlayerCharacter.h"
+#include "EmpathCharacter.h"
+#include "EmpathFunctionLibrary.h"
 #include "EmpathTypes.h"
+#include "EQC_LastKnownPlayerLocation.h"
 #include "GameFramework/PlayerController.h"
 #include "TimerManager.h"
+#include "Async/ParallelFor.h"
+#include "NavigationSystem/Public/NavigationSystem.h"
+#include "NavigationSystem/Public/NavMesh/RecastNavMesh.h"
+#include "NavigationSystem/Public/NavMesh/NavMeshPath.h"
 
 // Stats for UE Profiler
 DECLARE_CYCLE_STAT(TEXT("AI Hearing Checks"), STAT_EMPATH_HearingChecks, STATGROUP_EMPATH_AIManager);
+DECLARE_CYCLE_STAT(TEXT("AI World Snapshot"), STAT_EMPATH_WorldSnapshot, STATGROUP_EMPATH_AIManager);
+DECLARE_CYCLE_STAT(TEXT("AI Flow Field Update"), STAT_EMPATH_FlowFieldUpdate, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI Flow Field Polys"), STAT_EMPATH_FlowFieldPolys, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Flow Field Paths"), STAT_EMPATH_FlowFieldPaths, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI EQS Context Cache Hits"), STAT_EMPATH_EQSContextCacheHits, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI EQS Context Cache Misses"), STAT_EMPATH_EQSContextCacheMisses, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Noises Reported"), STAT_EMPATH_NoisesReported, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Noises Resolved"), STAT_EMPATH_NoisesResolved, STATGROUP_EMPATH_AIManager);
+DECLARE_CYCLE_STAT(TEXT("AI Targeting Scheduler"), STAT_EMPATH_TargetingScheduler, STATGROUP_EMPATH_AIManager);
+DECLARE_CYCLE_STAT(TEXT("AI Parallel Target Scoring"), STAT_EMPATH_ParallelTargetScoring, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI Targeting Queue Depth"), STAT_EMPATH_TargetingQueueDepth, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Targeting Updates"), STAT_EMPATH_TargetingUpdates, STATGROUP_EMPATH_AIManager);
+DECLARE_CYCLE_STAT(TEXT("AI EQS Scheduler"), STAT_EMPATH_EQSScheduler, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI EQS Queue Depth"), STAT_EMPATH_EQSQueueDepth, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI EQS Queries Run"), STAT_EMPATH_EQSQueriesRun, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI EQS Stale Results"), STAT_EMPATH_EQSStaleResults, STATGROUP_EMPATH_AIManager);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("AI EQS Worst Wait (ms)"), STAT_EMPATH_EQSWorstWait, STATGROUP_EMPATH_AIManager);
+DECLARE_CYCLE_STAT(TEXT("AI Nav Recovery Requests"), STAT_EMPATH_NavRecoveryRequests, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Nav Recovery Searches"), STAT_EMPATH_NavRecoverySearches, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Nav Recovery Points Reused"), STAT_EMPATH_NavRecoveryPointsReused, STATGROUP_EMPATH_AIManager);
+DECLARE_CYCLE_STAT(TEXT("AI Vision Trace Dispatch"), STAT_EMPATH_VisionTraceDispatch, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Vision Traces Requested"), STAT_EMPATH_VisionTracesRequested, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Vision Traces Dispatched"), STAT_EMPATH_VisionTracesDispatched, STATGROUP_EMPATH_AIManager);
+DECLARE_CYCLE_STAT(TEXT("AI Vision Cone Tests"), STAT_EMPATH_VisionConeTests, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Vision Cones Tested"), STAT_EMPATH_VisionConesTested, STATGROUP_EMPATH_AIManager);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("AI Targeting Worst Staleness (ms)"), STAT_EMPATH_TargetingWorstStaleness, STATGROUP_EMPATH_AIManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Targeting Count Lookups"), STAT_EMPATH_TargetingCountLookups, STATGROUP_EMPATH_AICon);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Targeting Loop Iterations Saved"), STAT_EMPATH_TargetingIterationsSaved, STATGROUP_EMPATH_AICon);
 
 // Log categories
 DEFINE_LOG_CATEGORY_STATIC(LogAIManager, Log, All);
 
+#if !UE_BUILD_SHIPPING
+static TAutoConsoleVariable<int32> CVarEmpathAIRecordFrameTimings(
+	TEXT("Empath.AIRecordFrameTimings"),
+	0,
+	TEXT("Whether the AI manager should time its hot paths each frame, for benchmarking. Benchmarks turn this on for themselves.\n")
+	TEXT("0: Disabled, 1: Enabled"),
+	ECVF_Cheat);
+#endif
+
 const float AEmpathAIManager::HearingDisconnectDist = 500.0f;
 
-// Sets default values
-AEmpathAIManager::AEmpathAIManager()
+// Sets default values
+AEmpathAIManager::AEmpathAIManager()
+{
+	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+	
+	// Initialize default settings
+	PlayerAwarenessState = EEmpathPlayerAwarenessState::PresenceNotKnown;
+	bPlayerHasEverBeenSeen = false;
+	bIsPlayerLocationKnown = false;
+	LostPlayerTimeThreshold = 0.5f;
+	StartSearchingTimeThreshold = 3.0f;
+	NumLostPlayerInvestigators = 3;
+	bUseFlowFieldNavigation = false;
+	FlowFieldMaxPolys = 4096;
+	FlowFieldPolysPerFrame = 256;
+	FlowFieldRebuildDistance = 100.0f;
+	FlowFieldGoalTolerance = 300.0f;
+	LostPlayerResponsesPerFrame = 4;
+	SpatialGridCellSize = 500.0f;
+	SpatialGridQuerySlack = 100.0f;
+	bUseTargetingScheduler = false;
+	bUseParallelTargetScoring = false;
+	ParallelTargetingMicrosecondsPerAI = 0.0f;
+	TargetingUpdateBudgetMicroseconds = 1000.0f;
+	MaxTargetingUpdateStaleness = 0.25f;
+	bUseEQSScheduler = false;
+	MaxRunningEQSQueries = 4;
+	MaxEQSRequestWait = 0.5f;
+	EQSPriorityFalloffDistance = 3000.0f;
+	EQSStaleResultMaxAge = 2.0f;
+	EQSStaleResultPriority = 0.5f;
+	bUseNavRecoveryService = false;
+	NavRecoveryClusterRadius = 500.0f;
+	NavRecoverySamplesPerCluster = 24;
+	NavRecoveryDestinationSpacing = 100.0f;
+	NavRecoveryPointLifetime = 2.0f;
+
+	// Noise merging
+	NoiseMergeDistance = 100.0f;
+
+	// Secondary target lookup
+	NumIndexedSecondaryTargets = 0;
+	bSecondaryTargetsNeedCleanUp = false;
+
+	// EQS context cache stats
+	NumEQSContextCacheHits = 0;
+	NumEQSContextCacheMisses = 0;
+
+	// World snapshot
+	bWorldSnapshotDirty = true;
+
+	// Frame timings
+	bRecordFrameTimings = false;
+
+	// Vision trace batching
+	NextVisionTraceID = 0;
+	VisionTraceParams = FCollisionQueryParams(AEmpathAIController::AIVisionTraceTag);
+	OnVisionTraceCompleteDelegate.BindUObject(this, &AEmpathAIManager::OnVisionTraceComplete);
+
+	// Dispatch vision traces after everything else has ticked, so that they still start this frame
+	VisionTraceTickFunction.bCanEverTick = true;
+	VisionTraceTickFunction.bStartWithTickEnabled = true;
+	VisionTraceTickFunction.TickGroup = TG_PostUpdateWork;
+}
+
+void FEmpathVisionTraceTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && !Target->IsPendingKill())
+	{
+		FEmpathScopedAIFrameTiming const DispatchTiming(Target, &FEmpathAIFrameTimings::VisionDispatchMs);
+		Target->DispatchVisionTraces();
+	}
+}
+
+FString FEmpathVisionTraceTickFunction::DiagnosticMessage()
+{
+	return GetNameSafe(Target) + TEXT("[DispatchVisionTraces]");
+}
+
+void AEmpathAIManager::RegisterActorTickFunctions(bool bRegister)
+{
+	Super::RegisterActorTickFunctions(bRegister);
+
+	if (bRegister)
+	{
+		if (PrimaryActorTick.bCanEverTick)
+		{
+			VisionTraceTickFunction.Target = this;
+			VisionTraceTickFunction.SetTickFunctionEnable(VisionTraceTickFunction.bStartWithTickEnabled);
+			VisionTraceTickFunction.RegisterTickFunction(GetLevel());
+		}
+	}
+	else if (VisionTraceTickFunction.IsTickFunctionRegistered())
+	{
+		VisionTraceTickFunction.UnRegisterTickFunction();
+	}
+}
+
+void AEmpathAIManager::OnPlayerDied(FHitResult const& KillingHitInfo, FVector KillingHitImpulseDir, const AController* DeathInstigator, const AActor* DeathCauser, const UDamageType* DeathDamageType)
+{
+	InvalidateWorldSnapshot();
+	InvalidateEQSContextCache();
+	SetPlayerAwarenessState(EEmpathPlayerAwarenessState::PresenceNotKnown);
+	bIsPlayerLocationKnown = false;
+}
+
+// Called when the game starts or when spawned
+void AEmpathAIManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Grab an AI controllers that were not already registered with us. Shouldn't ever happen, but just in case.
+	for (AEmpathAIController* CurrAICon : TActorRange<AEmpathAIController>(GetWorld()))
+	{
+		CurrAICon->RegisterAIManager(this);
+	}
+
+	// Bind delegates to the player
+	APlayerController* PlayerCon = GetWorld()->GetFirstPlayerController();
+	if (PlayerCon)
+	{
+		APawn* PlayerPawn = PlayerCon->GetPawn();
+		if (PlayerPawn)
+		{
+			AEmpathPlayerCharacter* VRPlayer = Cast<AEmpathPlayerCharacter>(PlayerPawn);
+			if (VRPlayer)
+			{
+				VRPlayer->OnTeleportToLocation.AddDynamic(this, &AEmpathAIManager::OnPlayerTeleported);
+				VRPlayer->OnDeath.AddDynamic(this, &AEmpathAIManager::OnPlayerDied);
+			}
+			else
+			{
+				UE_LOG(LogAIManager, Warning, TEXT("%s: ERROR: Player is not an Empath VR Character!"), *GetNameSafe(this));
+			}
+		}
+		else
+		{
+			UE_LOG(LogAIManager, Warning, TEXT("%s: ERROR: Player not possessing pawn!"), *GetNameSafe(this));
+		}
+	}
+	else
+	{
+		UE_LOG(LogAIManager, Warning, TEXT("%s: ERROR: Player not found!"), *GetNameSafe(this));
+	}
+}
+
+// Called every frame
+void AEmpathAIManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Start timing a new frame
+	LastFrameTimings = FrameTimings;
+	FrameTimings = FEmpathAIFrameTimings();
+
+	// Dead secondary targets are only removed once a lookup runs into one
+	if (bSecondaryTargetsNeedCleanUp)
+	{
+		CleanUpSecondaryTargets();
+	}
+
+	// Last frame's EQS context values are all stale
+	InvalidateEQSContextCache();
+
+	// Retake the world snapshot if it has changed since the AIs last used it. Nothing is holding on to it between ticks.
+	if (bWorldSnapshotDirty || WorldSnapshot.FrameNumber != GFrameCounter)
+	{
+		UpdateWorldSnapshot();
+	}
+	UpdateSpatialGrid();
+	UpdateTargetingCounts();
+	ProcessLostPlayerResponses();
+
+	{
+		FEmpathScopedAIFrameTiming const HearingTiming(this, &FEmpathAIFrameTimings::HearingMs);
+		ResolveNoises();
+	}
+
+	ProcessTargetingUpdateQueue();
+
+	{
+		FEmpathScopedAIFrameTiming const RepositionQueryTiming(this, &FEmpathAIFrameTimings::RepositionQueryMs);
+		ProcessEQSQueue();
+	}
+
+	{
+		FEmpathScopedAIFrameTiming const NavRecoveryTiming(this, &FEmpathAIFrameTimings::NavRecoveryMs);
+		ResolveNavRecoveryRequests();
+	}
+
+	{
+		FEmpathScopedAIFrameTiming const FlowFieldTiming(this, &FEmpathAIFrameTimings::FlowFieldMs);
+		UpdateFlowField();
+	}
+
+	// Vision traces are dispatched by the vision trace tick function, once the AIs have ticked
+}
+
+bool AEmpathAIManager::IsRecordingFrameTimings() const
+{
+#if UE_BUILD_SHIPPING
+	return false;
+#else
+	return bRecordFrameTimings || CVarEmpathAIRecordFrameTimings.GetValueOnAnyThread() != 0;
+#endif
+}
+
+void AEmpathAIManager::AddFrameTiming(double FEmpathAIFrameTimings::* Timing, double Ms)
+{
+	if (IsRecordingFrameTimings())
+	{
+		FrameTimings.*Timing += Ms;
+	}
+}
+
+void AEmpathAIManager::AddFrameCount(int32 FEmpathAIFrameTimings::* Count, int32 Num)
+{
+	if (IsRecordingFrameTimings())
+	{
+		FrameTimings.*Count += Num;
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+FEmpathScopedAIFrameTiming::FEmpathScopedAIFrameTiming(AEmpathAIManager* InAIManager, double FEmpathAIFrameTimings::* InTiming)
+	: AIManager((InAIManager && InAIManager->IsRecordingFrameTimings()) ? InAIManager : nullptr),
+	Timing(InTiming),
+	StartTime(AIManager ? FPlatformTime::Seconds() : 0.0)
+{}
+
+FEmpathScopedAIFrameTiming::~FEmpathScopedAIFrameTiming()
+{
+	if (AIManager)
+	{
+		AIManager->AddFrameTiming(Timing, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	}
+}
+#endif // !UE_BUILD_SHIPPING
+
+FEmpathAIWorldSnapshot const& AEmpathAIManager::GetWorldSnapshot()
+{
+	if (WorldSnapshot.FrameNumber != GFrameCounter)
+	{
+		UpdateWorldSnapshot();
+	}
+	return WorldSnapshot;
+}
+
+void AEmpathAIManager::UpdateWorldSnapshot()
+{
+	// Track how long it takes to complete this function for the profiler
+	SCOPE_CYCLE_COUNTER(STAT_EMPATH_WorldSnapshot);
+
+	WorldSnapshot = FEmpathAIWorldSnapshot();
+	WorldSnapshot.FrameNumber = GFrameCounter;
+	bWorldSnapshotDirty = false;
+
+	APlayerController* const PlayerCon = GetWorld()->GetFirstPlayerController();
+	if (PlayerCon)
+	{
+		WorldSnapshot.bHasPlayerView = true;
+		PlayerCon->GetPlayerViewPoint(WorldSnapshot.PlayerViewLocation, WorldSnapshot.PlayerViewRotation);
+
+		WorldSnapshot.PlayerPawn = PlayerCon->GetPawn();
+		WorldSnapshot.Player = Cast<AEmpathPlayerCharacter>(WorldSnapshot.PlayerPawn);
+		if (WorldSnapshot.Player)
+		{
+			WorldSnapshot.PlayerVRLocation = WorldSnapshot.Player->GetVRLocation();
+			WorldSnapshot.PlayerTeleportState = WorldSnapshot.Player->GetTeleportState();
+			WorldSnapshot.bPlayerDead = WorldSnapshot.Player->IsDead();
+		}
+	}
+
+	for (FSecondaryAttackTarget const& SecondaryTarget : SecondaryAttackTargets)
+	{
+		if (SecondaryTarget.IsValid())
+		{
+			WorldSnapshot.SecondaryTargets.Add(SecondaryTarget);
+		}
+	}
+}
+
+AEmpathAIManager* AEmpathAIManager::GetEQSContextCacheManager(APawn const* Querier)
+{
+	// Use the manager our AI invalidates the cache on, so that we see its target changes
+	AEmpathAIController const* const AI = Querier ? Cast<AEmpathAIController>(Querier->GetController()) : nullptr;
+	if (AI && AI->GetAIManager())
+	{
+		return AI->GetAIManager();
+	}
+	return Querier ? UEmpathFunctionLibrary::GetAIManager(Querier) : nullptr;
+}
+
+bool AEmpathAIManager::GetCachedEQSContext(UClass const* ContextClass, AActor const* Querier, FEmpathEQSContextCacheEntry& OutEntry)
+{
+	FEmpathEQSContextCacheEntry const* const Entry = EQSContextCache.Find(FEmpathEQSContextCacheKey(ContextClass, Querier));
+
+	// Actor values are only reused while the actor is still alive
+	if (Entry && Entry->FrameNumber == GFrameCounter && (!Entry->bIsActor || Entry->Actor.IsValid() || Entry->Actor.IsExplicitlyNull()))
+	{
+		OutEntry = *Entry;
+		++NumEQSContextCacheHits;
+		AddFrameCount(&FEmpathAIFrameTimings::NumEQSContextCacheHits);
+		INC_DWORD_STAT(STAT_EMPATH_EQSContextCacheHits);
+		return true;
+	}
+
+	++NumEQSContextCacheMisses;
+	AddFrameCount(&FEmpathAIFrameTimings::NumEQSContextCacheMisses);
+	INC_DWORD_STAT(STAT_EMPATH_EQSContextCacheMisses);
+	return false;
+}
+
+void AEmpathAIManager::CacheEQSContext(UClass const* ContextClass, AActor const* Querier, FEmpathEQSContextCacheEntry const& Entry)
+{
+	FEmpathEQSContextCacheEntry& CachedEntry = EQSContextCache.Add(FEmpathEQSContextCacheKey(ContextClass, Querier), Entry);
+	CachedEntry.FrameNumber = GFrameCounter;
+}
+
+void AEmpathAIManager::InvalidateEQSContextCache()
+{
+	EQSContextCache.Reset();
+}
+
+void AEmpathAIManager::InvalidateEQSContextCache(AActor const* Querier)
+{
+	for (auto It = EQSContextCache.CreateIterator(); It; ++It)
+	{
+		if (It.Key().Querier == Querier)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void AEmpathAIManager::InvalidateEQSContextCacheForContext(UClass const* ContextClass)
+{
+	for (auto It = EQSContextCache.CreateIterator(); It; ++It)
+	{
+		if (It.Key().ContextClass == ContextClass)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void AEmpathAIManager::QueueTargetingUpdate(AEmpathAIController* AI)
+{
+	if (AI && !QueuedTargetingUpdateAIs.Contains(AI))
+	{
+		QueuedTargetingUpdateAIs.Add(AI);
+		TargetingUpdateQueue.Add(FEmpathTargetingUpdateRequest(AI, GetWorld()->GetTimeSeconds()));
+	}
+}
+
+void AEmpathAIManager::CancelTargetingUpdate(AEmpathAIController* AI)
+{
+	// Clear the request rather than removing it, so that we don't shift the queue while it is being processed
+	if (QueuedTargetingUpdateAIs.Remove(AI) > 0)
+	{
+		for (FEmpathTargetingUpdateRequest& Request : TargetingUpdateQueue)
+		{
+			if (Request.AI == AI)
+			{
+				Request.AI = nullptr;
+			}
+		}
+	}
+}
+
+void AEmpathAIManager::RequestVisionTrace(AEmpathAIController* AI, FVector const& Start, FVector const& End, AActor* Target, bool bTestVisionCone, FEmpathVisionCone const& VisionCone)
+{
+	INC_DWORD_STAT(STAT_EMPATH_VisionTracesRequested);
+
+	// Only the most recent request from each AI matters
+	for (FEmpathVisionTraceRequest& Request : PendingVisionTraces)
+	{
+		if (Request.AI == AI)
+		{
+			Request = FEmpathVisionTraceRequest(AI, Start, End, Target, bTestVisionCone, VisionCone);
+			return;
+		}
+	}
+
+	PendingVisionTraces.Add(FEmpathVisionTraceRequest(AI, Start, End, Target, bTestVisionCone, VisionCone));
+}
+
+void AEmpathAIManager::CancelVisionTrace(AEmpathAIController* AI)
+{
+	PendingVisionTraces.RemoveAllSwap([AI](FEmpathVisionTraceRequest const& Request)
+	{
+		return Request.AI == AI;
+	});
+
+	// Traces being dispatched are cleared rather than removed, as we may be in the middle of iterating them
+	for (FEmpathVisionTraceRequest& Request : DispatchingVisionTraces)
+	{
+		if (Request.AI == AI)
+		{
+			Request.AI = nullptr;
+		}
+	}
+	VisionConeFailedAIs.Remove(AI);
+}
+
+void AEmpathAIManager::DispatchVisionTraces()
+{
+	if (PendingVisionTraces.Num() == 0)
+	{
+		return;
+	}
+
+	// Track how long it takes to complete this function for the profiler
+	SCOPE_CYCLE_COUNTER(STAT_EMPATH_VisionTraceDispatch);
+
+	Swap(PendingVisionTraces, DispatchingVisionTraces);
+
+	// Test every requested vision cone in one batch, before spending any traces
+	VisionConeSnapshot.Reset();
+	VisionConeRequestIndices.Reset();
+	for (int32 Idx = 0; Idx < DispatchingVisionTraces.Num(); ++Idx)
+	{
+		FEmpathVisionTraceRequest const& Request = DispatchingVisionTraces[Idx];
+		if (Request.bTestVisionCone)
+		{
+			VisionConeSnapshot.Add(Request.Start, Request.End, Request.VisionCone);
+			VisionConeRequestIndices.Add(Idx);
+		}
+	}
+	if (VisionConeSnapshot.Num() > 0)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_EMPATH_VisionConeTests);
+		INC_DWORD_STAT_BY(STAT_EMPATH_VisionConesTested, VisionConeSnapshot.Num());
+		VisionConeSnapshot.ComputeVisionCones(VisionConeResults);
+		for (int32 SnapshotIdx = 0; SnapshotIdx < VisionConeResults.Num(); ++SnapshotIdx)
+		{
+			FEmpathVisionTraceRequest& Request = DispatchingVisionTraces[VisionConeRequestIndices[SnapshotIdx]];
+			if (Request.AI == nullptr)
+			{
+				continue;
+			}
+
+			// Let the AI remember the result, so it can reuse it when its perception LOD skips the test
+			Request.AI->SetVisionConeResult(VisionConeResults[SnapshotIdx]);
+			if (!VisionConeResults[SnapshotIdx])
+			{
+				VisionConeFailedAIs.Add(Request.AI);
+				Request.AI = nullptr;
+			}
+		}
+	}
+
+	UWorld* const World = GetWorld();
+	FCollisionResponseParams const ResponseParams = FCollisionResponseParams::DefaultResponseParam;
+
+	for (int32 Idx = 0; Idx < DispatchingVisionTraces.Num(); ++Idx)
+	{
+		FEmpathVisionTraceRequest const& Request = DispatchingVisionTraces[Idx];
+
+		// Skip requests that were cancelled or failed the vision cone test
+		if (Request.AI == nullptr)
+		{
+			continue;
+		}
+
+		uint32 const TraceID = NextVisionTraceID++;
+		VisionTraceListeners.Add(TraceID, Request.AI);
+		VisionTraceParams.ClearIgnoredActors();
+		VisionTraceParams.AddIgnoredActor(Request.AI->GetPawn());
+		VisionTraceParams.AddIgnoredActor(Request.Target);
+
+		FTraceHandle const TraceHandle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single,
+			Request.Start, Request.End, ECC_Visibility, VisionTraceParams, ResponseParams,
+			&OnVisionTraceCompleteDelegate, TraceID);
+		INC_DWORD_STAT(STAT_EMPATH_VisionTracesDispatched);
+
+		// Let the AI know which trace to expect, so it can choose to ignore it
+		Request.AI->SetCurrentLOSTraceHandle(TraceHandle);
+	}
+	DispatchingVisionTraces.Reset();
+
+	// Tell the AIs that failed the vision cone test that they can't see their target.
+	// Done last, as losing sight of the target may lead to new requests or cancellations.
+	while (VisionConeFailedAIs.Num() > 0)
+	{
+		AEmpathAIController* const AI = VisionConeFailedAIs.Pop(false);
+		AI->SetCanSeeTarget(false);
+	}
+}
+
+void AEmpathAIManager::OnVisionTraceComplete(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	TWeakObjectPtr<AEmpathAIController> Listener;
+	if (VisionTraceListeners.RemoveAndCopyValue(TraceDatum.UserData, Listener) && Listener.IsValid())
+	{
+		Listener->OnLOSTraceComplete(TraceHandle, TraceDatum);
+	}
+}
+
+void AEmpathAIManager::ProcessTargetingUpdateQueue()
+{
+	// Track how long it takes to complete this function for the profiler
+	SCOPE_CYCLE_COUNTER(STAT_EMPATH_TargetingScheduler);
+
+	if (bUseParallelTargetScoring)
+	{
+		ProcessTargetingUpdateQueueParallel();
+		return;
+	}
+
+	float const CurrTime = GetWorld()->GetTimeSeconds();
+	double const StartTime = FPlatformTime::Seconds();
+	double const Budget = TargetingUpdateBudgetMicroseconds * 0.000001;
+	float WorstStaleness = 0.0f;
+
+	// The queue is ordered oldest first, so updating from the front is round robin. 
+	// We always update at least one AI per frame, and keep going past the budget for any AI that has waited too long.
+	// Requests made during these updates wait until next frame.
+	int32 const NumQueued = TargetingUpdateQueue.Num();
+	int32 NumProcessed = 0;
+	int32 NumUpdated = 0;
+	while (NumProcessed < NumQueued)
+	{
+		// Copy the request, since updating the AI may queue new requests
+		FEmpathTargetingUpdateRequest const Request = TargetingUpdateQueue[NumProcessed];
+		AEmpathAIController* const AI = Request.AI;
+
+		// Skip cancelled requests
+		if (AI == nullptr)
+		{
+			++NumProcessed;
+			continue;
+		}
+
+		float const Staleness = CurrTime - Request.RequestTime;
+		bool const bOverBudget = (NumUpdated > 0) && (FPlatformTime::Seconds() - StartTime >= Budget);
+		if (bOverBudget && Staleness < MaxTargetingUpdateStaleness)
+		{
+			break;
+		}
+
+		WorstStaleness = FMath::Max(WorstStaleness, Staleness);
+		QueuedTargetingUpdateAIs.Remove(AI);
+		++NumProcessed;
+
+		if (!AI->IsPendingKill() && !AI->IsDead())
+		{
+			AI->UpdateTargetingAndVisionImmediately();
+			++NumUpdated;
+			INC_DWORD_STAT(STAT_EMPATH_TargetingUpdates);
+			AddFrameCount(&FEmpathAIFrameTimings::NumTargetingUpdates);
+		}
+	}
+	TargetingUpdateQueue.RemoveAt(0, NumProcessed, false);
+
+	// Include the AIs still waiting when reporting how stale updates get
+	for (FEmpathTargetingUpdateRequest const& Request : TargetingUpdateQueue)
+	{
+		if (Request.AI)
+		{
+			WorstStaleness = FMath::Max(WorstStaleness, CurrTime - Request.RequestTime);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_EMPATH_TargetingQueueDepth, QueuedTargetingUpdateAIs.Num());
+	SET_FLOAT_STAT(STAT_EMPATH_TargetingWorstStaleness, WorstStaleness * 1000.0f);
+}
+
+void AEmpathAIManager::QueueEQSRequest(AEmpathAIController* AI, UEnvQuery* Query)
+{
+	if (AI && Query)
+	{
+		FEmpathEQSRequest* const ExistingRequest = EQSQueue.FindByPredicate([AI](FEmpathEQSRequest const& Request) { return Request.AI == AI; });
+		if (ExistingRequest)
+		{
+			ExistingRequest->Query = Query;
+		}
+		else
+		{
+			EQSQueue.Add(FEmpathEQSRequest(AI, Query, GetWorld()->GetTimeSeconds()));
+		}
+	}
+}
+
+void AEmpathAIManager::CancelEQSRequest(AEmpathAIController* AI)
+{
+	EQSQueue.RemoveAll([AI](FEmpathEQSRequest const& Request) { return Request.AI == AI; });
+}
+
+float AEmpathAIManager::GetEQSPriority(AEmpathAIController const* AI, FEmpathAIWorldSnapshot const& Snapshot, float CurrTime) const
+{
+	// AIs close to the player are the ones the player will notice standing still
+	float DistancePriority = 0.0f;
+	APawn const* const AIPawn = AI->GetPawn();
+	if (AIPawn && Snapshot.PlayerPawn)
+	{
+		FVector const PlayerLocation = (Snapshot.Player ? Snapshot.PlayerVRLocation : Snapshot.PlayerPawn->GetActorLocation());
+		DistancePriority = 1.0f - FMath::Clamp(FVector::Dist(AIPawn->GetActorLocation(), PlayerLocation) / EQSPriorityFalloffDistance, 0.0f, 1.0f);
+	}
+
+	// AIs that have gone a long time without a result can't reuse their last one
+	float AgePriority = 1.0f;
+	if (AI->HasRepositionQueryResult() && EQSStaleResultMaxAge > 0.0f)
+	{
+		AgePriority = FMath::Clamp((CurrTime - AI->GetLastRepositionQueryTime()) / EQSStaleResultMaxAge, 0.0f, 1.0f);
+	}
+
+	return DistancePriority + AgePriority;
+}
+
+void AEmpathAIManager::ProcessEQSQueue()
+{
+	// Track how long it takes to complete this function for the profiler
+	SCOPE_CYCLE_COUNTER(STAT_EMPATH_EQSScheduler);
+
+	// Queries run over several frames, so what we budget is how many are running at once
+	RunningEQSQueryAIs.RemoveAll([](TWeakObjectPtr<AEmpathAIController> const& AI) { return !AI.IsValid() || !AI->IsRepositionQueryRunning(); });
+
+	if (EQSQueue.Num() == 0)
+	{
+		SET_DWORD_STAT(STAT_EMPATH_EQSQueueDepth, 0);
+		return;
+	}
+
+	float const CurrTime = GetWorld()->GetTimeSeconds();
+	float WorstWait = 0.0f;
+
+	// Take this frame's requests in order of priority. Requests made while running these wait until next frame.
+	TArray<FEmpathEQSRequest> Requests = MoveTemp(EQSQueue);
+	EQSQueue.Reset();
+	FEmpathAIWorldSnapshot const& Snapshot = GetWorldSnapshot();
+	for (FEmpathEQSRequest& Request : Requests)
+	{
+		if (Request.AI && !Request.AI->IsPendingKill())
+		{
+			Request.Priority = GetEQSPriority(Request.AI, Snapshot, CurrTime);
+		}
+	}
+	Requests.Sort([](FEmpathEQSRequest const& A, FEmpathEQSRequest const& B) { return A.Priority > B.Priority; });
+
+	// We keep starting queries past the budget for any AI that has waited too long.
+	// Once the budget is spent, low priority AIs with a recent enough result are given that instead.
+	TArray<FEmpathEQSRequest> StillWaiting;
+	for (FEmpathEQSRequest const& Request : Requests)
+	{
+		AEmpathAIController* const AI = Request.AI;
+		UEnvQuery* const Query = Request.Query.Get();
+		if (!AI || AI->IsPendingKill() || AI->IsDead() || !Query)
+		{
+			continue;
+		}
+
+		float const Wait = CurrTime - Request.RequestTime;
+		bool const bOverBudget = RunningEQSQueryAIs.Num() >= MaxRunningEQSQueries;
+		if (bOverBudget && Wait < MaxEQSRequestWait)
+		{
+			bool const bCanUseStaleResult = Request.Priority < EQSStaleResultPriority 
+				&& AI->HasRepositionQueryResult() 
+				&& CurrTime - AI->GetLastRepositionQueryTime() <= EQSStaleResultMaxAge;
+			if (bCanUseStaleResult)
+			{
+				AI->AddEQSQueueWaitTime(Wait);
+				AI->UseStaleRepositionQueryResult();
+				INC_DWORD_STAT(STAT_EMPATH_EQSStaleResults);
+				AddFrameCount(&FEmpathAIFrameTimings::NumStaleRepositionResults);
+			}
+			else
+			{
+				WorstWait = FMath::Max(WorstWait, Wait);
+				StillWaiting.Add(Request);
+			}
+			continue;
+		}
+
+		WorstWait = FMath::Max(WorstWait, Wait);
+		AI->AddEQSQueueWaitTime(Wait);
+		if (AI->StartRepositionQuery(Query))
+		{
+			RunningEQSQueryAIs.AddUnique(AI);
+		}
+		INC_DWORD_STAT(STAT_EMPATH_EQSQueriesRun);
+		AddFrameCount(&FEmpathAIFrameTimings::NumRepositionQueries);
+	}
+
+	// Keep the place of any AI still waiting that asked again while we were running queries
+	for (FEmpathEQSRequest const& NewRequest : EQSQueue)
+	{
+		FEmpathEQSRequest* const WaitingRequest = StillWaiting.FindByPredicate([&NewRequest](FEmpathEQSRequest const& Request) { return Request.AI == NewRequest.AI; });
+		if (WaitingRequest)
+		{
+			WaitingRequest->Query = NewRequest.Query;
+		}
+		else
+		{
+			StillWaiting.Add(NewRequest);
+		}
+	}
+	EQSQueue = MoveTemp(StillWaiting);
+
+	SET_DWORD_STAT(STAT_EMPATH_EQSQueueDepth, EQSQueue.Num());
+	SET_FLOAT_STAT(STAT_EMPATH_EQSWorstWait, WorstWait * 1000.0f);
+}
+
+void AEmpathAIManager::RequestNavRecoveryDestination(AEmpathCharacter* Character)
+{
+	if (Character)
+	{
+		PendingNavRecoveryRequests.AddUnique(Character);
+	}
+}
+
+void AEmpathAIManager::ResolveNavRecoveryRequests()
+{
+	// Track how long it takes to complete this function for the profiler
+	SCOPE_CYCLE_COUNTER(STAT_EMPATH_NavRecoveryRequests);
+
+	// Forget points found too long ago, as the nav mesh may have changed since
+	float const CurrTime = GetWorld()->GetTimeSeconds();
+	NavRecoveryPoints.RemoveAll([CurrTime, this](FEmpathNavRecoveryPoint const& Point) { return CurrTime - Point.FoundTime > NavRecoveryPointLifetime; });
+
+	if (PendingNavRecoveryRequests.Num() == 0)
+	{
+		return;
+	}
+
+	// Give out recent points first, so only characters with nothing nearby need a search
+	UnassignedNavRecoveryCharacters.Reset();
+	for (TWeakObjectPtr<AEmpathCharacter> const& Request : PendingNavRecoveryRequests)
+	{
+		AEmpathCharacter* const Character = Request.Get();
+		if (!Character 
+			|| Character->IsDead() 
+			|| !Character->IsFailingNavigation() 
+			|| Character->IsFailingNavigationFromValidNavMesh() 
+			|| !Character->GetNavRecoveryDestination().IsZero())
+		{
+			continue;
+		}
+
+		if (AssignNavRecoveryPoint(Character))
+		{
+			INC_DWORD_STAT(STAT_EMPATH_NavRecoveryPointsReused);
+			AddFrameCount(&FEmpathAIFrameTimings::NumNavRecoveryPointsReused);
+		}
+		else
+		{
+			UnassignedNavRecoveryCharacters.Add(Character);
+		}
+	}
+	PendingNavRecoveryRequests.Reset();
+
+	// Group the rest by where they lost the nav mesh, and run one search for each group
+	float const ClusterRadiusSq = FMath::Square(NavRecoveryClusterRadius);
+	while (UnassignedNavRecoveryCharacters.Num() > 0)
+	{
+		NavRecoveryCluster.Reset();
+		AEmpathCharacter* const Seed = UnassignedNavRecoveryCharacters.Pop(false);
+		NavRecoveryCluster.Add(Seed);
+		for (int32 Idx = UnassignedNavRecoveryCharacters.Num() - 1; Idx >= 0; --Idx)
+		{
+			AEmpathCharacter* const Character = UnassignedNavRecoveryCharacters[Idx];
+			if (FVector::DistSquared(Character->NavRecoveryStartPathingLocation, Seed->NavRecoveryStartPathingLocation) <= ClusterRadiusSq)
+			{
+				NavRecoveryCluster.Add(Character);
+				UnassignedNavRecoveryCharacters.RemoveAtSwap(Idx, 1, false);
+			}
+		}
+
+		SearchForNavRecoveryPoints(NavRecoveryCluster);
+		INC_DWORD_STAT(STAT_EMPATH_NavRecoverySearches);
+		AddFrameCount(&FEmpathAIFrameTimings::NumNavRecoverySearches);
+
+		// Characters left without a point expand their search radii as usual, and ask again
+		for (AEmpathCharacter* const Character : NavRecoveryCluster)
+		{
+			AssignNavRecoveryPoint(Character);
+		}
+	}
+}
+
+void AEmpathAIManager::SearchForNavRecoveryPoints(TArray<AEmpathCharacter*> const& Cluster)
+{
+	if (Cluster.Num() == 0)
+	{
+		return;
+	}
+
+	// Search from the middle of the cluster, widening the ring to cover every member's search radii
+	FVector Center = FVector::ZeroVector;
+	for (AEmpathCharacter const* const Character : Cluster)
+	{
+		Center += Character->NavRecoveryStartPathingLocation;
+	}
+	Center /= Cluster.Num();
+
+	float InnerRadius = MAX_flt;
+	float OuterRadius = 0.0f;
+	for (AEmpathCharacter const* const Character : Cluster)
+	{
+		float CharInnerRadius = 0.0f;
+		float CharOuterRadius = 0.0f;
+		Character->GetNavSearchRadiiCurrent(CharInnerRadius, CharOuterRadius);
+		float const DistFromCenter = FVector::Dist2D(Character->NavRecoveryStartPathingLocation, Center);
+		InnerRadius = FMath::Min(InnerRadius, CharInnerRadius - DistFromCenter);
+		OuterRadius = FMath::Max(OuterRadius, CharOuterRadius + DistFromCenter);
+	}
+	InnerRadius = FMath::Max(InnerRadius, 0.0f);
+
+	// Spread the samples evenly over the ring along a golden angle spiral
+	static const float GoldenAngle = PI * (3.0f - FMath::Sqrt(5.0f));
+	AEmpathCharacter* const Querier = Cluster[0];
+	float const CurrTime = GetWorld()->GetTimeSeconds();
+	float const InnerRadiusSq = FMath::Square(InnerRadius);
+	float const OuterRadiusSq = FMath::Square(OuterRadius);
+	float const SpacingSq = FMath::Square(NavRecoveryDestinationSpacing);
+	for (int32 SampleIdx = 0; SampleIdx < NavRecoverySamplesPerCluster; ++SampleIdx)
+	{
+		float const Alpha = (SampleIdx + 0.5f) / NavRecoverySamplesPerCluster;
+		float const Radius = FMath::Sqrt(FMath::Lerp(InnerRadiusSq, OuterRadiusSq, Alpha));
+		float Sin = 0.0f;
+		float Cos = 0.0f;
+		FMath::SinCos(&Sin, &Cos, SampleIdx * GoldenAngle);
+		FVector const Sample = Center + FVector(Cos * Radius, Sin * Radius, 0.0f);
+
+		FVector ProjectedPoint = FVector::ZeroVector;
+		if (UEmpathFunctionLibrary::EmpathProjectPointToNavigation(Querier, ProjectedPoint, Sample, nullptr, nullptr, Querier->NavRecoveryTestExtent))
+		{
+			// Skip points we already know about
+			bool const bIsKnown = NavRecoveryPoints.ContainsByPredicate([&ProjectedPoint, SpacingSq](FEmpathNavRecoveryPoint const& Point)
+			{
+				return FVector::DistSquared(Point.Location, ProjectedPoint) < SpacingSq;
+			});
+			if (!bIsKnown)
+			{
+				NavRecoveryPoints.Add(FEmpathNavRecoveryPoint(ProjectedPoint, CurrTime));
+			}
+		}
+	}
+}
+
+bool AEmpathAIManager::AssignNavRecoveryPoint(AEmpathCharacter* Character)
+{
+	float InnerRadius = 0.0f;
+	float OuterRadius = 0.0f;
+	Character->GetNavSearchRadiiCurrent(InnerRadius, OuterRadius);
+	float const InnerRadiusSq = FMath::Square(InnerRadius);
+	float const OuterRadiusSq = FMath::Square(OuterRadius);
+	float const SpacingSq = FMath::Square(NavRecoveryDestinationSpacing);
+	FVector const Origin = Character->NavRecoveryStartPathingLocation;
+
+	// Find the closest free point within our search radii
+	int32 BestIdx = INDEX_NONE;
+	float BestDistSq = MAX_flt;
+	for (int32 PointIdx = 0; PointIdx < NavRecoveryPoints.Num(); ++PointIdx)
+	{
+		FEmpathNavRecoveryPoint const& Point = NavRecoveryPoints[PointIdx];
+		if (Point.ClaimedBy.IsValid())
+		{
+			continue;
+		}
+
+		float const DistSq = FVector::DistSquared2D(Point.Location, Origin);
+		if (DistSq < InnerRadiusSq || DistSq > OuterRadiusSq || DistSq >= BestDistSq)
+		{
+			continue;
+		}
+
+		// Don't send characters on top of each other
+		bool const bNearClaimedPoint = NavRecoveryPoints.ContainsByPredicate([&Point, SpacingSq](FEmpathNavRecoveryPoint const& OtherPoint)
+		{
+			return OtherPoint.ClaimedBy.IsValid() && FVector::DistSquared(OtherPoint.Location, Point.Location) < SpacingSq;
+		});
+		if (!bNearClaimedPoint)
+		{
+			BestIdx = PointIdx;
+			BestDistSq = DistSq;
+		}
+	}
+
+	if (BestIdx == INDEX_NONE)
+	{
+		return false;
+	}
+
+	NavRecoveryPoints[BestIdx].ClaimedBy = Character;
+	Character->SetNavRecoveryDestination(NavRecoveryPoints[BestIdx].Location);
+	return true;
+}
+
+void AEmpathAIManager::ProcessTargetingUpdateQueueParallel()
+{
+	float const CurrTime = GetWorld()->GetTimeSeconds();
+	double const StartTime = FPlatformTime::Seconds();
+	float WorstStaleness = 0.0f;
+
+	// We can't stop partway through a parallel batch, so use what updates cost last time to choose how many fit in the budget.
+	// As with serial updates, the queue is ordered oldest first, we always take at least one AI, and we take any AI that has waited too long regardless.
+	// Requests made while committing wait until next frame.
+	ParallelScoringAIs.Reset();
+	int32 const NumQueued = TargetingUpdateQueue.Num();
+	int32 NumProcessed = 0;
+	while (NumProcessed < NumQueued)
+	{
+		FEmpathTargetingUpdateRequest const& Request = TargetingUpdateQueue[NumProcessed];
+		AEmpathAIController* const AI = Request.AI;
+
+		// Skip cancelled requests
+		if (AI == nullptr)
+		{
+			++NumProcessed;
+			continue;
+		}
+
+		float const Staleness = CurrTime - Request.RequestTime;
+		bool const bOverBudget = (ParallelScoringAIs.Num() > 0) && (ParallelScoringAIs.Num() * ParallelTargetingMicrosecondsPerAI >= TargetingUpdateBudgetMicroseconds);
+		if (bOverBudget && Staleness < MaxTargetingUpdateStaleness)
+		{
+			break;
+		}
+
+		WorstStaleness = FMath::Max(WorstStaleness, Staleness);
+		QueuedTargetingUpdateAIs.Remove(AI);
+		++NumProcessed;
+
+		if (!AI->IsPendingKill() && !AI->IsDead())
+		{
+			ParallelScoringAIs.Add(AI);
+		}
+	}
+	TargetingUpdateQueue.RemoveAt(0, NumProcessed, false);
+
+	if (ParallelScoringAIs.Num() > 0)
+	{
+		// Count phase: score everyone against the same snapshot and targeting counts
+		{
+			SCOPE_CYCLE_COUNTER(STAT_EMPATH_ParallelTargetScoring);
+			FEmpathScopedAIFrameTiming const ScoringTiming(this, &FEmpathAIFrameTimings::AttackTargetMs);
+			ScoreAttackTargets(ParallelScoringAIs, ParallelScoringResults, true);
+		}
+
+		// Commit phase: apply the targets in queue order, which updates the targeting counts for next frame
+		for (int32 Idx = 0; Idx < ParallelScoringAIs.Num(); ++Idx)
+		{
+			AEmpathAIController* const AI = ParallelScoringAIs[Idx];
+			if (!AI->IsPendingKill() && !AI->IsDead())
+			{
+				AI->CommitAttackTargetAndUpdateVision(ParallelScoringResults[Idx]);
+				INC_DWORD_STAT(STAT_EMPATH_TargetingUpdates);
+				AddFrameCount(&FEmpathAIFrameTimings::NumTargetingUpdates);
+			}
+		}
+
+		// Remember what each update cost, smoothed so that one slow frame doesn't starve the next
+		float const MicrosecondsPerAI = (FPlatformTime::Seconds() - StartTime) * 1000000.0 / ParallelScoringAIs.Num();
+		ParallelTargetingMicrosecondsPerAI = (ParallelTargetingMicrosecondsPerAI > 0.0f) ? FMath::Lerp(ParallelTargetingMicrosecondsPerAI, MicrosecondsPerAI, 0.25f) : MicrosecondsPerAI;
+	}
+
+	// Include the AIs still waiting when reporting how stale updates get
+	for (FEmpathTargetingUpdateRequest const& Request : TargetingUpdateQueue)
+	{
+		if (Request.AI)
+		{
+			WorstStaleness = FMath::Max(WorstStaleness, CurrTime - Request.RequestTime);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_EMPATH_TargetingQueueDepth, QueuedTargetingUpdateAIs.Num());
+	SET_FLOAT_STAT(STAT_EMPATH_TargetingWorstStaleness, WorstStaleness * 1000.0f);
+}
+
+void AEmpathAIManager::ScoreAttackTargets(TArray<AEmpathAIController*> const& AIs, TArray<AActor*>& OutTargets, bool bInParallel)
+{
+	// Nothing may change the AI manager, the snapshot or the targeting counts until every AI is scored
+	FEmpathAIWorldSnapshot const& Snapshot = GetWorldSnapshot();
+	OutTargets.SetNumUninitialized(AIs.Num());
+	ParallelFor(AIs.Num(), [&AIs, &OutTargets, &Snapshot](int32 Idx)
+	{
+		OutTargets[Idx] = AIs[Idx]->ChooseAttackTarget(Snapshot);
+	}, !bInParallel);
+}
+
+// Returns the nav mesh that the flow field is built on
+static ARecastNavMesh* GetFlowFieldNavMesh(UWorld* World)
+{
+	UNavigationSystemV1* const NavSys = UNavigationSystemV1::GetCurrent(World);
+	return NavSys ? Cast<ARecastNavMesh>(NavSys->GetDefaultNavDataInstance()) : nullptr;
+}
+
+// The nav mesh's default query filter, unpacked so the flow field can cost polygons the same way pathfinding does
+struct FEmpathFlowFieldFilter
+{
+	float AreaCosts[RECAST_MAX_AREAS];
+	float FixedAreaCosts[RECAST_MAX_AREAS];
+	uint16 IncludeFlags;
+	uint16 ExcludeFlags;
+
+	FEmpathFlowFieldFilter(ARecastNavMesh const* NavMesh)
+	{
+		FNavigationQueryFilter const& Filter = *NavMesh->GetDefaultQueryFilter();
+		Filter.GetAllAreaCosts(AreaCosts, FixedAreaCosts, RECAST_MAX_AREAS);
+		IncludeFlags = Filter.GetIncludeFlags();
+		ExcludeFlags = Filter.GetExcludeFlags();
+	}
+
+	// Returns whether paths may pass through the polygon, and if so its area
+	bool IsPolyAllowed(ARecastNavMesh const* NavMesh, NavNodeRef PolyRef, uint32& OutAreaID) const
+	{
+		uint16 PolyFlags = 0;
+		uint16 AreaFlags = 0;
+		OutAreaID = NavMesh->GetPolyAreaID(PolyRef);
+		return OutAreaID < RECAST_MAX_AREAS
+			&& AreaCosts[OutAreaID] < BIG_NUMBER
+			&& NavMesh->GetPolyFlags(PolyRef, PolyFlags, AreaFlags)
+			&& (PolyFlags & IncludeFlags) != 0
+			&& (PolyFlags & ExcludeFlags) == 0;
+	}
+};
+
+void AEmpathAIManager::SetFlowFieldNavigationEnabled(bool bEnabled)
+{
+	bUseFlowFieldNavigation = bEnabled;
+	if (!bUseFlowFieldNavigation)
+	{
+		FlowField.Reset();
+		PendingFlowField.Reset();
+		FlowFieldOpenPolys.Reset();
+	}
+}
+
+void AEmpathAIManager::UpdateFlowField()
+{
+	if (!bUseFlowFieldNavigation || !bPlayerHasEverBeenSeen)
+	{
+		return;
+	}
+
+	ARecastNavMesh* const NavMesh = GetFlowFieldNavMesh(GetWorld());
+	if (!NavMesh)
+	{
+		return;
+	}
+
+	// Track how long it takes to complete this function for the profiler
+	SCOPE_CYCLE_COUNTER(STAT_EMPATH_FlowFieldUpdate);
+
+	auto const CostPredicate = [](TPair<float, NavNodeRef> const& A, TPair<float, NavNodeRef> const& B)
+	{
+		return A.Key < B.Key;
+	};
+
+	// Check whether the goal has moved. Only moving into another polygon needs a rebuild, otherwise we can just move the goal.
+	// The rebuild always starts from scratch, as a new goal polygon changes the cost of every route.
+	FEmpathFlowField& LatestFlowField = (PendingFlowField.IsValid() ? PendingFlowField : FlowField);
+	if (!LatestFlowField.IsValid() || FVector::DistSquared(LatestFlowField.GoalLocation, LastKnownPlayerLocation) > FMath::Square(FlowFieldRebuildDistance))
+	{
+		NavNodeRef const GoalPoly = NavMesh->FindNearestPoly(LastKnownPlayerLocation, NavMesh->GetConfig().DefaultQueryExtent, NavMesh->GetDefaultQueryFilter(), this);
+		if (GoalPoly != INVALID_NAVNODEREF)
+		{
+			if (LatestFlowField.IsValid() && LatestFlowField.GoalPoly == GoalPoly)
+			{
+				LatestFlowField.GoalLocation = LastKnownPlayerLocation;
+				LatestFlowField.Nodes.FindChecked(GoalPoly).NextPortal = LastKnownPlayerLocation;
+			}
+			else
+			{
+				PendingFlowField.Reset();
+				PendingFlowField.GoalLocation = LastKnownPlayerLocation;
+				PendingFlowField.GoalPoly = GoalPoly;
+				PendingFlowField.Nodes.Add(GoalPoly, FEmpathFlowFieldNode(INVALID_NAVNODEREF, LastKnownPlayerLocation, 0.0f));
+				FlowFieldOpenPolys.Reset();
+				FlowFieldOpenPolys.HeapPush(TPair<float, NavNodeRef>(0.0f, GoalPoly), CostPredicate);
+			}
+		}
+	}
+
+	if (!PendingFlowField.IsValid())
+	{
+		return;
+	}
+
+	// Expand outwards from the goal, cheapest first, until we run out of polygons for this frame
+	FEmpathFlowFieldFilter const Filter(NavMesh);
+	TArray<FNavigationPortalEdge> Neighbors;
+	TArray<FNavigationPortalEdge> NeighborExits;
+	int32 NumExpanded = 0;
+	while (FlowFieldOpenPolys.Num() > 0 && NumExpanded < FlowFieldPolysPerFrame)
+	{
+		TPair<float, NavNodeRef> Current;
+		FlowFieldOpenPolys.HeapPop(Current, CostPredicate, false);
+
+		// Skip polygons we've since found a cheaper route from
+		FEmpathFlowFieldNode const CurrentNode = PendingFlowField.Nodes.FindChecked(Current.Value);
+		if (Current.Key > CurrentNode.CostToGoal)
+		{
+			continue;
+		}
+		++NumExpanded;
+
+		uint32 CurrentAreaID = 0;
+		Filter.IsPolyAllowed(NavMesh, Current.Value, CurrentAreaID);
+
+		Neighbors.Reset();
+		NavMesh->GetPolyNeighbors(Current.Value, Neighbors);
+		for (FNavigationPortalEdge const& Edge : Neighbors)
+		{
+			uint32 NeighborAreaID = 0;
+			if (!Filter.IsPolyAllowed(NavMesh, Edge.ToRef, NeighborAreaID))
+			{
+				continue;
+			}
+
+			// We are searching backwards from the goal, so make sure the neighbor can actually move into us.
+			// Polygons always connect both ways, but one way nav links only connect from their start.
+			NeighborExits.Reset();
+			NavMesh->GetPolyNeighbors(Edge.ToRef, NeighborExits);
+			FNavigationPortalEdge const* const Exit = NeighborExits.FindByPredicate([&Current](FNavigationPortalEdge const& NeighborExit)
+			{
+				return NeighborExit.ToRef == Current.Value;
+			});
+			if (!Exit)
+			{
+				continue;
+			}
+
+			// Cost the walk across our polygon the way pathfinding does, scaled by our area's cost and with its entry cost if the area changes
+			FVector const Portal = Exit->GetMiddlePoint();
+			float const Cost = CurrentNode.CostToGoal 
+				+ FVector::Dist(Portal, CurrentNode.NextPortal) * Filter.AreaCosts[CurrentAreaID]
+				+ (NeighborAreaID != CurrentAreaID ? Filter.FixedAreaCosts[CurrentAreaID] : 0.0f);
+			FEmpathFlowFieldNode const* const ExistingNode = PendingFlowField.Nodes.Find(Edge.ToRef);
+			if (ExistingNode ? (Cost < ExistingNode->CostToGoal) : (PendingFlowField.Nodes.Num() < FlowFieldMaxPolys))
+			{
+				PendingFlowField.Nodes.Add(Edge.ToRef, FEmpathFlowFieldNode(Current.Value, Portal, Cost));
+				FlowFieldOpenPolys.HeapPush(TPair<float, NavNodeRef>(Cost, Edge.ToRef), CostPredicate);
+			}
+		}
+	}
+
+	// Once complete, start following the new field
+	if (FlowFieldOpenPolys.Num() == 0)
+	{
+		Swap(FlowField, PendingFlowField);
+		PendingFlowField.Reset();
+		SET_DWORD_STAT(STAT_EMPATH_FlowFieldPolys, FlowField.Nodes.Num());
+	}
+}
+
+bool AEmpathAIManager::GetFlowFieldPath(FVector const& Start, FVector const& Goal, UObject const* Querier, FNavPathSharedPtr& OutPath) const
+{
+	if (!bUseFlowFieldNavigation 
+		|| !FlowField.IsValid() 
+		|| FVector::DistSquared(Goal, FlowField.GoalLocation) > FMath::Square(FlowFieldGoalTolerance))
+	{
+		return false;
+	}
+
+	// The field only leads into the goal polygon, so the goal must be in it too
+	ARecastNavMesh* const NavMesh = GetFlowFieldNavMesh(GetWorld());
+	if (!NavMesh)
+	{
+		return false;
+	}
+	FSharedConstNavQueryFilter const QueryFilter = NavMesh->GetDefaultQueryFilter();
+	FVector const& QueryExtent = NavMesh->GetConfig().DefaultQueryExtent;
+	NavNodeRef const StartPoly = NavMesh->FindNearestPoly(Start, QueryExtent, QueryFilter, Querier);
+	FEmpathFlowFieldNode const* Node = FlowField.Nodes.Find(StartPoly);
+	if (!Node || NavMesh->FindNearestPoly(Goal, QueryExtent, QueryFilter, Querier) != FlowField.GoalPoly)
+	{
+		return false;
+	}
+
+	// Walk the polygons down to the goal polygon, giving us the same corridor a path query would
+	FNavPathSharedPtr const Path = NavMesh->CreatePathInstance<FNavMeshPath>(FPathFindingQueryData(Querier, Start, Goal, QueryFilter));
+	FNavMeshPath* const NavMeshPath = Path->CastPath<FNavMeshPath>();
+	NavMeshPath->PathCorridor.Add(StartPoly);
+	NavMeshPath->PathCorridorCost.Add(0.0f);
+	while (Node && Node->NextPoly != INVALID_NAVNODEREF && NavMeshPath->PathCorridor.Num() <= FlowField.Nodes.Num())
+	{
+		FEmpathFlowFieldNode const* const NextNode = FlowField.Nodes.Find(Node->NextPoly);
+		NavMeshPath->PathCorridor.Add(Node->NextPoly);
+		NavMeshPath->PathCorridorCost.Add(NextNode ? Node->CostToGoal - NextNode->CostToGoal : 0.0f);
+		Node = NextNode;
+	}
+	if (!Node || Node->NextPoly != INVALID_NAVNODEREF)
+	{
+		return false;
+	}
+
+	// String pull through the corridor. This also marks any custom nav links, so they can be claimed and jumped.
+	// If the nav mesh has been rebuilt since the field was, the corridor is stale and this fails.
+	NavMeshPath->PerformStringPulling(Start, Goal);
+	if (!NavMeshPath->IsStringPulled() || Path->GetPathPoints().Num() < 2)
+	{
+		return false;
+	}
+	Path->MarkReady();
+	OutPath = Path;
+
+	INC_DWORD_STAT(STAT_EMPATH_FlowFieldPaths);
+	return true;
+}
+
+FIntVector AEmpathAIManager::GetSpatialGridCell(FVector const& Location) const
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
-	
-	// Initialize default settings
-	PlayerAwarenessState = EEmpathPlayerAwarenessState::PresenceNotKnown;
-	bPlayerHasEverBeenSeen = false;
-	bIsPlayerLocationKnown = false;
-	LostPlayerTimeThreshold = 0.5f;
-	StartSearchingTimeThreshold = 3.0f;
+	float const CellSize = FMath::Max(SpatialGridCellSize, 1.0f);
+	return FIntVector(FMath::FloorToInt(Location.X / CellSize),
+		FMath::FloorToInt(Location.Y / CellSize),
+		FMath::FloorToInt(Location.Z / CellSize));
 }
 
-void AEmpathAIManager::OnPlayerDied(FHitResult const& KillingHitInfo, FVector KillingHitImpulseDir, const AController* DeathInstigator, const AActor* DeathCauser, const UDamageType* DeathDamageType)
+void AEmpathAIManager::UpdateSpatialGrid()
 {
-	SetPlayerAwarenessState(EEmpathPlayerAwarenessState::PresenceNotKnown);
-	bIsPlayerLocationKnown = false;
+	for (AEmpathAIController* AI : EmpathAICons)
+	{
+		UpdateSpatialGridCell(AI);
+	}
 }
 
-// Called when the game starts or when spawned
-void AEmpathAIManager::BeginPlay()
+void AEmpathAIManager::UpdateSpatialGridCell(AEmpathAIController* AI)
 {
-	Super::BeginPlay();
+	APawn const* const AIPawn = AI ? AI->GetPawn() : nullptr;
+	if (!AIPawn)
+	{
+		RemoveFromSpatialGrid(AI);
+		return;
+	}
 
-	// Grab an AI controllers that were not already registered with us. Shouldn't ever happen, but just in case.
-	for (AEmpathAIController* CurrAICon : TActorRange<AEmpathAIController>(GetWorld()))
+	// Only touch the cells if the pawn has moved to a new one
+	FIntVector const NewCell = GetSpatialGridCell(AIPawn->GetActorLocation());
+	FIntVector* const OldCell = SpatialGridCellsByAI.Find(AI);
+	if (OldCell && *OldCell == NewCell)
 	{
-		CurrAICon->RegisterAIManager(this);
+		return;
+	}
+	if (OldCell)
+	{
+		TArray<AEmpathAIController*>* const OldCellAIs = SpatialGridCells.Find(*OldCell);
+		if (OldCellAIs)
+		{
+			OldCellAIs->RemoveSwap(AI);
+			if (OldCellAIs->Num() == 0)
+			{
+				SpatialGridCells.Remove(*OldCell);
+			}
+		}
 	}
+	SpatialGridCells.FindOrAdd(NewCell).Add(AI);
+	SpatialGridCellsByAI.Add(AI, NewCell);
+}
 
-	// Bind delegates to the player
-	APlayerController* PlayerCon = GetWorld()->GetFirstPlayerController();
-	if (PlayerCon)
+void AEmpathAIManager::RemoveFromSpatialGrid(AEmpathAIController* AI)
+{
+	FIntVector Cell;
+	if (SpatialGridCellsByAI.RemoveAndCopyValue(AI, Cell))
 	{
-		APawn* PlayerPawn = PlayerCon->GetPawn();
-		if (PlayerPawn)
+		TArray<AEmpathAIController*>* const CellAIs = SpatialGridCells.Find(Cell);
+		if (CellAIs)
 		{
-			AEmpathPlayerCharacter* VRPlayer = Cast<AEmpathPlayerCharacter>(PlayerPawn);
-			if (VRPlayer)
+			CellAIs->RemoveSwap(AI);
+			if (CellAIs->Num() == 0)
 			{
-				VRPlayer->OnTeleportToLocation.AddDynamic(this, &AEmpathAIManager::OnPlayerTeleported);
-				VRPlayer->OnDeath.AddDynamic(this, &AEmpathAIManager::OnPlayerDied);
+				SpatialGridCells.Remove(Cell);
 			}
-			else
+		}
+	}
+}
+
+void AEmpathAIManager::ForEachAIInRadius(FVector Location, float Radius, TFunctionRef<bool(AEmpathAIController*)> Func) const
+{
+	if (Radius < 0.0f)
+	{
+		return;
+	}
+
+	// Find the range of cells that may contain pawns inside the radius
+	float const RadiusSq = FMath::Square(Radius);
+	FVector const Extent(Radius + SpatialGridQuerySlack);
+	FIntVector const MinCell = GetSpatialGridCell(Location - Extent);
+	FIntVector const MaxCell = GetSpatialGridCell(Location + Extent);
+
+	// Returns false if we should stop iterating
+	auto VisitCell = [&](TArray<AEmpathAIController*> const& CellAIs) -> bool
+	{
+		for (AEmpathAIController* AI : CellAIs)
+		{
+			APawn const* const AIPawn = AI->GetPawn();
+			if (AIPawn && FVector::DistSquared(AIPawn->GetActorLocation(), Location) <= RadiusSq)
 			{
-				UE_LOG(LogAIManager, Warning, TEXT("%s: ERROR: Player is not an Empath VR Character!"), *GetNameSafe(this));
+				if (!Func(AI))
+				{
+					return false;
+				}
 			}
 		}
-		else
+		return true;
+	};
+
+	// For large radii it is cheaper to walk the occupied cells than to look up every cell in the range
+	int64 const NumCellsInRange = (int64)(MaxCell.X - MinCell.X + 1) * (int64)(MaxCell.Y - MinCell.Y + 1) * (int64)(MaxCell.Z - MinCell.Z + 1);
+	if (NumCellsInRange > SpatialGridCells.Num())
+	{
+		for (TPair<FIntVector, TArray<AEmpathAIController*>> const& CurrCell : SpatialGridCells)
 		{
-			UE_LOG(LogAIManager, Warning, TEXT("%s: ERROR: Player not possessing pawn!"), *GetNameSafe(this));
+			FIntVector const& Cell = CurrCell.Key;
+			if (Cell.X >= MinCell.X && Cell.X <= MaxCell.X
+				&& Cell.Y >= MinCell.Y && Cell.Y <= MaxCell.Y
+				&& Cell.Z >= MinCell.Z && Cell.Z <= MaxCell.Z)
+			{
+				if (!VisitCell(CurrCell.Value))
+				{
+					return;
+				}
+			}
 		}
+		return;
 	}
-	else
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
 	{
-		UE_LOG(LogAIManager, Warning, TEXT("%s: ERROR: Player not found!"), *GetNameSafe(this));
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				TArray<AEmpathAIController*> const* const CellAIs = SpatialGridCells.Find(FIntVector(X, Y, Z));
+				if (CellAIs && !VisitCell(*CellAIs))
+				{
+					return;
+				}
+			}
+		}
 	}
 }
 
-// Called every frame
-void AEmpathAIManager::Tick(float DeltaTime)
+void AEmpathAIManager::GetAIsInRadius(FVector Location, float Radius, TArray<AEmpathAIController*>& OutAIs) const
 {
-	Super::Tick(DeltaTime);
+	OutAIs.Reset();
+	ForEachAIInRadius(Location, Radius, [&OutAIs](AEmpathAIController* AI)
+	{
+		OutAIs.Add(AI);
+		return true;
+	});
+}
+
+void AEmpathAIManager::GetNearestAIs(FVector Location, int32 NumAIs, TArray<AEmpathAIController*>& OutAIs) const
+{
+	OutAIs.Reset();
+	int32 const NumInGrid = SpatialGridCellsByAI.Num();
+	NumAIs = FMath::Min(NumAIs, NumInGrid);
+	if (NumAIs <= 0)
+	{
+		return;
+	}
+
+	// Grow the search radius until it contains enough AIs. 
+	// Everything closer than the k-th nearest is then guaranteed to be inside it.
+	float SearchRadius = FMath::Max(SpatialGridCellSize, 1.0f);
+	GetAIsInRadius(Location, SearchRadius, OutAIs);
+	while (OutAIs.Num() < NumAIs && OutAIs.Num() < NumInGrid)
+	{
+		SearchRadius *= 2.0f;
+		GetAIsInRadius(Location, SearchRadius, OutAIs);
+
+		// Pawns that moved out of the grid since the last update could keep us from ever reaching the count
+		if (SearchRadius > WORLD_MAX)
+		{
+			break;
+		}
+	}
 
+	OutAIs.Sort([&Location](AEmpathAIController const& A, AEmpathAIController const& B)
+	{
+		return FVector::DistSquared(A.GetPawn()->GetActorLocation(), Location) < FVector::DistSquared(B.GetPawn()->GetActorLocation(), Location);
+	});
+	if (OutAIs.Num() > NumAIs)
+	{
+		OutAIs.SetNum(NumAIs);
+	}
 }
 
 void AEmpathAIManager::CleanUpSecondaryTargets()
 {
+	SecondaryAttackTargets.RemoveAll([](FSecondaryAttackTarget const& AITarget)
+	{
+		return AITarget.IsValid() == false;
+	});
+	RebuildSecondaryTargetIndices();
+	bSecondaryTargetsNeedCleanUp = false;
+	InvalidateWorldSnapshot();
+}
+
+int32 AEmpathAIManager::FindSecondaryTargetIndex(AActor const* Target) const
+{
+	if (Target == nullptr)
+	{
+		return INDEX_NONE;
+	}
+
+	// The list may have been edited directly, so make sure the lookup is in sync before trusting it
+	if (NumIndexedSecondaryTargets != SecondaryAttackTargets.Num())
+	{
+		RebuildSecondaryTargetIndices();
+	}
+	int32 const* Idx = SecondaryTargetIndices.Find(Target);
+	if (Idx && !(SecondaryAttackTargets.IsValidIndex(*Idx) && SecondaryAttackTargets[*Idx].TargetActor == Target))
+	{
+		RebuildSecondaryTargetIndices();
+		Idx = SecondaryTargetIndices.Find(Target);
+	}
+	return Idx ? *Idx : INDEX_NONE;
+}
+
+void AEmpathAIManager::RebuildSecondaryTargetIndices() const
+{
+	SecondaryTargetIndices.Reset();
 	for (int32 Idx = 0; Idx < SecondaryAttackTargets.Num(); ++Idx)
 	{
-		FSecondaryAttackTarget& AITarget = SecondaryAttackTargets[Idx];
-		if (AITarget.IsValid() == false)
+		AActor const* const TargetActor = SecondaryAttackTargets[Idx].TargetActor;
+		if (TargetActor && !SecondaryTargetIndices.Contains(TargetActor))
 		{
-			SecondaryAttackTargets.RemoveAtSwap(Idx, 1, true);
-			--Idx;
+			SecondaryTargetIndices.Add(TargetActor, Idx);
 		}
 	}
+	NumIndexedSecondaryTargets = SecondaryAttackTargets.Num();
 }
 
 void AEmpathAIManager::SetPlayerAwarenessState(const EEmpathPlayerAwarenessState NewAwarenessState)
@@ -109,7 +1499,10 @@ void AEmpathAIManager::SetPlayerAwarenessState(const EEmpathPlayerAwarenessState
 
 void AEmpathAIManager::AddSecondaryTarget(AActor* Target, float TargetRatio, float TargetPreference, float TargetRadius)
 {
-	CleanUpSecondaryTargets();
+	if (bSecondaryTargetsNeedCleanUp)
+	{
+		CleanUpSecondaryTargets();
+	}
 
 	if (Target)
 	{
@@ -119,51 +1512,97 @@ void AEmpathAIManager::AddSecondaryTarget(AActor* Target, float TargetRatio, flo
 		NewAttackTarget.TargetingRatio = TargetRatio;
 		NewAttackTarget.TargetRadius = TargetRadius;
 
-		SecondaryAttackTargets.Add(NewAttackTarget);
+		// Update the existing entry if the target is already registered
+		int32 const ExistingIdx = FindSecondaryTargetIndex(Target);
+		if (ExistingIdx != INDEX_NONE)
+		{
+			SecondaryAttackTargets[ExistingIdx] = NewAttackTarget;
+		}
+		else
+		{
+			SecondaryTargetIndices.Add(Target, SecondaryAttackTargets.Add(NewAttackTarget));
+			NumIndexedSecondaryTargets = SecondaryAttackTargets.Num();
+		}
+		InvalidateWorldSnapshot();
 	}
 }
 
 void AEmpathAIManager::RemoveSecondaryTarget(AActor* Target)
 {
-	for (int32 Idx = 0; Idx < SecondaryAttackTargets.Num(); ++Idx)
+	// Remove every entry for the target in case it was added more than once by editing the list directly,
+	// along with any destroyed targets while we're at it
+	int32 const NumRemoved = SecondaryAttackTargets.RemoveAll([Target](FSecondaryAttackTarget const& AITarget)
 	{
-		FSecondaryAttackTarget& AITarget = SecondaryAttackTargets[Idx];
-		if (AITarget.TargetActor == Target)
-		{
-			SecondaryAttackTargets.RemoveAtSwap(Idx, 1, true);
-			--Idx;
-		}
+		return AITarget.IsValid() == false || AITarget.TargetActor == Target;
+	});
+	if (NumRemoved > 0)
+	{
+		RebuildSecondaryTargetIndices();
+		bSecondaryTargetsNeedCleanUp = false;
+		InvalidateWorldSnapshot();
 	}
 }
 
 void AEmpathAIManager::GetNumAITargeting(AActor const* Target, int32& NumAITargetingCandiate, int32& NumTotalAI) const
 {
-	NumAITargetingCandiate = 0;
-	NumTotalAI = 0;
+	// Counts are kept up to date by the AIs as they change targets, so we no longer need to loop over them
+	int32 const* const NumTargeting = Target ? NumAITargetingByTarget.Find(TWeakObjectPtr<AActor const>(Target)) : nullptr;
+	NumAITargetingCandiate = NumTargeting ? *NumTargeting : 0;
+	NumTotalAI = EmpathAICons.Num();
 
-	for (AEmpathAIController* AI : EmpathAICons)
+	INC_DWORD_STAT(STAT_EMPATH_TargetingCountLookups);
+	INC_DWORD_STAT_BY(STAT_EMPATH_TargetingIterationsSaved, NumTotalAI);
+}
+
+void AEmpathAIManager::OnAIAttackTargetChanged(AActor const* OldTarget, AActor const* NewTarget)
+{
+	if (OldTarget == NewTarget)
 	{
-		++NumTotalAI;
+		return;
+	}
 
-		if (AI->GetAttackTarget() == Target)
+	if (OldTarget)
+	{
+		TWeakObjectPtr<AActor const> const OldTargetKey(OldTarget);
+		int32* const NumTargeting = NumAITargetingByTarget.Find(OldTargetKey);
+		if (NumTargeting)
 		{
-			++NumAITargetingCandiate;
+			--(*NumTargeting);
+			if (*NumTargeting <= 0)
+			{
+				NumAITargetingByTarget.Remove(OldTargetKey);
+			}
 		}
 	}
+
+	if (NewTarget)
+	{
+		++NumAITargetingByTarget.FindOrAdd(TWeakObjectPtr<AActor const>(NewTarget));
+	}
 }
 
-float AEmpathAIManager::GetAttackTargetRadius(AActor* AttackTarget) const
+void AEmpathAIManager::UpdateTargetingCounts()
 {
-	// Check if it is a secondary attack target
-	for (FSecondaryAttackTarget const& CurrTarget : SecondaryAttackTargets)
+	// Destroyed actors can no longer be targeted, so forget their counts
+	for (auto It = NumAITargetingByTarget.CreateIterator(); It; ++It)
 	{
-		if (CurrTarget.TargetActor == AttackTarget)
+		if (!It.Key().IsValid())
 		{
-			return CurrTarget.TargetRadius;
+			It.RemoveCurrent();
 		}
 	}
 
-	return 0.0f;
+	for (AEmpathAIController* AI : EmpathAICons)
+	{
+		AI->UpdateCountedAttackTarget();
+	}
+}
+
+float AEmpathAIManager::GetAttackTargetRadius(AActor* AttackTarget) const
+{
+	// Check if it is a secondary attack target
+	int32 const Idx = FindSecondaryTargetIndex(AttackTarget);
+	return (Idx != INDEX_NONE ? SecondaryAttackTargets[Idx].TargetRadius : 0.0f);
 }
 
 void AEmpathAIManager::UpdateKnownTargetLocation(AActor const* Target)
@@ -172,12 +1611,20 @@ void AEmpathAIManager::UpdateKnownTargetLocation(AActor const* Target)
 	const AEmpathPlayerCharacter* Player = Cast<AEmpathPlayerCharacter>(Target);
 	if (Player)
 	{
-		// Update variables
+		// Update variables. Queries that already ran this frame cached the old location.
+		FVector const PlayerLocation = Player->GetVRLocation();
+		if (!bIsPlayerLocationKnown || PlayerLocation != LastKnownPlayerLocation)
+		{
+			InvalidateEQSContextCacheForContext(UEQC_LastKnownPlayerLocation::StaticClass());
+		}
 		bIsPlayerLocationKnown = true;
-		LastKnownPlayerLocation = Player->GetVRLocation();
+		LastKnownPlayerLocation = PlayerLocation;
 
 		// Stop the "lost player" state flow
 		SetPlayerAwarenessState(EEmpathPlayerAwarenessState::KnownLocation);
+		InvestigationPoints.Reset();
+		LostPlayerInvestigators.Reset();
+		StaggeredLostPlayerResponses.Reset();
 		GetWorldTimerManager().ClearTimer(LostPlayerTimerHandle);
 
 
@@ -208,13 +1655,17 @@ bool AEmpathAIManager::IsTargetLocationKnown(AActor const* Target) const
 		}
 
 		// Else, return true for secondary targets
-		for (FSecondaryAttackTarget const& CurrentTarget : SecondaryAttackTargets)
+		int32 const Idx = FindSecondaryTargetIndex(Target);
+		if (Idx != INDEX_NONE)
 		{
-			if (CurrentTarget.IsValid() && (CurrentTarget.TargetActor == Target))
+			// secondary targets are always known
+			if (SecondaryAttackTargets[Idx].IsValid())
 			{
-				// secondary targets are always known
 				return true;
 			}
+
+			// Dead targets are removed on the next tick
+			bSecondaryTargetsNeedCleanUp = true;
 		}
 	}
 
@@ -228,6 +1679,8 @@ bool AEmpathAIManager::IsPlayerPotentiallyLost() const
 
 void AEmpathAIManager::OnPlayerTeleported(AActor* Player, FVector Origin, FVector Destination, FVector Direction)
 {
+	InvalidateWorldSnapshot();
+	InvalidateEQSContextCache();
 	if (PlayerAwarenessState == EEmpathPlayerAwarenessState::KnownLocation)
 	{
 		SetPlayerAwarenessState(EEmpathPlayerAwarenessState::PotentiallyLost);
@@ -239,6 +1692,106 @@ void AEmpathAIManager::OnPlayerTeleported(AActor* Player, FVector Origin, FVecto
 	}
 }
 
+void AEmpathAIManager::DispatchLostPlayerResponses(EEmpathPlayerAwarenessState NewAwarenessState)
+{
+	// Choose the investigators when the player is first lost, skipping any AI that isn't running
+	if (NewAwarenessState == EEmpathPlayerAwarenessState::Lost)
+	{
+		LostPlayerInvestigators.Reset();
+		if (NumLostPlayerInvestigators > 0)
+		{
+			TArray<AEmpathAIController*> NearestAIs;
+			int32 NumToQuery = NumLostPlayerInvestigators;
+			do
+			{
+				GetNearestAIs(LastKnownPlayerLocation, NumToQuery, NearestAIs);
+				NearestAIs.RemoveAll([](AEmpathAIController const* AI)
+				{
+					return !AI->IsAIRunning();
+				});
+				NumToQuery *= 2;
+			} while (NearestAIs.Num() < NumLostPlayerInvestigators && NumToQuery / 2 < EmpathAICons.Num());
+
+			if (NearestAIs.Num() > NumLostPlayerInvestigators)
+			{
+				NearestAIs.SetNum(NumLostPlayerInvestigators);
+			}
+			LostPlayerInvestigators = NearestAIs;
+		}
+	}
+
+	// Without investigators, every running AI responds immediately
+	if (NumLostPlayerInvestigators <= 0)
+	{
+		TArray<AEmpathAIController*> const AIs = EmpathAICons;
+		for (AEmpathAIController* AI : AIs)
+		{
+			StaggeredLostPlayerResponses.Add(FEmpathLostPlayerResponse(AI, NewAwarenessState));
+		}
+		ProcessLostPlayerResponses();
+		return;
+	}
+
+	// Otherwise queue everyone else first, as responding may change the lists
+	for (AEmpathAIController* AI : EmpathAICons)
+	{
+		if (AI->IsAIRunning() && !LostPlayerInvestigators.Contains(AI))
+		{
+			StaggeredLostPlayerResponses.Add(FEmpathLostPlayerResponse(AI, NewAwarenessState));
+		}
+	}
+
+	// Then have the investigators respond immediately
+	TArray<AEmpathAIController*> const Investigators = LostPlayerInvestigators;
+	for (AEmpathAIController* AI : Investigators)
+	{
+		if (NewAwarenessState == EEmpathPlayerAwarenessState::Lost)
+		{
+			AI->OnLostPlayerTarget();
+		}
+		else
+		{
+			AI->OnSearchForPlayerStarted();
+		}
+	}
+}
+
+void AEmpathAIManager::ProcessLostPlayerResponses()
+{
+	// Responses are only staggered when we have investigators
+	int32 const NumToProcess = (NumLostPlayerInvestigators > 0 ? LostPlayerResponsesPerFrame : StaggeredLostPlayerResponses.Num());
+	for (int32 Idx = 0; Idx < NumToProcess && StaggeredLostPlayerResponses.Num() > 0; ++Idx)
+	{
+		FEmpathLostPlayerResponse const Response = StaggeredLostPlayerResponses[0];
+		StaggeredLostPlayerResponses.RemoveAt(0, 1, false);
+
+		// Responses are cleared when the player is found, but check the AI is still running and the player wasn't forgotten meanwhile
+		if (Response.AI && Response.AI->IsAIRunning() && PlayerAwarenessState != EEmpathPlayerAwarenessState::PresenceNotKnown)
+		{
+			if (Response.AwarenessState == EEmpathPlayerAwarenessState::Lost)
+			{
+				Response.AI->OnLostPlayerTarget();
+			}
+			else
+			{
+				Response.AI->OnSearchForPlayerStarted();
+			}
+		}
+	}
+}
+
+void AEmpathAIManager::CancelLostPlayerResponse(AEmpathAIController* AI)
+{
+	LostPlayerInvestigators.Remove(AI);
+	for (FEmpathLostPlayerResponse& Response : StaggeredLostPlayerResponses)
+	{
+		if (Response.AI == AI)
+		{
+			Response.AI = nullptr;
+		}
+	}
+}
+
 void AEmpathAIManager::OnLostPlayerTimerExpired()
 {
 	switch (PlayerAwarenessState)
@@ -256,31 +1809,16 @@ void AEmpathAIManager::OnLostPlayerTimerExpired()
 
 		bIsPlayerLocationKnown = false;
 
-		// Signal all AI to respond to losing player
-		// #TODO flag the AI closest to players last known position
-		for (AEmpathAIController* AI : EmpathAICons)
-		{
-			if (AI->IsAIRunning())
-			{
-				AI->OnLostPlayerTarget();
-			}
-		}
-
+		// Signal the AI closest to the player's last known position to respond to losing the player, and the rest over the next few frames
+		DispatchLostPlayerResponses(EEmpathPlayerAwarenessState::Lost);
 		break;
 
 	case EEmpathPlayerAwarenessState::Lost:
 		// Start searching
 		SetPlayerAwarenessState(EEmpathPlayerAwarenessState::Searching);
 
-		// Start searching
-		// #TODO have flagged AI check player's last known position
-		for (AEmpathAIController* AI : EmpathAICons)
-		{
-			if (AI->IsAIRunning())
-			{
-				AI->OnSearchForPlayerStarted();
-			}
-		}
+		// Start searching, with the flagged AI checking the player's last known position first
+		DispatchLostPlayerResponses(EEmpathPlayerAwarenessState::Searching);
 		break;
 
 	case EEmpathPlayerAwarenessState::Searching:
@@ -317,12 +1855,9 @@ void AEmpathAIManager::CheckForAwareAIs()
 
 void AEmpathAIManager::ReportNoise(AActor* NoiseInstigator, AActor* NoiseMaker, FVector Location, float HearingRadius)
 {
-	// Track how long it takes to complete this function for the profiler
-	SCOPE_CYCLE_COUNTER(STAT_EMPATH_HearingChecks);
-
 	// Since secondary targets are currently always known,
 	// we only care about this if the instigator is the player, and we are not currently aware of them
-	if (PlayerAwarenessState == EEmpathPlayerAwarenessState::KnownLocation)
+	if (PlayerAwarenessState == EEmpathPlayerAwarenessState::KnownLocation || !NoiseInstigator)
 	{
 		return;
 	}
@@ -336,36 +1871,112 @@ void AEmpathAIManager::ReportNoise(AActor* NoiseInstigator, AActor* NoiseMaker,
 		}
 	}
 
-	// Otherwise, loop through the AIs and see if any of them are in the hearing radius
-	bool bHeardSound = false;
-	for (AEmpathAIController* AI : EmpathAICons)
+	INC_DWORD_STAT(STAT_EMPATH_NoisesReported);
+
+	// Remember where the instigator is now, as they may have moved on by the time the noise is resolved
+	FVector const InstigatorLocation = VRCharNoiseInstigator->GetVRLocation();
+
+	// Merge with any noise already reported near here this frame, keeping the latest locations and the larger hearing radius
+	for (FEmpathNoiseEvent& Noise : PendingNoises)
 	{
-		// If the AI is valid
-		if (!AI->IsPassive() && !AI->IsDead())
+		if (Noise.Instigator == VRCharNoiseInstigator && FVector::DistSquared(Noise.Location, Location) <= FMath::Square(NoiseMergeDistance))
 		{
-			// Check if it is within hearing distance
-			float DistFromSound = (AI->GetPawn()->GetActorLocation() - Location).Size();
-			if (DistFromSound <= HearingRadius)
-			{
-				// If so, end the loop
-				bHeardSound = true;
-				break;
-			}
+			Noise.Location = Location;
+			Noise.InstigatorLocation = InstigatorLocation;
+			Noise.HearingRadius = FMath::Max(Noise.HearingRadius, HearingRadius);
+			return;
 		}
 	}
 
-	// If we heard the sound
-	if (bHeardSound)
+	PendingNoises.Add(FEmpathNoiseEvent(VRCharNoiseInstigator, Location, InstigatorLocation, HearingRadius));
+}
+
+void AEmpathAIManager::ResolveNoises()
+{
+	if (PendingNoises.Num() == 0)
+	{
+		return;
+	}
+
+	// Track how long it takes to complete this function for the profiler
+	SCOPE_CYCLE_COUNTER(STAT_EMPATH_HearingChecks);
+
+	// Drop noises whose instigator has since been destroyed
+	PendingNoises.RemoveAllSwap([](FEmpathNoiseEvent const& Noise)
+	{
+		return !Noise.Instigator.IsValid();
+	});
+
+	// Resolve the noises closest to their instigator first, as those are the ones that can reveal the player
+	PendingNoises.Sort([](FEmpathNoiseEvent const& A, FEmpathNoiseEvent const& B)
+	{
+		return FVector::DistSquared(A.Location, A.InstigatorLocation) < FVector::DistSquared(B.Location, B.InstigatorLocation);
+	});
+
+	for (FEmpathNoiseEvent const& Noise : PendingNoises)
 	{
+		// Once the player is found, the remaining noises can't change anything
+		if (PlayerAwarenessState == EEmpathPlayerAwarenessState::KnownLocation)
+		{
+			break;
+		}
+		INC_DWORD_STAT(STAT_EMPATH_NoisesResolved);
+
+		// Find the AIs that can hear the noise
+		NoiseListeners.Reset();
+		ForEachAIInRadius(Noise.Location, Noise.HearingRadius, [this](AEmpathAIController* AI)
+		{
+			if (!AI->IsPassive() && !AI->IsDead())
+			{
+				NoiseListeners.Add(AI);
+			}
+			return true;
+		});
+		if (NoiseListeners.Num() == 0)
+		{
+			continue;
+		}
+
 		// Check if it close enough to the instigator to be effectively the same location
-		float InstigatorDist = (Location - VRCharNoiseInstigator->GetVRLocation()).Size();
+		AEmpathPlayerCharacter* const VRCharNoiseInstigator = Noise.Instigator.Get();
+		float const InstigatorDist = (Noise.Location - Noise.InstigatorLocation).Size();
 		if (InstigatorDist <= HearingDisconnectDist)
 		{
 			// If so, we have found the target
 			UpdateKnownTargetLocation(VRCharNoiseInstigator);
 		}
-		
-		// TODO: Flag area for AI to investigate
+
+		// Otherwise, flag the area for each AI that heard it to investigate, keeping the closest noise to each AI
+		else
+		{
+			for (AEmpathAIController* AI : NoiseListeners)
+			{
+				FVector const AILocation = AI->GetPawn()->GetActorLocation();
+				FVector* const InvestigationPoint = InvestigationPoints.Find(AI);
+				if (!InvestigationPoint || FVector::DistSquared(AILocation, Noise.Location) < FVector::DistSquared(AILocation, *InvestigationPoint))
+				{
+					InvestigationPoints.Add(AI, Noise.Location);
+					AI->OnHeardNoise(Noise.Location);
+				}
+			}
+		}
 	}
-	return;
-}
\ No newline at end of file
+
+	PendingNoises.Reset();
+}
+
+bool AEmpathAIManager::GetInvestigationPoint(AEmpathAIController const* AI, FVector& OutLocation) const
+{
+	FVector const* const InvestigationPoint = InvestigationPoints.Find(AI);
+	if (InvestigationPoint)
+	{
+		OutLocation = *InvestigationPoint;
+		return true;
+	}
+	return false;
+}
+
+void AEmpathAIManager::ClearInvestigationPoint(AEmpathAIController const* AI)
+{
+	InvestigationPoints.Remove(AI);
+}
@@ -0,0 +1,268 @@
+// Copyright 2018 Team Empath All Rights Reserved
+
+#include "EmpathAIStressTest.h"
+#include "EmpathAIManager.h"
+#include "EmpathAIController.h"
+#include "EmpathCharacter.h"
+#include "EmpathGameModeBase.h"
+#include "EmpathFunctionLibrary.h"
+#include "GameFramework/PlayerController.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAIStressTest, Log, All);
+
+// Sets default values
+AEmpathAIStressTest::AEmpathAIStressTest()
+{
+ 	// Set this actor to call Tick() every frame.
+	PrimaryActorTick.bCanEverTick = true;
+
+	EnemyClass = AEmpathCharacter::StaticClass();
+	NumAIs = 100;
+	NumFrames = 600;
+	NumWarmUpFrames = 60;
+	ArenaSize = 10000.0f;
+	PlayerPathRadius = 2000.0f;
+	PlayerPathSpeed = 30.0f;
+	NoiseInterval = 1.0f;
+	NoiseHearingRadius = 3000.0f;
+	SaveDirectory = TEXT("Saved/Profiling");
+	FileName = TEXT("AIStressTest");
+	bUseFlowFieldNavigation = false;
+	bUseTargetingScheduler = false;
+	HistogramBucketMs = 0.25f;
+	NumHistogramBuckets = 40;
+	bSaveResults = true;
+	bQuitWhenFinished = false;
+	AIManager = nullptr;
+	SpawnedAIManager = nullptr;
+	FramesTicked = 0;
+	PlayerPathAngle = 0.0f;
+	TimeSinceNoise = 0.0f;
+	bFinished = false;
+}
+
+AEmpathAIStressTest* AEmpathAIStressTest::SpawnStressTest(UWorld* World)
+{
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	// Center the arena on the player, so that it lands somewhere sensible in whatever map is loaded
+	APlayerController* const PlayerCon = World->GetFirstPlayerController();
+	APawn* const PlayerPawn = PlayerCon ? PlayerCon->GetPawn() : nullptr;
+	FVector const Location = PlayerPawn ? PlayerPawn->GetActorLocation() : FVector::ZeroVector;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return World->SpawnActor<AEmpathAIStressTest>(Location, FRotator::ZeroRotator, SpawnParams);
+}
+
+// Called when the game starts or when spawned
+void AEmpathAIStressTest::BeginPlay()
+{
+	Super::BeginPlay();
+	StartStressTest();
+}
+
+void AEmpathAIStressTest::StartStressTest()
+{
+	// Allow automated runs to configure the test from the command line
+	FParse::Value(FCommandLine::Get(), TEXT("AIStressNumAIs="), NumAIs);
+	FParse::Value(FCommandLine::Get(), TEXT("AIStressFrames="), NumFrames);
+	FParse::Bool(FCommandLine::Get(), TEXT("AIStressFlowField="), bUseFlowFieldNavigation);
+	FParse::Bool(FCommandLine::Get(), TEXT("AIStressTargetingScheduler="), bUseTargetingScheduler);
+	if (FParse::Param(FCommandLine::Get(), TEXT("AIStressQuit")))
+	{
+		bQuitWhenFinished = true;
+	}
+
+	if (!EnemyClass)
+	{
+		UE_LOG(LogAIStressTest, Warning, TEXT("%s ERROR: Stress test needs an enemy class!"), *GetNameSafe(this));
+		bFinished = true;
+		return;
+	}
+
+	// Use the game's AI manager if it has one, so that we measure it as configured. Otherwise bring our own.
+	AEmpathGameModeBase* EmpathGMD = GetWorld()->GetAuthGameMode<AEmpathGameModeBase>();
+	AIManager = EmpathGMD ? EmpathGMD->GetAIManager() : nullptr;
+	if (!AIManager)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+		SpawnedAIManager = GetWorld()->SpawnActor<AEmpathAIManager>(SpawnParams);
+		AIManager = SpawnedAIManager;
+		if (!AIManager)
+		{
+			UE_LOG(LogAIStressTest, Warning, TEXT("%s ERROR: Failed to spawn an AI manager!"), *GetNameSafe(this));
+			bFinished = true;
+			return;
+		}
+	}
+
+	AIManager->SetFlowFieldNavigationEnabled(bUseFlowFieldNavigation);
+	AIManager->SetTargetingSchedulerEnabled(bUseTargetingScheduler);
+	AIManager->SetRecordFrameTimings(true);
+	FrameTimeHistogram.Init(0, FMath::Max(NumHistogramBuckets, 1));
+	RecordedLines.Add(TEXT("Frame,FrameMs,AttackTargetMs,VisionMs,HearingMs,VisionDispatchMs,FlowFieldMs,TargetingUpdates,PathRequests,FlowFieldPaths,EQSContextHits,EQSContextMisses,RepositionQueryMs,RepositionQueries,StaleRepositionResults,NumAIs"));
+	SpawnEnemies();
+}
+
+// Called every frame
+void AEmpathAIStressTest::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (bFinished)
+	{
+		return;
+	}
+
+	DrivePlayer(DeltaTime);
+
+	// Record the AI manager's last full frame once the AIs have settled
+	++FramesTicked;
+	int32 const RecordedFrame = FramesTicked - NumWarmUpFrames;
+	if (RecordedFrame > 0)
+	{
+		FEmpathAIFrameTimings const& Timings = AIManager->GetLastFrameTimings();
+		RecordedLines.Add(FString::Printf(TEXT("%d,%f,%f,%f,%f,%f,%f,%d,%d,%d,%d,%d,%f,%d,%d,%d"), 
+			RecordedFrame,
+			DeltaTime * 1000.0f,
+			Timings.AttackTargetMs,
+			Timings.VisionMs,
+			Timings.HearingMs,
+			Timings.VisionDispatchMs,
+			Timings.FlowFieldMs,
+			Timings.NumTargetingUpdates,
+			Timings.NumPathRequests,
+			Timings.NumFlowFieldPaths,
+			Timings.NumEQSContextCacheHits,
+			Timings.NumEQSContextCacheMisses,
+			Timings.RepositionQueryMs,
+			Timings.NumRepositionQueries,
+			Timings.NumStaleRepositionResults,
+			AIManager->EmpathAICons.Num()));
+
+		// Spikes show up as a long tail in the histogram
+		double const TargetingAndVisionMs = Timings.AttackTargetMs + Timings.VisionMs + Timings.VisionDispatchMs;
+		int32 const Bucket = FMath::Clamp(FMath::FloorToInt(TargetingAndVisionMs / FMath::Max(HistogramBucketMs, 0.001f)), 0, FrameTimeHistogram.Num() - 1);
+		++FrameTimeHistogram[Bucket];
+
+		if (RecordedFrame >= NumFrames)
+		{
+			FinishStressTest();
+		}
+	}
+}
+
+void AEmpathAIStressTest::SpawnEnemies()
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	// Lay the enemies out in a grid across the arena, facing the center
+	int32 const GridWidth = FMath::CeilToInt(FMath::Sqrt((float)NumAIs));
+	float const Spacing = ArenaSize / FMath::Max(GridWidth, 1);
+	FVector const Center = GetActorLocation();
+	FVector const Corner = Center - FVector(ArenaSize * 0.5f, ArenaSize * 0.5f, 0.0f) + FVector(Spacing * 0.5f, Spacing * 0.5f, 0.0f);
+	for (int32 Idx = 0; Idx < NumAIs; ++Idx)
+	{
+		FVector const SpawnLoc = Corner + FVector((Idx % GridWidth) * Spacing, (Idx / GridWidth) * Spacing, 0.0f);
+		FRotator const SpawnRot = (Center - SpawnLoc).GetSafeNormal2D().Rotation();
+		AEmpathCharacter* const SpawnedEnemy = GetWorld()->SpawnActor<AEmpathCharacter>(EnemyClass, SpawnLoc, SpawnRot, SpawnParams);
+		if (SpawnedEnemy)
+		{
+			if (!SpawnedEnemy->GetController())
+			{
+				if (!SpawnedEnemy->AIControllerClass || !SpawnedEnemy->AIControllerClass->IsChildOf(AEmpathAIController::StaticClass()))
+				{
+					SpawnedEnemy->AIControllerClass = AEmpathAIController::StaticClass();
+				}
+				SpawnedEnemy->SpawnDefaultController();
+			}
+
+			// AIs only find the game mode's AI manager by themselves
+			AEmpathAIController* const EnemyAI = Cast<AEmpathAIController>(SpawnedEnemy->GetController());
+			if (EnemyAI && !EnemyAI->IsRegisteredWithAIManager())
+			{
+				EnemyAI->RegisterAIManager(AIManager);
+			}
+			SpawnedEnemies.Add(SpawnedEnemy);
+		}
+	}
+
+	UE_LOG(LogAIStressTest, Log, TEXT("%s: Spawned %d of %d enemies."), *GetNameSafe(this), SpawnedEnemies.Num(), NumAIs);
+}
+
+void AEmpathAIStressTest::DrivePlayer(float DeltaTime)
+{
+	APlayerController* const PlayerCon = GetWorld()->GetFirstPlayerController();
+	APawn* const PlayerPawn = PlayerCon ? PlayerCon->GetPawn() : nullptr;
+	if (!PlayerPawn)
+	{
+		return;
+	}
+
+	// Circle the center of the arena
+	PlayerPathAngle = FMath::Fmod(PlayerPathAngle + PlayerPathSpeed * DeltaTime, 360.0f);
+	FVector const PathOffset = FRotator(0.0f, PlayerPathAngle, 0.0f).Vector() * PlayerPathRadius;
+	PlayerPawn->SetActorLocation(GetActorLocation() + PathOffset + FVector(0.0f, 0.0f, PlayerPawn->GetActorLocation().Z - GetActorLocation().Z));
+
+	// Make noises as we go
+	if (NoiseInterval > 0.0f)
+	{
+		TimeSinceNoise += DeltaTime;
+		if (TimeSinceNoise >= NoiseInterval)
+		{
+			TimeSinceNoise = 0.0f;
+			AIManager->ReportNoise(PlayerPawn, PlayerPawn, PlayerPawn->GetActorLocation(), NoiseHearingRadius);
+		}
+	}
+}
+
+void AEmpathAIStressTest::FinishStressTest()
+{
+	bFinished = true;
+	AIManager->SetRecordFrameTimings(false);
+
+	bool bSaved = false;
+	if (bSaveResults)
+	{
+		bSaved = UEmpathFunctionLibrary::SaveStringArrayToCSV(SaveDirectory, FileName, RecordedLines, false, true);
+
+		TArray<FString> HistogramLines;
+		HistogramLines.Add(TEXT("BucketStartMs,BucketEndMs,Frames"));
+		for (int32 Bucket = 0; Bucket < FrameTimeHistogram.Num(); ++Bucket)
+		{
+			HistogramLines.Add(FString::Printf(TEXT("%f,%f,%d"), Bucket * HistogramBucketMs, (Bucket + 1) * HistogramBucketMs, FrameTimeHistogram[Bucket]));
+		}
+		UEmpathFunctionLibrary::SaveStringArrayToCSV(SaveDirectory, FileName + TEXT("Histogram"), HistogramLines, false, true);
+	}
+	UE_LOG(LogAIStressTest, Log, TEXT("%s: Recorded %d frames with %d enemies. Saved: %s"), 
+		*GetNameSafe(this), GetNumRecordedFrames(), SpawnedEnemies.Num(), bSaved ? TEXT("true") : TEXT("false"));
+
+	for (AEmpathCharacter* SpawnedEnemy : SpawnedEnemies)
+	{
+		if (SpawnedEnemy && !SpawnedEnemy->IsPendingKill())
+		{
+			SpawnedEnemy->Destroy();
+		}
+	}
+	SpawnedEnemies.Empty();
+
+	if (SpawnedAIManager && !SpawnedAIManager->IsPendingKill())
+	{
+		SpawnedAIManager->Destroy();
+	}
+	SpawnedAIManager = nullptr;
+	AIManager = nullptr;
+
+	ReceiveStressTestFinished(FileName);
+
+	if (bQuitWhenFinished)
+	{
+		FGenericPlatformMisc::RequestExit(false);
+	}
+}
@@ -1148,6 +1148,12 @@ void AEmpathCharacter::OnStartNavRecovery_Implementation(FVector FailedGoalLocat
 	NavRecoveryStartPathingLocation = GetPathingSourceLocation();
 	NavRecoveryFailedGoalLocation = FailedGoalLocation;
 
+	// Queries run later this frame should start from the new location
+	if (CachedEmpathAICon && CachedEmpathAICon->GetAIManager())
+	{
+		CachedEmpathAICon->GetAIManager()->InvalidateEQSContextCache(this);
+	}
+
 	// Signal our AI to update its search radius. 
 	// The AI should run an EQS query from the blackboard
 	AEmpathAIController* const AI = Cast<AEmpathAIController>(GetController());
@@ -1548,6 +1554,13 @@ void AEmpathCharacter::TickUpdateNavMeshRecoveryState(float DeltaTime)
 					}
 					else
 					{
+						// Let the AI manager find us a destination along with anyone else nearby who lost the nav mesh
+						AEmpathAIManager* const AIManager = (CachedEmpathAICon ? CachedEmpathAICon->GetAIManager() : nullptr);
+						if (AIManager && AIManager->IsNavRecoveryServiceEnabled() && !IsFailingNavigationFromValidNavMesh())
+						{
+							AIManager->RequestNavRecoveryDestination(this);
+						}
+
 						// Allow slight delay for BT to set the location.
 						if (TimeSinceStart > 0.20f)
 						{
@@ -9,6 +9,10 @@
 #include "EmpathAIController.h"
 #include "EmpathPlayerCharacter.h"
 
+// Stats for UEmpathEnvQueryTest_Dot
+DECLARE_CYCLE_STAT(TEXT("EQS Dot Test"), STAT_EMPATH_EQSDotTest, STATGROUP_EMPATH_EQS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("EQS Dot Test Items"), STAT_EMPATH_EQSDotTestItems, STATGROUP_EMPATH_EQS);
+
 UEmpathEnvQueryTest_Dot::UEmpathEnvQueryTest_Dot(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
 	Cost = EEnvTestCost::Low;
@@ -38,78 +42,132 @@ void UEmpathEnvQueryTest_Dot::RunTest(FEnvQueryInstance& QueryInstance) const
 	FloatValueMax.BindData(QueryOwner, QueryInstance.QueryID);
 	float MaxThresholdValue = FloatValueMax.GetValue();
 
-	// gather all possible directions: for contexts different than Item
-	TArray<FVector> LineADirs;
-	const bool bUpdateLineAPerItem = RequiresPerItemUpdates(LineA.LineFrom, LineA.LineTo, LineA.Rotation, LineA.DirMode == EEnvDirection::Rotation);
-	if (!bUpdateLineAPerItem)
+	// Track how long it takes to complete this function for the profiler
+	SCOPE_CYCLE_COUNTER(STAT_EMPATH_EQSDotTest);
+	INC_DWORD_STAT_BY(STAT_EMPATH_EQSDotTestItems, QueryInstance.Items.Num());
+
+	if (TestMode != EEnvTestDot::Dot3D && TestMode != EEnvTestDot::Dot2D)
+	{
+		UE_LOG(LogEQS, Error, TEXT("Invalid TestMode in EmpathEnvQueryTest_Dot in query %s!"), *QueryInstance.QueryName);
+		return;
+	}
+
+	// Gather the directions of both lines for every item up front
+	int32 NumLineADirs = 0;
+	bool bLineAPerItem = false;
+	GatherLineDirectionsForAllItems(ScratchLineADirs, NumLineADirs, bLineAPerItem, QueryInstance, LineA);
+	int32 NumLineBDirs = 0;
+	bool bLineBPerItem = false;
+	GatherLineDirectionsForAllItems(ScratchLineBDirs, NumLineBDirs, bLineBPerItem, QueryInstance, LineB);
+	if (NumLineADirs == 0 || NumLineBDirs == 0)
 	{
-		GatherLineDirections(LineADirs, QueryInstance, LineA.LineFrom, LineA.LineTo, LineA.Rotation, LineA.DirMode == EEnvDirection::Rotation);
-		if (LineADirs.Num() == 0)
+		return;
+	}
+
+	// A 2D dot is a dot of the flattened directions
+	if (TestMode == EEnvTestDot::Dot2D)
+	{
+		for (FVector& Dir : ScratchLineADirs)
+		{
+			Dir = Dir.GetSafeNormal2D();
+		}
+		for (FVector& Dir : ScratchLineBDirs)
 		{
-			return;
+			Dir = Dir.GetSafeNormal2D();
 		}
 	}
 
-	TArray<FVector> LineBDirs;
-	const bool bUpdateLineBPerItem = RequiresPerItemUpdates(LineB.LineFrom, LineB.LineTo, LineB.Rotation, LineB.DirMode == EEnvDirection::Rotation);
-	if (!bUpdateLineBPerItem)
+	// Score every line pair of every item
+	int32 const NumItems = QueryInstance.Items.Num();
+	int32 const NumPairs = NumLineADirs * NumLineBDirs;
+	ScratchScores.SetNumUninitialized(NumItems * NumPairs, false);
+	float* const Scores = ScratchScores.GetData();
+	for (int32 ItemIdx = 0; ItemIdx < NumItems; ++ItemIdx)
 	{
-		GatherLineDirections(LineBDirs, QueryInstance, LineB.LineFrom, LineB.LineTo, LineB.Rotation, LineB.DirMode == EEnvDirection::Rotation);
-		if (LineBDirs.Num() == 0)
+		FVector const* const ItemLineADirs = ScratchLineADirs.GetData() + (bLineAPerItem ? ItemIdx * NumLineADirs : 0);
+		FVector const* const ItemLineBDirs = ScratchLineBDirs.GetData() + (bLineBPerItem ? ItemIdx * NumLineBDirs : 0);
+		float* const ItemScores = Scores + (ItemIdx * NumPairs);
+		for (int32 LineAIndex = 0; LineAIndex < NumLineADirs; ++LineAIndex)
 		{
-			return;
+			FVector const& DirA = ItemLineADirs[LineAIndex];
+			for (int32 LineBIndex = 0; LineBIndex < NumLineBDirs; ++LineBIndex)
+			{
+				FVector const& DirB = ItemLineBDirs[LineBIndex];
+				ItemScores[LineAIndex * NumLineBDirs + LineBIndex] = DirA.X * DirB.X + DirA.Y * DirB.Y + DirA.Z * DirB.Z;
+			}
+		}
+	}
+	if (bAbsoluteValue)
+	{
+		for (int32 ScoreIdx = 0; ScoreIdx < ScratchScores.Num(); ++ScoreIdx)
+		{
+			Scores[ScoreIdx] = FMath::Abs(Scores[ScoreIdx]);
 		}
 	}
 
-	// loop through all items
+	// Hand the scores over. With one context per line, this is one score per item.
 	for (FEnvQueryInstance::ItemIterator It(this, QueryInstance); It; ++It)
 	{
-		// update lines for contexts using current item
-		if (bUpdateLineAPerItem || bUpdateLineBPerItem)
+		float const* const ItemScores = Scores + (It.GetIndex() * NumPairs);
+		for (int32 PairIdx = 0; PairIdx < NumPairs; ++PairIdx)
 		{
-			const FVector ItemLocation = (LineA.DirMode == EEnvDirection::Rotation && LineB.DirMode == EEnvDirection::Rotation) ? FVector::ZeroVector : GetItemLocation(QueryInstance, It.GetIndex());
-			const FRotator ItemRotation = (LineA.DirMode == EEnvDirection::Rotation || LineB.DirMode == EEnvDirection::Rotation) ? GetItemRotation(QueryInstance, It.GetIndex()) : FRotator::ZeroRotator;
+			It.SetScore(TestPurpose, FilterType, ItemScores[PairIdx], MinThresholdValue, MaxThresholdValue);
+		}
+	}
+}
 
-			if (bUpdateLineAPerItem)
-			{
-				LineADirs.Reset();
-				GatherLineDirections(LineADirs, QueryInstance, LineA.LineFrom, LineA.LineTo, LineA.Rotation, LineA.DirMode == EEnvDirection::Rotation, ItemLocation, ItemRotation);
-			}
+void UEmpathEnvQueryTest_Dot::GatherLineDirectionsForAllItems(TArray<FVector>& OutDirs, int32& OutDirsPerItem, bool& bOutPerItem, FEnvQueryInstance& QueryInstance, FEnvDirection const& Line) const
+{
+	OutDirs.Reset();
+	OutDirsPerItem = 0;
+	bool const bUseDirectionContext = (Line.DirMode == EEnvDirection::Rotation);
+	bOutPerItem = RequiresPerItemUpdates(Line.LineFrom, Line.LineTo, Line.Rotation, bUseDirectionContext);
 
-			if (bUpdateLineBPerItem)
-			{
-				LineBDirs.Reset();
-				GatherLineDirections(LineBDirs, QueryInstance, LineB.LineFrom, LineB.LineTo, LineB.Rotation, LineB.DirMode == EEnvDirection::Rotation, ItemLocation, ItemRotation);
-			}
-		}
+	// Lines that don't depend on the item only need gathering once
+	if (!bOutPerItem)
+	{
+		GatherLineDirections(OutDirs, QueryInstance, Line.LineFrom, Line.LineTo, Line.Rotation, bUseDirectionContext);
+		OutDirsPerItem = OutDirs.Num();
+		return;
+	}
 
-		// perform test for each line pair
-		for (int32 LineAIndex = 0; LineAIndex < LineADirs.Num(); LineAIndex++)
-		{
-			for (int32 LineBIndex = 0; LineBIndex < LineBDirs.Num(); LineBIndex++)
-			{
-				float DotValue = 0.f;
-				switch (TestMode)
-				{
-				case EEnvTestDot::Dot3D:
-					DotValue = FVector::DotProduct(LineADirs[LineAIndex], LineBDirs[LineBIndex]);
-					break;
+	int32 const NumItems = QueryInstance.Items.Num();
 
-				case EEnvTestDot::Dot2D:
-					DotValue = LineADirs[LineAIndex].CosineAngle2D(LineBDirs[LineBIndex]);
-					break;
+	// The item's own rotation
+	if (bUseDirectionContext)
+	{
+		OutDirsPerItem = 1;
+		OutDirs.SetNumUninitialized(NumItems, false);
+		for (int32 ItemIdx = 0; ItemIdx < NumItems; ++ItemIdx)
+		{
+			OutDirs[ItemIdx] = GetItemRotation(QueryInstance, ItemIdx).Vector();
+		}
+		return;
+	}
 
-				default:
-					UE_LOG(LogEQS, Error, TEXT("Invalid TestMode in EmpathEnvQueryTest_Dot in query %s!"), *QueryInstance.QueryName);
-					break;
-				}
+	// Between the item and itself, which has no direction
+	bool const bFromItem = IsContextPerItem(Line.LineFrom);
+	bool const bToItem = IsContextPerItem(Line.LineTo);
+	if (bFromItem && bToItem)
+	{
+		OutDirsPerItem = 1;
+		OutDirs.SetNumZeroed(NumItems, false);
+		return;
+	}
 
-				if (bAbsoluteValue)
-				{
-					DotValue = FMath::Abs(DotValue);
-				}
-				It.SetScore(TestPurpose, FilterType, DotValue, MinThresholdValue, MaxThresholdValue);
-			}
+	// Between the item and the other context's locations, in the same order that GatherLineDirections uses
+	ScratchLocations.Reset();
+	QueryInstance.PrepareContext(bFromItem ? Line.LineTo : Line.LineFrom, ScratchLocations);
+	OutDirsPerItem = ScratchLocations.Num();
+	OutDirs.SetNumUninitialized(NumItems * OutDirsPerItem, false);
+	for (int32 ItemIdx = 0; ItemIdx < NumItems; ++ItemIdx)
+	{
+		FVector const ItemLocation = GetItemLocation(QueryInstance, ItemIdx);
+		FVector* const ItemDirs = OutDirs.GetData() + (ItemIdx * OutDirsPerItem);
+		for (int32 ContextIdx = 0; ContextIdx < OutDirsPerItem; ++ContextIdx)
+		{
+			FVector const& ContextLocation = ScratchLocations[ContextIdx];
+			ItemDirs[ContextIdx] = (bFromItem ? (ContextLocation - ItemLocation) : (ItemLocation - ContextLocation)).GetSafeNormal();
 		}
 	}
 }
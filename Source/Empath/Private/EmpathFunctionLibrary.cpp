@@ -721,10 +721,33 @@ const FString UEmpathFunctionLibrary::GestureCheckDebugToCSV(FEmpathOneHandGestu
 	ReturnValue += FString::SanitizeFloat(Input.MovementSinceStart);
 	ReturnValue += ",";
 	ReturnValue += FString::SanitizeFloat(Input.TimeSinceStart);
+	ReturnValue += ",\"";
+	ReturnValue += Input.FailureReason.Replace(TEXT("\""), TEXT("\"\""));
+	ReturnValue += "\"";
 
 	return ReturnValue;
 }
 
+const FString UEmpathFunctionLibrary::GetOneHandGestureFailureReason(FEmpathOneHandGestureData& Gesture, bool bSustain)
+{
+	return (bSustain ? Gesture.GetSustainFailureReason() : Gesture.GetEntryFailureReason());
+}
+
+const FString UEmpathFunctionLibrary::GetTwoHandGestureFailureReason(FEmpathTwoHandGestureData& Gesture, bool bSustain, EEmpathBinaryHand Hand)
+{
+	return (bSustain ? Gesture.GetSustainFailureReason(Hand) : Gesture.GetEntryFailureReason(Hand));
+}
+
+void UEmpathFunctionLibrary::CompileOneHandGestureConditions(FEmpathOneHandGestureData& Gesture)
+{
+	Gesture.CompileConditions();
+}
+
+void UEmpathFunctionLibrary::CompileTwoHandGestureConditions(FEmpathTwoHandGestureData& Gesture)
+{
+	Gesture.CalculateLeftHandConditions();
+}
+
 AEmpathPlayerCharacter* UEmpathFunctionLibrary::GetEmpathPlayerChar(const UObject* WorldContextObject)
 {
 	if (AEmpathPlayerController* PlayerCon = GetEmpathPlayerCon(WorldContextObject))
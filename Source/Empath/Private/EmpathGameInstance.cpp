@@ -1,10 +1,13 @@
 // Copyright 2018 Team Empath All Rights Reserved
 
 #include "EmpathGameInstance.h"
+#include "Empath.h"
 #include "EmpathGameSettings.h"
 #include "Classes/Kismet/GameplayStatics.h"
 #include "EmpathFunctionLibrary.h"
 #include "EmpathPlayerCharacter.h"
+#include "EmpathTypes.h"
+#include "EmpathAIStressTest.h"
 
 
 //FAutoConsoleCommand CSetPlayerIdx(
@@ -83,6 +86,17 @@ void UEmpathGameInstance::Shutdown()
 	Super::Shutdown();
 }
 
+void UEmpathGameInstance::OnStart()
+{
+	Super::OnStart();
+
+	// Lets the AI stress test run in whatever map the game was started in
+	if (FParse::Param(FCommandLine::Get(), TEXT("AIStress")))
+	{
+		AEmpathAIStressTest::SpawnStressTest(GetWorld());
+	}
+}
+
 bool UEmpathGameInstance::SetPlayerProgressIdx(int32 NewPlayerProgressIdx)
 {
 	if (PlayerProgressIdx != NewPlayerProgressIdx)
@@ -97,4 +111,16 @@ bool UEmpathGameInstance::SetPlayerProgressIdx(int32 NewPlayerProgressIdx)
 void UEmpathGameInstance::EmpathJumpToProgress(int32 NewPlayerProgressIdx)
 {
 	JumpToProgress(NewPlayerProgressIdx);
-}
\ No newline at end of file
+}
+
+void UEmpathGameInstance::EmpathBenchmarkKinematics(int32 NumIterations)
+{
+	NumIterations = (NumIterations > 0 ? NumIterations : 100000);
+	double const NanosecondsPerHand = FEmpathKinematicSamples::BenchmarkFrameUpdate(NumIterations);
+	UE_LOG(LogEmpath, Log, TEXT("Kinematic update: %.2f ns per hand update over %d frames of two hands."), NanosecondsPerHand, NumIterations);
+}
+
+void UEmpathGameInstance::EmpathAIStressTest()
+{
+	AEmpathAIStressTest::SpawnStressTest(GetWorld());
+}
@@ -33,6 +33,7 @@ AEmpathHandActor::AEmpathHandActor(const FObjectInitializer& ObjectInitializer)
 	ControllerOffsetLocation = FVector(8.5f, 1.0f, -2.5f);
 	ControllerOffsetRotation = FRotator(-20.0f, -100.0f, -90.0f);
 	ActiveOneHandGestureIdx = -1;
+	ReplayedDeltaDistance = 0.0f;
 	PunchCooldownAfterPunch = 0.2f;
 	PunchCooldownAfterSlash = 0.3f;
 	PunchCooldownAfterCannonShotStatic = 1.0f;
@@ -114,6 +115,12 @@ void AEmpathHandActor::RegisterHand(AEmpathHandActor* InOtherHand,
 	OwningHand = InOwningHand;
 	KinematicVelocityComponent->OwningPlayer = InOwningPlayerCharacter; 
 
+	// Update both hands' kinematic velocity together
+	if (InOtherHand)
+	{
+		KinematicVelocityComponent->SetBatchedComponent(InOtherHand->GetKinematicVelocityComponent());
+	}
+
 	// Invert the actor's left / right scale if it's the left hand
 	if (OwningHand == EEmpathBinaryHand::Left)
 	{
@@ -129,6 +136,13 @@ void AEmpathHandActor::RegisterHand(AEmpathHandActor* InOtherHand,
 		BlockingData.InvertHand();
 	}
 
+	// Compile the gesture conditions now that they face the right way
+	for (FEmpathOneHandGestureDataTyped& Gesture : TypedOneHandedGestures)
+	{
+		Gesture.CompileConditions();
+	}
+	BlockingData.CompileConditions();
+
 	// We apply an initial controller offset to the mesh 
 	// to compensate for the offset of the tracking origin and the actual center
 	MeshComponent->SetRelativeLocationAndRotation(ControllerOffsetLocation, ControllerOffsetRotation);
@@ -535,12 +549,12 @@ void AEmpathHandActor::OnGestureStateChanged(const EEmpathGestureType OldGesture
 	{
 	case EEmpathGestureType::Punching:
 	{
-		LastPunchExitTimeStamp = GetWorld()->GetRealTimeSeconds();
+		LastPunchExitTimeStamp = GetGestureTimeSeconds();
 		break;
 	}
 	case EEmpathGestureType::Slashing:
 	{
-		LastSlashExitTimeStamp = GetWorld()->GetRealTimeSeconds();
+		LastSlashExitTimeStamp = GetGestureTimeSeconds();
 		break;
 	}
 	default:
@@ -549,11 +563,15 @@ void AEmpathHandActor::OnGestureStateChanged(const EEmpathGestureType OldGesture
 	}
 	}
 
-	// Fire notifies and receives
-	ReceiveGestureStateChanged(OldGestureState, NewGestureState);
-	if (OtherHand)
+	// Fire notifies and receives. Replayed gestures are only reported to the player character
+	bool const bReplayingGestures = (OwningPlayerCharacter && OwningPlayerCharacter->IsReplayingGestures());
+	if (!bReplayingGestures)
 	{
-		OtherHand->OnOtherHandGestureStateChanged(OldGestureState, NewGestureState);
+		ReceiveGestureStateChanged(OldGestureState, NewGestureState);
+		if (OtherHand)
+		{
+			OtherHand->OnOtherHandGestureStateChanged(OldGestureState, NewGestureState);
+		}
 	}
 	if (OwningPlayerCharacter)
 	{
@@ -576,7 +594,7 @@ void AEmpathHandActor::TickUpdateBlockingState()
 		{
 			// If so, cancel deactivation and add the current distance traveled
 			BlockingData.GestureState.ActivationState = EEmpathActivationState::Active;
-			BlockingData.GestureState.GestureDistance += KinematicVelocityComponent->GetDeltaLocation().Size();
+			BlockingData.GestureState.GestureDistance += GetGestureDeltaDistance();
 			BlockingTransformCache.LastExitStartLocation = KinematicVelocityComponent->GetComponentLocation();
 			BlockingTransformCache.LastExitStartRotation = KinematicVelocityComponent->GetComponentRotation();
 			BlockingTransformCache.LastExitStartMotionAngle = GestureConditionCheck.MotionAngle;
@@ -589,12 +607,12 @@ void AEmpathHandActor::TickUpdateBlockingState()
 			// Begin deactivating if we have not already
 			if (BlockingData.GestureState.ActivationState != EEmpathActivationState::Deactivating)
 			{
-				BlockingData.GestureState.LastExitStartTime = GetWorld()->GetRealTimeSeconds();
+				BlockingData.GestureState.LastExitStartTime = GetGestureTimeSeconds();
 				BlockingData.GestureState.ActivationState = EEmpathActivationState::Deactivating;
 			}
 
 			// Deactivate the gesture if appropriate
-			if (UEmpathFunctionLibrary::GetRealTimeSince(this, BlockingData.GestureState.LastExitStartTime) >= BlockingData.MinExitTime)
+			if ((GetGestureTimeSeconds() - BlockingData.GestureState.LastExitStartTime) >= BlockingData.MinExitTime)
 			{
 				BlockingData.GestureState.ActivationState = EEmpathActivationState::Inactive;
 				SetIsBlocking(false);
@@ -603,7 +621,7 @@ void AEmpathHandActor::TickUpdateBlockingState()
 			// Otherwise, add the distance traveled to the curr gesture state
 			else if (KinematicVelocityComponent)
 			{
-				BlockingData.GestureState.GestureDistance += KinematicVelocityComponent->GetDeltaLocation().Size();
+				BlockingData.GestureState.GestureDistance += GetGestureDeltaDistance();
 			}
 		}
 	}
@@ -616,7 +634,7 @@ void AEmpathHandActor::TickUpdateBlockingState()
 			// Begin activating if we have not already
 			if (BlockingData.GestureState.ActivationState != EEmpathActivationState::Activating)
 			{
-				BlockingData.GestureState.LastEntryStartTime = GetWorld()->GetRealTimeSeconds();
+				BlockingData.GestureState.LastEntryStartTime = GetGestureTimeSeconds();
 				BlockingTransformCache.LastEntryStartLocation = KinematicVelocityComponent->GetComponentLocation();
 				BlockingTransformCache.LastEntryStartRotation = KinematicVelocityComponent->GetComponentRotation();
 				BlockingTransformCache.LastEntryStartMotionAngle = GestureConditionCheck.MotionAngle;
@@ -625,11 +643,11 @@ void AEmpathHandActor::TickUpdateBlockingState()
 			}
 
 			// Add the distance traveled to this gesture
-			BlockingData.GestureState.GestureDistance += KinematicVelocityComponent->GetDeltaLocation().Size();
+			BlockingData.GestureState.GestureDistance += GetGestureDeltaDistance();
 
 			// Activate if appropriate
 			if (BlockingData.GestureState.GestureDistance >= BlockingData.MinEntryDistance
-				&& UEmpathFunctionLibrary::GetRealTimeSince(this, BlockingData.GestureState.LastEntryStartTime) >= BlockingData.MinEntryTime)
+				&& (GetGestureTimeSeconds() - BlockingData.GestureState.LastEntryStartTime) >= BlockingData.MinEntryTime)
 			{
 				BlockingData.GestureState.ActivationState = EEmpathActivationState::Active;
 				BlockingTransformCache.LastExitStartLocation = KinematicVelocityComponent->GetComponentLocation();
@@ -664,13 +682,18 @@ void AEmpathHandActor::SetIsBlocking(const bool bNewIsBlocking)
 	if (bNewIsBlocking != bIsBlocking)
 	{
 		bIsBlocking = bNewIsBlocking;
-		if (bIsBlocking)
-		{
-			OnBlockingStart();
-		}
-		else
+
+		// Replayed blocking is only reported to the player character
+		if (!OwningPlayerCharacter || !OwningPlayerCharacter->IsReplayingGestures())
 		{
-			OnBlockingEnd();
+			if (bIsBlocking)
+			{
+				OnBlockingStart();
+			}
+			else
+			{
+				OnBlockingEnd();
+			}
 		}
 		if (OwningPlayerCharacter)
 		{
@@ -875,7 +898,7 @@ bool AEmpathHandActor::CanPunch_Implementation() const
 {
 	if (OwningPlayerCharacter && OwningPlayerCharacter->bPunchEnabled)
 	{
-		float RealTimeSecs = GetWorld()->GetRealTimeSeconds();
+		float RealTimeSecs = GetGestureTimeSeconds();
 		return (RealTimeSecs - LastPunchExitTimeStamp >= PunchCooldownAfterPunch
 			&& RealTimeSecs - LastSlashExitTimeStamp >= PunchCooldownAfterSlash
 			&& RealTimeSecs - OwningPlayerCharacter->LastCannonShotStaticcExitTimeStamp >= PunchCooldownAfterCannonShotStatic
@@ -888,7 +911,7 @@ bool AEmpathHandActor::CanSlash_Implementation() const
 {
 	if (OwningPlayerCharacter && OwningPlayerCharacter->bSlashEnabled)
 	{
-		float RealTimeSecs = GetWorld()->GetRealTimeSeconds();
+		float RealTimeSecs = GetGestureTimeSeconds();
 		return (RealTimeSecs - LastPunchExitTimeStamp >= SlashCooldownAfterPunch
 			&& RealTimeSecs - LastSlashExitTimeStamp >= SlashCooldownAfterSlash
 			&& RealTimeSecs - OwningPlayerCharacter->LastCannonShotStaticcExitTimeStamp >= SlashCooldownAfterCannonShotStatic
@@ -950,7 +973,7 @@ const bool AEmpathHandActor::AttemptEnterOneHandGesture()
 					ResetOneHandeGestureEntryState(Idx);
 
 					// Update variables
-					TypedOneHandedGestures[Idx].GestureState.LastEntryStartTime = GetWorld()->GetRealTimeSeconds();
+					TypedOneHandedGestures[Idx].GestureState.LastEntryStartTime = GetGestureTimeSeconds();
 					EEmpathGestureType GestureKey = UEmpathFunctionLibrary::FromOneHandGestureTypeToGestureType(TypedOneHandedGestures[Idx].GestureType);
 					GestureTransformCaches[GestureKey].LastEntryStartLocation = KinematicVelocityComponent->GetComponentLocation();
 					GestureTransformCaches[GestureKey].LastEntryStartRotation = KinematicVelocityComponent->GetComponentRotation();
@@ -960,11 +983,11 @@ const bool AEmpathHandActor::AttemptEnterOneHandGesture()
 				}
 
 				// Add the distance traveled to this gesture
-				TypedOneHandedGestures[Idx].GestureState.GestureDistance += KinematicVelocityComponent->GetDeltaLocation().Size();
+				TypedOneHandedGestures[Idx].GestureState.GestureDistance += GetGestureDeltaDistance();
 
 				// Activate if appropriate
 				if (TypedOneHandedGestures[Idx].GestureState.GestureDistance >= TypedOneHandedGestures[Idx].MinEntryDistance
-					&& UEmpathFunctionLibrary::GetRealTimeSince(this, TypedOneHandedGestures[Idx].GestureState.LastEntryStartTime) >= TypedOneHandedGestures[Idx].MinEntryTime)
+					&& (GetGestureTimeSeconds() - TypedOneHandedGestures[Idx].GestureState.LastEntryStartTime) >= TypedOneHandedGestures[Idx].MinEntryTime)
 				{
 					SetActiveOneHandGestureIdx(Idx);
 				}
@@ -1041,7 +1064,7 @@ const bool AEmpathHandActor::AttemptSustainOneHandGesture()
 			{
 				// If so, cancel deactivation and add the current distance traveled
 				TypedOneHandedGestures[ActiveOneHandGestureIdx].GestureState.ActivationState = EEmpathActivationState::Active;
-				TypedOneHandedGestures[ActiveOneHandGestureIdx].GestureState.GestureDistance += KinematicVelocityComponent->GetDeltaLocation().Size();
+				TypedOneHandedGestures[ActiveOneHandGestureIdx].GestureState.GestureDistance += GetGestureDeltaDistance();
 
 				// Update exit start locations
 				EEmpathGestureType GestureKey = UEmpathFunctionLibrary::FromOneHandGestureTypeToGestureType(TypedOneHandedGestures[ActiveOneHandGestureIdx].GestureType);
@@ -1058,12 +1081,12 @@ const bool AEmpathHandActor::AttemptSustainOneHandGesture()
 		// Begin deactivating if we have not already
 		if (TypedOneHandedGestures[ActiveOneHandGestureIdx].GestureState.ActivationState != EEmpathActivationState::Deactivating)
 		{
-			TypedOneHandedGestures[ActiveOneHandGestureIdx].GestureState.LastExitStartTime = GetWorld()->GetRealTimeSeconds();
+			TypedOneHandedGestures[ActiveOneHandGestureIdx].GestureState.LastExitStartTime = GetGestureTimeSeconds();
 			TypedOneHandedGestures[ActiveOneHandGestureIdx].GestureState.ActivationState = EEmpathActivationState::Deactivating;
 		}
 
 		// Deactivate the gesture if appropriate
-		if (UEmpathFunctionLibrary::GetRealTimeSince(this, TypedOneHandedGestures[ActiveOneHandGestureIdx].GestureState.LastExitStartTime) >= TypedOneHandedGestures[ActiveOneHandGestureIdx].MinExitTime)
+		if ((GetGestureTimeSeconds() - TypedOneHandedGestures[ActiveOneHandGestureIdx].GestureState.LastExitStartTime) >= TypedOneHandedGestures[ActiveOneHandGestureIdx].MinExitTime)
 		{
 			SetActiveOneHandGestureIdx();
 			return false;
@@ -1074,7 +1097,7 @@ const bool AEmpathHandActor::AttemptSustainOneHandGesture()
 		{
 			if (KinematicVelocityComponent)
 			{
-					TypedOneHandedGestures[ActiveOneHandGestureIdx].GestureState.GestureDistance += KinematicVelocityComponent->GetDeltaLocation().Size();
+					TypedOneHandedGestures[ActiveOneHandGestureIdx].GestureState.GestureDistance += GetGestureDeltaDistance();
 			}
 			return true;
 		}
@@ -1176,6 +1199,108 @@ void AEmpathHandActor::UpdateGestureConditionChecks()
 	return;
 }
 
+float AEmpathHandActor::GetGestureTimeSeconds() const
+{
+	if (OwningPlayerCharacter)
+	{
+		return OwningPlayerCharacter->GetGestureTimeSeconds();
+	}
+	return GetWorld()->GetRealTimeSeconds();
+}
+
+float AEmpathHandActor::GetGestureDeltaDistance() const
+{
+	if (OwningPlayerCharacter && OwningPlayerCharacter->IsReplayingGestures())
+	{
+		return ReplayedDeltaDistance;
+	}
+	return (KinematicVelocityComponent ? KinematicVelocityComponent->GetDeltaLocation().Size() : 0.0f);
+}
+
+float AEmpathHandActor::GetActiveOneHandGestureEntryStartTime() const
+{
+	if (ActiveOneHandGestureIdx > -1 && ActiveOneHandGestureIdx < TypedOneHandedGestures.Num())
+	{
+		return TypedOneHandedGestures[ActiveOneHandGestureIdx].GestureState.LastEntryStartTime;
+	}
+	return -1.0f;
+}
+
+void AEmpathHandActor::RecordGestureStreamFrame(FEmpathGestureStreamHandFrame& OutHandFrame) const
+{
+	OutHandFrame.GestureConditionCheck = GestureConditionCheck;
+	OutHandFrame.FrameConditionCheck = FrameConditionCheck;
+	OutHandFrame.DeltaDistance = GetGestureDeltaDistance();
+	OutHandFrame.bIsPowerCharged = bIsPowerCharged;
+}
+
+void AEmpathHandActor::ApplyGestureStreamFrame(const FEmpathGestureStreamHandFrame& HandFrame)
+{
+	// Bypass the charge events, as the frame may only be a replay
+	GestureConditionCheck = HandFrame.GestureConditionCheck;
+	FrameConditionCheck = HandFrame.FrameConditionCheck;
+	ReplayedDeltaDistance = HandFrame.DeltaDistance;
+	bIsPowerCharged = HandFrame.bIsPowerCharged;
+}
+
+void AEmpathHandActor::SetDescribeGestureFailures(const bool bNewDescribeFailures)
+{
+	for (FEmpathOneHandGestureDataTyped& Gesture : TypedOneHandedGestures)
+	{
+		Gesture.bDescribeFailures = bNewDescribeFailures;
+	}
+	BlockingData.bDescribeFailures = bNewDescribeFailures;
+}
+
+void AEmpathHandActor::ResetGestureState()
+{
+	SetActiveOneHandGestureIdx(-1);
+	ResetOneHandeGestureEntryState();
+	SetGestureState(EEmpathGestureType::NoGesture);
+	BlockingData.GestureState.ActivationState = EEmpathActivationState::Inactive;
+	BlockingData.GestureState.GestureDistance = 0.0f;
+	SetIsBlocking(false);
+}
+
+bool AEmpathHandActor::IsGestureIdle() const
+{
+	return (ActiveGestureType == EEmpathGestureType::NoGesture && ActiveOneHandGestureIdx == -1 && !bIsBlocking);
+}
+
+void AEmpathHandActor::SaveReplayedGestureState(FEmpathGestureReplayHandState& OutState) const
+{
+	RecordGestureStreamFrame(OutState.Inputs);
+	OutState.OneHandGestureStates.Reset(TypedOneHandedGestures.Num());
+	for (const FEmpathOneHandGestureDataTyped& Gesture : TypedOneHandedGestures)
+	{
+		OutState.OneHandGestureStates.Add(Gesture.GestureState);
+	}
+	OutState.BlockingState = BlockingData.GestureState;
+	OutState.GestureTransformCaches = GestureTransformCaches;
+	OutState.BlockingTransformCache = BlockingTransformCache;
+	OutState.LastActiveOneHandGestureIdx = LastActiveOneHandGestureIdx;
+	OutState.LastPunchExitTimeStamp = LastPunchExitTimeStamp;
+	OutState.LastSlashExitTimeStamp = LastSlashExitTimeStamp;
+}
+
+void AEmpathHandActor::RestoreReplayedGestureState(const FEmpathGestureReplayHandState& State)
+{
+	ApplyGestureStreamFrame(State.Inputs);
+	if (State.OneHandGestureStates.Num() == TypedOneHandedGestures.Num())
+	{
+		for (int32 Idx = 0; Idx < TypedOneHandedGestures.Num(); Idx++)
+		{
+			TypedOneHandedGestures[Idx].GestureState = State.OneHandGestureStates[Idx];
+		}
+	}
+	BlockingData.GestureState = State.BlockingState;
+	GestureTransformCaches = State.GestureTransformCaches;
+	BlockingTransformCache = State.BlockingTransformCache;
+	LastActiveOneHandGestureIdx = State.LastActiveOneHandGestureIdx;
+	LastPunchExitTimeStamp = State.LastPunchExitTimeStamp;
+	LastSlashExitTimeStamp = State.LastSlashExitTimeStamp;
+}
+
 void AEmpathHandActor::SetIsPowerCharged(const bool bNewIsCharged)
 {
 	if (bNewIsCharged != bIsPowerCharged)
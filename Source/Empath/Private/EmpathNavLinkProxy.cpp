@@ -4,6 +4,8 @@
 #include "NavigationSystem/Public/NavLinkCustomComponent.h"
 #include "Components/BoxComponent.h"
 
+TMap<uint32, AEmpathNavLinkProxy*> AEmpathNavLinkProxy::CustomLinkRegistry;
+
 AEmpathNavLinkProxy::AEmpathNavLinkProxy(const FObjectInitializer& ObjectInitializer)
 {
 	PointLinks.Empty();
@@ -11,6 +13,7 @@ AEmpathNavLinkProxy::AEmpathNavLinkProxy(const FObjectInitializer& ObjectInitial
 	bSmartLinkIsRelevant = true;
 
 	ClaimReleaseDelay = 0.5f;
+	RegisteredCustomLinkId = 0;
 
 #if WITH_EDITORONLY_DATA
 	StartEditorComp = CreateDefaultSubobject<UBoxComponent>(TEXT("StartBox0"));
@@ -90,6 +93,46 @@ void AEmpathNavLinkProxy::PostRegisterAllComponents()
 #endif // WITH_EDITOR
 
 
+void AEmpathNavLinkProxy::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Register so that AI can find us from path points
+	UNavLinkCustomComponent const* const LinkComp = GetSmartLinkComp();
+	if (LinkComp && LinkComp->GetLinkId() != 0)
+	{
+		RegisteredCustomLinkId = LinkComp->GetLinkId();
+		CustomLinkRegistry.Add(RegisteredCustomLinkId, this);
+	}
+}
+
+void AEmpathNavLinkProxy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (RegisteredCustomLinkId != 0)
+	{
+		// Only remove the entry if it is still ours
+		AEmpathNavLinkProxy* const* const RegisteredLink = CustomLinkRegistry.Find(RegisteredCustomLinkId);
+		if (RegisteredLink && *RegisteredLink == this)
+		{
+			CustomLinkRegistry.Remove(RegisteredCustomLinkId);
+		}
+		RegisteredCustomLinkId = 0;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+AEmpathNavLinkProxy* AEmpathNavLinkProxy::FindByCustomLinkId(uint32 CustomLinkId)
+{
+	if (CustomLinkId == 0)
+	{
+		return nullptr;
+	}
+
+	AEmpathNavLinkProxy* const* const RegisteredLink = CustomLinkRegistry.Find(CustomLinkId);
+	return RegisteredLink ? *RegisteredLink : nullptr;
+}
+
 void AEmpathNavLinkProxy::Claim(AEmpathAIController* ClaimHolder)
 {
 	ensure(IsClaimed() == false);
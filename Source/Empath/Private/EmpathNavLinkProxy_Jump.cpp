@@ -6,6 +6,7 @@
 #include "EmpathNavLineBatchComponent.h"
 #include "Components/BoxComponent.h"
 #include "EmpathFunctionLibrary.h"
+#include "GameFramework/Pawn.h"
 
 
 namespace JumpProxyStatics
@@ -37,6 +38,7 @@ AEmpathNavLinkProxy_Jump::AEmpathNavLinkProxy_Jump(const FObjectInitializer& Obj
 	}
 
 	JumpArc = 0.5f;
+	BakedJumpTolerance = 5.0f;
 
 #if WITH_EDITORONLY_DATA
 	bTraceJumpArc = false;
@@ -63,6 +65,76 @@ void AEmpathNavLinkProxy_Jump::PostLoad()
 	bWasLoaded = true;
 }
 
+void AEmpathNavLinkProxy_Jump::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Levels saved before jumps were baked won't have them yet
+	UNavLinkCustomComponent* const LinkComp = GetSmartLinkComp();
+	if (LinkComp && !FindBakedJumpTrajectory(LinkComp->GetStartPoint(), LinkComp->GetEndPoint(), JumpArc))
+	{
+		BakeJumpTrajectories();
+	}
+}
+
+// Computes the launch velocity and timings of a jump
+static void BakeJumpTrajectory(UObject const* WorldContextObject, FVector const& StartLocation, FVector const& EndLocation, float Arc, FEmpathJumpTrajectory& OutTrajectory)
+{
+	OutTrajectory = FEmpathJumpTrajectory();
+	OutTrajectory.StartLocation = StartLocation;
+	OutTrajectory.EndLocation = EndLocation;
+	OutTrajectory.Arc = Arc;
+
+	// Since we limit the jump arc, we should never have zero horizontal velocity
+	if (!UEmpathFunctionLibrary::SuggestProjectileVelocity(WorldContextObject, OutTrajectory.LaunchVelocity, StartLocation, EndLocation, Arc)
+		|| OutTrajectory.LaunchVelocity.SizeSquared2D() <= KINDA_SMALL_NUMBER)
+	{
+		return;
+	}
+	UEmpathFunctionLibrary::CalculateJumpTimings(WorldContextObject, OutTrajectory.LaunchVelocity, StartLocation, EndLocation, OutTrajectory.AscendingTime, OutTrajectory.DescendingTime);
+	OutTrajectory.bValid = true;
+}
+
+void AEmpathNavLinkProxy_Jump::BakeJumpTrajectories()
+{
+	UNavLinkCustomComponent* const LinkComp = GetSmartLinkComp();
+	if (!LinkComp || IsTemplate() || !GetWorld())
+	{
+		return;
+	}
+
+	FVector const StartLocation = LinkComp->GetStartPoint();
+	FVector const EndLocation = LinkComp->GetEndPoint();
+	BakeJumpTrajectory(this, StartLocation, EndLocation, JumpArc, BakedForwardJump);
+	BakeJumpTrajectory(this, EndLocation, StartLocation, JumpArc, BakedReverseJump);
+}
+
+FEmpathJumpTrajectory const* AEmpathNavLinkProxy_Jump::FindBakedJumpTrajectory(FVector const& StartLocation, FVector const& EndLocation, float Arc) const
+{
+	// Jumpers start from wherever they stand rather than exactly on the link's point. A launch velocity and its timings only depend on 
+	// the offset from the start to the end, so a baked jump can be used from anywhere as long as that offset matches in all three axes.
+	FVector const JumpOffset = EndLocation - StartLocation;
+	float const ToleranceSq = FMath::Square(BakedJumpTolerance);
+	FEmpathJumpTrajectory const* const BakedJumps[] = { &BakedForwardJump, &BakedReverseJump };
+	for (FEmpathJumpTrajectory const* const BakedJump : BakedJumps)
+	{
+		if (BakedJump->bValid
+			&& BakedJump->Arc == Arc
+			&& FVector::DistSquared(BakedJump->EndLocation - BakedJump->StartLocation, JumpOffset) <= ToleranceSq)
+		{
+			return BakedJump;
+		}
+	}
+
+	return nullptr;
+}
+
+FEmpathJumpTrajectory const* AEmpathNavLinkProxy_Jump::FindBakedJumpTrajectoryForJumper(const APawn* Jumper, FVector const& Destination, float Arc) const
+{
+	// Jumps are baked from point to point on the navmesh, so compare them from the jumper's feet rather than its center
+	return (Jumper ? FindBakedJumpTrajectory(Jumper->GetNavAgentLocation(), Destination, Arc) : nullptr);
+}
+
 #if WITH_EDITOR
 bool AEmpathNavLinkProxy_Jump::PredictJumpPath(FPredictProjectilePathResult& OutPathResult, bool& OutHit) const
 {
@@ -226,6 +298,7 @@ void AEmpathNavLinkProxy_Jump::SetRefreshTimer()
 void AEmpathNavLinkProxy_Jump::SyncLinkDataToComponents()
 {
 	Super::SyncLinkDataToComponents();
+	BakeJumpTrajectories();
 	// force an update
 	LastVisualizerUpdateFrame = 0;
 	RefreshPathVisualizer();
@@ -234,9 +307,17 @@ void AEmpathNavLinkProxy_Jump::SyncLinkDataToComponents()
 void AEmpathNavLinkProxy_Jump::PostEditImport()
 {
 	Super::PostEditImport();
+	BakeJumpTrajectories();
 	RefreshPathVisualizer();
 }
 
+void AEmpathNavLinkProxy_Jump::PreSave(const class ITargetPlatform* TargetPlatform)
+{
+	// Make sure saved and cooked levels always have up to date jumps
+	BakeJumpTrajectories();
+	Super::PreSave(TargetPlatform);
+}
+
 #endif // WITH_EDITOR
 
 
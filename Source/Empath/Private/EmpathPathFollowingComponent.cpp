@@ -185,3 +185,14 @@ void UEmpathPathFollowingComponent::Reset()
 	Super::Reset();
 	bIsDecelerating = false;
 }
+
+void UEmpathPathFollowingComponent::OnPathUpdated()
+{
+	Super::OnPathUpdated();
+
+	// The path was changed in place, so its nav links need to be looked up again
+	if (AEmpathAIController* const AI = Cast<AEmpathAIController>(GetOwner()))
+	{
+		AI->InvalidateCurrentPathNavLinks();
+	}
+}
@@ -23,6 +23,7 @@ DECLARE_CYCLE_STAT(TEXT("Empath Player Char Gesture Recognition"), STAT_EMPATH_P
 
 // Log categories
 DEFINE_LOG_CATEGORY_STATIC(LogTeleportTrace, Log, All);
+DEFINE_LOG_CATEGORY_STATIC(LogGestureRecording, Log, All);
 
 
 // Console variable setup so we can enable and disable debugging from the console
@@ -80,6 +81,13 @@ AEmpathPlayerCharacter::AEmpathPlayerCharacter(const FObjectInitializer& ObjectI
 	CannonShotCooldownAfterPunch = 0.5f;
 	CannonShotCooldownAfterSlash = 0.5f;
 	CannonShotCooldownAfterCannonShot = 1.5f;
+	bDescribingGestureFailures = false;
+	bRecordingGestures = false;
+	GestureRecordingStartTime = 0.0f;
+	bReplayingGestures = false;
+	GestureReplayTimeSeconds = 0.0f;
+	GestureReplayStartTimeSeconds = 0.0f;
+	bRecordGestureReplayEvents = false;
 	TeleportMagnitude = 1500.0f;
 	DashMagnitude = 800.0f;
 	TeleportRadius = 4.0f;
@@ -196,15 +204,7 @@ void AEmpathPlayerCharacter::BeginPlay()
 	}
 
 	// Register hands
-	if (RightHandActor)
-	{
-		RightHandActor->RegisterHand(LeftHandActor, this, RightMotionController, EEmpathBinaryHand::Right);
-	}
-	if (LeftHandActor)
-	{
-		LeftHandActor->RegisterHand(RightHandActor, this, LeftMotionController, EEmpathBinaryHand::Left);
-	}
-	OnHandsRegistered();
+	RegisterHands(RightHandActor, LeftHandActor);
 
 	// Spawn, attach, and hide the teleport marker
 	if (TeleportMarkerClass)
@@ -249,7 +249,19 @@ void AEmpathPlayerCharacter::Tick(float DeltaTime)
 	TickUpdateTeleportState();
 	TickUpdateWalk();
 	TickUpdateClimbing();
+
+	// Describe gesture failures only while something is listening for them. 
+	// Keep setting it while bound, in case gesture data is replaced.
+	bool const bDescribeGestureFailures = OnGestureConditionsChecked.IsBound();
+	if (bDescribeGestureFailures || bDescribingGestureFailures)
+	{
+		SetDescribeGestureFailures(bDescribeGestureFailures);
+	}
 	TickUpdateGestureState();
+	if (bDescribeGestureFailures)
+	{
+		OnGestureConditionsChecked.Broadcast();
+	}
 }
 
 void AEmpathPlayerCharacter::PossessedBy(AController* NewController)
@@ -1151,6 +1163,21 @@ void AEmpathPlayerCharacter::OnTeleportTraceResultChanged(const EEmpathTeleportT
 	return;
 }
 
+void AEmpathPlayerCharacter::RegisterHands(AEmpathHandActor* InRightHandActor, AEmpathHandActor* InLeftHandActor)
+{
+	RightHandActor = InRightHandActor;
+	LeftHandActor = InLeftHandActor;
+	if (RightHandActor)
+	{
+		RightHandActor->RegisterHand(LeftHandActor, this, RightMotionController, EEmpathBinaryHand::Right);
+	}
+	if (LeftHandActor)
+	{
+		LeftHandActor->RegisterHand(RightHandActor, this, LeftMotionController, EEmpathBinaryHand::Left);
+	}
+	OnHandsRegistered();
+}
+
 void AEmpathPlayerCharacter::ClearHandGrips()
 {
 	if (RightHandActor)
@@ -2388,6 +2415,17 @@ void AEmpathPlayerCharacter::OnNewChargedState(const bool bNewCharged, const EEm
 
 void AEmpathPlayerCharacter::OnNewBlockingState(const bool bNewBlockingState, const EEmpathBinaryHand Hand)
 {
+	// Replayed blocking is reported by the replay instead of firing gameplay events
+	if (bReplayingGestures)
+	{
+		AEmpathHandActor* const HandActor = (Hand == EEmpathBinaryHand::Right ? RightHandActor : LeftHandActor);
+		if (bNewBlockingState && HandActor)
+		{
+			RecordGestureReplayEvent(EEmpathGestureType::NoGesture, true, Hand, HandActor->BlockingData.GestureState.LastEntryStartTime);
+		}
+		return;
+	}
+
 	ReceiveNewBlockingState(bNewBlockingState, Hand);
 	OnNewBlockingStateDelegate.Broadcast(bNewBlockingState, Hand);
 }
@@ -2396,6 +2434,39 @@ void AEmpathPlayerCharacter::OnGestureStateChanged(const EEmpathGestureType OldG
 	const EEmpathGestureType NewGestureState,
 	const EEmpathBinaryHand Hand)
 {
+	// Replayed gestures are reported by the replay instead of firing gameplay events
+	if (bReplayingGestures)
+	{
+		switch (NewGestureState)
+		{
+		case EEmpathGestureType::Punching:
+		case EEmpathGestureType::Slashing:
+		{
+			AEmpathHandActor* const HandActor = (Hand == EEmpathBinaryHand::Right ? RightHandActor : LeftHandActor);
+			if (HandActor)
+			{
+				RecordGestureReplayEvent(NewGestureState, false, Hand, HandActor->GetActiveOneHandGestureEntryStartTime());
+			}
+			break;
+		}
+		case EEmpathGestureType::CannonShotStatic:
+		{
+			RecordGestureReplayEvent(NewGestureState, false, Hand, CannonShotData.StaticData.GestureState.LastEntryStartTime);
+			break;
+		}
+		case EEmpathGestureType::CannonShotDynamic:
+		{
+			RecordGestureReplayEvent(NewGestureState, false, Hand, CannonShotData.DynamicData.GestureState.LastEntryStartTime);
+			break;
+		}
+		default:
+		{
+			break;
+		}
+		}
+		return;
+	}
+
 	ReceiveGestureStateChanged(OldGestureState, NewGestureState, Hand);
 	OnGestureStateChangedDelegate.Broadcast(OldGestureState, NewGestureState, Hand);
 }
@@ -2417,19 +2488,241 @@ void AEmpathPlayerCharacter::SetGestureCastingEnabled(const bool bNewEnabled)
 	}
 }
 
-void AEmpathPlayerCharacter::TickUpdateGestureState()
+void AEmpathPlayerCharacter::SetDescribeGestureFailures(const bool bNewDescribeFailures)
 {
-	// Scope process for the UE4 profiler
-	SCOPE_CYCLE_COUNTER(STAT_EMPATH_PlayerGestureRecognition);
+	bDescribingGestureFailures = bNewDescribeFailures;
+	if (RightHandActor)
+	{
+		RightHandActor->SetDescribeGestureFailures(bNewDescribeFailures);
+	}
+	if (LeftHandActor)
+	{
+		LeftHandActor->SetDescribeGestureFailures(bNewDescribeFailures);
+	}
+	CannonShotData.StaticData.bDescribeFailures = bNewDescribeFailures;
+	CannonShotData.DynamicData.bDescribeFailures = bNewDescribeFailures;
+}
+
+float AEmpathPlayerCharacter::GetGestureTimeSeconds() const
+{
+	return (bReplayingGestures ? GestureReplayTimeSeconds : GetWorld()->GetRealTimeSeconds());
+}
+
+void AEmpathPlayerCharacter::EmpathRecordGestures(FString FileName)
+{
+	if (bReplayingGestures)
+	{
+		UE_LOG(LogGestureRecording, Warning, TEXT("%s: Cannot record gestures while replaying them."), *GetNameSafe(this));
+		return;
+	}
+
+	GestureRecording.Reset();
+	GestureRecordingFileName = (FileName.IsEmpty() ? FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")) : FileName);
+	GestureRecordingStartTime = GetWorld()->GetRealTimeSeconds();
+	bRecordingGestures = true;
+	UE_LOG(LogGestureRecording, Log, TEXT("%s: Recording gestures to %s."), *GetNameSafe(this), *FEmpathGestureStream::GetFilePath(GestureRecordingFileName));
+}
+
+void AEmpathPlayerCharacter::EmpathStopRecordingGestures()
+{
+	if (!bRecordingGestures)
+	{
+		UE_LOG(LogGestureRecording, Warning, TEXT("%s: Not currently recording gestures."), *GetNameSafe(this));
+		return;
+	}
+
+	bRecordingGestures = false;
+	FString const FilePath = FEmpathGestureStream::GetFilePath(GestureRecordingFileName);
+	if (GestureRecording.SaveToFile(GestureRecordingFileName))
+	{
+		UE_LOG(LogGestureRecording, Log, TEXT("%s: Saved %d frames (%.2f seconds) of gestures to %s."), 
+			*GetNameSafe(this), GestureRecording.Frames.Num(), GestureRecording.GetDuration(), *FilePath);
+	}
+	else
+	{
+		UE_LOG(LogGestureRecording, Error, TEXT("%s: Could not save gestures to %s."), *GetNameSafe(this), *FilePath);
+	}
+	GestureRecording.Reset();
+}
+
+void AEmpathPlayerCharacter::EmpathReplayGestures(FString FileName, int32 NumIterations)
+{
+	FEmpathGestureStream Stream;
+	if (!Stream.LoadFromFile(FileName) || Stream.Frames.Num() == 0)
+	{
+		UE_LOG(LogGestureRecording, Error, TEXT("%s: Could not load gestures from %s."), *GetNameSafe(this), *FEmpathGestureStream::GetFilePath(FileName));
+		return;
+	}
+	NumIterations = FMath::Max(NumIterations, 1);
+
+	double const StartSeconds = FPlatformTime::Seconds();
+	if (!ReplayGestureStream(Stream, NumIterations))
+	{
+		return;
+	}
+	double const ElapsedSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+	// Report the recognized gestures
+	UE_LOG(LogGestureRecording, Log, TEXT("%s: Replayed %d frames (%.2f seconds) of gestures from %s."), 
+		*GetNameSafe(this), Stream.Frames.Num(), Stream.GetDuration(), *FEmpathGestureStream::GetFilePath(FileName));
+	const UEnum* GestureEnumPtr = FindObject<UEnum>(ANY_PACKAGE, TEXT("EEmpathGestureType"), true);
+	float TotalLatencySeconds = 0.0f;
+	for (const FEmpathGestureReplayEvent& Event : GestureReplayEvents)
+	{
+		FString GestureName = TEXT("Blocking");
+		if (!Event.bBlocking)
+		{
+			GestureName = (GestureEnumPtr ? GestureEnumPtr->GetNameStringByValue((int64)Event.GestureType) : FString::FromInt((int32)Event.GestureType));
+		}
+		UE_LOG(LogGestureRecording, Log, TEXT("    %.3fs: %s hand entered %s after %.1f ms."), 
+			Event.TimeSeconds, (Event.Hand == EEmpathBinaryHand::Right ? TEXT("Right") : TEXT("Left")), *GestureName, Event.LatencySeconds * 1000.0f);
+		TotalLatencySeconds += Event.LatencySeconds;
+	}
+	UE_LOG(LogGestureRecording, Log, TEXT("%s: Recognized %d gestures with an average latency of %.1f ms."), 
+		*GetNameSafe(this), GestureReplayEvents.Num(), (GestureReplayEvents.Num() > 0 ? TotalLatencySeconds * 1000.0f / GestureReplayEvents.Num() : 0.0f));
 
-	// Update condition checks
+	// Report the throughput
+	int32 const NumFramesReplayed = Stream.Frames.Num() * NumIterations;
+	UE_LOG(LogGestureRecording, Log, TEXT("%s: Evaluated %d frames over %d iterations in %.2f ms: %.2f us per frame, %.0f frames per second."), 
+		*GetNameSafe(this), NumFramesReplayed, NumIterations, ElapsedSeconds * 1000.0, 
+		ElapsedSeconds * 1000000.0 / NumFramesReplayed, (ElapsedSeconds > 0.0 ? NumFramesReplayed / ElapsedSeconds : 0.0));
+	GestureReplayEvents.Empty();
+}
+
+bool AEmpathPlayerCharacter::ReplayGestureStream(const FEmpathGestureStream& Stream, int32 NumIterations)
+{
+	if (bRecordingGestures || bReplayingGestures)
+	{
+		UE_LOG(LogGestureRecording, Warning, TEXT("%s: Cannot replay gestures while recording or replaying them."), *GetNameSafe(this));
+		return false;
+	}
+	if (!RightHandActor || !LeftHandActor)
+	{
+		UE_LOG(LogGestureRecording, Warning, TEXT("%s: Cannot replay gestures without both hands."), *GetNameSafe(this));
+		return false;
+	}
+
+	// Replayed gestures are entered and exited without firing gameplay events, 
+	// so a pose or gesture that is already active could not be cleanly ended or resumed
+	if (CastingPose != EEmpathCastingPose::NoPose || !RightHandActor->IsGestureIdle() || !LeftHandActor->IsGestureIdle())
+	{
+		UE_LOG(LogGestureRecording, Warning, TEXT("%s: Cannot replay gestures while in a casting pose, gesture, or blocking."), *GetNameSafe(this));
+		return false;
+	}
+	NumIterations = FMath::Max(NumIterations, 1);
+
+	// Keep the current gesture state of both hands and Cannon Shot, so that the replay does not affect gameplay afterwards
+	AEmpathHandActor* Hands[2];
+	Hands[(uint8)EEmpathBinaryHand::Left] = LeftHandActor;
+	Hands[(uint8)EEmpathBinaryHand::Right] = RightHandActor;
+	FEmpathGestureReplayHandState SavedHandStates[2];
+	for (int32 HandIdx = 0; HandIdx < 2; ++HandIdx)
+	{
+		Hands[HandIdx]->SaveReplayedGestureState(SavedHandStates[HandIdx]);
+	}
+	FEmpathTwoHandGestureState const SavedCannonShotStaticState = CannonShotData.StaticData.GestureState;
+	FEmpathTwoHandGestureState const SavedCannonShotDynamicState = CannonShotData.DynamicData.GestureState;
+	float const SavedCannonShotStaticExitTimeStamp = LastCannonShotStaticcExitTimeStamp;
+	float const SavedCannonShotDynamicExitTimeStamp = LastCannonShotDynamicExitTimeStamp;
+
+	auto RestoreGestureState = [&]()
+	{
+		ResetReplayedGestureState();
+		for (int32 HandIdx = 0; HandIdx < 2; ++HandIdx)
+		{
+			Hands[HandIdx]->RestoreReplayedGestureState(SavedHandStates[HandIdx]);
+		}
+		CannonShotData.StaticData.GestureState = SavedCannonShotStaticState;
+		CannonShotData.DynamicData.GestureState = SavedCannonShotDynamicState;
+		LastCannonShotStaticcExitTimeStamp = SavedCannonShotStaticExitTimeStamp;
+		LastCannonShotDynamicExitTimeStamp = SavedCannonShotDynamicExitTimeStamp;
+	};
+
+	// Replay every frame as if it were ticked, using the recorded time for gesture timing.
+	// Each iteration starts from the saved state, so that every iteration does the same work.
+	bReplayingGestures = true;
+	GestureReplayEvents.Reset();
+	GestureReplayStartTimeSeconds = GetWorld()->GetRealTimeSeconds();
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		GestureReplayTimeSeconds = GestureReplayStartTimeSeconds;
+		bRecordGestureReplayEvents = false;
+		RestoreGestureState();
+
+		// Only report the gestures of the first iteration, as the rest are identical
+		bRecordGestureReplayEvents = (Iteration == 0);
+		for (const FEmpathGestureStreamFrame& Frame : Stream.Frames)
+		{
+			GestureReplayTimeSeconds = GestureReplayStartTimeSeconds + Frame.TimeSeconds;
+			for (int32 HandIdx = 0; HandIdx < 2; ++HandIdx)
+			{
+				Hands[HandIdx]->ApplyGestureStreamFrame(Frame.Hands[HandIdx]);
+			}
+			TickUpdateGestureState();
+			RightHandActor->TickUpdateBlockingState();
+			LeftHandActor->TickUpdateBlockingState();
+		}
+	}
+
+	// Restore the state from before the replay
+	bRecordGestureReplayEvents = false;
+	RestoreGestureState();
+	bReplayingGestures = false;
+	return true;
+}
+
+void AEmpathPlayerCharacter::ResetReplayedGestureState()
+{
+	SetCastingPose(EEmpathCastingPose::NoPose);
+	ResetPoseEntryState(EEmpathCastingPose::NoPose);
 	if (RightHandActor)
 	{
-		RightHandActor->UpdateGestureConditionChecks();
+		RightHandActor->ResetGestureState();
 	}
 	if (LeftHandActor)
 	{
-		LeftHandActor->UpdateGestureConditionChecks();
+		LeftHandActor->ResetGestureState();
+	}
+}
+
+void AEmpathPlayerCharacter::RecordGestureReplayEvent(const EEmpathGestureType GestureType, const bool bBlocking, const EEmpathBinaryHand Hand, const float EntryStartTime)
+{
+	if (bRecordGestureReplayEvents)
+	{
+		FEmpathGestureReplayEvent& Event = GestureReplayEvents[GestureReplayEvents.AddDefaulted()];
+		Event.TimeSeconds = GestureReplayTimeSeconds - GestureReplayStartTimeSeconds;
+		Event.GestureType = GestureType;
+		Event.bBlocking = bBlocking;
+		Event.Hand = Hand;
+		Event.LatencySeconds = FMath::Max(GestureReplayTimeSeconds - EntryStartTime, 0.0f);
+	}
+}
+
+void AEmpathPlayerCharacter::TickUpdateGestureState()
+{
+	// Scope process for the UE4 profiler
+	SCOPE_CYCLE_COUNTER(STAT_EMPATH_PlayerGestureRecognition);
+
+	// Update condition checks, unless they are being supplied by a replay
+	if (!bReplayingGestures)
+	{
+		if (RightHandActor)
+		{
+			RightHandActor->UpdateGestureConditionChecks();
+		}
+		if (LeftHandActor)
+		{
+			LeftHandActor->UpdateGestureConditionChecks();
+		}
+
+		// Capture the inputs of both hands if we are recording them
+		if (bRecordingGestures && RightHandActor && LeftHandActor)
+		{
+			FEmpathGestureStreamFrame& Frame = GestureRecording.Frames[GestureRecording.Frames.AddDefaulted()];
+			Frame.TimeSeconds = GetWorld()->GetRealTimeSeconds() - GestureRecordingStartTime;
+			RightHandActor->RecordGestureStreamFrame(Frame.Hands[(uint8)EEmpathBinaryHand::Right]);
+			LeftHandActor->RecordGestureStreamFrame(Frame.Hands[(uint8)EEmpathBinaryHand::Left]);
+		}
 	}
 
 	// Update state depending on the current casting pose
@@ -2470,7 +2763,7 @@ void AEmpathPlayerCharacter::TickUpdateGestureState()
 					CannonShotData.DynamicData.GestureState.ActivationState = EEmpathActivationState::Activating;
 
 					// Cache entry variables
-					CannonShotData.DynamicData.GestureState.LastEntryStartTime = GetWorld()->GetRealTimeSeconds();
+					CannonShotData.DynamicData.GestureState.LastEntryStartTime = GetGestureTimeSeconds();
 					RightHandActor->GestureTransformCaches[EEmpathGestureType::CannonShotDynamic].LastEntryStartLocation = RightHandActor->GetKinematicVelocityComponent()->GetComponentLocation();
 					RightHandActor->GestureTransformCaches[EEmpathGestureType::CannonShotDynamic].LastEntryStartRotation = RightHandActor->GetKinematicVelocityComponent()->GetComponentRotation();
 					RightHandActor->GestureTransformCaches[EEmpathGestureType::CannonShotDynamic].LastEntryStartMotionAngle = RightHandActor->GestureConditionCheck.MotionAngle;
@@ -2482,11 +2775,11 @@ void AEmpathPlayerCharacter::TickUpdateGestureState()
 				}
 
 				// Increment the distance traveled by each hand
-				CannonShotData.DynamicData.GestureState.GestureDistanceRight += RightHandActor->GetKinematicVelocityComponent()->GetDeltaLocation().Size();
-				CannonShotData.DynamicData.GestureState.GestureDistanceLeft += LeftHandActor->GetKinematicVelocityComponent()->GetDeltaLocation().Size();
+				CannonShotData.DynamicData.GestureState.GestureDistanceRight += RightHandActor->GetGestureDeltaDistance();
+				CannonShotData.DynamicData.GestureState.GestureDistanceLeft += LeftHandActor->GetGestureDeltaDistance();
 
 				// Check if we have moved the minimum distance and for the minimum time
-				if (UEmpathFunctionLibrary::GetRealTimeSince(this, CannonShotData.DynamicData.GestureState.LastEntryStartTime) >= CannonShotData.DynamicData.MinEntryTime
+				if ((GetGestureTimeSeconds() - CannonShotData.DynamicData.GestureState.LastEntryStartTime) >= CannonShotData.DynamicData.MinEntryTime
 					&& CannonShotData.DynamicData.GestureState.GestureDistanceRight >= CannonShotData.DynamicData.MinEntryDistance
 					&& CannonShotData.DynamicData.GestureState.GestureDistanceLeft >= CannonShotData.DynamicData.MinEntryDistance)
 				{
@@ -2512,8 +2805,8 @@ void AEmpathPlayerCharacter::TickUpdateGestureState()
 				{
 					// If so, maintain and update the static state and update the distance traveled
 					CannonShotData.StaticData.GestureState.ActivationState = EEmpathActivationState::Active;
-					CannonShotData.StaticData.GestureState.GestureDistanceRight += RightHandActor->GetKinematicVelocityComponent()->GetDeltaLocation().Size();
-					CannonShotData.StaticData.GestureState.GestureDistanceLeft += LeftHandActor->GetKinematicVelocityComponent()->GetDeltaLocation().Size();
+					CannonShotData.StaticData.GestureState.GestureDistanceRight += RightHandActor->GetGestureDeltaDistance();
+					CannonShotData.StaticData.GestureState.GestureDistanceLeft += LeftHandActor->GetGestureDeltaDistance();
 					
 					return;
 					break;
@@ -2527,11 +2820,11 @@ void AEmpathPlayerCharacter::TickUpdateGestureState()
 		{
 			// Update the exit state
 			CannonShotData.StaticData.GestureState.ActivationState = EEmpathActivationState::Deactivating;
-			CannonShotData.StaticData.GestureState.LastExitStartTime = GetWorld()->GetRealTimeSeconds();
+			CannonShotData.StaticData.GestureState.LastExitStartTime = GetGestureTimeSeconds();
 		}
 
 		// Deactivate if enough time has passed since we began deactivating
-		if (UEmpathFunctionLibrary::GetRealTimeSince(this, CannonShotData.StaticData.GestureState.LastExitStartTime) >= CannonShotData.StaticData.MinExitTime)
+		if ((GetGestureTimeSeconds() - CannonShotData.StaticData.GestureState.LastExitStartTime) >= CannonShotData.StaticData.MinExitTime)
 		{
 			CannonShotData.StaticData.GestureState.ActivationState = EEmpathActivationState::Inactive;
 			SetCastingPose(EEmpathCastingPose::NoPose);
@@ -2542,11 +2835,11 @@ void AEmpathPlayerCharacter::TickUpdateGestureState()
 		{
 			if (RightHandActor && RightHandActor->GetKinematicVelocityComponent())
 			{
-				CannonShotData.StaticData.GestureState.GestureDistanceRight += RightHandActor->GetKinematicVelocityComponent()->GetDeltaLocation().Size();
+				CannonShotData.StaticData.GestureState.GestureDistanceRight += RightHandActor->GetGestureDeltaDistance();
 			}
 			if (LeftHandActor && LeftHandActor->GetKinematicVelocityComponent())
 			{
-				CannonShotData.StaticData.GestureState.GestureDistanceLeft += LeftHandActor->GetKinematicVelocityComponent()->GetDeltaLocation().Size();
+				CannonShotData.StaticData.GestureState.GestureDistanceLeft += LeftHandActor->GetGestureDeltaDistance();
 			}
 		}
 
@@ -2565,8 +2858,8 @@ void AEmpathPlayerCharacter::TickUpdateGestureState()
 			CannonShotData.DynamicData.GestureState.ActivationState = EEmpathActivationState::Active;
 
 			// Update gesture distances
-			CannonShotData.DynamicData.GestureState.GestureDistanceLeft += LeftHandActor->GetKinematicVelocityComponent()->GetDeltaLocation().Size();
-			CannonShotData.DynamicData.GestureState.GestureDistanceRight += RightHandActor->GetKinematicVelocityComponent()->GetDeltaLocation().Size();
+			CannonShotData.DynamicData.GestureState.GestureDistanceLeft += LeftHandActor->GetGestureDeltaDistance();
+			CannonShotData.DynamicData.GestureState.GestureDistanceRight += RightHandActor->GetGestureDeltaDistance();
 
 			// Update last positions and rotations
 			RightHandActor->GestureTransformCaches[EEmpathGestureType::CannonShotDynamic].LastExitStartLocation = RightHandActor->GetKinematicVelocityComponent()->GetComponentLocation();
@@ -2590,11 +2883,11 @@ void AEmpathPlayerCharacter::TickUpdateGestureState()
 			{
 				// Update gesture state
 				CannonShotData.DynamicData.GestureState.ActivationState = EEmpathActivationState::Deactivating;
-				CannonShotData.DynamicData.GestureState.LastExitStartTime = GetWorld()->GetRealTimeSeconds();
+				CannonShotData.DynamicData.GestureState.LastExitStartTime = GetGestureTimeSeconds();
 			}
 
 			// If enough time has passed, deactivate the gesture
-			if (UEmpathFunctionLibrary::GetRealTimeSince(this, CannonShotData.DynamicData.GestureState.LastExitStartTime) >= CannonShotData.DynamicData.MinExitTime)
+			if ((GetGestureTimeSeconds() - CannonShotData.DynamicData.GestureState.LastExitStartTime) >= CannonShotData.DynamicData.MinExitTime)
 			{
 				CannonShotData.DynamicData.GestureState.ActivationState = EEmpathActivationState::Inactive;
 				SetCastingPose(EEmpathCastingPose::NoPose);
@@ -2605,11 +2898,11 @@ void AEmpathPlayerCharacter::TickUpdateGestureState()
 			{
 				if (RightHandActor && RightHandActor->GetKinematicVelocityComponent())
 				{
-					CannonShotData.StaticData.GestureState.GestureDistanceRight += RightHandActor->GetKinematicVelocityComponent()->GetDeltaLocation().Size();
+					CannonShotData.StaticData.GestureState.GestureDistanceRight += RightHandActor->GetGestureDeltaDistance();
 				}
 				if (LeftHandActor && LeftHandActor->GetKinematicVelocityComponent())
 				{
-					CannonShotData.StaticData.GestureState.GestureDistanceLeft += LeftHandActor->GetKinematicVelocityComponent()->GetDeltaLocation().Size();
+					CannonShotData.StaticData.GestureState.GestureDistanceLeft += LeftHandActor->GetGestureDeltaDistance();
 				}
 			}
 		}
@@ -2724,7 +3017,7 @@ bool AEmpathPlayerCharacter::AttemptEnterStaticCastingPose()
 				ResetPoseEntryState(EEmpathCastingPose::CannonShotStatic);
 
 				// Cache entry variables
-				CannonShotData.StaticData.GestureState.LastEntryStartTime = GetWorld()->GetRealTimeSeconds();
+				CannonShotData.StaticData.GestureState.LastEntryStartTime = GetGestureTimeSeconds();
 				RightHandActor->GestureTransformCaches[EEmpathGestureType::CannonShotStatic].LastEntryStartLocation = RightHandActor->GetKinematicVelocityComponent()->GetComponentLocation();
 				RightHandActor->GestureTransformCaches[EEmpathGestureType::CannonShotStatic].LastEntryStartRotation = RightHandActor->GetKinematicVelocityComponent()->GetComponentRotation();
 				RightHandActor->GestureTransformCaches[EEmpathGestureType::CannonShotStatic].LastEntryStartMotionAngle = RightHandActor->GestureConditionCheck.MotionAngle;
@@ -2739,11 +3032,11 @@ bool AEmpathPlayerCharacter::AttemptEnterStaticCastingPose()
 			}
 
 			// Update distance traveled
-			CannonShotData.StaticData.GestureState.GestureDistanceRight += RightHandActor->GetKinematicVelocityComponent()->GetDeltaLocation().Size();
-			CannonShotData.StaticData.GestureState.GestureDistanceLeft += LeftHandActor->GetKinematicVelocityComponent()->GetDeltaLocation().Size();
+			CannonShotData.StaticData.GestureState.GestureDistanceRight += RightHandActor->GetGestureDeltaDistance();
+			CannonShotData.StaticData.GestureState.GestureDistanceLeft += LeftHandActor->GetGestureDeltaDistance();
 
 			// Enter the static state if enough time has passed and we have trave;ed far enough
-			if (UEmpathFunctionLibrary::GetRealTimeSince(this, CannonShotData.StaticData.GestureState.LastEntryStartTime) >= CannonShotData.StaticData.MinEntryTime
+			if ((GetGestureTimeSeconds() - CannonShotData.StaticData.GestureState.LastEntryStartTime) >= CannonShotData.StaticData.MinEntryTime
 				&& CannonShotData.StaticData.GestureState.GestureDistanceRight >= CannonShotData.StaticData.MinEntryDistance
 				&& CannonShotData.StaticData.GestureState.GestureDistanceLeft >= CannonShotData.StaticData.MinEntryDistance)
 			{
@@ -2810,7 +3103,7 @@ bool AEmpathPlayerCharacter::CanCannonShot_Implementation() const
 {
 	if (bCannonShotEnabled && RightHandActor && LeftHandActor)
 	{
-		float RealTimeSecs = GetWorld()->GetRealTimeSeconds();
+		float RealTimeSecs = GetGestureTimeSeconds();
 		return (RealTimeSecs - LastCannonShotDynamicExitTimeStamp >= CannonShotCooldownAfterCannonShot
 			&& RealTimeSecs - RightHandActor->LastPunchExitTimeStamp >= CannonShotCooldownAfterPunch
 			&& RealTimeSecs - LeftHandActor->LastPunchExitTimeStamp >= CannonShotCooldownAfterPunch
@@ -2872,13 +3165,13 @@ void AEmpathPlayerCharacter::OnCastingPoseChanged(const EEmpathCastingPose OldPo
 	{
 		if (NewPose != EEmpathCastingPose::CannonShotDynamic)
 		{
-			LastCannonShotStaticcExitTimeStamp = GetWorld()->GetRealTimeSeconds();
+			LastCannonShotStaticcExitTimeStamp = GetGestureTimeSeconds();
 		}
 		break;
 	}
 	case EEmpathCastingPose::CannonShotDynamic:
 	{
-		LastCannonShotDynamicExitTimeStamp = GetWorld()->GetRealTimeSeconds();
+		LastCannonShotDynamicExitTimeStamp = GetGestureTimeSeconds();
 		break;
 	}
 	default:
@@ -2887,8 +3180,12 @@ void AEmpathPlayerCharacter::OnCastingPoseChanged(const EEmpathCastingPose OldPo
 	}
 	}
 
-	ReceiveCastingPoseChanged(OldPose, CastingPose);
-	OnCastingPoseChangedDelegate.Broadcast(OldPose, CastingPose);
+	// Replayed poses are reported through the hands' gesture states instead
+	if (!bReplayingGestures)
+	{
+		ReceiveCastingPoseChanged(OldPose, CastingPose);
+		OnCastingPoseChangedDelegate.Broadcast(OldPose, CastingPose);
+	}
 	return;
 }
 
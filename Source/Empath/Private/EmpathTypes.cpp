@@ -3,6 +3,11 @@
 #include "EmpathTypes.h"
 #include "EmpathHandActor.h"
 #include "EmpathKinematicVelocityComponent.h"
+#include "Curves/CurveFloat.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 
 const FName FEmpathBBKeys::AttackTarget(TEXT("AttackTarget"));
 const FName FEmpathBBKeys::bCanSeeTarget(TEXT("bCanSeeTarget"));
@@ -33,12 +38,729 @@ const FName FEmpathCollisionProfiles::Projectile(TEXT("Projectile"));
 const FName FEmpathCollisionProfiles::ProjectileSensor(TEXT("ProjectileSensor"));
 const FName FEmpathCollisionProfiles::EmpathTrigger(TEXT("EmpathTrigger"));
 
+static TAutoConsoleVariable<int32> CVarEmpathGestureConditionPrograms(
+	TEXT("Empath.GestureConditionPrograms"),
+	1,
+	TEXT("Whether to evaluate gesture conditions with their compiled programs rather than walking the condition trees.\n")
+	TEXT("0: Disabled, 1: Enabled"),
+	ECVF_Cheat);
+
+/** 
+* Evaluates gesture conditions with their compiled program, compiling it first if it has been reset since the conditions last changed.
+* Compiled failures are recorded without allocating, and only described right away if asked to.
+*/
+static bool AreGestureConditionsMet(FEmpathGestureCondition01& Conditions, 
+	FEmpathGestureConditionProgram& Program, 
+	const FEmpathGestureCheck& GestureConditionCheck, 
+	const FEmpathGestureCheck& FrameConditionCheck, 
+	bool bDescribeFailures,
+	FEmpathGestureConditionFailure& OutFailure,
+	FString& OutFailureReason)
+{
+	if (!CVarEmpathGestureConditionPrograms.GetValueOnGameThread())
+	{
+		OutFailure.Reset();
+		return Conditions.AreAllConditionsMet(GestureConditionCheck, FrameConditionCheck, OutFailureReason);
+	}
+
+	if (!Program.IsCompiled())
+	{
+		Program.Compile(Conditions);
+	}
+	bool const bConditionsMet = Program.Evaluate(GestureConditionCheck, FrameConditionCheck);
+
+	if (bConditionsMet)
+	{
+		OutFailure.Reset();
+	}
+	else
+	{
+		OutFailure.Record(Program, GestureConditionCheck, FrameConditionCheck);
+	}
+
+	// Describing failures builds strings, so only do it right away if we were asked to
+	if (!bConditionsMet && bDescribeFailures)
+	{
+		OutFailureReason = OutFailure.GetFailureReason();
+	}
+	else if (!OutFailureReason.IsEmpty())
+	{
+		OutFailureReason.Reset();
+	}
+	return bConditionsMet;
+}
+
 
 bool FSecondaryAttackTarget::IsValid() const
 {
 	return (TargetActor != nullptr) && !TargetActor->IsPendingKill();
 }
 
+float FEmpathCurveLUT::Bake(UCurveFloat const* Curve, int32 NumSamples)
+{
+	Samples.Reset();
+	SourceCurve = Curve;
+	bKeyedByCosine = false;
+	MaxError = 0.0f;
+	if (Curve == nullptr || NumSamples < 2)
+	{
+		return 0.0f;
+	}
+
+	Curve->GetTimeRange(MinKey, MaxKey);
+	if (MaxKey <= MinKey)
+	{
+		// Nothing to interpolate, so leave the table unbaked and use the curve directly
+		return 0.0f;
+	}
+	return BakeSamples(NumSamples);
+}
+
+float FEmpathCurveLUT::BakeByCosine(UCurveFloat const* Curve, int32 NumSamples)
+{
+	Samples.Reset();
+	SourceCurve = Curve;
+	bKeyedByCosine = true;
+	MaxError = 0.0f;
+	if (Curve == nullptr || NumSamples < 2)
+	{
+		return 0.0f;
+	}
+
+	// Cosines cover every angle, so the curve is never evaluated directly
+	MinKey = ToSampleKey(-1.0f);
+	MaxKey = ToSampleKey(1.0f);
+	return BakeSamples(NumSamples);
+}
+
+float FEmpathCurveLUT::BakeSamples(int32 NumSamples)
+{
+	InvKeyStep = (float)(NumSamples - 1) / (MaxKey - MinKey);
+	Samples.SetNumUninitialized(NumSamples);
+	for (int32 Idx = 0; Idx < NumSamples; ++Idx)
+	{
+		Samples[Idx] = EvaluateSourceCurve(FromSampleKey(MinKey + Idx / InvKeyStep));
+	}
+	MaxError = GetMaxError();
+	return MaxError;
+}
+
+namespace
+{
+	/** Identifies a shared baked curve. */
+	struct FEmpathCurveLUTCacheKey
+	{
+		TWeakObjectPtr<UCurveFloat const> Curve;
+		int32 NumSamples;
+		bool bKeyedByCosine;
+
+		bool operator==(FEmpathCurveLUTCacheKey const& Other) const
+		{
+			return Curve == Other.Curve && NumSamples == Other.NumSamples && bKeyedByCosine == Other.bKeyedByCosine;
+		}
+
+		friend uint32 GetTypeHash(FEmpathCurveLUTCacheKey const& Key)
+		{
+			return HashCombine(GetTypeHash(Key.Curve), HashCombine(GetTypeHash(Key.NumSamples), GetTypeHash(Key.bKeyedByCosine)));
+		}
+	};
+}
+
+TSharedPtr<FEmpathCurveLUT const> FEmpathCurveLUT::FindOrBake(UCurveFloat const* Curve, int32 NumSamples, bool bInKeyedByCosine)
+{
+	check(IsInGameThread());
+	if (Curve == nullptr)
+	{
+		return nullptr;
+	}
+
+	// Tables are only kept alive by their users, so a curve is rebaked once everyone using it has gone
+	static TMap<FEmpathCurveLUTCacheKey, TWeakPtr<FEmpathCurveLUT const>> SharedTables;
+
+	FEmpathCurveLUTCacheKey Key;
+	Key.Curve = Curve;
+	Key.NumSamples = NumSamples;
+	Key.bKeyedByCosine = bInKeyedByCosine;
+	if (TWeakPtr<FEmpathCurveLUT const> const* const ExistingTable = SharedTables.Find(Key))
+	{
+		TSharedPtr<FEmpathCurveLUT const> const PinnedTable = ExistingTable->Pin();
+		if (PinnedTable.IsValid())
+		{
+			return PinnedTable;
+		}
+	}
+
+	// Drop any tables nobody is using any more before adding ours
+	for (auto It = SharedTables.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().IsValid() || !It.Key().Curve.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	TSharedRef<FEmpathCurveLUT> const NewTable = MakeShared<FEmpathCurveLUT>();
+	if (bInKeyedByCosine)
+	{
+		NewTable->BakeByCosine(Curve, NumSamples);
+	}
+	else
+	{
+		NewTable->Bake(Curve, NumSamples);
+	}
+	SharedTables.Add(Key, NewTable);
+	return NewTable;
+}
+
+float FEmpathCurveLUT::ToSampleKey(float Key) const
+{
+	if (!bKeyedByCosine)
+	{
+		return Key;
+	}
+
+	// Near +-1, one minus the cosine grows with the square of the angle, so its square root is close to linear in the angle.
+	// This keeps the spacing between samples at about the same angle everywhere, rather than several degrees wide near 0 and 180.
+	float const Cos = FMath::Clamp(Key, -1.0f, 1.0f);
+	return (Cos >= 0.0f) ? (1.0f - FMath::Sqrt(1.0f - Cos)) : (FMath::Sqrt(1.0f + Cos) - 1.0f);
+}
+
+float FEmpathCurveLUT::FromSampleKey(float SampleKey) const
+{
+	if (!bKeyedByCosine)
+	{
+		return SampleKey;
+	}
+	return (SampleKey >= 0.0f) ? (1.0f - FMath::Square(1.0f - SampleKey)) : (FMath::Square(SampleKey + 1.0f) - 1.0f);
+}
+
+float FEmpathCurveLUT::Evaluate(float Key) const
+{
+	// Cosines are only outside the range due to rounding, which converting to a sample key clamps
+	if (bKeyedByCosine)
+	{
+		return EvaluateSampleKey(ToSampleKey(Key));
+	}
+
+	// Let the curve handle its own extrapolation
+	if (Key < MinKey || Key > MaxKey)
+	{
+		return EvaluateSourceCurve(Key);
+	}
+	return EvaluateSampleKey(Key);
+}
+
+float FEmpathCurveLUT::EvaluateSampleKey(float SampleKey) const
+{
+	float const SamplePos = (SampleKey - MinKey) * InvKeyStep;
+	int32 const LowIdx = FMath::Clamp(FMath::FloorToInt(SamplePos), 0, Samples.Num() - 2);
+	return FMath::Lerp(Samples[LowIdx], Samples[LowIdx + 1], SamplePos - LowIdx);
+}
+
+float FEmpathCurveLUT::EvaluateSourceCurve(float Key) const
+{
+	if (SourceCurve == nullptr)
+	{
+		return 0.0f;
+	}
+	return SourceCurve->GetFloatValue(bKeyedByCosine ? FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(Key, -1.0f, 1.0f))) : Key);
+}
+
+float FEmpathCurveLUT::GetMaxError() const
+{
+	float Error = 0.0f;
+	for (int32 Idx = 0; Idx < Samples.Num() - 1; ++Idx)
+	{
+		float const SampleKey = MinKey + (Idx + 0.5f) / InvKeyStep;
+		Error = FMath::Max(Error, FMath::Abs(EvaluateSampleKey(SampleKey) - EvaluateSourceCurve(FromSampleKey(SampleKey))));
+	}
+	return Error;
+}
+
+bool FEmpathVisionCone::IsInVisionCone(FVector const& EyesLocation, FVector const& TargetLocation) const
+{
+	FVector const ToTarget = TargetLocation - EyesLocation;
+	float const ToTargetDist = ToTarget.Size();
+
+	// Targets within the auto see range are always seen
+	if (ToTargetDist <= AutoSeeDistance)
+	{
+		return true;
+	}
+
+	// Otherwise, check the angle against the limit for this distance
+	float const AngleCos = FVector::DotProduct(ToTarget.GetSafeNormal(), EyesForward);
+	float const CosLimit = ((ToTargetDist <= PeripheralVisionDistance) ? PeripheralVisionCos : ForwardVisionCos);
+	return (AngleCos >= CosLimit);
+}
+
+void FEmpathVisionConeSnapshot::Reset()
+{
+	EyesX.Reset();
+	EyesY.Reset();
+	EyesZ.Reset();
+	ForwardX.Reset();
+	ForwardY.Reset();
+	ForwardZ.Reset();
+	TargetX.Reset();
+	TargetY.Reset();
+	TargetZ.Reset();
+	AutoSeeDistanceSq.Reset();
+	PeripheralVisionDistanceSq.Reset();
+	PeripheralVisionCos.Reset();
+	ForwardVisionCos.Reset();
+}
+
+int32 FEmpathVisionConeSnapshot::Add(FVector const& EyesLocation, FVector const& TargetLocation, FEmpathVisionCone const& VisionCone)
+{
+	EyesX.Add(EyesLocation.X);
+	EyesY.Add(EyesLocation.Y);
+	EyesZ.Add(EyesLocation.Z);
+	ForwardX.Add(VisionCone.EyesForward.X);
+	ForwardY.Add(VisionCone.EyesForward.Y);
+	ForwardZ.Add(VisionCone.EyesForward.Z);
+	TargetX.Add(TargetLocation.X);
+	TargetY.Add(TargetLocation.Y);
+	TargetZ.Add(TargetLocation.Z);
+
+	// Negative ranges never pass, so keep them negative rather than squaring them
+	AutoSeeDistanceSq.Add(VisionCone.AutoSeeDistance >= 0.0f ? FMath::Square(VisionCone.AutoSeeDistance) : -1.0f);
+	PeripheralVisionDistanceSq.Add(VisionCone.PeripheralVisionDistance >= 0.0f ? FMath::Square(VisionCone.PeripheralVisionDistance) : -1.0f);
+	PeripheralVisionCos.Add(VisionCone.PeripheralVisionCos);
+	return ForwardVisionCos.Add(VisionCone.ForwardVisionCos);
+}
+
+void FEmpathVisionConeSnapshot::ComputeVisionCones(TArray<bool>& OutInVisionCone) const
+{
+	int32 const NumCones = Num();
+	OutInVisionCone.SetNumUninitialized(NumCones);
+
+	// Same test as FEmpathVisionCone::IsInVisionCone, but without normalizing:
+	// Dot(ToTarget, Forward) >= CosLimit * Dist is equivalent to comparing the cosine of the angle.
+	int32 const NumVectorized = NumCones & ~3;
+	for (int32 Idx = 0; Idx < NumVectorized; Idx += 4)
+	{
+		VectorRegister const ToTargetX = VectorSubtract(VectorLoad(&TargetX[Idx]), VectorLoad(&EyesX[Idx]));
+		VectorRegister const ToTargetY = VectorSubtract(VectorLoad(&TargetY[Idx]), VectorLoad(&EyesY[Idx]));
+		VectorRegister const ToTargetZ = VectorSubtract(VectorLoad(&TargetZ[Idx]), VectorLoad(&EyesZ[Idx]));
+
+		VectorRegister DistSq = VectorMultiply(ToTargetX, ToTargetX);
+		DistSq = VectorMultiplyAdd(ToTargetY, ToTargetY, DistSq);
+		DistSq = VectorMultiplyAdd(ToTargetZ, ToTargetZ, DistSq);
+
+		VectorRegister Dot = VectorMultiply(ToTargetX, VectorLoad(&ForwardX[Idx]));
+		Dot = VectorMultiplyAdd(ToTargetY, VectorLoad(&ForwardY[Idx]), Dot);
+		Dot = VectorMultiplyAdd(ToTargetZ, VectorLoad(&ForwardZ[Idx]), Dot);
+
+		// Auto see anything close enough
+		VectorRegister const AutoSeeMask = VectorCompareGE(VectorLoad(&AutoSeeDistanceSq[Idx]), DistSq);
+
+		// Otherwise test against the peripheral or forward limit depending on distance. 
+		// A zero distance gives a NaN here, but is always caught by the auto see test above unless the auto see range is negative.
+		VectorRegister const PeripheralMask = VectorCompareGE(VectorLoad(&PeripheralVisionDistanceSq[Idx]), DistSq);
+		VectorRegister const CosLimit = VectorSelect(PeripheralMask, VectorLoad(&PeripheralVisionCos[Idx]), VectorLoad(&ForwardVisionCos[Idx]));
+		VectorRegister const Dist = VectorMultiply(DistSq, VectorReciprocalSqrtAccurate(DistSq));
+		VectorRegister const ConeMask = VectorCompareGE(Dot, VectorMultiply(CosLimit, Dist));
+
+		int32 const ResultBits = VectorMaskBits(VectorBitwiseOr(AutoSeeMask, ConeMask));
+		OutInVisionCone[Idx] = (ResultBits & 1) != 0;
+		OutInVisionCone[Idx + 1] = (ResultBits & 2) != 0;
+		OutInVisionCone[Idx + 2] = (ResultBits & 4) != 0;
+		OutInVisionCone[Idx + 3] = (ResultBits & 8) != 0;
+	}
+
+	// Finish off any remainder with the scalar test
+	for (int32 Idx = NumVectorized; Idx < NumCones; ++Idx)
+	{
+		FEmpathVisionCone const VisionCone(FVector(ForwardX[Idx], ForwardY[Idx], ForwardZ[Idx]),
+			AutoSeeDistanceSq[Idx] >= 0.0f ? FMath::Sqrt(AutoSeeDistanceSq[Idx]) : -1.0f,
+			PeripheralVisionDistanceSq[Idx] >= 0.0f ? FMath::Sqrt(PeripheralVisionDistanceSq[Idx]) : -1.0f,
+			PeripheralVisionCos[Idx],
+			ForwardVisionCos[Idx]);
+		OutInVisionCone[Idx] = VisionCone.IsInVisionCone(FVector(EyesX[Idx], EyesY[Idx], EyesZ[Idx]), FVector(TargetX[Idx], TargetY[Idx], TargetZ[Idx]));
+	}
+}
+
+void FEmpathVelocityHistory::Init(int32 Capacity)
+{
+	Capacity = FMath::Max(Capacity, 1);
+	if (Frames.Num() != Capacity)
+	{
+		Frames.Empty(Capacity);
+		Frames.SetNum(Capacity);
+	}
+	Reset();
+}
+
+void FEmpathVelocityHistory::Reset()
+{
+	Head = 0;
+	Count = 0;
+	Totals = FEmpathVelocityFrame();
+	PushesSinceResum = 0;
+}
+
+void FEmpathVelocityHistory::Push(FEmpathVelocityFrame const& Frame)
+{
+	if (Frames.Num() == 0)
+	{
+		Init(1);
+	}
+
+	if (Count == Frames.Num())
+	{
+		PopOldest();
+	}
+
+	int32 Tail = Head + Count;
+	if (Tail >= Frames.Num())
+	{
+		Tail -= Frames.Num();
+	}
+	Frames[Tail] = Frame;
+	++Count;
+	AddToTotals(Frame, 1.0f);
+
+	// Adding and removing floats slowly accumulates error, so start the totals afresh every so often.
+	// Once every capacity's worth of frames keeps this constant time on average.
+	++PushesSinceResum;
+	if (PushesSinceResum >= Frames.Num())
+	{
+		Resum();
+	}
+}
+
+void FEmpathVelocityHistory::RemoveExpired(float CurrentTime, float SampleTime)
+{
+	while (Count > 0 && (CurrentTime - Frames[Head].FrameTimeStamp) > SampleTime)
+	{
+		PopOldest();
+	}
+}
+
+void FEmpathVelocityHistory::PopOldest()
+{
+	AddToTotals(Frames[Head], -1.0f);
+	++Head;
+	if (Head >= Frames.Num())
+	{
+		Head = 0;
+	}
+	--Count;
+
+	// Nothing left, so the totals are exactly zero
+	if (Count == 0)
+	{
+		Reset();
+	}
+}
+
+FEmpathVelocityFrame FEmpathVelocityHistory::GetAverage() const
+{
+	if (Count == 0)
+	{
+		return FEmpathVelocityFrame();
+	}
+
+	float const CountDivisor = (float)Count;
+	return FEmpathVelocityFrame(Totals.Velocity / CountDivisor,
+		Totals.AngularVelocity / CountDivisor,
+		Totals.KAcceleration / CountDivisor,
+		Totals.SphericalVelocity / CountDivisor,
+		Totals.RadialVelocity / CountDivisor,
+		Totals.VerticalVelocity / CountDivisor,
+		Totals.SphericalAccel / CountDivisor,
+		Totals.RadialAccel / CountDivisor,
+		Totals.VerticalAccel / CountDivisor);
+}
+
+FEmpathVelocityFrame FEmpathVelocityHistory::GetAverageBruteForce() const
+{
+	if (Count == 0)
+	{
+		return FEmpathVelocityFrame();
+	}
+
+	FVector TotalVelocity = FVector::ZeroVector;
+	FVector TotalAngularVelocity = FVector::ZeroVector;
+	FVector TotalAcceleration = FVector::ZeroVector;
+	float TotalSphericalVelcity = 0.0f;
+	float TotalRadialVelocity = 0.0f;
+	float TotalVerticalVelocity = 0.0f;
+	float TotalSphericalAccel = 0.0f;
+	float TotalRadialAccel = 0.0f;
+	float TotalVerticalAccel = 0.0f;
+	for (int32 Offset = 0; Offset < Count; ++Offset)
+	{
+		FEmpathVelocityFrame const& VF = Frames[(Head + Offset) % Frames.Num()];
+		TotalVelocity += VF.Velocity;
+		TotalAngularVelocity += VF.AngularVelocity;
+		TotalAcceleration += VF.KAcceleration;
+		TotalSphericalVelcity += VF.SphericalVelocity;
+		TotalRadialVelocity += VF.RadialVelocity;
+		TotalVerticalVelocity += VF.VerticalVelocity;
+		TotalSphericalAccel += VF.SphericalAccel;
+		TotalRadialAccel += VF.RadialAccel;
+		TotalVerticalAccel += VF.VerticalAccel;
+	}
+
+	float const CountDivisor = (float)Count;
+	return FEmpathVelocityFrame(TotalVelocity / CountDivisor,
+		TotalAngularVelocity / CountDivisor,
+		TotalAcceleration / CountDivisor,
+		TotalSphericalVelcity / CountDivisor,
+		TotalRadialVelocity / CountDivisor,
+		TotalVerticalVelocity / CountDivisor,
+		TotalSphericalAccel / CountDivisor,
+		TotalRadialAccel / CountDivisor,
+		TotalVerticalAccel / CountDivisor);
+}
+
+void FEmpathVelocityHistory::Resum()
+{
+	Totals = FEmpathVelocityFrame();
+	for (int32 Offset = 0; Offset < Count; ++Offset)
+	{
+		AddToTotals(Frames[(Head + Offset) % Frames.Num()], 1.0f);
+	}
+	PushesSinceResum = 0;
+}
+
+void FEmpathVelocityHistory::AddToTotals(FEmpathVelocityFrame const& Frame, float Sign)
+{
+	Totals.Velocity += Frame.Velocity * Sign;
+	Totals.AngularVelocity += Frame.AngularVelocity * Sign;
+	Totals.KAcceleration += Frame.KAcceleration * Sign;
+	Totals.SphericalVelocity += Frame.SphericalVelocity * Sign;
+	Totals.RadialVelocity += Frame.RadialVelocity * Sign;
+	Totals.VerticalVelocity += Frame.VerticalVelocity * Sign;
+	Totals.SphericalAccel += Frame.SphericalAccel * Sign;
+	Totals.RadialAccel += Frame.RadialAccel * Sign;
+	Totals.VerticalAccel += Frame.VerticalAccel * Sign;
+}
+
+void FEmpathKinematicSamples::Reset()
+{
+	FMemory::Memzero(Values);
+	FMemory::Memzero(LastLocation);
+	FMemory::Memzero(DeltaLocation);
+	FMemory::Memzero(LastDists);
+	FMemory::Memzero(DeltaDists);
+	LastSphericalLocation = FVector::ZeroVector;
+	LastRotation = FQuat::Identity;
+	DeltaRotation = FQuat::Identity;
+}
+
+void FEmpathKinematicSamples::ArchiveSamples(FEmpathKinematicSamples* const* Samples, int32 NumSamples)
+{
+	for (int32 Idx = 0; Idx < NumSamples; ++Idx)
+	{
+		FEmpathKinematicSamples& Block = *Samples[Idx];
+		FMemory::Memcpy(Block.Values[EmpathKinematicSample::Last], Block.Values[EmpathKinematicSample::Kinematic], sizeof(Block.Values[EmpathKinematicSample::Kinematic]));
+		FMemory::Memcpy(Block.Values[EmpathKinematicSample::LastFrame], Block.Values[EmpathKinematicSample::Frame], sizeof(Block.Values[EmpathKinematicSample::Frame]));
+	}
+}
+
+void FEmpathKinematicSamples::UpdateFrameSamples(FEmpathKinematicSamples* const* Samples, FEmpathKinematicSampleInput const* Inputs, int32 NumSamples, float DeltaSeconds)
+{
+	VectorRegister const InvDeltaSeconds = VectorSetFloat1(1.0f / DeltaSeconds);
+	for (int32 Idx = 0; Idx < NumSamples; ++Idx)
+	{
+		FEmpathKinematicSamples& Block = *Samples[Idx];
+		FEmpathKinematicSampleInput const& Input = Inputs[Idx];
+
+		// Velocity from the change in location, and acceleration from the change in velocity.
+		// The fourth lane stays zero throughout.
+		VectorRegister const Location = MakeVectorRegister(Input.Location.X, Input.Location.Y, Input.Location.Z, 0.0f);
+		VectorRegister const DeltaLocation = VectorSubtract(Location, VectorLoad(Block.LastLocation));
+		VectorRegister const FrameVelocity = VectorMultiply(DeltaLocation, InvDeltaSeconds);
+		VectorRegister const LastFrameVelocity = VectorLoad(Block.Values[EmpathKinematicSample::LastFrame][EmpathKinematicChannel::Velocity]);
+		VectorRegister const FrameAcceleration = VectorMultiply(VectorSubtract(FrameVelocity, LastFrameVelocity), InvDeltaSeconds);
+		VectorStore(DeltaLocation, Block.DeltaLocation);
+		VectorStore(FrameVelocity, Block.Values[EmpathKinematicSample::Frame][EmpathKinematicChannel::Velocity]);
+		VectorStore(FrameAcceleration, Block.Values[EmpathKinematicSample::Frame][EmpathKinematicChannel::Acceleration]);
+		VectorStore(Location, Block.LastLocation);
+
+		// Spherical, radial, and vertical distances share a register, so their derivatives are calculated together
+		if (Input.bHasOwningPlayer)
+		{
+			FVector const& SphericalLocation = Input.SphericalLocation;
+			VectorRegister const Dists = MakeVectorRegister(SphericalLocation.Size(), SphericalLocation.Size2D(), FMath::Abs(SphericalLocation.Z), 0.0f);
+			VectorRegister const DeltaDists = VectorSubtract(Dists, VectorLoad(Block.LastDists));
+			VectorRegister const FrameDistVelocity = VectorMultiply(DeltaDists, InvDeltaSeconds);
+			VectorRegister const LastFrameDistVelocity = VectorLoad(Block.Values[EmpathKinematicSample::LastFrame][EmpathKinematicChannel::DistVelocity]);
+			VectorRegister const FrameDistAccel = VectorMultiply(VectorSubtract(FrameDistVelocity, LastFrameDistVelocity), InvDeltaSeconds);
+			VectorStore(DeltaDists, Block.DeltaDists);
+			VectorStore(FrameDistVelocity, Block.Values[EmpathKinematicSample::Frame][EmpathKinematicChannel::DistVelocity]);
+			VectorStore(FrameDistAccel, Block.Values[EmpathKinematicSample::Frame][EmpathKinematicChannel::DistAccel]);
+			VectorStore(Dists, Block.LastDists);
+			Block.LastSphericalLocation = SphericalLocation;
+		}
+	}
+}
+
+void FEmpathKinematicSamples::UpdateAveragedSamples(FTransform const& ComponentTransform, FEmpathVelocityHistory& VelocityHistory, float SampleTime, float CurrentTime, float DeltaSeconds)
+{
+	// Next get the current angular velocity by the delta rotation
+	FQuat CurrentRotation = ComponentTransform.GetRotation();
+	CurrentRotation.Normalize();
+	DeltaRotation = CurrentRotation.Inverse() * LastRotation;
+	FVector Axis;
+	float Angle;
+	DeltaRotation.ToAxisAndAngle(Axis, Angle);
+
+	// Convert to degrees since those will be used more often
+	FVector FrameAngularVelocity = FVector::RadiansToDegrees(CurrentRotation.RotateVector((Axis * Angle) / DeltaSeconds));
+
+	// Fix angular velocity weirdness at particular angles.
+	// At certain, rare angles close to the 'poles' of the object, the rotate vector function produces wildly inaccurate results.
+	// To correct for this behavior, we assume that the angular velocity has continued along its current trajectory in such cases.
+	FVector const LastFrameAngularVelocity = GetVector(EmpathKinematicSample::LastFrame, EmpathKinematicChannel::AngularVelocity);
+	if ((FMath::Abs(LastFrameAngularVelocity.X - FrameAngularVelocity.X) > 500.0f
+		&& FMath::Abs(FrameAngularVelocity.X) > 500.0f)
+		|| (FMath::Abs(LastFrameAngularVelocity.Y - FrameAngularVelocity.Y) > 500.0f
+			&& FMath::Abs(FrameAngularVelocity.Y) > 500.0f)
+		|| (FMath::Abs(LastFrameAngularVelocity.Z - FrameAngularVelocity.Z) > 500.0f
+			&& FMath::Abs(FrameAngularVelocity.Z) > 500.0f))
+	{
+		// 'Unfix' the world acceleration from the last frame so we can apply it to the frame angular velocity
+		FVector LastAngularAccel = GetVector(EmpathKinematicSample::Last, EmpathKinematicChannel::AngularAccelWorld);
+		LastAngularAccel.Z *= -1.0f;
+		FrameAngularVelocity = LastFrameAngularVelocity + (DeltaSeconds * LastAngularAccel);
+	}
+	SetVector(EmpathKinematicSample::Frame, EmpathKinematicChannel::AngularVelocity, FrameAngularVelocity);
+
+	// Next get the velocity over the sample time if appropriate.
+	FVector const FrameVelocity = GetVector(EmpathKinematicSample::Frame, EmpathKinematicChannel::Velocity);
+	FVector const FrameAcceleration = GetVector(EmpathKinematicSample::Frame, EmpathKinematicChannel::Acceleration);
+	float const* FrameDistVelocity = Values[EmpathKinematicSample::Frame][EmpathKinematicChannel::DistVelocity];
+	float const* FrameDistAccel = Values[EmpathKinematicSample::Frame][EmpathKinematicChannel::DistAccel];
+	FVector KinematicAngularVelocity;
+	if (SampleTime > 0.0f)
+	{
+		// Log the velocity and the timestamp
+		VelocityHistory.Push(FEmpathVelocityFrame(FrameVelocity, FrameAngularVelocity, FrameAcceleration, 
+			FrameDistVelocity[EmpathKinematicChannel::Spherical], FrameDistVelocity[EmpathKinematicChannel::Radial], FrameDistVelocity[EmpathKinematicChannel::Vertical], 
+			FrameDistAccel[EmpathKinematicChannel::Spherical], FrameDistAccel[EmpathKinematicChannel::Radial], FrameDistAccel[EmpathKinematicChannel::Vertical], 
+			CurrentTime));
+
+		// Remove expired frames. The remaining history is now guaranteed to be inside the time threshold,
+		// and its running totals give us the averages without summing every frame again.
+		VelocityHistory.RemoveExpired(CurrentTime, SampleTime);
+		FEmpathVelocityFrame const Average = VelocityHistory.GetAverage();
+		KinematicAngularVelocity = Average.AngularVelocity;
+		SetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::Velocity, Average.Velocity);
+		SetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::Acceleration, Average.KAcceleration);
+		SetDists(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::DistVelocity, Average.SphericalVelocity, Average.RadialVelocity, Average.VerticalVelocity);
+		SetDists(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::DistAccel, Average.SphericalAccel, Average.RadialAccel, Average.VerticalAccel);
+	}
+
+	// If our sample time is <= 0 we just use the frame velocity.
+	else
+	{
+		KinematicAngularVelocity = FrameAngularVelocity;
+		FMemory::Memcpy(Values[EmpathKinematicSample::Kinematic], Values[EmpathKinematicSample::Frame], sizeof(Values[EmpathKinematicSample::Frame]));
+	}
+	SetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::AngularVelocity, KinematicAngularVelocity);
+
+	// Fix angular velocities to account for Z inversion in UE4
+	// Curr ang velocity
+	FVector AngVelFixedWorld = KinematicAngularVelocity;
+	AngVelFixedWorld.Z *= -1.0f;
+	FVector AngVelFixedLocal = ComponentTransform.InverseTransformVectorNoScale(KinematicAngularVelocity);
+	AngVelFixedLocal.Z *= -1.0f;
+	SetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::AngVelFixedWorld, AngVelFixedWorld);
+	SetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::AngVelFixedLocal, AngVelFixedLocal);
+
+	// Curr frame ang velocity
+	FVector FrameAngVelFixedWorld = FrameAngularVelocity;
+	FrameAngVelFixedWorld.Z *= -1.0f;
+	FVector FrameAngVelFixedLocal = ComponentTransform.InverseTransformVectorNoScale(FrameAngularVelocity);
+	FrameAngVelFixedLocal.Z *= -1.0f;
+	SetVector(EmpathKinematicSample::Frame, EmpathKinematicChannel::AngVelFixedWorld, FrameAngVelFixedWorld);
+	SetVector(EmpathKinematicSample::Frame, EmpathKinematicChannel::AngVelFixedLocal, FrameAngVelFixedLocal);
+
+	// Log our current rotation for the next time we check our velocity.
+	LastRotation = CurrentRotation;
+}
+
+void FEmpathKinematicSamples::UpdateAngularAccelerations(FEmpathKinematicSamples* const* Samples, int32 NumSamples, float DeltaSeconds)
+{
+	VectorRegister const InvDeltaSeconds = VectorSetFloat1(1.0f / DeltaSeconds);
+	for (int32 Idx = 0; Idx < NumSamples; ++Idx)
+	{
+		FEmpathKinematicSamples& Block = *Samples[Idx];
+		float const (*Current)[4] = Block.Values[EmpathKinematicSample::Kinematic];
+		float const (*Last)[4] = Block.Values[EmpathKinematicSample::Last];
+		float const (*CurrentFrame)[4] = Block.Values[EmpathKinematicSample::Frame];
+		float const (*LastFrame)[4] = Block.Values[EmpathKinematicSample::LastFrame];
+
+		VectorStore(VectorMultiply(VectorSubtract(VectorLoad(Current[EmpathKinematicChannel::AngVelFixedWorld]), VectorLoad(Last[EmpathKinematicChannel::AngVelFixedWorld])), InvDeltaSeconds),
+			Block.Values[EmpathKinematicSample::Kinematic][EmpathKinematicChannel::AngularAccelWorld]);
+		VectorStore(VectorMultiply(VectorSubtract(VectorLoad(Current[EmpathKinematicChannel::AngVelFixedLocal]), VectorLoad(Last[EmpathKinematicChannel::AngVelFixedLocal])), InvDeltaSeconds),
+			Block.Values[EmpathKinematicSample::Kinematic][EmpathKinematicChannel::AngularAccelLocal]);
+		VectorStore(VectorMultiply(VectorSubtract(VectorLoad(CurrentFrame[EmpathKinematicChannel::AngVelFixedWorld]), VectorLoad(LastFrame[EmpathKinematicChannel::AngVelFixedWorld])), InvDeltaSeconds),
+			Block.Values[EmpathKinematicSample::Frame][EmpathKinematicChannel::AngularAccelWorld]);
+		VectorStore(VectorMultiply(VectorSubtract(VectorLoad(CurrentFrame[EmpathKinematicChannel::AngVelFixedLocal]), VectorLoad(LastFrame[EmpathKinematicChannel::AngVelFixedLocal])), InvDeltaSeconds),
+			Block.Values[EmpathKinematicSample::Frame][EmpathKinematicChannel::AngularAccelLocal]);
+	}
+}
+
+double FEmpathKinematicSamples::BenchmarkFrameUpdate(int32 NumIterations)
+{
+	NumIterations = FMath::Max(NumIterations, 1);
+	int32 const NumHands = 2;
+	float const DeltaSeconds = 1.0f / 90.0f;
+	float const SampleTime = 0.1f;
+
+	// Generate the input up front so that only the update is timed.
+	// The hands circle in front of the center of mass and twist as they go, so the values stay in a realistic range.
+	TArray<FEmpathKinematicSampleInput> Inputs;
+	TArray<FTransform> Transforms;
+	Inputs.Reserve(NumIterations * NumHands);
+	Transforms.Reserve(NumIterations * NumHands);
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		float Sin, Cos;
+		FMath::SinCos(&Sin, &Cos, Iteration * DeltaSeconds * 2.0f * PI);
+		FVector const Offset(40.0f * Cos, 40.0f * Sin, 20.0f * Sin);
+		FRotator const Twist(30.0f * Sin, 45.0f * Cos, 60.0f * Sin);
+		Inputs.Add(FEmpathKinematicSampleInput(FVector(30.0f, 20.0f, 120.0f) + Offset, FVector(40.0f, 20.0f, 30.0f) + Offset, true));
+		Inputs.Add(FEmpathKinematicSampleInput(FVector(30.0f, -20.0f, 120.0f) - Offset, FVector(40.0f, -20.0f, 30.0f) - Offset, true));
+		Transforms.Add(FTransform(Twist, FVector(30.0f, 20.0f, 120.0f) + Offset));
+		Transforms.Add(FTransform(Twist.GetInverse(), FVector(30.0f, -20.0f, 120.0f) - Offset));
+	}
+
+	// Sized the way the kinematic velocity component sizes it, at the highest frame rate we expect
+	FEmpathKinematicSamples Hands[NumHands];
+	FEmpathKinematicSamples* HandSamples[NumHands] = { &Hands[0], &Hands[1] };
+	FEmpathVelocityHistory Histories[NumHands];
+	for (FEmpathVelocityHistory& History : Histories)
+	{
+		History.Init(FMath::CeilToInt(SampleTime * 144.0f) + 2);
+	}
+
+	double const StartTime = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		ArchiveSamples(HandSamples, NumHands);
+		UpdateFrameSamples(HandSamples, &Inputs[Iteration * NumHands], NumHands, DeltaSeconds);
+		for (int32 HandIdx = 0; HandIdx < NumHands; ++HandIdx)
+		{
+			Hands[HandIdx].UpdateAveragedSamples(Transforms[Iteration * NumHands + HandIdx], Histories[HandIdx], SampleTime, Iteration * DeltaSeconds, DeltaSeconds);
+		}
+		UpdateAngularAccelerations(HandSamples, NumHands, DeltaSeconds);
+	}
+	double const ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+
+	// Read the result back so the updates can't be optimized away
+	volatile float Result = Hands[0].Values[EmpathKinematicSample::Kinematic][EmpathKinematicChannel::AngularAccelLocal][0] 
+		+ Hands[1].Values[EmpathKinematicSample::Kinematic][EmpathKinematicChannel::DistAccel][0];
+	(void)Result;
+
+	return (ElapsedSeconds * 1.0e9) / (double)(NumIterations * NumHands);
+}
+
 bool FEmpathPlayerAttackTarget::IsValid() const
 {
 	return (TargetActor != nullptr) && !TargetActor->IsPendingKill();
@@ -47,13 +769,13 @@ bool FEmpathPlayerAttackTarget::IsValid() const
 
 const bool FEmpathOneHandGestureData::AreEntryConditionsMet(const FEmpathGestureCheck& GestureConditionCheck, const FEmpathGestureCheck& FrameConditionCheck)
 {
-	return (EntryConditions.AreAllConditionsMet(GestureConditionCheck, FrameConditionCheck, LastEntryFailureReason));
+	return AreGestureConditionsMet(EntryConditions, EntryProgram, GestureConditionCheck, FrameConditionCheck, bDescribeFailures, EntryFailure, LastEntryFailureReason);
 }
 
 
 const bool FEmpathOneHandGestureData::AreSustainConditionsMet(const FEmpathGestureCheck& GestureConditionCheck, const FEmpathGestureCheck& FrameConditionCheck)
 {
-	return (SustainConditions.AreAllConditionsMet(GestureConditionCheck, FrameConditionCheck, LastSustainFailureReason));
+	return AreGestureConditionsMet(SustainConditions, SustainProgram, GestureConditionCheck, FrameConditionCheck, bDescribeFailures, SustainFailure, LastSustainFailureReason);
 }
 
 void FEmpathOneHandGestureData::InvertHand()
@@ -62,10 +784,30 @@ void FEmpathOneHandGestureData::InvertHand()
 	EntryConditions.InvertSubConditions();
 	SustainConditions.InvertHand();
 	SustainConditions.InvertSubConditions();
+	EntryProgram.Reset();
+	SustainProgram.Reset();
 
 	return;
 }
 
+void FEmpathOneHandGestureData::CompileConditions()
+{
+	EntryProgram.Compile(EntryConditions);
+	SustainProgram.Compile(SustainConditions);
+	EntryFailure.Reset();
+	SustainFailure.Reset();
+}
+
+FString FEmpathOneHandGestureData::GetEntryFailureReason()
+{
+	return (EntryFailure.HasFailed() ? EntryFailure.GetFailureReason() : LastEntryFailureReason);
+}
+
+FString FEmpathOneHandGestureData::GetSustainFailureReason()
+{
+	return (SustainFailure.HasFailed() ? SustainFailure.GetFailureReason() : LastSustainFailureReason);
+}
+
 const bool FEmpathGestureCondition::EvaluateBinary(float Value, FString& OutFailureMessage)
 {
 
@@ -946,14 +1688,14 @@ void FEmpathGestureCondition::InvertHand()
 
 const bool FEmpathTwoHandGestureData::AreEntryConditionsMet(FEmpathGestureCheck& RightHandGestureCheck, FEmpathGestureCheck& RightHandFrameGestureCheck, FEmpathGestureCheck& LeftHandGestureCheck, FEmpathGestureCheck& LeftHandFrameGestureCheck)
 {
-	return (RightHandEntryConditions.AreAllConditionsMet(RightHandGestureCheck, RightHandFrameGestureCheck, LastRightHandEntryFailureReason)
-		&& LeftHandEntryConditions.AreAllConditionsMet(LeftHandGestureCheck, LeftHandFrameGestureCheck, LastLeftHandEntryFailureReason));
+	return (AreGestureConditionsMet(RightHandEntryConditions, RightHandEntryProgram, RightHandGestureCheck, RightHandFrameGestureCheck, bDescribeFailures, RightHandEntryFailure, LastRightHandEntryFailureReason)
+		&& AreGestureConditionsMet(LeftHandEntryConditions, LeftHandEntryProgram, LeftHandGestureCheck, LeftHandFrameGestureCheck, bDescribeFailures, LeftHandEntryFailure, LastLeftHandEntryFailureReason));
 }
 
 const bool FEmpathTwoHandGestureData::AreSustainConditionsMet(FEmpathGestureCheck& RightHandGestureCheck, FEmpathGestureCheck& RightHandFrameGestureCheck, FEmpathGestureCheck& LeftHandGestureCheck, FEmpathGestureCheck& LeftHandFrameGestureCheck)
 {
-	return (RightHandSustainConditions.AreAllConditionsMet(RightHandGestureCheck, RightHandFrameGestureCheck, LastRightHandSustainFailureReason)
-		&& LeftHandSustainConditions.AreAllConditionsMet(LeftHandGestureCheck, LeftHandFrameGestureCheck, LastLeftHandSustainFailureReason));
+	return (AreGestureConditionsMet(RightHandSustainConditions, RightHandSustainProgram, RightHandGestureCheck, RightHandFrameGestureCheck, bDescribeFailures, RightHandSustainFailure, LastRightHandSustainFailureReason)
+		&& AreGestureConditionsMet(LeftHandSustainConditions, LeftHandSustainProgram, LeftHandGestureCheck, LeftHandFrameGestureCheck, bDescribeFailures, LeftHandSustainFailure, LastLeftHandSustainFailureReason));
 }
 
 void FEmpathTwoHandGestureData::CalculateLeftHandConditions()
@@ -964,6 +1706,33 @@ void FEmpathTwoHandGestureData::CalculateLeftHandConditions()
 	LeftHandSustainConditions = RightHandSustainConditions;
 	LeftHandSustainConditions.InvertHand();
 	LeftHandSustainConditions.InvertSubConditions();
+
+	RightHandEntryProgram.Compile(RightHandEntryConditions);
+	LeftHandEntryProgram.Compile(LeftHandEntryConditions);
+	RightHandSustainProgram.Compile(RightHandSustainConditions);
+	LeftHandSustainProgram.Compile(LeftHandSustainConditions);
+	RightHandEntryFailure.Reset();
+	LeftHandEntryFailure.Reset();
+	RightHandSustainFailure.Reset();
+	LeftHandSustainFailure.Reset();
+}
+
+FString FEmpathTwoHandGestureData::GetEntryFailureReason(EEmpathBinaryHand Hand)
+{
+	if (Hand == EEmpathBinaryHand::Right)
+	{
+		return (RightHandEntryFailure.HasFailed() ? RightHandEntryFailure.GetFailureReason() : LastRightHandEntryFailureReason);
+	}
+	return (LeftHandEntryFailure.HasFailed() ? LeftHandEntryFailure.GetFailureReason() : LastLeftHandEntryFailureReason);
+}
+
+FString FEmpathTwoHandGestureData::GetSustainFailureReason(EEmpathBinaryHand Hand)
+{
+	if (Hand == EEmpathBinaryHand::Right)
+	{
+		return (RightHandSustainFailure.HasFailed() ? RightHandSustainFailure.GetFailureReason() : LastRightHandSustainFailureReason);
+	}
+	return (LeftHandSustainFailure.HasFailed() ? LeftHandSustainFailure.GetFailureReason() : LastLeftHandSustainFailureReason);
 }
 
 const bool FEmpathGestureCondition04::AreAllConditionsMet(const FEmpathGestureCheck& GestureConditionCheck, const FEmpathGestureCheck& FrameConditionCheck, FString& OutFailureMessage)
@@ -1225,3 +1994,439 @@ void FEmpathPoseData::CalculateLeftHandConditions()
 
 	return;
 }
+
+/** Returns the byte offset of the value checked by a condition inside FEmpathGestureCheck. Returns false if the check type is invalid. */
+static bool GetGestureConditionOperandOffset(EEmpathGestureConditionCheckType ConditionCheckType, bool bFrameCheck, uint16& OutOffset)
+{
+	int32 Offset = 0;
+	switch (ConditionCheckType)
+	{
+	case EEmpathGestureConditionCheckType::VelocityMagnitude:			Offset = STRUCT_OFFSET(FEmpathGestureCheck, VelocityMagnitude); break;
+	case EEmpathGestureConditionCheckType::VelocityX:					Offset = STRUCT_OFFSET(FEmpathGestureCheck, CheckVelocity) + STRUCT_OFFSET(FVector, X); break;
+	case EEmpathGestureConditionCheckType::VelocityY:					Offset = STRUCT_OFFSET(FEmpathGestureCheck, CheckVelocity) + STRUCT_OFFSET(FVector, Y); break;
+
+	// The condition tree reads Y rather than Z for last frame only checks, so we do the same to keep the results identical
+	case EEmpathGestureConditionCheckType::VelocityZ:					Offset = STRUCT_OFFSET(FEmpathGestureCheck, CheckVelocity) + (bFrameCheck ? STRUCT_OFFSET(FVector, Y) : STRUCT_OFFSET(FVector, Z)); break;
+	case EEmpathGestureConditionCheckType::AngularVelocityX:			Offset = STRUCT_OFFSET(FEmpathGestureCheck, AngularVelocity) + STRUCT_OFFSET(FVector, X); break;
+	case EEmpathGestureConditionCheckType::AngularVelocityY:			Offset = STRUCT_OFFSET(FEmpathGestureCheck, AngularVelocity) + STRUCT_OFFSET(FVector, Y); break;
+	case EEmpathGestureConditionCheckType::AngularVelocityZ:			Offset = STRUCT_OFFSET(FEmpathGestureCheck, AngularVelocity) + STRUCT_OFFSET(FVector, Z); break;
+	case EEmpathGestureConditionCheckType::ScaledAngularVelocityX:		Offset = STRUCT_OFFSET(FEmpathGestureCheck, ScaledAngularVelocity) + STRUCT_OFFSET(FVector, X); break;
+	case EEmpathGestureConditionCheckType::ScaledAngularVelocityY:		Offset = STRUCT_OFFSET(FEmpathGestureCheck, ScaledAngularVelocity) + STRUCT_OFFSET(FVector, Y); break;
+	case EEmpathGestureConditionCheckType::ScaledAngularVelocityZ:		Offset = STRUCT_OFFSET(FEmpathGestureCheck, ScaledAngularVelocity) + STRUCT_OFFSET(FVector, Z); break;
+	case EEmpathGestureConditionCheckType::SphericalVelocity:			Offset = STRUCT_OFFSET(FEmpathGestureCheck, SphericalVelocity); break;
+	case EEmpathGestureConditionCheckType::RadialVelocity:				Offset = STRUCT_OFFSET(FEmpathGestureCheck, RadialVelocity); break;
+	case EEmpathGestureConditionCheckType::VerticalVelocity:			Offset = STRUCT_OFFSET(FEmpathGestureCheck, VerticalVelocity); break;
+	case EEmpathGestureConditionCheckType::SphericalDistance:			Offset = STRUCT_OFFSET(FEmpathGestureCheck, SphericalDist); break;
+	case EEmpathGestureConditionCheckType::RadialDistance:				Offset = STRUCT_OFFSET(FEmpathGestureCheck, RadialDist); break;
+	case EEmpathGestureConditionCheckType::VerticalDistance:			Offset = STRUCT_OFFSET(FEmpathGestureCheck, VerticalDist); break;
+	case EEmpathGestureConditionCheckType::AccelerationMagnitude:		Offset = STRUCT_OFFSET(FEmpathGestureCheck, AccelMagnitude); break;
+	case EEmpathGestureConditionCheckType::AccelerationX:				Offset = STRUCT_OFFSET(FEmpathGestureCheck, CheckAcceleration) + STRUCT_OFFSET(FVector, X); break;
+	case EEmpathGestureConditionCheckType::AccelerationY:				Offset = STRUCT_OFFSET(FEmpathGestureCheck, CheckAcceleration) + STRUCT_OFFSET(FVector, Y); break;
+	case EEmpathGestureConditionCheckType::AccelerationZ:				Offset = STRUCT_OFFSET(FEmpathGestureCheck, CheckAcceleration) + STRUCT_OFFSET(FVector, Z); break;
+	case EEmpathGestureConditionCheckType::AngularAccelerationX:		Offset = STRUCT_OFFSET(FEmpathGestureCheck, AngularAcceleration) + STRUCT_OFFSET(FVector, X); break;
+	case EEmpathGestureConditionCheckType::AngularAccelerationY:		Offset = STRUCT_OFFSET(FEmpathGestureCheck, AngularAcceleration) + STRUCT_OFFSET(FVector, Y); break;
+	case EEmpathGestureConditionCheckType::AngularAccelerationZ:		Offset = STRUCT_OFFSET(FEmpathGestureCheck, AngularAcceleration) + STRUCT_OFFSET(FVector, Z); break;
+	case EEmpathGestureConditionCheckType::SphericalAcceleration:		Offset = STRUCT_OFFSET(FEmpathGestureCheck, SphericalAccel); break;
+	case EEmpathGestureConditionCheckType::RadialAcceleration:			Offset = STRUCT_OFFSET(FEmpathGestureCheck, RadialAccel); break;
+	case EEmpathGestureConditionCheckType::VerticalAcceleration:		Offset = STRUCT_OFFSET(FEmpathGestureCheck, VerticalAccel); break;
+	case EEmpathGestureConditionCheckType::MotionAngleX:				Offset = STRUCT_OFFSET(FEmpathGestureCheck, MotionAngle) + STRUCT_OFFSET(FVector, X); break;
+	case EEmpathGestureConditionCheckType::MotionAngleY:				Offset = STRUCT_OFFSET(FEmpathGestureCheck, MotionAngle) + STRUCT_OFFSET(FVector, Y); break;
+	case EEmpathGestureConditionCheckType::MotionAngleZ:				Offset = STRUCT_OFFSET(FEmpathGestureCheck, MotionAngle) + STRUCT_OFFSET(FVector, Z); break;
+	case EEmpathGestureConditionCheckType::DistanceBetweenHands:		Offset = STRUCT_OFFSET(FEmpathGestureCheck, DistBetweenHands); break;
+	case EEmpathGestureConditionCheckType::InteriorAngleToOtherHand:	Offset = STRUCT_OFFSET(FEmpathGestureCheck, InteriorAngleToOtherHand); break;
+	default:
+	{
+		return false;
+	}
+	}
+
+	OutOffset = (uint16)Offset;
+	return true;
+}
+
+/** Appends the sub-conditions of each parent instruction as contiguous strong and weak spans, and records them as the parents of the next level. */
+template <typename ParentType, typename ChildType>
+static void CompileGestureSubConditions(TArray<FEmpathGestureInstruction>& Instructions, 
+	const TArray<TPair<const ParentType*, int32>>& Parents,
+	TArray<TPair<const ChildType*, int32>>& OutChildren)
+{
+	OutChildren.Reset();
+	for (const TPair<const ParentType*, int32>& Parent : Parents)
+	{
+		int32 const StrongStart = Instructions.Num();
+		for (const ChildType& Child : Parent.Key->StrongSubConditions)
+		{
+			OutChildren.Add(TPair<const ChildType*, int32>(&Child, Instructions.Add(FEmpathGestureConditionProgram::CompileCondition(Child))));
+		}
+		int32 const WeakStart = Instructions.Num();
+		for (const ChildType& Child : Parent.Key->WeakSubConditions)
+		{
+			OutChildren.Add(TPair<const ChildType*, int32>(&Child, Instructions.Add(FEmpathGestureConditionProgram::CompileCondition(Child))));
+		}
+
+		FEmpathGestureInstruction& ParentInstruction = Instructions[Parent.Value];
+		ParentInstruction.StrongStart = StrongStart;
+		ParentInstruction.StrongNum = WeakStart - StrongStart;
+		ParentInstruction.WeakStart = WeakStart;
+		ParentInstruction.WeakNum = Instructions.Num() - WeakStart;
+	}
+}
+
+/** Records the check type of each compiled condition against its instruction. */
+template <typename ConditionType>
+static void RecordGestureConditionCheckTypes(const TArray<TPair<const ConditionType*, int32>>& Conditions, TArray<EEmpathGestureConditionCheckType>& OutCheckTypes)
+{
+	for (const TPair<const ConditionType*, int32>& Condition : Conditions)
+	{
+		OutCheckTypes[Condition.Value] = Condition.Key->ConditionCheckType;
+	}
+}
+
+FEmpathGestureInstruction FEmpathGestureConditionProgram::CompileCondition(const FEmpathGestureCondition& Condition)
+{
+	FEmpathGestureInstruction Instruction;
+	Instruction.Threshold = Condition.ThresholdValue;
+	Instruction.CheckIdx = (Condition.VelocityCheckType == EEmpathVelocityCheckType::BufferedAverage ? 0 : 1);
+
+	// Auto success never looks at the value
+	if (Condition.ConditionCheckType == EEmpathGestureConditionCheckType::AutoSuccess)
+	{
+		Instruction.Opcode = EEmpathGestureOpcode::AutoSuccess;
+		return Instruction;
+	}
+
+	// Invalid checks and operations always fail, as they do in the condition tree
+	if (!GetGestureConditionOperandOffset(Condition.ConditionCheckType, Instruction.CheckIdx == 1, Instruction.OperandOffset))
+	{
+		Instruction.Opcode = EEmpathGestureOpcode::AutoFail;
+		return Instruction;
+	}
+
+	switch (Condition.CheckOperationType)
+	{
+	case EEmpathBinaryOperation::GreaterThan:		Instruction.Opcode = EEmpathGestureOpcode::GreaterThan; break;
+	case EEmpathBinaryOperation::GreaterThanEqual:	Instruction.Opcode = EEmpathGestureOpcode::GreaterThanEqual; break;
+	case EEmpathBinaryOperation::LessThan:			Instruction.Opcode = EEmpathGestureOpcode::LessThan; break;
+	case EEmpathBinaryOperation::LessThanEqual:		Instruction.Opcode = EEmpathGestureOpcode::LessThanEqual; break;
+	case EEmpathBinaryOperation::Equal:				Instruction.Opcode = EEmpathGestureOpcode::Equal; break;
+	default:										Instruction.Opcode = EEmpathGestureOpcode::AutoFail; break;
+	}
+	return Instruction;
+}
+
+void FEmpathGestureConditionProgram::Compile(const FEmpathGestureCondition01& Conditions)
+{
+	Instructions.Reset();
+
+	// Lay the tree out one level at a time, so that every condition's sub-conditions sit together after it
+	TArray<TPair<const FEmpathGestureCondition01*, int32>> Level01;
+	Level01.Add(TPair<const FEmpathGestureCondition01*, int32>(&Conditions, Instructions.Add(CompileCondition(Conditions))));
+	TArray<TPair<const FEmpathGestureCondition02*, int32>> Level02;
+	CompileGestureSubConditions(Instructions, Level01, Level02);
+	TArray<TPair<const FEmpathGestureCondition03*, int32>> Level03;
+	CompileGestureSubConditions(Instructions, Level02, Level03);
+	TArray<TPair<const FEmpathGestureCondition04*, int32>> Level04;
+	CompileGestureSubConditions(Instructions, Level03, Level04);
+	TArray<TPair<const FEmpathGestureCondition*, int32>> Leaves;
+	CompileGestureSubConditions(Instructions, Level04, Leaves);
+
+	ConditionCheckTypes.SetNumUninitialized(Instructions.Num());
+	RecordGestureConditionCheckTypes(Level01, ConditionCheckTypes);
+	RecordGestureConditionCheckTypes(Level02, ConditionCheckTypes);
+	RecordGestureConditionCheckTypes(Level03, ConditionCheckTypes);
+	RecordGestureConditionCheckTypes(Level04, ConditionCheckTypes);
+	RecordGestureConditionCheckTypes(Leaves, ConditionCheckTypes);
+
+	Instructions.Shrink();
+	TestResults.SetNumZeroed(Instructions.Num());
+	Results.SetNumZeroed(Instructions.Num());
+}
+
+void FEmpathGestureConditionProgram::Reset()
+{
+	Instructions.Empty();
+	ConditionCheckTypes.Empty();
+	TestResults.Empty();
+	Results.Empty();
+}
+
+bool FEmpathGestureConditionProgram::Evaluate(const FEmpathGestureCheck& GestureConditionCheck, const FEmpathGestureCheck& FrameConditionCheck)
+{
+	int32 const NumInstructions = Instructions.Num();
+	if (NumInstructions == 0)
+	{
+		return false;
+	}
+	TestResults.SetNumUninitialized(NumInstructions, false);
+	Results.SetNumUninitialized(NumInstructions, false);
+
+	// Test every condition on its own first. Conditions have no side effects, 
+	// so testing them all gives the same result as the tree's early outs.
+	const uint8* Checks[2] = { reinterpret_cast<const uint8*>(&GestureConditionCheck), reinterpret_cast<const uint8*>(&FrameConditionCheck) };
+	for (int32 Idx = 0; Idx < NumInstructions; ++Idx)
+	{
+		const FEmpathGestureInstruction& Instruction = Instructions[Idx];
+		float const Value = *reinterpret_cast<const float*>(Checks[Instruction.CheckIdx] + Instruction.OperandOffset);
+		float const Threshold = Instruction.Threshold;
+		uint8 const Passes[] =
+		{
+			1,
+			0,
+			Value > Threshold,
+			Value >= Threshold,
+			Value < Threshold,
+			Value <= Threshold,
+			FMath::IsNearlyEqual(Value, Threshold)
+		};
+		TestResults[Idx] = Passes[(uint8)Instruction.Opcode];
+	}
+
+	// Then fold sub-conditions into their parents, from the leaves up
+	for (int32 Idx = NumInstructions - 1; Idx >= 0; --Idx)
+	{
+		const FEmpathGestureInstruction& Instruction = Instructions[Idx];
+		uint8 bStrongPassed = TestResults[Idx];
+		for (int32 SubIdx = Instruction.StrongStart; SubIdx < Instruction.StrongStart + Instruction.StrongNum; ++SubIdx)
+		{
+			bStrongPassed &= Results[SubIdx];
+		}
+		uint8 bWeakPassed = (Instruction.WeakNum == 0);
+		for (int32 SubIdx = Instruction.WeakStart; SubIdx < Instruction.WeakStart + Instruction.WeakNum; ++SubIdx)
+		{
+			bWeakPassed |= Results[SubIdx];
+		}
+		Results[Idx] = bStrongPassed & bWeakPassed;
+	}
+
+	return Results[0] != 0;
+}
+
+int32 FEmpathGestureConditionProgram::GetLastFailure(EEmpathGestureFailureCode& OutFailureCode) const
+{
+	OutFailureCode = EEmpathGestureFailureCode::None;
+	if (Results.Num() == 0 || Results[0])
+	{
+		return INDEX_NONE;
+	}
+
+	// Like the tree, a failed condition is reported before its sub-conditions, and the first failed strong sub-condition before the weak ones
+	int32 Idx = 0;
+	while (true)
+	{
+		const FEmpathGestureInstruction& Instruction = Instructions[Idx];
+		if (!TestResults[Idx])
+		{
+			switch (Instruction.Opcode)
+			{
+			case EEmpathGestureOpcode::GreaterThan:
+			case EEmpathGestureOpcode::GreaterThanEqual:
+			{
+				OutFailureCode = EEmpathGestureFailureCode::TooLow;
+				break;
+			}
+			case EEmpathGestureOpcode::LessThan:
+			case EEmpathGestureOpcode::LessThanEqual:
+			{
+				OutFailureCode = EEmpathGestureFailureCode::TooHigh;
+				break;
+			}
+			case EEmpathGestureOpcode::Equal:
+			{
+				OutFailureCode = EEmpathGestureFailureCode::NotEqual;
+				break;
+			}
+			default:
+			{
+				OutFailureCode = EEmpathGestureFailureCode::InvalidCase;
+				break;
+			}
+			}
+			return Idx;
+		}
+
+		int32 FailedStrongIdx = INDEX_NONE;
+		for (int32 SubIdx = Instruction.StrongStart; SubIdx < Instruction.StrongStart + Instruction.StrongNum; ++SubIdx)
+		{
+			if (!Results[SubIdx])
+			{
+				FailedStrongIdx = SubIdx;
+				break;
+			}
+		}
+		if (FailedStrongIdx == INDEX_NONE)
+		{
+			OutFailureCode = EEmpathGestureFailureCode::WeakSubConditions;
+			return Idx;
+		}
+		Idx = FailedStrongIdx;
+	}
+}
+
+void FEmpathGestureConditionFailure::Record(const FEmpathGestureConditionProgram& Program, const FEmpathGestureCheck& GestureConditionCheck, const FEmpathGestureCheck& FrameConditionCheck)
+{
+	InstructionIdx = Program.GetLastFailure(FailureCode);
+	if (InstructionIdx != INDEX_NONE)
+	{
+		Instruction = Program.Instructions[InstructionIdx];
+		ConditionCheckType = Program.ConditionCheckTypes[InstructionIdx];
+		const FEmpathGestureCheck& Check = (Instruction.CheckIdx == 0 ? GestureConditionCheck : FrameConditionCheck);
+		Value = *reinterpret_cast<const float*>(reinterpret_cast<const uint8*>(&Check) + Instruction.OperandOffset);
+	}
+}
+
+void FEmpathGestureConditionFailure::Reset()
+{
+	FailureCode = EEmpathGestureFailureCode::None;
+	InstructionIdx = INDEX_NONE;
+}
+
+FString FEmpathGestureConditionFailure::GetFailureReason() const
+{
+	if (!HasFailed())
+	{
+		return FString();
+	}
+
+	const UEnum* CheckTypeEnum = FindObject<UEnum>(ANY_PACKAGE, TEXT("EEmpathGestureConditionCheckType"), true);
+	FString const CheckTypeName = (CheckTypeEnum ? CheckTypeEnum->GetDisplayNameTextByValue((int64)ConditionCheckType).ToString() : FString::FromInt((int32)ConditionCheckType));
+	switch (FailureCode)
+	{
+	case EEmpathGestureFailureCode::TooLow:
+	case EEmpathGestureFailureCode::TooHigh:
+	case EEmpathGestureFailureCode::NotEqual:
+	{
+		TCHAR const* const FailureText = (FailureCode == EEmpathGestureFailureCode::TooLow ? TEXT("Too Low") : (FailureCode == EEmpathGestureFailureCode::TooHigh ? TEXT("Too High") : TEXT("Not Equal")));
+		return FString::Printf(TEXT("%s %s: %f against %f%s"), FailureText, *CheckTypeName, Value, Instruction.Threshold, Instruction.CheckIdx == 1 ? TEXT(" on the last frame") : TEXT(""));
+	}
+	case EEmpathGestureFailureCode::WeakSubConditions:
+	{
+		return FString::Printf(TEXT("Weak Sub Conditions of %s"), *CheckTypeName);
+	}
+	default:
+	{
+		return FString::Printf(TEXT("Invalid Case %s"), *CheckTypeName);
+	}
+	}
+}
+
+/** 
+* Identifies gesture stream files, and the version of their layout. 
+* Bump the version whenever the fields written by SerializeGestureStreamCheck or SerializeGestureStreamFrame change.
+*/
+static const uint32 GestureStreamFileTag = 0x53475045;
+static const uint32 GestureStreamFileVersion = 2;
+
+/** The size in bytes of a gesture check, and of a whole frame, as written to a gesture stream file. */
+static const uint32 GestureStreamCheckSize = 31 * sizeof(float);
+static const int64 GestureStreamFrameSize = sizeof(float) + 2 * (2 * GestureStreamCheckSize + sizeof(float) + sizeof(uint8));
+
+static void SerializeGestureStreamCheck(FArchive& Ar, FEmpathGestureCheck& Check)
+{
+	Ar << Check.CheckVelocity;
+	Ar << Check.VelocityMagnitude;
+	Ar << Check.AngularVelocity;
+	Ar << Check.ScaledAngularVelocity;
+	Ar << Check.SphericalVelocity;
+	Ar << Check.RadialVelocity;
+	Ar << Check.VerticalVelocity;
+	Ar << Check.SphericalDist;
+	Ar << Check.RadialDist;
+	Ar << Check.VerticalDist;
+	Ar << Check.AccelMagnitude;
+	Ar << Check.CheckAcceleration;
+	Ar << Check.AngularAcceleration;
+	Ar << Check.SphericalAccel;
+	Ar << Check.RadialAccel;
+	Ar << Check.VerticalAccel;
+	Ar << Check.MotionAngle;
+	Ar << Check.DistBetweenHands;
+	Ar << Check.InteriorAngleToOtherHand;
+}
+
+static void SerializeGestureStreamFrame(FArchive& Ar, FEmpathGestureStreamFrame& Frame)
+{
+	Ar << Frame.TimeSeconds;
+	for (FEmpathGestureStreamHandFrame& Hand : Frame.Hands)
+	{
+		SerializeGestureStreamCheck(Ar, Hand.GestureConditionCheck);
+		SerializeGestureStreamCheck(Ar, Hand.FrameConditionCheck);
+		Ar << Hand.DeltaDistance;
+		uint8 bIsPowerCharged = Hand.bIsPowerCharged;
+		Ar << bIsPowerCharged;
+		Hand.bIsPowerCharged = (bIsPowerCharged != 0);
+	}
+}
+
+bool FEmpathGestureStream::SaveToFile(const FString& FileName) const
+{
+	TArray<uint8> Bytes;
+	Bytes.Reserve(16 + Frames.Num() * GestureStreamFrameSize);
+	FMemoryWriter Writer(Bytes);
+
+	uint32 FileTag = GestureStreamFileTag;
+	uint32 FileVersion = GestureStreamFileVersion;
+	uint32 CheckSize = GestureStreamCheckSize;
+	int32 NumFrames = Frames.Num();
+	Writer << FileTag << FileVersion << CheckSize << NumFrames;
+	for (const FEmpathGestureStreamFrame& Frame : Frames)
+	{
+		FEmpathGestureStreamFrame FrameToWrite = Frame;
+		SerializeGestureStreamFrame(Writer, FrameToWrite);
+	}
+
+	return FFileHelper::SaveArrayToFile(Bytes, *GetFilePath(FileName));
+}
+
+bool FEmpathGestureStream::LoadFromFile(const FString& FileName)
+{
+	Frames.Reset();
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *GetFilePath(FileName)))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+	uint32 FileTag = 0;
+	uint32 FileVersion = 0;
+	uint32 CheckSize = 0;
+	int32 NumFrames = 0;
+	Reader << FileTag << FileVersion << CheckSize << NumFrames;
+	if (Reader.IsError() 
+		|| FileTag != GestureStreamFileTag 
+		|| FileVersion != GestureStreamFileVersion 
+		|| CheckSize != GestureStreamCheckSize 
+		|| NumFrames < 0)
+	{
+		return false;
+	}
+
+	// Make sure the file actually holds as many frames as it claims before allocating them
+	if (Reader.TotalSize() - Reader.Tell() < NumFrames * GestureStreamFrameSize)
+	{
+		return false;
+	}
+
+	Frames.SetNum(NumFrames);
+	for (FEmpathGestureStreamFrame& Frame : Frames)
+	{
+		SerializeGestureStreamFrame(Reader, Frame);
+	}
+
+	if (Reader.IsError())
+	{
+		Frames.Reset();
+		return false;
+	}
+	return true;
+}
+
+FString FEmpathGestureStream::GetFilePath(const FString& FileName)
+{
+	FString FilePath = FPaths::ProjectSavedDir() / TEXT("GestureStreams") / FileName;
+	if (FPaths::GetExtension(FilePath).IsEmpty())
+	{
+		FilePath += TEXT(".gesturestream");
+	}
+	return FilePath;
+}
@@ -0,0 +1,542 @@
+// Copyright 2018 Team Empath All Rights Reserved
+
+#include "EmpathTestWorld.h"
+#include "EmpathAIStressTest.h"
+#include "EQC_AttackTarget.h"
+#include "EQC_DefendTarget.h"
+#include "EQC_FleeTarget.h"
+#include "EQC_LastKnownPlayerLocation.h"
+#include "EQC_NavRecoveryStartLocation.h"
+#include "EQC_PlayerLocation.h"
+#include "EmpathCharacter.h"
+#include "EmpathPlayerCharacter.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "EnvironmentQuery/EnvQueryContext.h"
+#include "EnvironmentQuery/Items/EnvQueryItemType_Actor.h"
+#include "EnvironmentQuery/Items/EnvQueryItemType_Point.h"
+#include "Curves/CurveFloat.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** Gives the AIs score curves that favour close targets in front of them, so that distance and angle both matter. */
+	bool SetTargetSelectionCurves(FAutomationTestBase& Test, TArray<AEmpathAIController*> const& AIs)
+	{
+		UCurveFloat* const DistCurve = NewObject<UCurveFloat>();
+		DistCurve->FloatCurve.AddKey(0.0f, 1.0f);
+		DistCurve->FloatCurve.AddKey(4000.0f, 0.0f);
+		UCurveFloat* const AngleCurve = NewObject<UCurveFloat>();
+		AngleCurve->FloatCurve.AddKey(0.0f, 1.0f);
+		AngleCurve->FloatCurve.AddKey(180.0f, 0.0f);
+		UObjectProperty* const DistCurveProp = FindField<UObjectProperty>(AEmpathAIController::StaticClass(), TEXT("TargetSelectionDistScoreCurve"));
+		UObjectProperty* const AngleCurveProp = FindField<UObjectProperty>(AEmpathAIController::StaticClass(), TEXT("TargetSelectionAngleScoreCurve"));
+		Test.TestNotNull(TEXT("Distance score curve property"), DistCurveProp);
+		Test.TestNotNull(TEXT("Angle score curve property"), AngleCurveProp);
+		if (!DistCurveProp || !AngleCurveProp)
+		{
+			return false;
+		}
+
+		for (AEmpathAIController* AI : AIs)
+		{
+			DistCurveProp->SetObjectPropertyValue_InContainer(AI, DistCurve);
+			AngleCurveProp->SetObjectPropertyValue_InContainer(AI, AngleCurve);
+		}
+		return true;
+	}
+
+	/** Makes a blackboard with just the attack, defend and flee targets, so that AIs without a behavior tree can hold targets. */
+	UBlackboardData* MakeTargetBlackboard()
+	{
+		UBlackboardData* const BlackboardData = NewObject<UBlackboardData>();
+		UBlackboardKeyType_Object* const KeyType = NewObject<UBlackboardKeyType_Object>(BlackboardData);
+		KeyType->BaseClass = AActor::StaticClass();
+		FName const KeyNames[] = { FEmpathBBKeys::AttackTarget, FEmpathBBKeys::DefendTarget, FEmpathBBKeys::FleeTarget };
+		for (FName const& KeyName : KeyNames)
+		{
+			FBlackboardEntry Entry;
+			Entry.EntryName = KeyName;
+			Entry.KeyType = KeyType;
+			BlackboardData->Keys.Add(Entry);
+		}
+		return BlackboardData;
+	}
+
+	/** Has the context provide its value to a query run by the querier, the way the EQS manager does. */
+	FEnvQueryContextData ProvideContext(UClass* ContextClass, APawn* Querier)
+	{
+		FEnvQueryInstance QueryInstance;
+		QueryInstance.Owner = Querier;
+		QueryInstance.World = Querier->GetWorld();
+		FEnvQueryContextData ContextData;
+		ContextClass->GetDefaultObject<UEnvQueryContext>()->ProvideContext(QueryInstance, ContextData);
+		return ContextData;
+	}
+
+	/** Returns the actor an actor context provides to the querier. */
+	AActor* ProvideContextActor(UClass* ContextClass, APawn* Querier)
+	{
+		FEnvQueryContextData const ContextData = ProvideContext(ContextClass, Querier);
+		return (ContextData.NumValues == 1 ? UEnvQueryItemType_Actor::GetValue(ContextData.RawData.GetData()) : nullptr);
+	}
+
+	/** Returns the location a point context provides to the querier. */
+	FVector ProvideContextLocation(UClass* ContextClass, APawn* Querier)
+	{
+		FEnvQueryContextData const ContextData = ProvideContext(ContextClass, Querier);
+		return (ContextData.NumValues == 1 ? UEnvQueryItemType_Point::GetValue(ContextData.RawData.GetData()) : FNavigationSystem::InvalidLocation);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathAISpatialGridTest, "Empath.AI.SpatialGrid", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEmpathAISpatialGridTest::RunTest(const FString& Parameters)
+{
+	FEmpathTestWorld TestWorld;
+	AEmpathAIManager* const AIManager = TestWorld.SpawnAIManager();
+	FRandomStream Random(1337);
+
+	// Scatter AIs over a few grid cells in every direction, including negative coordinates
+	TArray<AEmpathAIController*> AIs;
+	for (int32 Idx = 0; Idx < 200; ++Idx)
+	{
+		AIs.Add(TestWorld.SpawnAI(AIManager, FVector(Random.FRandRange(-3000.0f, 3000.0f), Random.FRandRange(-3000.0f, 3000.0f), Random.FRandRange(-500.0f, 500.0f))));
+	}
+
+	// Compares the grid's answers against checking every AI, at random locations and radii
+	auto CheckQueries = [&](const TCHAR* Stage)
+	{
+		for (int32 QueryIdx = 0; QueryIdx < 50; ++QueryIdx)
+		{
+			FVector const Location(Random.FRandRange(-3500.0f, 3500.0f), Random.FRandRange(-3500.0f, 3500.0f), Random.FRandRange(-600.0f, 600.0f));
+			float const Radius = Random.FRandRange(0.0f, 2500.0f);
+
+			TArray<AEmpathAIController*> Expected;
+			for (AEmpathAIController* AI : AIs)
+			{
+				if (FVector::DistSquared(AI->GetPawn()->GetActorLocation(), Location) <= FMath::Square(Radius))
+				{
+					Expected.Add(AI);
+				}
+			}
+
+			TArray<AEmpathAIController*> Found;
+			AIManager->GetAIsInRadius(Location, Radius, Found);
+			TestEqual(FString::Printf(TEXT("%s: number of AIs within %.0f of %s"), Stage, Radius, *Location.ToString()), Found.Num(), Expected.Num());
+			for (AEmpathAIController* AI : Expected)
+			{
+				TestTrue(FString::Printf(TEXT("%s: %s found within %.0f of %s"), Stage, *GetNameSafe(AI), Radius, *Location.ToString()), Found.Contains(AI));
+			}
+
+			// The nearest AIs must be exactly as far away as the closest AIs found by sorting everyone
+			int32 const NumNearest = Random.RandRange(1, 20);
+			TArray<float> ExpectedDists;
+			for (AEmpathAIController* AI : AIs)
+			{
+				ExpectedDists.Add(FVector::Dist(AI->GetPawn()->GetActorLocation(), Location));
+			}
+			ExpectedDists.Sort();
+
+			TArray<AEmpathAIController*> Nearest;
+			AIManager->GetNearestAIs(Location, NumNearest, Nearest);
+			TestEqual(FString::Printf(TEXT("%s: number of nearest AIs to %s"), Stage, *Location.ToString()), Nearest.Num(), NumNearest);
+			if (Nearest.Num() == NumNearest)
+			{
+				for (int32 Idx = 0; Idx < NumNearest; ++Idx)
+				{
+					TestEqual(FString::Printf(TEXT("%s: distance to nearest AI %d to %s"), Stage, Idx, *Location.ToString()),
+						FVector::Dist(Nearest[Idx]->GetPawn()->GetActorLocation(), Location), ExpectedDists[Idx], KINDA_SMALL_NUMBER);
+				}
+			}
+		}
+	};
+
+	AIManager->Tick(0.0f);
+	CheckQueries(TEXT("Initial"));
+
+	// Move some of the AIs into other cells and make sure the incremental update follows them
+	for (int32 Idx = 0; Idx < AIs.Num(); Idx += 3)
+	{
+		APawn* const Pawn = AIs[Idx]->GetPawn();
+		Pawn->SetActorLocation(Pawn->GetActorLocation() + FVector(Random.FRandRange(-1500.0f, 1500.0f), Random.FRandRange(-1500.0f, 1500.0f), 0.0f));
+	}
+	AIManager->Tick(0.0f);
+	CheckQueries(TEXT("After moving"));
+
+	// Unregistered AIs must no longer be found
+	for (int32 Idx = AIs.Num() - 1; Idx >= 0; Idx -= 4)
+	{
+		AIs[Idx]->UnPossess();
+		AIs.RemoveAt(Idx);
+	}
+	AIManager->Tick(0.0f);
+	CheckQueries(TEXT("After unregistering"));
+
+	// AIs registered since the last tick must be found straight away, whether they possessed their pawn before registering or after
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	for (int32 Idx = 0; Idx < 20; ++Idx)
+	{
+		FVector const Location(Random.FRandRange(-3000.0f, 3000.0f), Random.FRandRange(-3000.0f, 3000.0f), Random.FRandRange(-500.0f, 500.0f));
+		if (Idx % 2 == 0)
+		{
+			AIs.Add(TestWorld.SpawnAI(AIManager, Location));
+		}
+		else
+		{
+			APawn* const Pawn = TestWorld.GetWorld()->SpawnActor<ADefaultPawn>(Location, FRotator::ZeroRotator, SpawnParams);
+			AEmpathAIController* const AI = TestWorld.GetWorld()->SpawnActor<AEmpathAIController>(SpawnParams);
+			AI->RegisterAIManager(AIManager);
+			AI->Possess(Pawn);
+			AIs.Add(AI);
+		}
+	}
+	CheckQueries(TEXT("After registering mid-frame"));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathAIParallelTargetScoringTest, "Empath.AI.ParallelTargetScoring", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEmpathAIParallelTargetScoringTest::RunTest(const FString& Parameters)
+{
+	FEmpathTestWorld TestWorld;
+	AEmpathAIManager* const AIManager = TestWorld.SpawnAIManager();
+	FRandomStream Random(90210);
+
+	// Scoring needs character pawns
+	TArray<AEmpathAIController*> AIs;
+	for (int32 Idx = 0; Idx < 128; ++Idx)
+	{
+		AIs.Add(TestWorld.SpawnAI(AIManager, 
+			FVector(Random.FRandRange(-3000.0f, 3000.0f), Random.FRandRange(-3000.0f, 3000.0f), 0.0f), 
+			FRotator(0.0f, Random.FRandRange(-180.0f, 180.0f), 0.0f), 
+			ACharacter::StaticClass()));
+	}
+	if (!SetTargetSelectionCurves(*this, AIs))
+	{
+		return false;
+	}
+
+	// Scatter secondary targets with a mix of preferences and targeting ratios
+	for (int32 Idx = 0; Idx < 16; ++Idx)
+	{
+		AActor* const Target = TestWorld.GetWorld()->SpawnActor<ADefaultPawn>(FVector(Random.FRandRange(-3000.0f, 3000.0f), Random.FRandRange(-3000.0f, 3000.0f), 0.0f), FRotator::ZeroRotator);
+		AIManager->AddSecondaryTarget(Target, Random.FRandRange(0.0f, 0.5f), Random.FRandRange(0.0f, 1.0f), 100.0f);
+	}
+
+	// Score several times, moving the AIs in between, and make sure worker threads always agree with scoring on one thread
+	for (int32 Round = 0; Round < 4; ++Round)
+	{
+		AIManager->Tick(0.0f);
+
+		TArray<AActor*> SerialTargets;
+		TArray<AActor*> ParallelTargets;
+		AIManager->ScoreAttackTargets(AIs, SerialTargets, false);
+		AIManager->ScoreAttackTargets(AIs, ParallelTargets, true);
+
+		int32 NumChosen = 0;
+		for (int32 Idx = 0; Idx < AIs.Num(); ++Idx)
+		{
+			TestTrue(FString::Printf(TEXT("Round %d: %s chose %s in parallel and %s serially"), Round, *GetNameSafe(AIs[Idx]), *GetNameSafe(ParallelTargets[Idx]), *GetNameSafe(SerialTargets[Idx])), 
+				ParallelTargets[Idx] == SerialTargets[Idx]);
+			NumChosen += (SerialTargets[Idx] != nullptr) ? 1 : 0;
+		}
+		TestTrue(FString::Printf(TEXT("Round %d: AIs chose targets"), Round), NumChosen > 0);
+
+		for (AEmpathAIController* AI : AIs)
+		{
+			APawn* const Pawn = AI->GetPawn();
+			Pawn->SetActorLocationAndRotation(Pawn->GetActorLocation() + FVector(Random.FRandRange(-500.0f, 500.0f), Random.FRandRange(-500.0f, 500.0f), 0.0f), 
+				FRotator(0.0f, Random.FRandRange(-180.0f, 180.0f), 0.0f));
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathAIParallelTargetScoringWithPlayerTest, "Empath.AI.ParallelTargetScoringWithPlayer", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEmpathAIParallelTargetScoringWithPlayerTest::RunTest(const FString& Parameters)
+{
+	FEmpathTestWorld TestWorld;
+	AEmpathAIManager* const AIManager = TestWorld.SpawnAIManager();
+	FRandomStream Random(4242);
+
+	// The player is found through the first player controller when the AI manager takes its snapshot
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	APlayerController* const PlayerCon = TestWorld.GetWorld()->SpawnActor<APlayerController>(SpawnParams);
+	AEmpathPlayerCharacter* const Player = TestWorld.GetWorld()->SpawnActor<AEmpathPlayerCharacter>(FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
+	PlayerCon->Possess(Player);
+	AIManager->UpdateKnownTargetLocation(Player);
+
+	// A handful of AIs that can hold targets around the player, competing for it and two distant secondary targets that each want a share of them
+	UBlackboardData* const BlackboardData = MakeTargetBlackboard();
+	TArray<AEmpathAIController*> AIs;
+	for (int32 Idx = 0; Idx < 12; ++Idx)
+	{
+		AEmpathAIController* const AI = TestWorld.SpawnAI(AIManager, 
+			FVector(Random.FRandRange(-2000.0f, 2000.0f), Random.FRandRange(-2000.0f, 2000.0f), 0.0f), 
+			FRotator(0.0f, Random.FRandRange(-180.0f, 180.0f), 0.0f), 
+			ACharacter::StaticClass());
+		UBlackboardComponent* BlackboardComp = nullptr;
+		TestTrue(TEXT("AI uses the target blackboard"), AI->UseBlackboard(BlackboardData, BlackboardComp));
+		AIs.Add(AI);
+	}
+	if (!SetTargetSelectionCurves(*this, AIs))
+	{
+		return false;
+	}
+	TArray<AActor*> Targets;
+	Targets.Add(Player);
+	for (int32 Idx = 0; Idx < 2; ++Idx)
+	{
+		AActor* const Target = TestWorld.GetWorld()->SpawnActor<ADefaultPawn>(FVector(Idx == 0 ? 2500.0f : -2500.0f, 2500.0f, 0.0f), FRotator::ZeroRotator, SpawnParams);
+		AIManager->AddSecondaryTarget(Target, 0.3f, 0.0f, 100.0f);
+		Targets.Add(Target);
+	}
+
+	// Each round, both ways of scoring must pick the same targets, and committing them must count each AI against its new target
+	int32 NumPlayerChoices = 0;
+	for (int32 Round = 0; Round < 4; ++Round)
+	{
+		AIManager->Tick(0.0f);
+		TestTrue(FString::Printf(TEXT("Round %d: Player is in the snapshot"), Round), AIManager->GetWorldSnapshot().Player == Player);
+
+		TArray<AActor*> SerialTargets;
+		TArray<AActor*> ParallelTargets;
+		AIManager->ScoreAttackTargets(AIs, SerialTargets, false);
+		AIManager->ScoreAttackTargets(AIs, ParallelTargets, true);
+
+		for (int32 Idx = 0; Idx < AIs.Num(); ++Idx)
+		{
+			TestTrue(FString::Printf(TEXT("Round %d: %s chose %s in parallel and %s serially"), Round, *GetNameSafe(AIs[Idx]), *GetNameSafe(ParallelTargets[Idx]), *GetNameSafe(SerialTargets[Idx])), 
+				ParallelTargets[Idx] == SerialTargets[Idx]);
+			NumPlayerChoices += (SerialTargets[Idx] == Player) ? 1 : 0;
+		}
+
+		// Commit the parallel results like the targeting queue does
+		for (int32 Idx = 0; Idx < AIs.Num(); ++Idx)
+		{
+			AIs[Idx]->SetAttackTarget(ParallelTargets[Idx]);
+			TestTrue(FString::Printf(TEXT("Round %d: %s holds its new attack target"), Round, *GetNameSafe(AIs[Idx])), AIs[Idx]->GetAttackTarget() == ParallelTargets[Idx]);
+		}
+
+		// The AI manager's counts must match the serially chosen targets
+		for (AActor* const Target : Targets)
+		{
+			int32 ExpectedNumTargeting = 0;
+			for (AActor* const SerialTarget : SerialTargets)
+			{
+				ExpectedNumTargeting += (SerialTarget == Target) ? 1 : 0;
+			}
+			int32 NumTargeting = 0;
+			int32 NumTotal = 0;
+			AIManager->GetNumAITargeting(Target, NumTargeting, NumTotal);
+			TestEqual(FString::Printf(TEXT("Round %d: AIs counted against %s"), Round, *GetNameSafe(Target)), NumTargeting, ExpectedNumTargeting);
+			TestEqual(FString::Printf(TEXT("Round %d: AIs counted in total"), Round), NumTotal, AIs.Num());
+		}
+
+		for (AEmpathAIController* AI : AIs)
+		{
+			APawn* const Pawn = AI->GetPawn();
+			Pawn->SetActorLocationAndRotation(Pawn->GetActorLocation() + FVector(Random.FRandRange(-500.0f, 500.0f), Random.FRandRange(-500.0f, 500.0f), 0.0f), 
+				FRotator(0.0f, Random.FRandRange(-180.0f, 180.0f), 0.0f));
+		}
+	}
+	TestTrue(TEXT("AIs chose the player"), NumPlayerChoices > 0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathAIStressScenarioTest, "Empath.AI.StressScenario", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEmpathAIStressScenarioTest::RunTest(const FString& Parameters)
+{
+	FEmpathTestWorld TestWorld;
+
+	// Frame timings are only gathered while someone is recording them
+	AEmpathAIManager* const IdleAIManager = TestWorld.SpawnAIManager();
+	IdleAIManager->AddFrameCount(&FEmpathAIFrameTimings::NumPathRequests, 3);
+	IdleAIManager->Tick(0.0f);
+	TestEqual(TEXT("Path requests counted without recording"), IdleAIManager->GetLastFrameTimings().NumPathRequests, 0);
+	IdleAIManager->SetRecordFrameTimings(true);
+	IdleAIManager->AddFrameCount(&FEmpathAIFrameTimings::NumPathRequests, 3);
+	IdleAIManager->Tick(0.0f);
+	TestEqual(TEXT("Path requests counted while recording"), IdleAIManager->GetLastFrameTimings().NumPathRequests, 3);
+	IdleAIManager->Destroy();
+
+	// The test world has no game mode, so the stress test has to bring its own AI manager and set up everything else itself
+	AEmpathAIStressTest* const StressTest = AEmpathAIStressTest::SpawnStressTest(TestWorld.GetWorld());
+	TestNotNull(TEXT("Stress test"), StressTest);
+	if (!StressTest)
+	{
+		return false;
+	}
+	StressTest->NumAIs = 8;
+	StressTest->NumFrames = 5;
+	StressTest->NumWarmUpFrames = 2;
+	StressTest->bSaveResults = false;
+	StressTest->StartStressTest();
+
+	AEmpathAIManager* const AIManager = StressTest->GetAIManager();
+	TestNotNull(TEXT("Stress test AI manager"), AIManager);
+	if (!AIManager)
+	{
+		return false;
+	}
+	TestTrue(TEXT("Recording frame timings"), AIManager->IsRecordingFrameTimings());
+	TestEqual(TEXT("Enemies registered with the AI manager"), AIManager->EmpathAICons.Num(), StressTest->NumAIs);
+
+	float const DeltaTime = 1.0f / 90.0f;
+	for (int32 Frame = 0; Frame < 100 && !StressTest->IsFinished(); ++Frame)
+	{
+		AIManager->Tick(DeltaTime);
+		StressTest->Tick(DeltaTime);
+	}
+
+	TestTrue(TEXT("Stress test finished"), StressTest->IsFinished());
+	TestEqual(TEXT("Recorded frames"), StressTest->GetNumRecordedFrames(), StressTest->NumFrames);
+	TestFalse(TEXT("Recording frame timings once finished"), AIManager->IsRecordingFrameTimings());
+	TestTrue(TEXT("Own AI manager cleaned up"), AIManager->IsPendingKill());
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathAIEQSContextCacheTest, "Empath.AI.EQSContextCache", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEmpathAIEQSContextCacheTest::RunTest(const FString& Parameters)
+{
+	FEmpathTestWorld TestWorld;
+	AEmpathAIManager* const AIManager = TestWorld.SpawnAIManager();
+	AEmpathAIController* const AI = TestWorld.SpawnAI(AIManager, FVector::ZeroVector, FRotator::ZeroRotator, AEmpathCharacter::StaticClass());
+	AEmpathCharacter* const Querier = Cast<AEmpathCharacter>(AI->GetPawn());
+	UBlackboardComponent* BlackboardComp = nullptr;
+	TestTrue(TEXT("AI uses the target blackboard"), AI->UseBlackboard(MakeTargetBlackboard(), BlackboardComp));
+	if (!Querier || !BlackboardComp)
+	{
+		AddError(TEXT("Could not set up an AI character with a blackboard."));
+		return false;
+	}
+
+	UClass* const LastKnownClass = UEQC_LastKnownPlayerLocation::StaticClass();
+	UClass* const PlayerClass = UEQC_PlayerLocation::StaticClass();
+	AIManager->CacheEQSContext(LastKnownClass, Querier, FEmpathEQSContextCacheEntry(FVector(100.0f, 0.0f, 0.0f)));
+	AIManager->CacheEQSContext(PlayerClass, Querier, FEmpathEQSContextCacheEntry(FVector(200.0f, 0.0f, 0.0f)));
+
+	FEmpathEQSContextCacheEntry Entry;
+	TestTrue(TEXT("Last known location is cached"), AIManager->GetCachedEQSContext(LastKnownClass, Querier, Entry));
+	TestEqual(TEXT("Cached last known location"), Entry.Location, FVector(100.0f, 0.0f, 0.0f));
+
+	// A new last known location only throws away that context's values
+	AIManager->InvalidateEQSContextCacheForContext(LastKnownClass);
+	TestFalse(TEXT("Last known location is cached after invalidating it"), AIManager->GetCachedEQSContext(LastKnownClass, Querier, Entry));
+	TestTrue(TEXT("Player location is cached after invalidating the last known location"), AIManager->GetCachedEQSContext(PlayerClass, Querier, Entry));
+	AIManager->InvalidateEQSContextCache();
+
+	// The frame counter does not advance here, so every query below runs in the same frame.
+	// Each target context is reused until the AI sets a new target through its own setter.
+	struct FTargetContext
+	{
+		UClass* ContextClass;
+		FName BlackboardKey;
+		void (AEmpathAIController::*SetTarget)(AActor*);
+	};
+	FTargetContext const TargetContexts[] =
+	{
+		{ UEQC_AttackTarget::StaticClass(), FEmpathBBKeys::AttackTarget, &AEmpathAIController::SetAttackTarget },
+		{ UEQC_DefendTarget::StaticClass(), FEmpathBBKeys::DefendTarget, &AEmpathAIController::SetDefendTarget },
+		{ UEQC_FleeTarget::StaticClass(), FEmpathBBKeys::FleeTarget, &AEmpathAIController::SetFleeTarget }
+	};
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	for (FTargetContext const& TargetContext : TargetContexts)
+	{
+		FString const ContextName = TargetContext.ContextClass->GetName();
+		AActor* Targets[3];
+		for (AActor*& Target : Targets)
+		{
+			Target = TestWorld.GetWorld()->SpawnActor<AActor>(SpawnParams);
+		}
+
+		(AI->*TargetContext.SetTarget)(Targets[0]);
+		int32 StartHits, StartMisses;
+		AIManager->GetEQSContextCacheStats(StartHits, StartMisses);
+		TestTrue(FString::Printf(TEXT("%s provides the first target"), *ContextName), ProvideContextActor(TargetContext.ContextClass, Querier) == Targets[0]);
+
+		// Changing the blackboard behind the AI's back is not seen until the next frame
+		BlackboardComp->SetValueAsObject(TargetContext.BlackboardKey, Targets[1]);
+		TestTrue(FString::Printf(TEXT("%s reuses the first target within the frame"), *ContextName), ProvideContextActor(TargetContext.ContextClass, Querier) == Targets[0]);
+		int32 Hits, Misses;
+		AIManager->GetEQSContextCacheStats(Hits, Misses);
+		TestEqual(FString::Printf(TEXT("%s cache hits"), *ContextName), Hits - StartHits, 1);
+		TestEqual(FString::Printf(TEXT("%s cache misses"), *ContextName), Misses - StartMisses, 1);
+
+		(AI->*TargetContext.SetTarget)(Targets[2]);
+		TestTrue(FString::Printf(TEXT("%s provides the target set later in the frame"), *ContextName), ProvideContextActor(TargetContext.ContextClass, Querier) == Targets[2]);
+
+		// A destroyed target is never handed out from the cache
+		Targets[2]->Destroy();
+		TestTrue(FString::Printf(TEXT("%s provides no target once it is destroyed"), *ContextName), ProvideContextActor(TargetContext.ContextClass, Querier) == nullptr);
+		(AI->*TargetContext.SetTarget)(Targets[0]);
+	}
+
+	// The player location is reused until the player teleports
+	APlayerController* const PlayerCon = TestWorld.GetWorld()->SpawnActor<APlayerController>(SpawnParams);
+	AEmpathPlayerCharacter* const Player = TestWorld.GetWorld()->SpawnActor<AEmpathPlayerCharacter>(FVector(1000.0f, 0.0f, 0.0f), FRotator::ZeroRotator, SpawnParams);
+	PlayerCon->Possess(Player);
+	FVector const PlayerOrigin = Player->GetVRLocation();
+	TestEqual(TEXT("Player location"), ProvideContextLocation(PlayerClass, Querier), PlayerOrigin);
+	Player->SetActorLocation(FVector(0.0f, 1000.0f, 0.0f));
+	FVector const PlayerDestination = Player->GetVRLocation();
+	TestEqual(TEXT("Player location after walking within the frame"), ProvideContextLocation(PlayerClass, Querier), PlayerOrigin);
+	ProvideContext(UEQC_AttackTarget::StaticClass(), Querier);
+	TestTrue(TEXT("Attack target is cached before the player teleports"), AIManager->GetCachedEQSContext(UEQC_AttackTarget::StaticClass(), Querier, Entry));
+	AIManager->OnPlayerTeleported(Player, PlayerOrigin, PlayerDestination, PlayerDestination - PlayerOrigin);
+	TestFalse(TEXT("Attack target is cached after the player teleports"), AIManager->GetCachedEQSContext(UEQC_AttackTarget::StaticClass(), Querier, Entry));
+	TestEqual(TEXT("Player location after teleporting"), ProvideContextLocation(PlayerClass, Querier), PlayerDestination);
+
+	// The last known location is reused until the AIs learn a new one
+	AIManager->UpdateKnownTargetLocation(Player);
+	TestEqual(TEXT("Last known player location"), ProvideContextLocation(LastKnownClass, Querier), PlayerDestination);
+	Player->SetActorLocation(FVector(-1000.0f, 0.0f, 0.0f));
+	TestEqual(TEXT("Last known player location before it is updated"), ProvideContextLocation(LastKnownClass, Querier), PlayerDestination);
+	AIManager->UpdateKnownTargetLocation(Player);
+	TestEqual(TEXT("Last known player location after it is updated"), ProvideContextLocation(LastKnownClass, Querier), Player->GetVRLocation());
+	TestTrue(TEXT("Player location is cached after updating the last known location"), AIManager->GetCachedEQSContext(PlayerClass, Querier, Entry));
+
+	// Everything goes when the player dies
+	AIManager->OnPlayerDied(FHitResult(), FVector::ZeroVector, nullptr, nullptr, nullptr);
+	TestFalse(TEXT("Player location is cached after the player dies"), AIManager->GetCachedEQSContext(PlayerClass, Querier, Entry));
+	TestFalse(TEXT("Last known player location is cached after the player dies"), AIManager->GetCachedEQSContext(LastKnownClass, Querier, Entry));
+	TestEqual(TEXT("Player location after the player dies"), ProvideContextLocation(PlayerClass, Querier), Player->GetVRLocation());
+
+	// The nav recovery start location is the AI's own until it starts recovering, and is reused until then
+	UClass* const NavRecoveryClass = UEQC_NavRecoveryStartLocation::StaticClass();
+	FVector const QuerierOrigin = Querier->GetActorLocation();
+	TestEqual(TEXT("Nav recovery start location while navigating"), ProvideContextLocation(NavRecoveryClass, Querier), QuerierOrigin);
+	Querier->SetActorLocation(QuerierOrigin + FVector(500.0f, 0.0f, 0.0f));
+	TestEqual(TEXT("Nav recovery start location after moving within the frame"), ProvideContextLocation(NavRecoveryClass, Querier), QuerierOrigin);
+	AddExpectedError(TEXT("Failed Navigation"), EAutomationExpectedErrorFlags::Contains, 1);
+	Querier->OnStartNavRecovery(FVector(5000.0f, 0.0f, 0.0f), true);
+	TestTrue(TEXT("AI is recovering"), Querier->IsFailingNavigation());
+	TestEqual(TEXT("Nav recovery start location after starting recovery"), ProvideContextLocation(NavRecoveryClass, Querier), Querier->NavRecoveryStartPathingLocation);
+
+	// The AI's values go when it dies, as it is no longer registered to clear them
+	AActor* const AttackTarget = AI->GetAttackTarget();
+	TestTrue(TEXT("Attack target before the AI dies"), AttackTarget && ProvideContextActor(UEQC_AttackTarget::StaticClass(), Querier) == AttackTarget);
+	Querier->Die(FHitResult(), FVector::ZeroVector, nullptr, nullptr, nullptr);
+	TestFalse(TEXT("Attack target is cached after the AI dies"), AIManager->GetCachedEQSContext(UEQC_AttackTarget::StaticClass(), Querier, Entry));
+	TestFalse(TEXT("Nav recovery start location is cached after the AI dies"), AIManager->GetCachedEQSContext(NavRecoveryClass, Querier, Entry));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,86 @@
+// Copyright 2018 Team Empath All Rights Reserved
+
+#include "EmpathTypes.h"
+#include "Curves/CurveFloat.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** Makes a curve from linearly interpolated keys. */
+	UCurveFloat* MakeLinearCurve(TArray<FVector2D> const& Keys)
+	{
+		UCurveFloat* const Curve = NewObject<UCurveFloat>();
+		for (FVector2D const& Key : Keys)
+		{
+			FKeyHandle const Handle = Curve->FloatCurve.AddKey(Key.X, Key.Y);
+			Curve->FloatCurve.SetKeyInterpMode(Handle, RCIM_Linear);
+		}
+		return Curve;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathCurveLUTMaxErrorTest, "Empath.AI.CurveLUTMaxError", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEmpathCurveLUTMaxErrorTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(2018);
+	int32 const NumSamples = 256;
+	float const MaxAllowedError = 0.005f;
+
+	// An angle score that falls off quickly in front of the AI, where a table spaced evenly by cosine is several degrees wide
+	UCurveFloat* const AngleCurve = MakeLinearCurve({ FVector2D(0.0f, 1.0f), FVector2D(45.0f, 0.5f), FVector2D(180.0f, 0.0f) });
+	FEmpathCurveLUT AngleLUT;
+	float const AngleBakeError = AngleLUT.BakeByCosine(AngleCurve, NumSamples);
+	TestTrue(FString::Printf(TEXT("Angle table bake error %f is within %f"), AngleBakeError, MaxAllowedError), AngleBakeError <= MaxAllowedError);
+
+	// Check random angles everywhere, and densely within a few degrees of straight ahead and straight behind
+	float WorstAngleError = 0.0f;
+	for (int32 Idx = 0; Idx < 10000; ++Idx)
+	{
+		float Angle = Random.FRandRange(0.0f, 180.0f);
+		if (Idx % 3 == 1)
+		{
+			Angle = Random.FRandRange(0.0f, 5.0f);
+		}
+		else if (Idx % 3 == 2)
+		{
+			Angle = Random.FRandRange(175.0f, 180.0f);
+		}
+		float const Expected = AngleCurve->GetFloatValue(Angle);
+		float const Actual = AngleLUT.Evaluate(FMath::Cos(FMath::DegreesToRadians(Angle)));
+		WorstAngleError = FMath::Max(WorstAngleError, FMath::Abs(Actual - Expected));
+	}
+	TestTrue(FString::Printf(TEXT("Angle table error %f is within %f"), WorstAngleError, MaxAllowedError), WorstAngleError <= MaxAllowedError);
+
+	// Cosines slightly outside the valid range from rounding must still evaluate to the ends of the curve
+	TestEqual(TEXT("Angle table just above a cosine of 1"), AngleLUT.Evaluate(1.0001f), 1.0f, MaxAllowedError);
+	TestEqual(TEXT("Angle table just below a cosine of -1"), AngleLUT.Evaluate(-1.0001f), 0.0f, MaxAllowedError);
+
+	// A distance score, which is keyed by the curve's own time and extrapolated outside of it
+	UCurveFloat* const DistCurve = MakeLinearCurve({ FVector2D(0.0f, 1.0f), FVector2D(500.0f, 0.8f), FVector2D(3000.0f, 0.0f) });
+	FEmpathCurveLUT DistLUT;
+	float const DistBakeError = DistLUT.Bake(DistCurve, NumSamples);
+	TestTrue(FString::Printf(TEXT("Distance table bake error %f is within %f"), DistBakeError, MaxAllowedError), DistBakeError <= MaxAllowedError);
+
+	float WorstDistError = 0.0f;
+	for (int32 Idx = 0; Idx < 10000; ++Idx)
+	{
+		float const Dist = Random.FRandRange(0.0f, 4000.0f);
+		WorstDistError = FMath::Max(WorstDistError, FMath::Abs(DistLUT.Evaluate(Dist) - DistCurve->GetFloatValue(Dist)));
+	}
+	TestTrue(FString::Printf(TEXT("Distance table error %f is within %f"), WorstDistError, MaxAllowedError), WorstDistError <= MaxAllowedError);
+
+	// Everyone asking for the same curve gets the same table, and different settings get their own
+	TSharedPtr<FEmpathCurveLUT const> const SharedLUT = FEmpathCurveLUT::FindOrBake(AngleCurve, NumSamples, true);
+	TestTrue(TEXT("Shared table is baked"), SharedLUT.IsValid() && SharedLUT->IsBaked());
+	TestTrue(TEXT("Same curve and settings share a table"), SharedLUT == FEmpathCurveLUT::FindOrBake(AngleCurve, NumSamples, true));
+	TestTrue(TEXT("Different sample counts get their own table"), SharedLUT != FEmpathCurveLUT::FindOrBake(AngleCurve, NumSamples * 2, true));
+	TestFalse(TEXT("No curve gives no table"), FEmpathCurveLUT::FindOrBake(nullptr, NumSamples, true).IsValid());
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,274 @@
+// Copyright 2018 Team Empath All Rights Reserved
+
+#include "EmpathTestWorld.h"
+#include "EmpathEnvQueryTest_Dot.h"
+#include "EmpathEnvQueryTest_DotReference.h"
+#include "EmpathCharacter.h"
+#include "EnvironmentQuery/EnvQuery.h"
+#include "EnvironmentQuery/EnvQueryOption.h"
+#include "EnvironmentQuery/EnvQueryManager.h"
+#include "EnvironmentQuery/Generators/EnvQueryGenerator_SimpleGrid.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** 
+	* Makes a query scoring a grid of points around the querier with the Empath dot test between the querier's facing and the direction to each point. 
+	* The test class can be swapped for the per item reference to compare against it.
+	*/
+	UEnvQuery* MakeDotQuery(EEnvTestDot TestMode, bool bAbsoluteValue, float GridSize, TSubclassOf<UEmpathEnvQueryTest_Dot> TestClass = UEmpathEnvQueryTest_Dot::StaticClass())
+	{
+		// Each query gets its own name, as the query manager caches its instances by name
+		UEnvQuery* const Query = NewObject<UEnvQuery>(GetTransientPackage(), MakeUniqueObjectName(GetTransientPackage(), UEnvQuery::StaticClass(), TEXT("EmpathDotTestQuery")));
+		UEnvQueryOption* const Option = NewObject<UEnvQueryOption>(Query);
+
+		UEnvQueryGenerator_SimpleGrid* const Generator = NewObject<UEnvQueryGenerator_SimpleGrid>(Option);
+		Generator->GridSize.DefaultValue = GridSize;
+		Generator->SpaceBetween.DefaultValue = 100.0f;
+		Generator->ProjectionData.TraceMode = EEnvQueryTrace::None;
+		Option->Generator = Generator;
+
+		UEmpathEnvQueryTest_Dot* const DotTest = NewObject<UEmpathEnvQueryTest_Dot>(Option, TestClass);
+		DotTest->TestPurpose = EEnvTestPurpose::Score;
+		*FindField<UProperty>(UEmpathEnvQueryTest_Dot::StaticClass(), TEXT("TestMode"))->ContainerPtrToValuePtr<EEnvTestDot>(DotTest) = TestMode;
+		FindField<UBoolProperty>(UEmpathEnvQueryTest_Dot::StaticClass(), TEXT("bAbsoluteValue"))->SetPropertyValue_InContainer(DotTest, bAbsoluteValue);
+		Option->Tests.Add(DotTest);
+
+		Query->GetOptionsMutable().Add(Option);
+		return Query;
+	}
+
+	/** Spawns a querier facing up and to the side, so that the 2D and 3D dots differ. */
+	APawn* SpawnQuerier(FEmpathTestWorld const& TestWorld)
+	{
+		return TestWorld.GetWorld()->SpawnActor<ADefaultPawn>(FVector(150.0f, -80.0f, 20.0f), FRotator(25.0f, 40.0f, 0.0f));
+	}
+
+	UEnvQueryManager* GetQueryManager(FEmpathTestWorld const& TestWorld)
+	{
+		if (!TestWorld.GetWorld()->GetAISystem())
+		{
+			TestWorld.GetWorld()->CreateAISystem();
+		}
+		return UEnvQueryManager::GetCurrent(TestWorld.GetWorld());
+	}
+
+	/** Runs the query repeatedly, returning how many items were scored and how long it took. */
+	void TimeDotQuery(UEnvQueryManager* QueryManager, FEnvQueryRequest& QueryRequest, int32 NumRuns, int32& OutNumItems, double& OutElapsedMs)
+	{
+		OutNumItems = 0;
+		double const StartTime = FPlatformTime::Seconds();
+		for (int32 RunIdx = 0; RunIdx < NumRuns; ++RunIdx)
+		{
+			TSharedPtr<FEnvQueryResult> const Result = QueryManager->RunInstantQuery(QueryRequest, EEnvQueryRunMode::AllMatching);
+			if (Result.IsValid())
+			{
+				OutNumItems += Result->Items.Num();
+			}
+		}
+		OutElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathEQSDotTestScoresTest, "Empath.AI.EQSDotTestScores", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEmpathEQSDotTestScoresTest::RunTest(const FString& Parameters)
+{
+	FEmpathTestWorld TestWorld;
+	UEnvQueryManager* const QueryManager = GetQueryManager(TestWorld);
+	TestNotNull(TEXT("EQS manager"), QueryManager);
+	APawn* const Querier = SpawnQuerier(TestWorld);
+	if (!QueryManager || !Querier)
+	{
+		return false;
+	}
+
+	FVector const QuerierLocation = Querier->GetActorLocation();
+	FVector const QuerierForward = Querier->GetActorRotation().Vector();
+	struct FDotTestCase
+	{
+		EEnvTestDot TestMode;
+		bool bAbsoluteValue;
+		TCHAR const* Name;
+	};
+	FDotTestCase const TestCases[] = {
+		{ EEnvTestDot::Dot3D, false, TEXT("3D") },
+		{ EEnvTestDot::Dot2D, false, TEXT("2D") },
+		{ EEnvTestDot::Dot3D, true, TEXT("Absolute 3D") },
+		{ EEnvTestDot::Dot2D, true, TEXT("Absolute 2D") },
+	};
+
+	for (FDotTestCase const& TestCase : TestCases)
+	{
+		TSharedPtr<FEnvQueryResult> const Result = QueryManager->RunInstantQuery(FEnvQueryRequest(MakeDotQuery(TestCase.TestMode, TestCase.bAbsoluteValue, 1000.0f), Querier), EEnvQueryRunMode::AllMatching);
+		TestTrue(FString::Printf(TEXT("%s: Query returned items"), TestCase.Name), Result.IsValid() && Result->Items.Num() > 1);
+		if (!Result.IsValid() || Result->Items.Num() <= 1)
+		{
+			continue;
+		}
+
+		// Work out each item's dot the long way
+		TArray<float> Expected;
+		for (int32 Idx = 0; Idx < Result->Items.Num(); ++Idx)
+		{
+			FVector const ToItem = Result->GetItemAsLocation(Idx) - QuerierLocation;
+			float Dot = (TestCase.TestMode == EEnvTestDot::Dot2D)
+				? FVector::DotProduct(QuerierForward.GetSafeNormal2D(), ToItem.GetSafeNormal2D())
+				: FVector::DotProduct(QuerierForward, ToItem.GetSafeNormal());
+			Expected.Add(TestCase.bAbsoluteValue ? FMath::Abs(Dot) : Dot);
+		}
+
+		// The query normalizes the scores, so they should be the dots scaled and offset by the same amounts
+		int32 MinIdx = 0;
+		int32 MaxIdx = 0;
+		for (int32 Idx = 1; Idx < Expected.Num(); ++Idx)
+		{
+			MinIdx = (Expected[Idx] < Expected[MinIdx]) ? Idx : MinIdx;
+			MaxIdx = (Expected[Idx] > Expected[MaxIdx]) ? Idx : MaxIdx;
+		}
+		float const ExpectedRange = Expected[MaxIdx] - Expected[MinIdx];
+		TestTrue(FString::Printf(TEXT("%s: Items have different dots"), TestCase.Name), ExpectedRange > KINDA_SMALL_NUMBER);
+		if (ExpectedRange <= KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+		float const Scale = (Result->GetItemScore(MaxIdx) - Result->GetItemScore(MinIdx)) / ExpectedRange;
+		TestTrue(FString::Printf(TEXT("%s: Better dots score higher"), TestCase.Name), Scale > 0.0f);
+		for (int32 Idx = 0; Idx < Expected.Num(); ++Idx)
+		{
+			float const ExpectedScore = Result->GetItemScore(MinIdx) + (Expected[Idx] - Expected[MinIdx]) * Scale;
+			TestEqual(FString::Printf(TEXT("%s: Score of item at %s"), TestCase.Name, *Result->GetItemAsLocation(Idx).ToString()), Result->GetItemScore(Idx), ExpectedScore, 1.e-3f);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathEQSDotTestBenchmark, "Empath.AI.EQSDotTestBenchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FEmpathEQSDotTestBenchmark::RunTest(const FString& Parameters)
+{
+	FEmpathTestWorld TestWorld;
+	UEnvQueryManager* const QueryManager = GetQueryManager(TestWorld);
+	TestNotNull(TEXT("EQS manager"), QueryManager);
+	APawn* const Querier = SpawnQuerier(TestWorld);
+	if (!QueryManager || !Querier)
+	{
+		return false;
+	}
+
+	// Roughly the size of a reposition query, scored by the batched test and by the per item reference it replaced
+	FEnvQueryRequest QueryRequest(MakeDotQuery(EEnvTestDot::Dot3D, false, 1100.0f), Querier);
+	FEnvQueryRequest ReferenceQueryRequest(MakeDotQuery(EEnvTestDot::Dot3D, false, 1100.0f, UEmpathEnvQueryTest_DotReference::StaticClass()), Querier);
+
+	// Run each once first so the query manager has cached their instances, and check that they agree
+	TSharedPtr<FEnvQueryResult> const Result = QueryManager->RunInstantQuery(QueryRequest, EEnvQueryRunMode::AllMatching);
+	TSharedPtr<FEnvQueryResult> const ReferenceResult = QueryManager->RunInstantQuery(ReferenceQueryRequest, EEnvQueryRunMode::AllMatching);
+	TestTrue(TEXT("Benchmark queries returned items"), Result.IsValid() && ReferenceResult.IsValid() && Result->Items.Num() > 0);
+	if (!Result.IsValid() || !ReferenceResult.IsValid())
+	{
+		return false;
+	}
+	TestEqual(TEXT("Items scored by the reference"), ReferenceResult->Items.Num(), Result->Items.Num());
+
+	// Items with nearly equal scores may be sorted differently, so match them up by location
+	for (int32 Idx = 0; Idx < Result->Items.Num(); ++Idx)
+	{
+		FVector const ItemLocation = Result->GetItemAsLocation(Idx);
+		int32 ReferenceIdx = 0;
+		while (ReferenceIdx < ReferenceResult->Items.Num() && !ReferenceResult->GetItemAsLocation(ReferenceIdx).Equals(ItemLocation))
+		{
+			++ReferenceIdx;
+		}
+		if (ReferenceIdx == ReferenceResult->Items.Num() || !FMath::IsNearlyEqual(Result->GetItemScore(Idx), ReferenceResult->GetItemScore(ReferenceIdx), 1.e-3f))
+		{
+			AddError(FString::Printf(TEXT("Item at %s scored %f, but the reference scored %f."), *ItemLocation.ToString(),
+				Result->GetItemScore(Idx), ReferenceIdx < ReferenceResult->Items.Num() ? ReferenceResult->GetItemScore(ReferenceIdx) : 0.0f));
+			break;
+		}
+	}
+
+	int32 const NumRuns = 200;
+	int32 NumItems = 0;
+	double ElapsedMs = 0.0;
+	TimeDotQuery(QueryManager, QueryRequest, NumRuns, NumItems, ElapsedMs);
+	int32 NumReferenceItems = 0;
+	double ReferenceElapsedMs = 0.0;
+	TimeDotQuery(QueryManager, ReferenceQueryRequest, NumRuns, NumReferenceItems, ReferenceElapsedMs);
+
+	AddInfo(FString::Printf(TEXT("Empath dot test query: %d runs, %d items in %.3f ms, %.1f items per ms"),
+		NumRuns, NumItems, ElapsedMs, ElapsedMs > 0.0 ? NumItems / ElapsedMs : 0.0));
+	AddInfo(FString::Printf(TEXT("Per item reference query: %d runs, %d items in %.3f ms, %.1f items per ms"),
+		NumRuns, NumReferenceItems, ReferenceElapsedMs, ReferenceElapsedMs > 0.0 ? NumReferenceItems / ReferenceElapsedMs : 0.0));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathEQSSchedulerTest, "Empath.AI.EQSScheduler", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEmpathEQSSchedulerTest::RunTest(const FString& Parameters)
+{
+	FEmpathTestWorld TestWorld;
+	UEnvQueryManager* const QueryManager = GetQueryManager(TestWorld);
+	TestNotNull(TEXT("EQS manager"), QueryManager);
+	if (!QueryManager)
+	{
+		return false;
+	}
+
+	// Schedule queries, but only let two run at once
+	AEmpathAIManager* const AIManager = TestWorld.SpawnAIManager();
+	FindField<UBoolProperty>(AEmpathAIManager::StaticClass(), TEXT("bUseEQSScheduler"))->SetPropertyValue_InContainer(AIManager, true);
+	FindField<UIntProperty>(AEmpathAIManager::StaticClass(), TEXT("MaxRunningEQSQueries"))->SetPropertyValue_InContainer(AIManager, 2);
+
+	UEnvQuery* const Query = MakeDotQuery(EEnvTestDot::Dot3D, false, 500.0f);
+	TArray<AEmpathAIController*> AIs;
+	for (int32 Idx = 0; Idx < 5; ++Idx)
+	{
+		AEmpathAIController* const AI = TestWorld.SpawnAI(AIManager, FVector(Idx * 1000.0f, 0.0f, 0.0f), FRotator::ZeroRotator, AEmpathCharacter::StaticClass());
+		AI->RunRepositionQuery(Query);
+		AIs.Add(AI);
+	}
+
+	auto CountRunning = [&AIs]()
+	{
+		int32 NumRunning = 0;
+		for (AEmpathAIController const* const AI : AIs)
+		{
+			NumRunning += AI->IsRepositionQueryRunning() ? 1 : 0;
+		}
+		return NumRunning;
+	};
+
+	// Queries run in the EQS manager's tick, so starting them doesn't answer them
+	AIManager->Tick(0.0f);
+	TestEqual(TEXT("Queries running after the first AI manager tick"), CountRunning(), 2);
+	AIManager->Tick(0.0f);
+	TestEqual(TEXT("Queries running while the first ones are in flight"), CountRunning(), 2);
+
+	// Finished queries free up the budget for the AIs still waiting
+	int32 NumAnswered = 0;
+	for (int32 Frame = 0; Frame < 100 && NumAnswered < AIs.Num(); ++Frame)
+	{
+		QueryManager->Tick(0.1f);
+		AIManager->Tick(0.0f);
+		TestTrue(TEXT("Never more than two queries running"), CountRunning() <= 2);
+
+		NumAnswered = 0;
+		for (AEmpathAIController const* const AI : AIs)
+		{
+			NumAnswered += (AI->HasRepositionQueryResult() && !AI->IsRepositionQueryRunning()) ? 1 : 0;
+		}
+	}
+	TestEqual(TEXT("AIs given a reposition result"), NumAnswered, AIs.Num());
+
+	// Aborting a query frees its slot without answering it
+	AIs[0]->StartRepositionQuery(Query);
+	TestTrue(TEXT("Query running after starting it"), AIs[0]->IsRepositionQueryRunning());
+	AIs[0]->AbortRepositionQuery();
+	TestFalse(TEXT("Query running after aborting it"), AIs[0]->IsRepositionQueryRunning());
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
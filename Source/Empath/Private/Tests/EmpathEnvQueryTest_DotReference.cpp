@@ -0,0 +1,93 @@
+// Copyright 2018 Team Empath All Rights Reserved
+
+#include "EmpathEnvQueryTest_DotReference.h"
+
+void UEmpathEnvQueryTest_DotReference::RunTest(FEnvQueryInstance& QueryInstance) const
+{
+	UObject* QueryOwner = QueryInstance.Owner.Get();
+	if (QueryOwner == nullptr)
+	{
+		return;
+	}
+
+	FloatValueMin.BindData(QueryOwner, QueryInstance.QueryID);
+	float MinThresholdValue = FloatValueMin.GetValue();
+
+	FloatValueMax.BindData(QueryOwner, QueryInstance.QueryID);
+	float MaxThresholdValue = FloatValueMax.GetValue();
+
+	// gather all possible directions: for contexts different than Item
+	TArray<FVector> LineADirs;
+	const bool bUpdateLineAPerItem = RequiresPerItemUpdates(LineA.LineFrom, LineA.LineTo, LineA.Rotation, LineA.DirMode == EEnvDirection::Rotation);
+	if (!bUpdateLineAPerItem)
+	{
+		GatherLineDirections(LineADirs, QueryInstance, LineA.LineFrom, LineA.LineTo, LineA.Rotation, LineA.DirMode == EEnvDirection::Rotation);
+		if (LineADirs.Num() == 0)
+		{
+			return;
+		}
+	}
+
+	TArray<FVector> LineBDirs;
+	const bool bUpdateLineBPerItem = RequiresPerItemUpdates(LineB.LineFrom, LineB.LineTo, LineB.Rotation, LineB.DirMode == EEnvDirection::Rotation);
+	if (!bUpdateLineBPerItem)
+	{
+		GatherLineDirections(LineBDirs, QueryInstance, LineB.LineFrom, LineB.LineTo, LineB.Rotation, LineB.DirMode == EEnvDirection::Rotation);
+		if (LineBDirs.Num() == 0)
+		{
+			return;
+		}
+	}
+
+	// loop through all items
+	for (FEnvQueryInstance::ItemIterator It(this, QueryInstance); It; ++It)
+	{
+		// update lines for contexts using current item
+		if (bUpdateLineAPerItem || bUpdateLineBPerItem)
+		{
+			const FVector ItemLocation = (LineA.DirMode == EEnvDirection::Rotation && LineB.DirMode == EEnvDirection::Rotation) ? FVector::ZeroVector : GetItemLocation(QueryInstance, It.GetIndex());
+			const FRotator ItemRotation = (LineA.DirMode == EEnvDirection::Rotation || LineB.DirMode == EEnvDirection::Rotation) ? GetItemRotation(QueryInstance, It.GetIndex()) : FRotator::ZeroRotator;
+
+			if (bUpdateLineAPerItem)
+			{
+				LineADirs.Reset();
+				GatherLineDirections(LineADirs, QueryInstance, LineA.LineFrom, LineA.LineTo, LineA.Rotation, LineA.DirMode == EEnvDirection::Rotation, ItemLocation, ItemRotation);
+			}
+
+			if (bUpdateLineBPerItem)
+			{
+				LineBDirs.Reset();
+				GatherLineDirections(LineBDirs, QueryInstance, LineB.LineFrom, LineB.LineTo, LineB.Rotation, LineB.DirMode == EEnvDirection::Rotation, ItemLocation, ItemRotation);
+			}
+		}
+
+		// perform test for each line pair
+		for (int32 LineAIndex = 0; LineAIndex < LineADirs.Num(); LineAIndex++)
+		{
+			for (int32 LineBIndex = 0; LineBIndex < LineBDirs.Num(); LineBIndex++)
+			{
+				float DotValue = 0.f;
+				switch (TestMode)
+				{
+				case EEnvTestDot::Dot3D:
+					DotValue = FVector::DotProduct(LineADirs[LineAIndex], LineBDirs[LineBIndex]);
+					break;
+
+				case EEnvTestDot::Dot2D:
+					DotValue = LineADirs[LineAIndex].CosineAngle2D(LineBDirs[LineBIndex]);
+					break;
+
+				default:
+					UE_LOG(LogEQS, Error, TEXT("Invalid TestMode in EmpathEnvQueryTest_DotReference in query %s!"), *QueryInstance.QueryName);
+					break;
+				}
+
+				if (bAbsoluteValue)
+				{
+					DotValue = FMath::Abs(DotValue);
+				}
+				It.SetScore(TestPurpose, FilterType, DotValue, MinThresholdValue, MaxThresholdValue);
+			}
+		}
+	}
+}
@@ -0,0 +1,19 @@
+// Copyright 2018 Team Empath All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EmpathEnvQueryTest_Dot.h"
+#include "EmpathEnvQueryTest_DotReference.generated.h"
+
+// The Empath dot test as it scored before batching, gathering and scoring one item at a time.
+// Only used by the automation tests as a baseline for the batched test.
+
+UCLASS(HideDropdown)
+class UEmpathEnvQueryTest_DotReference : public UEmpathEnvQueryTest_Dot
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void RunTest(FEnvQueryInstance& QueryInstance) const override;
+};
@@ -0,0 +1,231 @@
+// Copyright 2018 Team Empath All Rights Reserved
+
+#include "EmpathTypes.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/IConsoleManager.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** Makes a condition with a random check, operation, and threshold. */
+	template <typename ConditionType>
+	ConditionType MakeRandomCondition(FRandomStream& Random)
+	{
+		ConditionType Condition;
+		Condition.ConditionCheckType = (Random.FRand() < 0.1f ? EEmpathGestureConditionCheckType::AutoSuccess
+			: (EEmpathGestureConditionCheckType)Random.RandRange(1, (int32)EEmpathGestureConditionCheckType::InteriorAngleToOtherHand));
+		Condition.VelocityCheckType = (Random.FRand() < 0.5f ? EEmpathVelocityCheckType::BufferedAverage : EEmpathVelocityCheckType::LastFrameOnly);
+		Condition.CheckOperationType = (EEmpathBinaryOperation)Random.RandRange(0, (int32)EEmpathBinaryOperation::Equal);
+		Condition.ThresholdValue = Random.FRandRange(-500.0f, 500.0f);
+		return Condition;
+	}
+
+	/** Leaf conditions have no sub-conditions. */
+	void AddRandomSubConditions(FRandomStream& Random, FEmpathGestureCondition& Condition)
+	{}
+
+	/** Adds up to two strong and two weak sub-conditions, all the way down the tree. */
+	template <typename ConditionType>
+	void AddRandomSubConditions(FRandomStream& Random, ConditionType& Condition)
+	{
+		typedef typename decltype(Condition.StrongSubConditions)::ElementType SubConditionType;
+		for (int32 Num = Random.RandRange(0, 2); Num > 0; --Num)
+		{
+			SubConditionType SubCondition = MakeRandomCondition<SubConditionType>(Random);
+			AddRandomSubConditions(Random, SubCondition);
+			Condition.StrongSubConditions.Add(SubCondition);
+		}
+		for (int32 Num = Random.RandRange(0, 2); Num > 0; --Num)
+		{
+			SubConditionType SubCondition = MakeRandomCondition<SubConditionType>(Random);
+			AddRandomSubConditions(Random, SubCondition);
+			Condition.WeakSubConditions.Add(SubCondition);
+		}
+	}
+
+	/** Makes a random condition tree, inverted for the left hand half of the time. */
+	FEmpathGestureCondition01 MakeRandomConditionTree(FRandomStream& Random)
+	{
+		FEmpathGestureCondition01 Conditions = MakeRandomCondition<FEmpathGestureCondition01>(Random);
+		AddRandomSubConditions(Random, Conditions);
+		if (Random.FRand() < 0.5f)
+		{
+			Conditions.InvertHand();
+			Conditions.InvertSubConditions();
+		}
+		return Conditions;
+	}
+
+	/**
+	* Fills both gesture checks with random values, then places about half of the values tested by the program
+	* on or just around their thresholds, where the results are most likely to differ.
+	*/
+	void MakeRandomGestureChecks(FRandomStream& Random, const FEmpathGestureConditionProgram& Program, FEmpathGestureCheck (&OutChecks)[2])
+	{
+		static_assert(sizeof(FEmpathGestureCheck) % sizeof(float) == 0, "FEmpathGestureCheck is expected to contain only floats.");
+		int32 const NumFloats = sizeof(FEmpathGestureCheck) / sizeof(float);
+		for (FEmpathGestureCheck& Check : OutChecks)
+		{
+			float* Values = reinterpret_cast<float*>(&Check);
+			for (int32 Idx = 0; Idx < NumFloats; ++Idx)
+			{
+				Values[Idx] = Random.FRandRange(-1000.0f, 1000.0f);
+			}
+		}
+
+		float const Offsets[] = { 0.0f, KINDA_SMALL_NUMBER, -KINDA_SMALL_NUMBER, SMALL_NUMBER * 0.5f, -SMALL_NUMBER * 0.5f, 1.0f, -1.0f };
+		for (const FEmpathGestureInstruction& Instruction : Program.Instructions)
+		{
+			if (Instruction.Opcode == EEmpathGestureOpcode::AutoSuccess || Instruction.Opcode == EEmpathGestureOpcode::AutoFail || Random.FRand() < 0.5f)
+			{
+				continue;
+			}
+			float* Value = reinterpret_cast<float*>(reinterpret_cast<uint8*>(&OutChecks[Instruction.CheckIdx]) + Instruction.OperandOffset);
+			*Value = Instruction.Threshold + Offsets[Random.RandHelper(ARRAY_COUNT(Offsets))];
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathGestureConditionProgramTest, "Empath.Player.GestureConditionPrograms", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEmpathGestureConditionProgramTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(1337);
+
+	// Compiled programs must give exactly the same result as walking their condition tree
+	int32 const NumTrees = 200;
+	int32 const NumSamples = 2000;
+	int32 NumMismatches = 0;
+	int32 NumPassed = 0;
+	FString FailureReason;
+	for (int32 TreeIdx = 0; TreeIdx < NumTrees; ++TreeIdx)
+	{
+		FEmpathGestureCondition01 Conditions = MakeRandomConditionTree(Random);
+		FEmpathGestureConditionProgram Program;
+		Program.Compile(Conditions);
+		for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+		{
+			FEmpathGestureCheck Checks[2];
+			MakeRandomGestureChecks(Random, Program, Checks);
+			bool const bTreeResult = Conditions.AreAllConditionsMet(Checks[0], Checks[1], FailureReason);
+			if (Program.Evaluate(Checks[0], Checks[1]) != bTreeResult)
+			{
+				// Only report the first few, as one bad instruction tends to spoil the rest
+				if (NumMismatches < 10)
+				{
+					AddError(FString::Printf(TEXT("Tree %d sample %d: Program returned %s but the condition tree returned %s."),
+						TreeIdx, Sample, bTreeResult ? TEXT("false") : TEXT("true"), bTreeResult ? TEXT("true") : TEXT("false")));
+				}
+				++NumMismatches;
+			}
+			NumPassed += (bTreeResult ? 1 : 0);
+		}
+	}
+	TestEqual(TEXT("Samples where the program differed from the condition tree"), NumMismatches, 0);
+
+	// Both results need to be well covered for the comparison to mean anything
+	TestTrue(FString::Printf(TEXT("%d of %d samples passed"), NumPassed, NumTrees * NumSamples), NumPassed > 0 && NumPassed < NumTrees * NumSamples);
+
+	// Copies of gesture data start uncompiled, and are compiled again from their own conditions when first evaluated
+	FEmpathOneHandGestureData Gesture;
+	Gesture.EntryConditions = MakeRandomConditionTree(Random);
+	Gesture.SustainConditions = MakeRandomConditionTree(Random);
+	Gesture.CompileConditions();
+	FEmpathOneHandGestureData CopiedGesture = Gesture;
+	TestFalse(TEXT("Copied entry program is compiled"), CopiedGesture.EntryProgram.IsCompiled());
+	CopiedGesture.EntryConditions = MakeRandomConditionTree(Random);
+	for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+	{
+		FEmpathGestureCheck Checks[2];
+		MakeRandomGestureChecks(Random, Gesture.EntryProgram, Checks);
+		bool const bTreeResult = CopiedGesture.EntryConditions.AreAllConditionsMet(Checks[0], Checks[1], FailureReason);
+		if (CopiedGesture.AreEntryConditionsMet(Checks[0], Checks[1]) != bTreeResult)
+		{
+			AddError(FString::Printf(TEXT("Sample %d: Copied gesture returned %s but its condition tree returned %s."),
+				Sample, bTreeResult ? TEXT("false") : TEXT("true"), bTreeResult ? TEXT("true") : TEXT("false")));
+			break;
+		}
+	}
+	TestTrue(TEXT("Copied entry program is compiled once evaluated"), CopiedGesture.EntryProgram.IsCompiled());
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathGestureFailureReasonTest, "Empath.Player.GestureFailureReasons", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEmpathGestureFailureReasonTest::RunTest(const FString& Parameters)
+{
+	// Fast enough sideways, not too fast overall on the last frame, and spinning one way or the other
+	FEmpathOneHandGestureData Gesture;
+	Gesture.EntryConditions.ConditionCheckType = EEmpathGestureConditionCheckType::VelocityX;
+	Gesture.EntryConditions.VelocityCheckType = EEmpathVelocityCheckType::BufferedAverage;
+	Gesture.EntryConditions.CheckOperationType = EEmpathBinaryOperation::GreaterThan;
+	Gesture.EntryConditions.ThresholdValue = 50.0f;
+	FEmpathGestureCondition02 StrongCondition;
+	StrongCondition.ConditionCheckType = EEmpathGestureConditionCheckType::VelocityMagnitude;
+	StrongCondition.VelocityCheckType = EEmpathVelocityCheckType::LastFrameOnly;
+	StrongCondition.CheckOperationType = EEmpathBinaryOperation::LessThan;
+	StrongCondition.ThresholdValue = 100.0f;
+	Gesture.EntryConditions.StrongSubConditions.Add(StrongCondition);
+	FEmpathGestureCondition02 WeakCondition;
+	WeakCondition.ConditionCheckType = EEmpathGestureConditionCheckType::AngularVelocityX;
+	WeakCondition.VelocityCheckType = EEmpathVelocityCheckType::BufferedAverage;
+	WeakCondition.CheckOperationType = EEmpathBinaryOperation::GreaterThan;
+	WeakCondition.ThresholdValue = 1000.0f;
+	Gesture.EntryConditions.WeakSubConditions.Add(WeakCondition);
+	WeakCondition.CheckOperationType = EEmpathBinaryOperation::LessThan;
+	WeakCondition.ThresholdValue = -1000.0f;
+	Gesture.EntryConditions.WeakSubConditions.Add(WeakCondition);
+	Gesture.CompileConditions();
+
+	// Failure codes are only recorded by the compiled programs
+	IConsoleVariable* ProgramsCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("Empath.GestureConditionPrograms"));
+	int32 const PreviousPrograms = (ProgramsCVar ? ProgramsCVar->GetInt() : 1);
+	if (ProgramsCVar)
+	{
+		ProgramsCVar->Set(1, ECVF_SetByCode);
+	}
+
+	FEmpathGestureCheck Check;
+	FEmpathGestureCheck FrameCheck;
+	FMemory::Memzero(Check);
+	FMemory::Memzero(FrameCheck);
+
+	// Failures are only recorded as codes, and described when asked for
+	Check.CheckVelocity.X = 10.0f;
+	TestFalse(TEXT("Too slow sideways"), Gesture.AreEntryConditionsMet(Check, FrameCheck));
+	TestTrue(TEXT("Too slow sideways is recorded as too low"), Gesture.EntryFailure.FailureCode == EEmpathGestureFailureCode::TooLow);
+	TestEqual(TEXT("Too slow sideways fails the root condition"), Gesture.EntryFailure.InstructionIdx, 0);
+	TestTrue(TEXT("Last failure reason is left empty"), Gesture.LastEntryFailureReason.IsEmpty());
+	FString const TooLowReason = Gesture.GetEntryFailureReason();
+	TestTrue(FString::Printf(TEXT("Reason '%s' says the value is too low"), *TooLowReason), TooLowReason.StartsWith(TEXT("Too Low")) && TooLowReason.Contains(TEXT("10.0")));
+
+	// While asked to, every failure is described as it happens
+	Gesture.bDescribeFailures = true;
+	Check.CheckVelocity.X = 60.0f;
+	FrameCheck.VelocityMagnitude = 200.0f;
+	TestFalse(TEXT("Too fast on the last frame"), Gesture.AreEntryConditionsMet(Check, FrameCheck));
+	TestTrue(TEXT("Too fast on the last frame is recorded as too high"), Gesture.EntryFailure.FailureCode == EEmpathGestureFailureCode::TooHigh);
+	FString const TooHighReason = Gesture.GetEntryFailureReason();
+	TestTrue(FString::Printf(TEXT("Reason '%s' says the last frame value is too high"), *TooHighReason), TooHighReason.StartsWith(TEXT("Too High")) && TooHighReason.Contains(TEXT("last frame")));
+	TestEqual(TEXT("Last failure reason"), Gesture.LastEntryFailureReason, TooHighReason);
+
+	FrameCheck.VelocityMagnitude = 80.0f;
+	TestFalse(TEXT("Not spinning"), Gesture.AreEntryConditionsMet(Check, FrameCheck));
+	TestTrue(TEXT("Not spinning is recorded as failing the weak sub-conditions"), Gesture.EntryFailure.FailureCode == EEmpathGestureFailureCode::WeakSubConditions);
+	TestTrue(FString::Printf(TEXT("Reason '%s' names the weak sub-conditions"), *Gesture.LastEntryFailureReason), Gesture.LastEntryFailureReason.StartsWith(TEXT("Weak Sub Conditions")));
+
+	Check.AngularVelocity.X = -1500.0f;
+	TestTrue(TEXT("Spinning"), Gesture.AreEntryConditionsMet(Check, FrameCheck));
+	TestFalse(TEXT("Passing clears the failure"), Gesture.EntryFailure.HasFailed());
+	TestTrue(TEXT("Passing clears the failure reason"), Gesture.LastEntryFailureReason.IsEmpty() && Gesture.GetEntryFailureReason().IsEmpty());
+
+	if (ProgramsCVar)
+	{
+		ProgramsCVar->Set(PreviousPrograms, ECVF_SetByCode);
+	}
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
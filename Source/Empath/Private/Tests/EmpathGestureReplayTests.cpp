@@ -0,0 +1,185 @@
+// Copyright 2018 Team Empath All Rights Reserved
+
+#include "EmpathTestWorld.h"
+#include "EmpathPlayerCharacter.h"
+#include "EmpathHandActor.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** The frame rate of the generated gesture stream. */
+	static const float ReplayFrameRate = 90.0f;
+
+	/** The hand speed while punching in the generated gesture stream. */
+	static const float ReplayPunchSpeed = 400.0f;
+
+	/** Makes a gesture condition on the buffered velocity magnitude of the hand. */
+	FEmpathGestureCondition01 MakeSpeedCondition(float MinSpeed)
+	{
+		FEmpathGestureCondition01 Condition;
+		Condition.ConditionCheckType = EEmpathGestureConditionCheckType::VelocityMagnitude;
+		Condition.VelocityCheckType = EEmpathVelocityCheckType::BufferedAverage;
+		Condition.CheckOperationType = EEmpathBinaryOperation::GreaterThan;
+		Condition.ThresholdValue = MinSpeed;
+		return Condition;
+	}
+
+	/** Makes a punch that is entered above 200 units per second after 10 units and 20 ms, and sustained above 100. */
+	FEmpathOneHandGestureDataTyped MakePunch()
+	{
+		FEmpathOneHandGestureDataTyped Punch;
+		Punch.GestureType = EEmpathOneHandGestureType::Punching;
+		Punch.EntryConditions = MakeSpeedCondition(200.0f);
+		Punch.SustainConditions = MakeSpeedCondition(100.0f);
+		Punch.MinEntryTime = 0.02f;
+		Punch.MinEntryDistance = 10.0f;
+		Punch.MinExitTime = 0.05f;
+		Punch.GestureState = FEmpathOneHandGestureState();
+		return Punch;
+	}
+
+	/** Makes a charged gesture stream where each hand punches once, the right hand at 1.2 seconds and the left at 1.8 seconds, each for 0.2 seconds. */
+	FEmpathGestureStream MakePunchStream()
+	{
+		FEmpathGestureStream Stream;
+		float PunchStartTimes[2];
+		PunchStartTimes[(uint8)EEmpathBinaryHand::Right] = 1.2f;
+		PunchStartTimes[(uint8)EEmpathBinaryHand::Left] = 1.8f;
+		int32 const NumFrames = FMath::CeilToInt(2.5f * ReplayFrameRate);
+		for (int32 FrameIdx = 0; FrameIdx < NumFrames; ++FrameIdx)
+		{
+			FEmpathGestureStreamFrame& Frame = Stream.Frames[Stream.Frames.AddDefaulted()];
+			Frame.TimeSeconds = FrameIdx / ReplayFrameRate;
+			for (int32 HandIdx = 0; HandIdx < 2; ++HandIdx)
+			{
+				FEmpathGestureStreamHandFrame& Hand = Frame.Hands[HandIdx];
+				FMemory::Memzero(Hand.GestureConditionCheck);
+				FMemory::Memzero(Hand.FrameConditionCheck);
+				bool const bPunching = (Frame.TimeSeconds >= PunchStartTimes[HandIdx] && Frame.TimeSeconds < PunchStartTimes[HandIdx] + 0.2f);
+				float const Speed = (bPunching ? ReplayPunchSpeed : 0.0f);
+				Hand.GestureConditionCheck.CheckVelocity = FVector(Speed, 0.0f, 0.0f);
+				Hand.GestureConditionCheck.VelocityMagnitude = Speed;
+				Hand.GestureConditionCheck.MotionAngle = FVector(0.0f, 0.0f, FrameIdx * 0.5f);
+				Hand.FrameConditionCheck = Hand.GestureConditionCheck;
+				Hand.DeltaDistance = Speed / ReplayFrameRate;
+				Hand.bIsPowerCharged = true;
+			}
+		}
+		return Stream;
+	}
+
+	/** Spawns a player with two hands that can only punch, ready to replay gestures. */
+	AEmpathPlayerCharacter* SpawnPunchingPlayer(const FEmpathTestWorld& TestWorld, AEmpathHandActor*& OutRightHand, AEmpathHandActor*& OutLeftHand)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		AEmpathPlayerCharacter* const Player = TestWorld.GetWorld()->SpawnActor<AEmpathPlayerCharacter>(SpawnParams);
+		SpawnParams.Owner = Player;
+		AEmpathHandActor* const RightHand = TestWorld.GetWorld()->SpawnActor<AEmpathHandActor>(SpawnParams);
+		AEmpathHandActor* const LeftHand = TestWorld.GetWorld()->SpawnActor<AEmpathHandActor>(SpawnParams);
+		RightHand->TypedOneHandedGestures.Add(MakePunch());
+		LeftHand->TypedOneHandedGestures.Add(MakePunch());
+		Player->bPunchEnabled = true;
+		Player->bSlashEnabled = false;
+		Player->bBlockEnabled = false;
+		Player->bCannonShotEnabled = false;
+		Player->RegisterHands(RightHand, LeftHand);
+		RightHand->SetGestureCastingEnabled(true);
+		LeftHand->SetGestureCastingEnabled(true);
+		OutRightHand = RightHand;
+		OutLeftHand = LeftHand;
+		return Player;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathGestureReplayTest, "Empath.Player.GestureReplay", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEmpathGestureReplayTest::RunTest(const FString& Parameters)
+{
+	// Gesture streams must survive a trip through a file unchanged
+	FEmpathGestureStream const GeneratedStream = MakePunchStream();
+	FString const FileName = TEXT("AutomationGestureReplay");
+	if (!GeneratedStream.SaveToFile(FileName))
+	{
+		AddError(FString::Printf(TEXT("Could not save the generated gesture stream to %s."), *FEmpathGestureStream::GetFilePath(FileName)));
+		return false;
+	}
+	FEmpathGestureStream Stream;
+	bool const bLoaded = Stream.LoadFromFile(FileName);
+	IFileManager::Get().Delete(*FEmpathGestureStream::GetFilePath(FileName));
+	TestTrue(TEXT("Generated gesture stream loaded"), bLoaded);
+	TestEqual(TEXT("Loaded frames"), Stream.Frames.Num(), GeneratedStream.Frames.Num());
+	for (int32 FrameIdx = 0; FrameIdx < FMath::Min(Stream.Frames.Num(), GeneratedStream.Frames.Num()); ++FrameIdx)
+	{
+		FEmpathGestureStreamHandFrame const& Hand = Stream.Frames[FrameIdx].Hands[(uint8)EEmpathBinaryHand::Right];
+		FEmpathGestureStreamHandFrame const& GeneratedHand = GeneratedStream.Frames[FrameIdx].Hands[(uint8)EEmpathBinaryHand::Right];
+		if (Stream.Frames[FrameIdx].TimeSeconds != GeneratedStream.Frames[FrameIdx].TimeSeconds
+			|| Hand.GestureConditionCheck.VelocityMagnitude != GeneratedHand.GestureConditionCheck.VelocityMagnitude
+			|| Hand.FrameConditionCheck.MotionAngle != GeneratedHand.FrameConditionCheck.MotionAngle
+			|| Hand.DeltaDistance != GeneratedHand.DeltaDistance
+			|| Hand.bIsPowerCharged != GeneratedHand.bIsPowerCharged)
+		{
+			AddError(FString::Printf(TEXT("Frame %d differs after loading."), FrameIdx));
+			break;
+		}
+	}
+
+	FEmpathTestWorld TestWorld;
+	AEmpathHandActor* RightHand = nullptr;
+	AEmpathHandActor* LeftHand = nullptr;
+	AEmpathPlayerCharacter* const Player = SpawnPunchingPlayer(TestWorld, RightHand, LeftHand);
+
+	// Replays are refused while a gesture is active, as they could not end or resume it cleanly
+	RightHand->SetActiveOneHandGestureIdx(0);
+	AddExpectedError(TEXT("Cannot replay gestures while in a casting pose, gesture, or blocking"), EAutomationExpectedErrorFlags::Contains, 1);
+	TestFalse(TEXT("Replayed while punching"), Player->ReplayGestureStream(Stream));
+	RightHand->SetActiveOneHandGestureIdx(-1);
+
+	// Mark the state that the replay will overwrite, so we can tell that it was restored
+	FVector const MarkedVelocity(1.0f, 2.0f, 3.0f);
+	RightHand->GestureTransformCaches[EEmpathGestureType::Punching].LastEntryStartVelocity = MarkedVelocity;
+	RightHand->TypedOneHandedGestures[0].GestureState.LastEntryStartTime = -5.0f;
+	RightHand->LastPunchExitTimeStamp = -10.0f;
+
+	// Each hand should punch once, a couple of frames after starting to move
+	int32 const NumIterations = 3;
+	TestTrue(TEXT("Replayed while idle"), Player->ReplayGestureStream(Stream, NumIterations));
+	const TArray<FEmpathGestureReplayEvent>& Events = Player->GetGestureReplayEvents();
+	struct FExpectedPunch
+	{
+		EEmpathBinaryHand Hand;
+		float StartTime;
+	};
+	FExpectedPunch const ExpectedPunches[] = { { EEmpathBinaryHand::Right, 1.2f }, { EEmpathBinaryHand::Left, 1.8f } };
+	TestEqual(TEXT("Recognized gestures"), Events.Num(), (int32)ARRAY_COUNT(ExpectedPunches));
+	for (int32 EventIdx = 0; EventIdx < FMath::Min(Events.Num(), (int32)ARRAY_COUNT(ExpectedPunches)); ++EventIdx)
+	{
+		FEmpathGestureReplayEvent const& Event = Events[EventIdx];
+		FExpectedPunch const& Expected = ExpectedPunches[EventIdx];
+		FString const Context = FString::Printf(TEXT("Gesture %d"), EventIdx);
+		TestTrue(FString::Printf(TEXT("%s is a punch"), *Context), Event.GestureType == EEmpathGestureType::Punching && !Event.bBlocking);
+		TestTrue(FString::Printf(TEXT("%s is on the expected hand"), *Context), Event.Hand == Expected.Hand);
+
+		// The punch must travel its minimum distance, which takes three frames at this speed
+		float const ExpectedTime = Expected.StartTime + 2.0f / ReplayFrameRate;
+		TestTrue(FString::Printf(TEXT("%s entered at %f rather than about %f"), *Context, Event.TimeSeconds, ExpectedTime),
+			FMath::IsNearlyEqual(Event.TimeSeconds, ExpectedTime, 1.0f / ReplayFrameRate));
+		TestTrue(FString::Printf(TEXT("%s latency %f is within the entry"), *Context, Event.LatencySeconds),
+			Event.LatencySeconds >= 0.02f - KINDA_SMALL_NUMBER && Event.LatencySeconds <= 3.0f / ReplayFrameRate);
+	}
+
+	// Everything the replay touched is back the way it was
+	TestTrue(TEXT("Right hand is idle after the replay"), RightHand->IsGestureIdle());
+	TestTrue(TEXT("Left hand is idle after the replay"), LeftHand->IsGestureIdle());
+	TestTrue(TEXT("Not replaying after the replay"), !Player->IsReplayingGestures());
+	TestEqual(TEXT("Punch transform cache after the replay"), RightHand->GestureTransformCaches[EEmpathGestureType::Punching].LastEntryStartVelocity, MarkedVelocity);
+	TestEqual(TEXT("Punch entry start time after the replay"), RightHand->TypedOneHandedGestures[0].GestureState.LastEntryStartTime, -5.0f);
+	TestEqual(TEXT("Punch exit time stamp after the replay"), RightHand->LastPunchExitTimeStamp, -10.0f);
+	TestFalse(TEXT("Right hand is charged after the replay"), RightHand->IsPowerCharged());
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,372 @@
+// Copyright 2018 Team Empath All Rights Reserved
+
+#include "EmpathTypes.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** The number of averaged values in a velocity frame. */
+	static const int32 NumVelocityFrameValues = 15;
+
+	/** Copies out every averaged value of the frame, so they can be checked in one loop. */
+	void GetVelocityFrameValues(FEmpathVelocityFrame const& Frame, float* OutValues)
+	{
+		float const Values[NumVelocityFrameValues] = {
+			Frame.Velocity.X, Frame.Velocity.Y, Frame.Velocity.Z,
+			Frame.AngularVelocity.X, Frame.AngularVelocity.Y, Frame.AngularVelocity.Z,
+			Frame.KAcceleration.X, Frame.KAcceleration.Y, Frame.KAcceleration.Z,
+			Frame.SphericalVelocity, Frame.RadialVelocity, Frame.VerticalVelocity,
+			Frame.SphericalAccel, Frame.RadialAccel, Frame.VerticalAccel };
+		FMemory::Memcpy(OutValues, Values, sizeof(Values));
+	}
+
+	FVector RandomVector(FRandomStream& Random, float Extent)
+	{
+		return FVector(Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent));
+	}
+
+	/** The kinematic update one value at a time, the way the component did it before hands were updated together, to check the batched update against. */
+	struct FScalarKinematicReference
+	{
+		/** Each row holds every channel as a vector. The distance channels hold the spherical, radial, and vertical values in X, Y, and Z. */
+		FVector Values[EmpathKinematicSample::Num][EmpathKinematicChannel::Num];
+		FVector LastLocation;
+		FVector LastDists;
+		FQuat LastRotation;
+		FEmpathVelocityHistory History;
+
+		FScalarKinematicReference(int32 HistoryCapacity)
+			: LastLocation(FVector::ZeroVector),
+			LastDists(FVector::ZeroVector),
+			LastRotation(FQuat::Identity)
+		{
+			for (int32 Sample = 0; Sample < EmpathKinematicSample::Num; ++Sample)
+			{
+				for (int32 Channel = 0; Channel < EmpathKinematicChannel::Num; ++Channel)
+				{
+					Values[Sample][Channel] = FVector::ZeroVector;
+				}
+			}
+			History.Init(HistoryCapacity);
+		}
+
+		void Update(FEmpathKinematicSampleInput const& Input, FTransform const& ComponentTransform, float SampleTime, float CurrentTime, float DeltaSeconds)
+		{
+			FVector* const Kinematic = Values[EmpathKinematicSample::Kinematic];
+			FVector* const Last = Values[EmpathKinematicSample::Last];
+			FVector* const Frame = Values[EmpathKinematicSample::Frame];
+			FVector* const LastFrame = Values[EmpathKinematicSample::LastFrame];
+			for (int32 Channel = 0; Channel < EmpathKinematicChannel::Num; ++Channel)
+			{
+				Last[Channel] = Kinematic[Channel];
+				LastFrame[Channel] = Frame[Channel];
+			}
+
+			if (Input.bHasOwningPlayer)
+			{
+				FVector const Dists(Input.SphericalLocation.Size(), Input.SphericalLocation.Size2D(), FMath::Abs(Input.SphericalLocation.Z));
+				Frame[EmpathKinematicChannel::DistVelocity] = (Dists - LastDists) / DeltaSeconds;
+				Frame[EmpathKinematicChannel::DistAccel] = (Frame[EmpathKinematicChannel::DistVelocity] - LastFrame[EmpathKinematicChannel::DistVelocity]) / DeltaSeconds;
+				LastDists = Dists;
+			}
+			Frame[EmpathKinematicChannel::Velocity] = (Input.Location - LastLocation) / DeltaSeconds;
+			Frame[EmpathKinematicChannel::Acceleration] = (Frame[EmpathKinematicChannel::Velocity] - LastFrame[EmpathKinematicChannel::Velocity]) / DeltaSeconds;
+			LastLocation = Input.Location;
+
+			FQuat CurrentRotation = ComponentTransform.GetRotation();
+			CurrentRotation.Normalize();
+			FVector Axis;
+			float Angle;
+			(CurrentRotation.Inverse() * LastRotation).ToAxisAndAngle(Axis, Angle);
+			FVector FrameAngularVelocity = FVector::RadiansToDegrees(CurrentRotation.RotateVector((Axis * Angle) / DeltaSeconds));
+			FVector const& LastFrameAngularVelocity = LastFrame[EmpathKinematicChannel::AngularVelocity];
+			if ((FMath::Abs(LastFrameAngularVelocity.X - FrameAngularVelocity.X) > 500.0f && FMath::Abs(FrameAngularVelocity.X) > 500.0f)
+				|| (FMath::Abs(LastFrameAngularVelocity.Y - FrameAngularVelocity.Y) > 500.0f && FMath::Abs(FrameAngularVelocity.Y) > 500.0f)
+				|| (FMath::Abs(LastFrameAngularVelocity.Z - FrameAngularVelocity.Z) > 500.0f && FMath::Abs(FrameAngularVelocity.Z) > 500.0f))
+			{
+				FVector LastAngularAccel = Last[EmpathKinematicChannel::AngularAccelWorld];
+				LastAngularAccel.Z *= -1.0f;
+				FrameAngularVelocity = LastFrameAngularVelocity + (DeltaSeconds * LastAngularAccel);
+			}
+			Frame[EmpathKinematicChannel::AngularVelocity] = FrameAngularVelocity;
+
+			if (SampleTime > 0.0f)
+			{
+				FVector const& FrameDistVelocity = Frame[EmpathKinematicChannel::DistVelocity];
+				FVector const& FrameDistAccel = Frame[EmpathKinematicChannel::DistAccel];
+				History.Push(FEmpathVelocityFrame(Frame[EmpathKinematicChannel::Velocity], FrameAngularVelocity, Frame[EmpathKinematicChannel::Acceleration],
+					FrameDistVelocity.X, FrameDistVelocity.Y, FrameDistVelocity.Z, FrameDistAccel.X, FrameDistAccel.Y, FrameDistAccel.Z, CurrentTime));
+				History.RemoveExpired(CurrentTime, SampleTime);
+				FEmpathVelocityFrame const Average = History.GetAverageBruteForce();
+				Kinematic[EmpathKinematicChannel::Velocity] = Average.Velocity;
+				Kinematic[EmpathKinematicChannel::Acceleration] = Average.KAcceleration;
+				Kinematic[EmpathKinematicChannel::AngularVelocity] = Average.AngularVelocity;
+				Kinematic[EmpathKinematicChannel::DistVelocity] = FVector(Average.SphericalVelocity, Average.RadialVelocity, Average.VerticalVelocity);
+				Kinematic[EmpathKinematicChannel::DistAccel] = FVector(Average.SphericalAccel, Average.RadialAccel, Average.VerticalAccel);
+			}
+			else
+			{
+				Kinematic[EmpathKinematicChannel::Velocity] = Frame[EmpathKinematicChannel::Velocity];
+				Kinematic[EmpathKinematicChannel::Acceleration] = Frame[EmpathKinematicChannel::Acceleration];
+				Kinematic[EmpathKinematicChannel::AngularVelocity] = FrameAngularVelocity;
+				Kinematic[EmpathKinematicChannel::DistVelocity] = Frame[EmpathKinematicChannel::DistVelocity];
+				Kinematic[EmpathKinematicChannel::DistAccel] = Frame[EmpathKinematicChannel::DistAccel];
+			}
+
+			// Fix the Z of the angular velocities for UE4, and differentiate them
+			for (FVector* const Row : { Kinematic, Frame })
+			{
+				FVector* const LastRow = (Row == Kinematic ? Last : LastFrame);
+				Row[EmpathKinematicChannel::AngVelFixedWorld] = Row[EmpathKinematicChannel::AngularVelocity] * FVector(1.0f, 1.0f, -1.0f);
+				Row[EmpathKinematicChannel::AngVelFixedLocal] = ComponentTransform.InverseTransformVectorNoScale(Row[EmpathKinematicChannel::AngularVelocity]) * FVector(1.0f, 1.0f, -1.0f);
+				Row[EmpathKinematicChannel::AngularAccelWorld] = (Row[EmpathKinematicChannel::AngVelFixedWorld] - LastRow[EmpathKinematicChannel::AngVelFixedWorld]) / DeltaSeconds;
+				Row[EmpathKinematicChannel::AngularAccelLocal] = (Row[EmpathKinematicChannel::AngVelFixedLocal] - LastRow[EmpathKinematicChannel::AngVelFixedLocal]) / DeltaSeconds;
+			}
+			LastRotation = CurrentRotation;
+		}
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathKinematicVelocityHistoryTest, "Empath.Player.KinematicVelocityHistory", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEmpathKinematicVelocityHistoryTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(1337);
+
+	// Sized the way the kinematic velocity component sizes it, for a 0.1 second sample time at up to 90 frames per second
+	float const SampleTime = 0.1f;
+	int32 const Capacity = FMath::CeilToInt(SampleTime * 90.0f) + 2;
+	FEmpathVelocityHistory History;
+	History.Init(Capacity);
+
+	// The frames the history should be holding, kept the slow way, and the frames that may still be in its running totals
+	TArray<FEmpathVelocityFrame> ExpectedFrames;
+	TArray<FEmpathVelocityFrame> RecentFrames;
+
+	// Run long enough for the running totals to be recalculated many times, at frame rates above and below the capacity, with the odd hitch
+	float CurrentTime = 0.0f;
+	int32 NumMismatches = 0;
+	int32 const NumFrames = 20000;
+	for (int32 FrameIdx = 0; FrameIdx < NumFrames; ++FrameIdx)
+	{
+		float const DeltaTime = (Random.FRand() < 0.01f) ? Random.FRandRange(0.1f, 0.3f) : 1.0f / Random.FRandRange(30.0f, 144.0f);
+		CurrentTime += DeltaTime;
+
+		FEmpathVelocityFrame const Frame(RandomVector(Random, 500.0f), RandomVector(Random, 1000.0f), RandomVector(Random, 50000.0f),
+			Random.FRandRange(-500.0f, 500.0f), Random.FRandRange(-500.0f, 500.0f), Random.FRandRange(-500.0f, 500.0f),
+			Random.FRandRange(-50000.0f, 50000.0f), Random.FRandRange(-50000.0f, 50000.0f), Random.FRandRange(-50000.0f, 50000.0f),
+			CurrentTime);
+		History.Push(Frame);
+		History.RemoveExpired(CurrentTime, SampleTime);
+
+		ExpectedFrames.Add(Frame);
+		if (ExpectedFrames.Num() > Capacity)
+		{
+			ExpectedFrames.RemoveAt(0);
+		}
+		RecentFrames.Add(Frame);
+		if (RecentFrames.Num() > 2 * Capacity)
+		{
+			RecentFrames.RemoveAt(0);
+		}
+		ExpectedFrames.RemoveAll([CurrentTime, SampleTime](FEmpathVelocityFrame const& ExpectedFrame) { return (CurrentTime - ExpectedFrame.FrameTimeStamp) > SampleTime; });
+
+		if (History.Num() != ExpectedFrames.Num())
+		{
+			AddError(FString::Printf(TEXT("Frame %d: History holds %d frames rather than %d."), FrameIdx, History.Num(), ExpectedFrames.Num()));
+			return false;
+		}
+
+		// Average the frames in double precision, so that the reference doesn't have rounding errors of its own.
+		// The running totals may still hold rounding error from any frame added since they were last recalculated, 
+		// so allow for float rounding relative to the largest of those, which can be much larger than the average.
+		double Sums[NumVelocityFrameValues] = { 0.0 };
+		float Largest[NumVelocityFrameValues] = { 0.0f };
+		float Values[NumVelocityFrameValues];
+		for (FEmpathVelocityFrame const& ExpectedFrame : ExpectedFrames)
+		{
+			GetVelocityFrameValues(ExpectedFrame, Values);
+			for (int32 ValueIdx = 0; ValueIdx < NumVelocityFrameValues; ++ValueIdx)
+			{
+				Sums[ValueIdx] += Values[ValueIdx];
+			}
+		}
+		for (FEmpathVelocityFrame const& RecentFrame : RecentFrames)
+		{
+			GetVelocityFrameValues(RecentFrame, Values);
+			for (int32 ValueIdx = 0; ValueIdx < NumVelocityFrameValues; ++ValueIdx)
+			{
+				Largest[ValueIdx] = FMath::Max(Largest[ValueIdx], FMath::Abs(Values[ValueIdx]));
+			}
+		}
+
+		float Averages[NumVelocityFrameValues];
+		float BruteForceAverages[NumVelocityFrameValues];
+		GetVelocityFrameValues(History.GetAverage(), Averages);
+		GetVelocityFrameValues(History.GetAverageBruteForce(), BruteForceAverages);
+		for (int32 ValueIdx = 0; ValueIdx < NumVelocityFrameValues; ++ValueIdx)
+		{
+			double const Expected = ExpectedFrames.Num() > 0 ? Sums[ValueIdx] / ExpectedFrames.Num() : 0.0;
+			double const Tolerance = 1.e-4 * FMath::Max(1.0f, Largest[ValueIdx]);
+			if (FMath::Abs(Averages[ValueIdx] - Expected) > Tolerance || FMath::Abs(BruteForceAverages[ValueIdx] - Expected) > Tolerance)
+			{
+				// Only report the first few, as one bad frame tends to spoil the rest
+				if (NumMismatches < 10)
+				{
+					AddError(FString::Printf(TEXT("Frame %d: Running average %f and full average %f of value %d differ from %f over %d frames."),
+						FrameIdx, Averages[ValueIdx], BruteForceAverages[ValueIdx], ValueIdx, Expected, ExpectedFrames.Num()));
+				}
+				++NumMismatches;
+			}
+		}
+	}
+
+	TestEqual(TEXT("Frames where the running average differed from the full average"), NumMismatches, 0);
+
+	// Resetting keeps the capacity, but empties the history
+	History.Reset();
+	TestEqual(TEXT("Frames after reset"), History.Num(), 0);
+	TestEqual(TEXT("Capacity after reset"), History.GetCapacity(), Capacity);
+	TestTrue(TEXT("Average after reset is zero"), History.GetAverage().Velocity.IsZero());
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathKinematicUpdateTest, "Empath.Player.KinematicUpdate", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEmpathKinematicUpdateTest::RunTest(const FString& Parameters)
+{
+	// A hand moving in a straight line at a constant speed while turning at a constant rate, sampled the way the component samples it
+	float const DeltaSeconds = 1.0f / 90.0f;
+	float const SampleTime = 0.1f;
+	FVector const Velocity(100.0f, 50.0f, -20.0f);
+	float const TurnRate = 90.0f;
+	for (float const TestSampleTime : { SampleTime, 0.0f })
+	{
+		FEmpathKinematicSamples Hand;
+		FEmpathKinematicSamples* HandSamples[1] = { &Hand };
+		FEmpathVelocityHistory History;
+		History.Init(FMath::CeilToInt(SampleTime * 90.0f) + 2);
+		int32 const NumFrames = 90;
+		for (int32 FrameIdx = 0; FrameIdx < NumFrames; ++FrameIdx)
+		{
+			float const Time = FrameIdx * DeltaSeconds;
+			FVector const Location = Velocity * Time;
+			FEmpathKinematicSampleInput const Input(Location);
+			FEmpathKinematicSamples::ArchiveSamples(HandSamples, 1);
+			FEmpathKinematicSamples::UpdateFrameSamples(HandSamples, &Input, 1, DeltaSeconds);
+			Hand.UpdateAveragedSamples(FTransform(FRotator(0.0f, TurnRate * Time, 0.0f), Location), History, TestSampleTime, Time, DeltaSeconds);
+			FEmpathKinematicSamples::UpdateAngularAccelerations(HandSamples, 1, DeltaSeconds);
+		}
+
+		// Once settled, averaging a constant motion must give back the same motion
+		FString const Context = FString::Printf(TEXT("with a sample time of %f"), TestSampleTime);
+		FVector const KinematicVelocity = Hand.GetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::Velocity);
+		FVector const KinematicAngularVelocity = Hand.GetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::AngularVelocity);
+		FVector const AngularAccel = Hand.GetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::AngularAccelWorld);
+		TestTrue(FString::Printf(TEXT("Velocity %s is %s rather than %s"), *Context, *KinematicVelocity.ToString(), *Velocity.ToString()),
+			KinematicVelocity.Equals(Velocity, 0.05f));
+		TestTrue(FString::Printf(TEXT("Acceleration %s is zero"), *Context),
+			Hand.GetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::Acceleration).IsNearlyZero(1.0f));
+		TestTrue(FString::Printf(TEXT("Angular velocity %s is %s rather than %f about the vertical axis"), *Context, *KinematicAngularVelocity.ToString(), TurnRate),
+			FMath::IsNearlyEqual(FMath::Abs(KinematicAngularVelocity.Z), TurnRate, 0.5f) && FMath::IsNearlyZero(KinematicAngularVelocity.X, 0.5f) && FMath::IsNearlyZero(KinematicAngularVelocity.Y, 0.5f));
+		TestTrue(FString::Printf(TEXT("Angular acceleration %s is %s rather than zero"), *Context, *AngularAccel.ToString()), AngularAccel.IsNearlyZero(1.0f));
+		TestTrue(FString::Printf(TEXT("History is only used %s"), *Context), (History.Num() > 0) == (TestSampleTime > 0.0f));
+	}
+
+	// A hand orbiting a walking player's center of mass at a changing speed, radius, and height, while twisting about every axis.
+	// Every channel of the batched update must match the update done one value at a time, frame by frame.
+	int32 const HistoryCapacity = FMath::CeilToInt(SampleTime * 144.0f) + 2;
+	EmpathKinematicSample::Type const ComparedSamples[] = { EmpathKinematicSample::Kinematic, EmpathKinematicSample::Frame };
+	for (float const TestSampleTime : { SampleTime, 0.0f })
+	{
+		FRandomStream Random(4242);
+		FEmpathKinematicSamples Hand;
+		FEmpathKinematicSamples* HandSamples[1] = { &Hand };
+		FEmpathVelocityHistory History;
+		History.Init(HistoryCapacity);
+		FScalarKinematicReference Reference(HistoryCapacity);
+
+		float Largest[EmpathKinematicSample::Num][EmpathKinematicChannel::Num] = { { 0.0f } };
+		int32 NumMismatches = 0;
+		float Time = 0.0f;
+		int32 const NumFrames = 360;
+		int32 const NumWarmUpFrames = 2 * HistoryCapacity;
+		for (int32 FrameIdx = 0; FrameIdx < NumFrames; ++FrameIdx)
+		{
+			float const FrameDeltaSeconds = 1.0f / Random.FRandRange(80.0f, 100.0f);
+			Time += FrameDeltaSeconds;
+
+			FVector const VRLocation(50.0f * Time, 10.0f * Time, 0.0f);
+			FVector const CenterMassLocation = VRLocation + FVector(0.0f, 0.0f, -40.0f);
+			float const OrbitAngle = 2.0f * PI * (0.5f * Time + 0.2f * Time * Time);
+			float const OrbitRadius = 40.0f + 10.0f * FMath::Sin(2.0f * Time);
+			FVector const SphericalLocation(OrbitRadius * FMath::Cos(OrbitAngle), OrbitRadius * FMath::Sin(OrbitAngle), 20.0f * FMath::Sin(1.5f * Time) - 5.0f);
+			FVector const HandLocation = CenterMassLocation + SphericalLocation;
+			FRotator const HandRotation(30.0f * FMath::Sin(3.0f * Time), 120.0f * Time + 40.0f * Time * Time, 20.0f * FMath::Cos(2.0f * Time));
+			FTransform const HandTransform(HandRotation, HandLocation);
+			FEmpathKinematicSampleInput const Input(HandLocation - VRLocation, SphericalLocation, true);
+
+			FEmpathKinematicSamples::ArchiveSamples(HandSamples, 1);
+			FEmpathKinematicSamples::UpdateFrameSamples(HandSamples, &Input, 1, FrameDeltaSeconds);
+			Hand.UpdateAveragedSamples(HandTransform, History, TestSampleTime, Time, FrameDeltaSeconds);
+			FEmpathKinematicSamples::UpdateAngularAccelerations(HandSamples, 1, FrameDeltaSeconds);
+			Reference.Update(Input, HandTransform, TestSampleTime, Time, FrameDeltaSeconds);
+
+			// The first frames jump from rest at the origin, so their accelerations dwarf the rest of the motion. Wait for them to leave the history.
+			if (FrameIdx < NumWarmUpFrames)
+			{
+				continue;
+			}
+
+			// The batched update multiplies by the inverse frame time where the reference divides by it, 
+			// so allow for float rounding relative to the largest value each channel has held
+			for (EmpathKinematicSample::Type const Sample : ComparedSamples)
+			{
+				for (int32 Channel = 0; Channel < EmpathKinematicChannel::Num; ++Channel)
+				{
+					FVector const Value = Hand.GetVector(Sample, (EmpathKinematicChannel::Type)Channel);
+					FVector const& Expected = Reference.Values[Sample][Channel];
+					Largest[Sample][Channel] = FMath::Max(Largest[Sample][Channel], Expected.GetAbsMax());
+					if (!Value.Equals(Expected, 1.e-3f * FMath::Max(1.0f, Largest[Sample][Channel])))
+					{
+						// Only report the first few, as one bad frame spoils the frames after it
+						if (NumMismatches < 10)
+						{
+							AddError(FString::Printf(TEXT("Sample time %f, frame %d: Channel %d of sample %d is %s rather than %s."),
+								TestSampleTime, FrameIdx, Channel, (int32)Sample, *Value.ToString(), *Expected.ToString()));
+						}
+						++NumMismatches;
+					}
+				}
+			}
+		}
+
+		TestEqual(FString::Printf(TEXT("Values that differed from the reference with a sample time of %f"), TestSampleTime), NumMismatches, 0);
+
+		// Make sure the motion exercised every value, so that a channel left at zero can't pass by matching a zero reference
+		for (EmpathKinematicSample::Type const Sample : ComparedSamples)
+		{
+			for (int32 Channel = 0; Channel < EmpathKinematicChannel::Num; ++Channel)
+			{
+				TestTrue(FString::Printf(TEXT("Channel %d of sample %d was exercised with a sample time of %f"), Channel, (int32)Sample, TestSampleTime), Largest[Sample][Channel] > 1.0f);
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathKinematicBenchmarkTest, "Empath.Player.KinematicBenchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FEmpathKinematicBenchmarkTest::RunTest(const FString& Parameters)
+{
+	int32 const NumIterations = 100000;
+	double const NanosecondsPerHand = FEmpathKinematicSamples::BenchmarkFrameUpdate(NumIterations);
+	TestTrue(TEXT("Benchmark measured the update"), NanosecondsPerHand > 0.0 && FMath::IsFinite(NanosecondsPerHand));
+	AddInfo(FString::Printf(TEXT("Kinematic update: %.2f ns per hand update over %d frames of two hands."), NanosecondsPerHand, NumIterations));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
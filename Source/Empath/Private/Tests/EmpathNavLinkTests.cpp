@@ -0,0 +1,72 @@
+// Copyright 2018 Team Empath All Rights Reserved
+
+#include "EmpathTestWorld.h"
+#include "EmpathNavLinkProxy_Jump.h"
+#include "NavigationSystem/Public/NavLinkCustomComponent.h"
+#include "GameFramework/Character.h"
+#include "Components/CapsuleComponent.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathBakedJumpTrajectoryTest, "Empath.AI.BakedJumpTrajectory", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEmpathBakedJumpTrajectoryTest::RunTest(const FString& Parameters)
+{
+	FEmpathTestWorld TestWorld;
+	AEmpathNavLinkProxy_Jump* const JumpLink = TestWorld.GetWorld()->SpawnActor<AEmpathNavLinkProxy_Jump>(FVector(100.0f, 200.0f, 0.0f), FRotator::ZeroRotator);
+	UNavLinkCustomComponent* const LinkComp = JumpLink ? JumpLink->GetSmartLinkComp() : nullptr;
+	TestNotNull(TEXT("Jump link"), LinkComp);
+	if (!LinkComp)
+	{
+		return false;
+	}
+
+	// Jump up onto a ledge
+	LinkComp->SetLinkData(FVector::ZeroVector, FVector(400.0f, 0.0f, 150.0f), ENavLinkDirection::BothWays);
+	JumpLink->BakeJumpTrajectories();
+	FVector const StartPoint = LinkComp->GetStartPoint();
+	FVector const EndPoint = LinkComp->GetEndPoint();
+	TestTrue(TEXT("Forward jump baked"), JumpLink->BakedForwardJump.bValid);
+	TestTrue(TEXT("Reverse jump baked"), JumpLink->BakedReverseJump.bValid);
+
+	// JumpTo is given the link's end point on the ground, while the jumper stands on the start point with its capsule's center above it
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	ACharacter* const Jumper = TestWorld.GetWorld()->SpawnActor<ACharacter>(StartPoint, FRotator::ZeroRotator, SpawnParams);
+	TestNotNull(TEXT("Jumper"), Jumper);
+	if (!Jumper)
+	{
+		return false;
+	}
+	FVector const CapsuleOffset(0.0f, 0.0f, Jumper->GetCapsuleComponent()->GetScaledCapsuleHalfHeight());
+	Jumper->SetActorLocation(StartPoint + CapsuleOffset);
+	FEmpathJumpTrajectory const* const ForwardJump = JumpLink->FindBakedJumpTrajectoryForJumper(Jumper, EndPoint, JumpLink->JumpArc);
+	TestTrue(TEXT("Forward jump from the start point uses the forward bake"), ForwardJump == &JumpLink->BakedForwardJump);
+	if (ForwardJump)
+	{
+		// The jumper is launched from its center, so the baked velocity must land its center the same height above the end point
+		float const Time = ForwardJump->AscendingTime + ForwardJump->DescendingTime;
+		FVector const Gravity(0.0f, 0.0f, TestWorld.GetWorld()->GetGravityZ());
+		FVector const Landing = Jumper->GetActorLocation() + (ForwardJump->LaunchVelocity * Time) + (0.5f * Gravity * Time * Time);
+		TestTrue(FString::Printf(TEXT("Forward jump lands at %s rather than %s"), *Landing.ToString(), *(EndPoint + CapsuleOffset).ToString()),
+			Landing.Equals(EndPoint + CapsuleOffset, 1.0f));
+	}
+
+	Jumper->SetActorLocation(EndPoint + CapsuleOffset);
+	FEmpathJumpTrajectory const* const ReverseJump = JumpLink->FindBakedJumpTrajectoryForJumper(Jumper, StartPoint, JumpLink->JumpArc);
+	TestTrue(TEXT("Reverse jump from the end point uses the reverse bake"), ReverseJump == &JumpLink->BakedReverseJump);
+
+	// Jumpers that have drifted off the link's point still use the bake, as long as they are within the tolerance
+	Jumper->SetActorLocation(StartPoint + CapsuleOffset + FVector(JumpLink->BakedJumpTolerance * 0.5f, 0.0f, 0.0f));
+	TestNotNull(TEXT("Jump from just beside the start point"), JumpLink->FindBakedJumpTrajectoryForJumper(Jumper, EndPoint, JumpLink->JumpArc));
+
+	// Jumps that only line up horizontally would land at the wrong height, so they must be computed instead
+	Jumper->SetActorLocation(StartPoint + CapsuleOffset);
+	TestNull(TEXT("Jump from the start point to the end point's capsule center"), JumpLink->FindBakedJumpTrajectoryForJumper(Jumper, EndPoint + CapsuleOffset, JumpLink->JumpArc));
+	TestNull(TEXT("Jump to a higher ledge"), JumpLink->FindBakedJumpTrajectory(StartPoint, EndPoint + FVector(0.0f, 0.0f, 60.0f), JumpLink->JumpArc));
+	TestNull(TEXT("Jump with a different arc"), JumpLink->FindBakedJumpTrajectory(StartPoint, EndPoint, JumpLink->JumpArc * 0.5f));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
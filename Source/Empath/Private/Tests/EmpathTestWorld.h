@@ -0,0 +1,60 @@
+// Copyright 2018 Team Empath All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/DefaultPawn.h"
+#include "EmpathAIManager.h"
+#include "EmpathAIController.h"
+
+/**
+* An empty game world that lives for the duration of an automation test, so tests can spawn actors without loading a map.
+* Play never begins in it, so spawned actors are not ticked and do not run BeginPlay unless the test does so itself.
+*/
+class FEmpathTestWorld
+{
+public:
+	FEmpathTestWorld()
+	{
+		World = UWorld::CreateWorld(EWorldType::Game, false);
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+		World->InitializeActorsForPlay(FURL());
+	}
+
+	~FEmpathTestWorld()
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	UWorld* GetWorld() const { return World; }
+
+	/** Spawns an AI manager. */
+	AEmpathAIManager* SpawnAIManager() const
+	{
+		return World->SpawnActor<AEmpathAIManager>();
+	}
+
+	/** Spawns an AI controller possessing a bare pawn of the class at the location, and registers it with the AI manager. */
+	AEmpathAIController* SpawnAI(AEmpathAIManager* AIManager, FVector const& Location, FRotator const& Rotation = FRotator::ZeroRotator, TSubclassOf<APawn> PawnClass = ADefaultPawn::StaticClass()) const
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		APawn* const Pawn = World->SpawnActor<APawn>(PawnClass, Location, Rotation, SpawnParams);
+		AEmpathAIController* const AI = World->SpawnActor<AEmpathAIController>(SpawnParams);
+		AI->Possess(Pawn);
+		AI->RegisterAIManager(AIManager);
+		return AI;
+	}
+
+private:
+	UWorld* World;
+};
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,75 @@
+// Copyright 2018 Team Empath All Rights Reserved
+
+#include "EmpathTypes.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEmpathVisionConeSnapshotTest, "Empath.AI.VisionConeSnapshot", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEmpathVisionConeSnapshotTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(4242);
+
+	// Use a count that isn't a multiple of four, so the scalar remainder is tested too
+	int32 const NumCones = 4099;
+	FEmpathVisionConeSnapshot Snapshot;
+	TArray<FVector> EyesLocations;
+	TArray<FVector> TargetLocations;
+	TArray<FEmpathVisionCone> VisionCones;
+	for (int32 Idx = 0; Idx < NumCones; ++Idx)
+	{
+		FVector const EyesLocation(Random.FRandRange(-5000.0f, 5000.0f), Random.FRandRange(-5000.0f, 5000.0f), Random.FRandRange(-500.0f, 500.0f));
+		FVector const TargetLocation = EyesLocation + Random.VRand() * Random.FRandRange(0.0f, 3000.0f);
+
+		// Occasionally disable the auto see or peripheral ranges, as designers may
+		float const AutoSeeDistance = (Random.FRand() < 0.1f) ? -1.0f : Random.FRandRange(0.0f, 500.0f);
+		float const PeripheralVisionDistance = (Random.FRand() < 0.1f) ? -1.0f : Random.FRandRange(0.0f, 2500.0f);
+		FEmpathVisionCone const VisionCone(Random.VRand(),
+			AutoSeeDistance,
+			PeripheralVisionDistance,
+			FMath::Cos(FMath::DegreesToRadians(Random.FRandRange(0.0f, 180.0f))),
+			FMath::Cos(FMath::DegreesToRadians(Random.FRandRange(0.0f, 180.0f))));
+
+		EyesLocations.Add(EyesLocation);
+		TargetLocations.Add(TargetLocation);
+		VisionCones.Add(VisionCone);
+		Snapshot.Add(EyesLocation, TargetLocation, VisionCone);
+	}
+
+	TArray<bool> Results;
+	Snapshot.ComputeVisionCones(Results);
+	TestEqual(TEXT("Number of vision cone results"), Results.Num(), NumCones);
+	if (Results.Num() != NumCones)
+	{
+		return false;
+	}
+
+	int32 NumCompared = 0;
+	for (int32 Idx = 0; Idx < NumCones; ++Idx)
+	{
+		FEmpathVisionCone const& VisionCone = VisionCones[Idx];
+		FVector const ToTarget = TargetLocations[Idx] - EyesLocations[Idx];
+		float const Dist = ToTarget.Size();
+
+		// The two tests round differently, so skip targets that lie right on one of the cone's boundaries
+		float const CosLimit = (Dist <= VisionCone.PeripheralVisionDistance) ? VisionCone.PeripheralVisionCos : VisionCone.ForwardVisionCos;
+		if (FMath::IsNearlyEqual(Dist, VisionCone.AutoSeeDistance, 0.01f)
+			|| FMath::IsNearlyEqual(Dist, VisionCone.PeripheralVisionDistance, 0.01f)
+			|| FMath::IsNearlyEqual(FVector::DotProduct(ToTarget.GetSafeNormal(), VisionCone.EyesForward), CosLimit, 1.e-4f))
+		{
+			continue;
+		}
+
+		bool const bExpected = VisionCone.IsInVisionCone(EyesLocations[Idx], TargetLocations[Idx]);
+		TestEqual(FString::Printf(TEXT("Vision cone %d (eyes %s, target %s)"), Idx, *EyesLocations[Idx].ToString(), *TargetLocations[Idx].ToString()), Results[Idx], bExpected);
+		++NumCompared;
+	}
+
+	// Make sure the boundary skipping didn't hide most of the test
+	TestTrue(TEXT("Most vision cones were compared"), NumCompared > NumCones * 9 / 10);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
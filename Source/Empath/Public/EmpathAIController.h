@@ -21,6 +21,8 @@ class AEmpathCharacter;
 class AEmpathPlayerCharacter;
 class AEmpathNavLinkProxy;
 class AEmpathNavLinkProxy_Jump;
+class UEnvQuery;
+struct FEnvQueryResult;
 
 /**
 *
@@ -45,11 +47,16 @@ public:
 	/** Constructor like behavior. */
 	AEmpathAIController(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
+	virtual void PostInitProperties() override;
 	virtual void BeginPlay() override;
 	virtual void Possess(APawn* InPawn) override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void UnPossess() override;
 
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif // WITH_EDITOR
+
 	/** Registers this AI controller with the AI Manager. */
 	void RegisterAIManager(AEmpathAIManager* RegisteredAIManager);
 
@@ -95,6 +102,9 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathAIController)
 	AActor* GetAttackTarget() const;
 
+	/** Makes sure the AI manager counts us against our current attack target, even if it was set in the Blackboard directly. */
+	void UpdateCountedAttackTarget();
+
 	/** Sets the AI's current defend target. */
 	UFUNCTION(BlueprintCallable, Category = EmpathAIController)
 	void SetDefendTarget(AActor* NewDefendTarget);
@@ -258,6 +268,21 @@ public:
 	UFUNCTION(BlueprintImplementableEvent, Category = EmpathAIController, meta = (DisplayName = "On Target Spotted"))
 	void ReceiveTargetSpotted();
 
+	/** Called by the AI manager when we hear a noise that did not reveal the player. */
+	void OnHeardNoise(FVector const& NoiseLocation);
+
+	/** Triggered when we hear a noise worth investigating. */
+	UFUNCTION(BlueprintImplementableEvent, Category = EmpathAIController, meta = (DisplayName = "On Investigate Location"))
+	void ReceiveInvestigateLocation(FVector InvestigationLocation);
+
+	/** Returns whether we have a location to investigate from a noise we heard, and if so, where. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathAIController)
+	bool GetInvestigationLocation(FVector& OutLocation) const;
+
+	/** Clears the location we were investigating, once we are done with it. */
+	UFUNCTION(BlueprintCallable, Category = EmpathAIController)
+	void ClearInvestigationLocation();
+
 	/** Triggered when we first see the target. */
 	UFUNCTION(BlueprintImplementableEvent, Category = EmpathAIController)
 	void OnCanSeeTarget();
@@ -312,13 +337,41 @@ public:
 	// ---------------------------------------------------------
 	//	State flow / Commands
 
-	/** Updates what targets are visible and which is our current attack target */
+	/** 
+	* Updates what targets are visible and which is our current attack target.
+	* If the AI manager is time slicing these updates, the update is queued instead and run within a few frames.
+	*/
 	UFUNCTION(BlueprintCallable, Category = EmpathAIController)
 	void UpdateTargetingAndVision();
 
+	/** Updates what targets are visible and which is our current attack target this frame, bypassing the AI manager's scheduler. */
+	void UpdateTargetingAndVisionImmediately();
+
+	/** 
+	* Scores the targets in the world snapshot and returns the best one, without changing any state. 
+	* Only reads from the AI manager, so the AI manager may score many AIs at once on worker threads as long as nothing changes it meanwhile.
+	*/
+	AActor* ChooseAttackTarget(FEmpathAIWorldSnapshot const& WorldSnapshot) const;
+
+	/** Sets the attack target chosen by the AI manager and updates vision for it. */
+	void CommitAttackTargetAndUpdateVision(AActor* NewAttackTarget);
+
 	/** Alerts us that the target has been spotted, and updates the AI manager as to its location. */
 	void UpdateKnownTargetLocation(AActor const* AITarget);
 
+	/** Returns the index of the perception LOD tier used for the last vision update, or INDEX_NONE if vision was skipped or LOD is disabled. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathAIController)
+	int32 GetPerceptionLOD() const { return CurrentPerceptionLOD; }
+
+	/** Called by the AI manager when our async vision trace is complete. */
+	void OnLOSTraceComplete(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	/** Called by the AI manager when our queued vision trace is dispatched. */
+	void SetCurrentLOSTraceHandle(FTraceHandle const& TraceHandle) { CurrentLOSTraceHandle = TraceHandle; }
+
+	/** Called by the AI manager with the result of our vision cone test, when it tested the cone for us. */
+	void SetVisionConeResult(bool bInVisionCone) { bLastInVisionCone = bInVisionCone; bHasVisionConeResult = true; }
+
 	/** Fires the OnAIInitialized event on the Empath Character. */
 	virtual bool RunBehaviorTree(UBehaviorTree* BTAsset) override;
 
@@ -385,6 +438,50 @@ public:
 	UFUNCTION(BlueprintCallable, Category = EmpathAIController)
 	void RequestReposition() { bShouldReposition = true; };
 
+	/** 
+	* Runs an EQS query to find somewhere to reposition to, and calls On Reposition Query Complete with the result.
+	* If the AI manager is scheduling these queries, the query is queued instead, and may be answered with our previous result if we are low priority.
+	*/
+	UFUNCTION(BlueprintCallable, Category = EmpathAIController)
+	void RunRepositionQuery(UEnvQuery* Query);
+
+	/** 
+	* Starts the reposition query, bypassing the AI manager's scheduler. The EQS manager runs it over the following frames. 
+	* Aborts any reposition query we already have running. Returns whether the query was started.
+	*/
+	bool StartRepositionQuery(UEnvQuery* Query);
+
+	/** Stops our running reposition query, if any, without calling On Reposition Query Complete. */
+	void AbortRepositionQuery();
+
+	/** Returns whether we have a reposition query running. */
+	bool IsRepositionQueryRunning() const { return RepositionQueryID != INDEX_NONE; }
+
+	/** Answers our pending reposition query with our previous result. Called by the AI manager for low priority AIs when it is over budget. */
+	void UseStaleRepositionQueryResult();
+
+	/** Called when a reposition query completes. bIsStale is true if we were given our previous result instead of running the query again. */
+	UFUNCTION(BlueprintImplementableEvent, Category = EmpathAIController, meta = (DisplayName = "On Reposition Query Complete"))
+	void ReceiveRepositionQueryComplete(bool bSuccess, FVector Location, bool bIsStale);
+
+	/** Returns whether our last reposition query found a location. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathAIController)
+	bool HasRepositionQueryResult() const { return bHasRepositionQueryResult; }
+
+	/** Returns the location found by our last successful reposition query. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathAIController)
+	FVector GetRepositionQueryResult() const { return RepositionQueryResult; }
+
+	/** Returns the time our last reposition query finished. */
+	float GetLastRepositionQueryTime() const { return LastRepositionQueryTime; }
+
+	/** Records how long a reposition query waited in the AI manager's queue. */
+	void AddEQSQueueWaitTime(float WaitTime);
+
+	/** Returns how long our reposition queries have waited in the AI manager's queue, in seconds. */
+	UFUNCTION(BlueprintCallable, Category = EmpathAIController)
+	void GetEQSQueueWaitStats(float& LastWait, float& AverageWait, float& MaxWait) const;
+
 	/** Whether this AI should automatically claim navlinks when moving. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIController)
 	bool bClaimNavLinksOnMove;
@@ -402,6 +499,12 @@ public:
 	/** Releases claims on all claimed nav links. */
 	void ReleaseAllClaimedNavLinks();
 
+	/** Gets the Empath nav links on the current path, in path order. Cached until the path changes. */
+	TArray<FEmpathPathNavLink> const& GetCurrentPathNavLinks() const;
+
+	/** Forces the nav links on the current path to be looked up again, e.g. when the path is updated in place. */
+	void InvalidateCurrentPathNavLinks();
+
 	/** Clears the nav recovery destination. */
 	void ClearNavRecoveryDestination();
 
@@ -469,6 +572,42 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = EmpathAIController)
 	float AutoSeeDistance;
 
+	/** 
+	* Perception LOD tiers, ordered from most to least detailed. Each vision update uses the first tier whose requirements are met, or the last tier if none are.
+	* Passive and dead AIs skip vision updates entirely. If empty, perception LOD is disabled and every update is fully detailed.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = EmpathAIController)
+	TArray<FEmpathPerceptionLODSettings> PerceptionLODTiers;
+
+	/** Half angle of the player's view used to decide whether this AI is in view for perception LOD. */
+	UPROPERTY(EditDefaultsOnly, Category = EmpathAIController, meta = (Units = deg))
+	float PerceptionLODPlayerViewAngle;
+
+	/** The perception LOD tier used for the last vision update. */
+	int32 CurrentPerceptionLOD;
+
+	/** The time of the last vision update that was not skipped by perception LOD. */
+	float LastVisionUpdateTime;
+
+	/** Whether our target was inside our vision cone the last time we tested it. Reused when our perception LOD skips the test. */
+	uint32 bLastInVisionCone : 1;
+
+	/** Whether we have tested our vision cone since our last attack target change. */
+	uint32 bHasVisionConeResult : 1;
+
+	/** Selects the perception LOD tier for a vision update. Returns false if the update should be skipped. */
+	bool UpdatePerceptionLOD();
+
+	/** Returns our vision cone when looking along the given forward vector. */
+	FEmpathVisionCone GetVisionCone(FVector const& EyesForward) const;
+
+	/** Cosines of our peripheral and forward vision angles, cached so that vision updates don't recompute them. */
+	float PeripheralVisionCos;
+	float ForwardVisionCos;
+
+	/** Recomputes the cached vision angle cosines. Called whenever the vision angles may have changed. */
+	void UpdateVisionConeCosines();
+
 	///** Whether we should draw debug vision cones when updating vision. */
 	//UPROPERTY(EditDefaultsOnly, Category = "Empath|AI")
 	//bool bDrawDebugVision;
@@ -496,6 +635,23 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = EmpathAIController)
 	float AngleScoreWeight;
 
+	/** The number of samples the target selection score curves are baked into at begin play. If less than 2, the curves are evaluated directly. */
+	UPROPERTY(EditDefaultsOnly, Category = EmpathAIController)
+	int32 TargetSelectionCurveSamples;
+
+	/** The largest error allowed between the baked target selection score curves and the originals before we warn about it. */
+	UPROPERTY(EditDefaultsOnly, Category = EmpathAIController)
+	float TargetSelectionCurveMaxError;
+
+	/** The baked distance score curve, shared with every AI using the same curve. */
+	TSharedPtr<FEmpathCurveLUT const> TargetSelectionDistScoreLUT;
+
+	/** The baked angle score curve, keyed by the cosine of the angle so that scoring does not need an Acos. Shared with every AI using the same curve. */
+	TSharedPtr<FEmpathCurveLUT const> TargetSelectionAngleScoreLUT;
+
+	/** Finds or bakes the shared lookup tables for the target selection score curves, and warns if they stray too far from the originals. */
+	void BakeTargetSelectionCurves();
+
 	/** Target selection preferred target weight. */
 	UPROPERTY(EditDefaultsOnly, Category = EmpathAIController)
 	float TargetPrefScoreWeight;
@@ -532,7 +688,8 @@ protected:
 	float GetTargetSelectionScore(AActor* CandidateTarget, 
 		float DesiredCandidateTargetingRatio, 
 		float CandidateTargetPriority, 
-		AActor* CurrentTarget) const;
+		AActor* CurrentTarget,
+		bool bCandidateLocationKnown) const;
 	void UpdateAttackTarget();
 	void UpdateVision(bool bTestImmediately = false);
 
@@ -546,12 +703,6 @@ protected:
 	/** Handle for stale vision trace we need to ignore. */
 	FTraceHandle LOSTraceHandleToIgnore;
 
-	/** Delegate four when our vision trace. */
-	FTraceDelegate OnLOSTraceCompleteDelegate;
-
-	/** Called when our async vision trace is complete. */
-	void OnLOSTraceComplete(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
-
 	// ---------------------------------------------------------
 	//	Obstacle avoidance
 
@@ -574,6 +725,30 @@ protected:
 	/** If true, next WantsToAdvance will return true. Reset when WantsToAdvance is called, so that we don't keep returning true infinitely. */
 	bool bShouldReposition;
 
+	/** Whether our last reposition query found a location. */
+	bool bHasRepositionQueryResult;
+
+	/** The location found by our last successful reposition query. */
+	FVector RepositionQueryResult;
+
+	/** The time our last reposition query finished. */
+	float LastRepositionQueryTime;
+
+	/** The EQS manager's ID for our running reposition query, or INDEX_NONE if we have none running. */
+	int32 RepositionQueryID;
+
+	/** How long our last reposition query waited in the AI manager's queue. */
+	float LastEQSQueueWaitTime;
+
+	/** How long our reposition queries have waited in the AI manager's queue in total. */
+	float TotalEQSQueueWaitTime;
+
+	/** The longest any of our reposition queries has waited in the AI manager's queue. */
+	float MaxEQSQueueWaitTime;
+
+	/** The number of our reposition queries that have waited in the AI manager's queue. */
+	int32 NumEQSQueueWaits;
+
 	UFUNCTION()
 	void OnCapsuleBumpDuringMove(UPrimitiveComponent* HitComp,
 		AActor* OtherActor, UPrimitiveComponent* OtherComp, 
@@ -615,10 +790,25 @@ private:
 	/** The AI manager we grabbed when spawning. */
 	AEmpathAIManager* AIManager;
 
+	/** The Empath nav links on the path in CurrentPathNavLinksSource. */
+	mutable TArray<FEmpathPathNavLink> CurrentPathNavLinks;
+
+	/** The distance along the path in CurrentPathNavLinksSource to each of its points. */
+	mutable TArray<float> CurrentPathDistances;
+
+	/** The path CurrentPathNavLinks was built from. */
+	mutable FNavPathWeakPtr CurrentPathNavLinksSource;
+
 	/** Our index inside the list of EmpathAICons stored in the AI manager. */
 	int32 AIManagerIndex;
 
+	/** The attack target the AI manager is counting us against. */
+	TWeakObjectPtr<AActor> CountedAttackTarget;
+
 	/** Stored reference to the Empath Character we control */
 	AEmpathCharacter* CachedEmpathChar;
 
+	/** Called by the EQS manager when our reposition query finishes. */
+	void OnRepositionQueryFinished(TSharedPtr<FEnvQueryResult> Result);
+
 };
\ No newline at end of file
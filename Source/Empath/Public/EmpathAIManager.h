@@ -15,7 +15,55 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnNewPlayerAwarenessStateDelegate,
 
 // Forward declarations
 class AEmpathAIController;
+class AEmpathCharacter;
 class AEmpathPlayerCharacter;
+class APawn;
+
+/** Tick function that dispatches the AI manager's queued vision traces late in the frame, after the AIs have requested them. */
+USTRUCT()
+struct FEmpathVisionTraceTickFunction : public FTickFunction
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** The AI manager to dispatch vision traces for. */
+	AEmpathAIManager* Target;
+
+	FEmpathVisionTraceTickFunction()
+		: Target(nullptr)
+	{}
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FEmpathVisionTraceTickFunction> : public TStructOpsTypeTraitsBase2<FEmpathVisionTraceTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/** 
+* Adds the time spent in its scope to one of the AI manager's frame timings. 
+* Does nothing unless the AI manager is recording frame timings, and compiles away in shipping builds.
+*/
+struct FEmpathScopedAIFrameTiming
+{
+public:
+#if !UE_BUILD_SHIPPING
+	FEmpathScopedAIFrameTiming(AEmpathAIManager* InAIManager, double FEmpathAIFrameTimings::* InTiming);
+	~FEmpathScopedAIFrameTiming();
+
+private:
+	AEmpathAIManager* AIManager;
+	double FEmpathAIFrameTimings::* Timing;
+	double StartTime;
+#else
+	FEmpathScopedAIFrameTiming(AEmpathAIManager* InAIManager, double FEmpathAIFrameTimings::* InTiming) {}
+#endif
+};
 
 
 UCLASS(Transient, BlueprintType)
@@ -32,6 +80,9 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	/** Registers the vision trace tick function along with our own. */
+	virtual void RegisterActorTickFunctions(bool bRegister) override;
+
 	UFUNCTION()
 	void OnPlayerTeleported(AActor* Player, FVector Origin, FVector Destination, FVector Direction);
 	UFUNCTION()
@@ -56,6 +107,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = EmpathAIManager)
 	void GetNumAITargeting(AActor const* Target, int32& NumAITargetingCandiate, int32& NumTotalAI) const;
 
+	/** Updates the number of AIs targeting each actor. Called by registered AIs when their attack target changes. */
+	void OnAIAttackTargetChanged(AActor const* OldTarget, AActor const* NewTarget);
+
 	/** Returns the radius of the attack target. */
 	UFUNCTION(BlueprintCallable, Category = EmpathAIManager)
 	float GetAttackTargetRadius(AActor* AttackTarget) const;
@@ -83,7 +137,8 @@ public:
 	/** Called when an AI controller dies, to calculate whether any remaining AIs are aware of the player. */
 	void CheckForAwareAIs();
 
-	/** Called when we want to report a noise to the AI manager. This is a heavy operation so do not overuse it.
+	/** Called when we want to report a noise to the AI manager. 
+	* Noises are queued and resolved together once per frame, so nearby noises from the same frame are merged.
 	* @param NoiseInstigator	The actor that that caused the noise event, even if they are not the source of the noise (i.e. whoever cast the fireball).
 	* @param NoiseMaker			The actor directly responsible for the noise (i.e. the fireball).
 	* @param Location			Where the sound occurred.
@@ -92,6 +147,154 @@ public:
 	UFUNCTION(BlueprintCallable, Category = EmpathAIManager)
 	void ReportNoise(AActor* NoiseInstigator, AActor* NoiseMaker, FVector Location, float HearingRadius);
 
+	/** Returns all registered AIs whose pawns are within the radius of the location, using the spatial grid. */
+	UFUNCTION(BlueprintCallable, Category = EmpathAIManager)
+	void GetAIsInRadius(FVector Location, float Radius, TArray<AEmpathAIController*>& OutAIs) const;
+
+	/** Returns up to NumAIs registered AIs closest to the location, sorted from nearest to farthest. */
+	UFUNCTION(BlueprintCallable, Category = EmpathAIManager)
+	void GetNearestAIs(FVector Location, int32 NumAIs, TArray<AEmpathAIController*>& OutAIs) const;
+
+	/** 
+	* Calls the function on every registered AI whose pawn is within the radius of the location.
+	* Return false from the function to stop iterating early.
+	*/
+	void ForEachAIInRadius(FVector Location, float Radius, TFunctionRef<bool(AEmpathAIController*)> Func) const;
+
+	/** 
+	* Puts an AI controller in the spatial grid cell containing its pawn, or removes it if it has no pawn. 
+	* Called when the AI registers or possesses a pawn, so that it can be found before our next tick.
+	*/
+	void UpdateSpatialGridCell(AEmpathAIController* AI);
+
+	/** Removes an AI controller from the spatial grid. Called when the AI unregisters. */
+	void RemoveFromSpatialGrid(AEmpathAIController* AI);
+
+	/** 
+	* Returns what the AIs need to know about the world this frame: the player, their state, and the secondary targets. 
+	* Taken on first use each frame, and retaken at the top of our tick if the player teleports or dies or the secondary targets change.
+	* Never retaken in the middle of the frame otherwise, so references to it stay valid until the next frame.
+	*/
+	FEmpathAIWorldSnapshot const& GetWorldSnapshot();
+
+	/** Returns the AI manager that caches EQS context values for the querier: the one its AI is registered with, otherwise the game mode's. */
+	static AEmpathAIManager* GetEQSContextCacheManager(APawn const* Querier);
+
+	/** 
+	* Returns whether a value for the EQS context was already provided for the querier this frame, and if so, what it was. 
+	* Counts towards the cache hits or misses.
+	*/
+	bool GetCachedEQSContext(UClass const* ContextClass, AActor const* Querier, FEmpathEQSContextCacheEntry& OutEntry);
+
+	/** Caches the value the EQS context provided for the querier, to be reused by the querier's other queries this frame. */
+	void CacheEQSContext(UClass const* ContextClass, AActor const* Querier, FEmpathEQSContextCacheEntry const& Entry);
+
+	/** Clears the cached EQS context values for every querier. */
+	void InvalidateEQSContextCache();
+
+	/** Clears the cached EQS context values for the querier. */
+	void InvalidateEQSContextCache(AActor const* Querier);
+
+	/** Clears the cached values the EQS context class provided for every querier. */
+	void InvalidateEQSContextCacheForContext(UClass const* ContextClass);
+
+	/** Returns the number of EQS context values served from the cache and computed since play began. */
+	void GetEQSContextCacheStats(int32& OutHits, int32& OutMisses) const { OutHits = NumEQSContextCacheHits; OutMisses = NumEQSContextCacheMisses; }
+
+	/** Returns whether the AI was one of those closest to the player's last known location when the player was lost, and so should investigate it. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathAIManager)
+	bool IsLostPlayerInvestigator(AEmpathAIController const* AI) const { return LostPlayerInvestigators.Contains(AI); }
+
+	/** Removes the AI from the lost player investigators and any staggered lost player responses. */
+	void CancelLostPlayerResponse(AEmpathAIController* AI);
+
+	/** Returns whether AIs hunting the player should follow the shared flow field rather than each finding their own path. */
+	bool IsFlowFieldNavigationEnabled() const { return bUseFlowFieldNavigation; }
+
+	/** Turns flow field navigation on or off. */
+	UFUNCTION(BlueprintCallable, Category = EmpathAIManager)
+	void SetFlowFieldNavigationEnabled(bool bEnabled);
+
+	/** 
+	* Builds a nav mesh path from the start to the goal by following the flow field towards the player's last known location. 
+	* Returns false if the field isn't ready, the goal isn't in the field's goal polygon, or the start is outside the field, in which case the caller should find its own path.
+	*/
+	bool GetFlowFieldPath(FVector const& Start, FVector const& Goal, UObject const* Querier, FNavPathSharedPtr& OutPath) const;
+
+	/** Returns how long the AI hot paths took over the last full frame. Used for benchmarking. All zero unless frame timings were being recorded. */
+	FEmpathAIFrameTimings const& GetLastFrameTimings() const { return LastFrameTimings; }
+
+	/** Returns whether frame timings are being recorded, either because they were asked for or through Empath.AIRecordFrameTimings. Always false in shipping builds. */
+	bool IsRecordingFrameTimings() const;
+
+	/** Turns recording of frame timings on or off. Ignored in shipping builds. */
+	void SetRecordFrameTimings(bool bRecord) { bRecordFrameTimings = bRecord; }
+
+	/** Adds time in milliseconds to one of this frame's timings, if frame timings are being recorded. */
+	void AddFrameTiming(double FEmpathAIFrameTimings::* Timing, double Ms);
+
+	/** Adds to one of this frame's counts, if frame timings are being recorded. */
+	void AddFrameCount(int32 FEmpathAIFrameTimings::* Count, int32 Num = 1);
+
+	/** Returns whether the AI has a location to investigate from a noise it heard, and if so, where. */
+	bool GetInvestigationPoint(AEmpathAIController const* AI, FVector& OutLocation) const;
+
+	/** Clears any location the AI was flagged to investigate. */
+	void ClearInvestigationPoint(AEmpathAIController const* AI);
+
+	/** Returns whether targeting and vision updates are time sliced by the AI manager. */
+	bool IsTargetingSchedulerEnabled() const { return bUseTargetingScheduler || bUseParallelTargetScoring; }
+
+	/** Turns time slicing of targeting and vision updates on or off. Updates already queued are still run. */
+	UFUNCTION(BlueprintCallable, Category = EmpathAIManager)
+	void SetTargetingSchedulerEnabled(bool bEnabled) { bUseTargetingScheduler = bEnabled; }
+
+	/** 
+	* Chooses an attack target for each AI against this frame's world snapshot and targeting counts, without committing them. 
+	* Scores across worker threads if in parallel. Either way, the results are the same.
+	*/
+	void ScoreAttackTargets(TArray<AEmpathAIController*> const& AIs, TArray<AActor*>& OutTargets, bool bInParallel);
+
+	/** Queues a targeting and vision update for the AI, to be run when it fits in the per-frame budget. Does nothing if the AI is already queued. */
+	void QueueTargetingUpdate(AEmpathAIController* AI);
+
+	/** Removes any queued targeting and vision update for the AI. */
+	void CancelTargetingUpdate(AEmpathAIController* AI);
+
+	/** Returns whether reposition queries are run through the AI manager's priority queue. */
+	bool IsEQSSchedulerEnabled() const { return bUseEQSScheduler; }
+
+	/** 
+	* Queues a reposition query for the AI, to be run when it fits in the per-frame budget. 
+	* AIs closer to the player, or that have gone longer without a result, run first.
+	* Replaces the query of any request the AI already has queued, keeping its place in the queue.
+	*/
+	void QueueEQSRequest(AEmpathAIController* AI, UEnvQuery* Query);
+
+	/** Removes any queued reposition query for the AI. */
+	void CancelEQSRequest(AEmpathAIController* AI);
+
+	/** Returns whether characters that lost the nav mesh should have their recovery destinations found by the AI manager. */
+	bool IsNavRecoveryServiceEnabled() const { return bUseNavRecoveryService; }
+
+	/** 
+	* Asks the AI manager to find a nav recovery destination for the character. 
+	* Requests are resolved together once per frame, with one search shared by each cluster of nearby characters, and each character is sent to a different point.
+	* Does nothing if the character already has a request waiting.
+	*/
+	void RequestNavRecoveryDestination(AEmpathCharacter* Character);
+
+	/** 
+	* Queues a vision trace for the AI, ignoring its pawn and the target. 
+	* Queued traces are dispatched together late in the frame they were requested in, and the result is sent back through the AI's OnLOSTraceComplete.
+	* Replaces any trace the AI already has queued.
+	* If bTestVisionCone is set, the end is first tested against the vision cone along with all other queued requests, and the AI is told it cannot see the target without tracing if it fails.
+	*/
+	void RequestVisionTrace(AEmpathAIController* AI, FVector const& Start, FVector const& End, AActor* Target, bool bTestVisionCone = false, FEmpathVisionCone const& VisionCone = FEmpathVisionCone());
+
+	/** Removes any queued vision trace for the AI. */
+	void CancelVisionTrace(AEmpathAIController* AI);
+
 	/** Called when the player awareness state changes */
 	FOnNewPlayerAwarenessStateDelegate OnNewPlayerAwarenessState;
 
@@ -104,6 +307,17 @@ protected:
 	float LostPlayerTimeThreshold;
 	float StartSearchingTimeThreshold;
 
+	/** 
+	* How many of the AIs closest to the player's last known location respond to losing the player immediately, and investigate that location. 
+	* The other AIs respond over the following frames. If zero or less, every AI responds immediately.
+	*/
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly)
+	int32 NumLostPlayerInvestigators;
+
+	/** How many of the remaining AIs respond to losing or searching for the player each frame. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 1))
+	int32 LostPlayerResponsesPerFrame;
+
 	/** Called when the game starts or when spawned. */
 	virtual void BeginPlay() override;
 
@@ -111,6 +325,118 @@ protected:
 	UPROPERTY(Category = EmpathAIManager, EditAnywhere, BlueprintReadWrite)
 	TArray<FSecondaryAttackTarget> SecondaryAttackTargets;
 
+	/** The size of each cell in the spatial grid used for AI proximity queries. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly)
+	float SpatialGridCellSize;
+
+	/** 
+	* Extra distance added to the cells visited by spatial queries. 
+	* The grid is only refreshed once per tick, so this covers pawns that moved into a new cell since then. 
+	*/
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly)
+	float SpatialGridQuerySlack;
+
+	/** 
+	* Whether AI targeting and vision updates should be time sliced by the AI manager. 
+	* If true, AIs requesting an update are queued and updated in order as the per-frame budget allows. 
+	* Off by default, as Blueprint callers of Update Targeting And Vision otherwise no longer see the result straight away.
+	*/
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly)
+	bool bUseTargetingScheduler;
+
+	/** How much time the scheduler may spend on targeting and vision updates each frame, in microseconds. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 0))
+	float TargetingUpdateBudgetMicroseconds;
+
+	/** 
+	* Whether queued targeting updates should be scored all at once across worker threads. 
+	* Every AI is scored against the same world snapshot and targeting counts, and the chosen targets are only committed once all AIs are scored, so results don't depend on update order.
+	* The per-frame budget and staleness limit still apply, using the measured cost of recent updates to choose how many AIs to take each frame.
+	*/
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly)
+	bool bUseParallelTargetScoring;
+
+	/** The longest an AI may wait for a queued targeting and vision update, in seconds. AIs past this are updated regardless of the budget. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 0))
+	float MaxTargetingUpdateStaleness;
+
+	/** 
+	* Whether reposition queries should be run through the AI manager. 
+	* If true, AIs requesting a query are queued and started in order of priority, as long as few enough queries are already running. 
+	*/
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly)
+	bool bUseEQSScheduler;
+
+	/** How many reposition queries the AI manager may have running at once. The EQS manager runs them over several frames. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 1))
+	int32 MaxRunningEQSQueries;
+
+	/** The longest an AI may wait for a queued reposition query, in seconds. AIs past this are run regardless of the budget. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 0))
+	float MaxEQSRequestWait;
+
+	/** AIs this far or further from the player get no priority from distance. Closer AIs get more, up to 1. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 1))
+	float EQSPriorityFalloffDistance;
+
+	/** 
+	* How old an AI's last reposition result may be and still be reused, in seconds. 
+	* Also how long since its last query before an AI gets full priority from waiting. 
+	*/
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 0))
+	float EQSStaleResultMaxAge;
+
+	/** AIs below this priority are given their last reposition result, if recent enough, rather than waiting once the budget is spent. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 0))
+	float EQSStaleResultPriority;
+
+	/** 
+	* Whether characters that lost the nav mesh should have their recovery destinations found by the AI manager, rather than each by their own behavior tree. 
+	* Only characters that are off the nav mesh are handled. Characters stranded on a nav mesh island still search on their own.
+	*/
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly)
+	bool bUseNavRecoveryService;
+
+	/** Characters looking for a nav recovery destination within this distance of each other share one search. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly)
+	float NavRecoveryClusterRadius;
+
+	/** How many points are tested against the nav mesh for each cluster of characters. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 1))
+	int32 NavRecoverySamplesPerCluster;
+
+	/** How far apart the destinations given to different characters must be. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly)
+	float NavRecoveryDestinationSpacing;
+
+	/** How long points found on the nav mesh are kept to be given to other characters, in seconds. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 0))
+	float NavRecoveryPointLifetime;
+
+	/** Noises reported within this distance of each other by the same instigator in the same frame are merged into one. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly)
+	float NoiseMergeDistance;
+
+	/** Whether AIs hunting the player should follow a shared flow field towards the player's last known location, rather than each finding their own path. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly)
+	bool bUseFlowFieldNavigation;
+
+	/** The most nav mesh polygons the flow field may cover. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 1))
+	int32 FlowFieldMaxPolys;
+
+	/** How many nav mesh polygons to add to the flow field each frame while rebuilding it. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly, meta = (ClampMin = 1))
+	int32 FlowFieldPolysPerFrame;
+
+	/** How far the player's last known location must move before the flow field goal is updated. The field is only rebuilt if the goal moves into another polygon, in which case it is rebuilt from scratch. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly)
+	float FlowFieldRebuildDistance;
+
+	/** How close a move goal must be to the flow field's goal for the move to follow the flow field. */
+	UPROPERTY(Category = EmpathAIManager, EditDefaultsOnly, BlueprintReadOnly)
+	float FlowFieldGoalTolerance;
+
 	/** Variables governing player awareness. */
 	bool bPlayerHasEverBeenSeen;
 	bool bIsPlayerLocationKnown;
@@ -121,6 +447,205 @@ private:
 	/** Removes any stale or dead secondary AI cons from the list. */
 	void CleanUpSecondaryTargets();
 
+	/** Returns the index of the target in the secondary attack target list, or INDEX_NONE if it is not a secondary target. */
+	int32 FindSecondaryTargetIndex(AActor const* Target) const;
+
+	/** Rebuilds the secondary target lookup from the secondary target list. */
+	void RebuildSecondaryTargetIndices() const;
+
+	/** 
+	* Index of each secondary attack target in the secondary target list. 
+	* Rebuilt lazily, as the list may also be edited directly. 
+	*/
+	mutable TMap<AActor const*, int32> SecondaryTargetIndices;
+
+	/** The number of secondary targets when the lookup was last rebuilt. */
+	mutable int32 NumIndexedSecondaryTargets;
+
+	/** Whether a lookup found a dead secondary target, so the list should be cleaned up on the next tick. */
+	mutable bool bSecondaryTargetsNeedCleanUp;
+
+	/** Timings for the AI hot paths this frame, added to by the AIs as they update. */
+	FEmpathAIFrameTimings FrameTimings;
+
+	/** The AI hot path timings from the last full frame. */
+	FEmpathAIFrameTimings LastFrameTimings;
+
+	/** Whether frame timings were asked for, e.g. by a benchmark. */
+	bool bRecordFrameTimings;
+
+	/** Refreshes the world snapshot from the current state of the world. */
+	void UpdateWorldSnapshot();
+
+	/** Flags the world snapshot to be retaken at the top of our next tick, or on first use next frame if that comes sooner. */
+	void InvalidateWorldSnapshot() { bWorldSnapshotDirty = true; }
+
+	/** Whether the world snapshot is out of date and should be retaken at the next safe point. */
+	bool bWorldSnapshotDirty;
+
+	/** The shared view of the world for AIs this frame. */
+	FEmpathAIWorldSnapshot WorldSnapshot;
+
+	/** The values provided by Empath EQS contexts this frame, keyed by context class and querier. */
+	TMap<FEmpathEQSContextCacheKey, FEmpathEQSContextCacheEntry> EQSContextCache;
+
+	/** The number of EQS context values served from the cache since play began. */
+	int32 NumEQSContextCacheHits;
+
+	/** The number of EQS context values computed since play began. */
+	int32 NumEQSContextCacheMisses;
+
+	/** Starts rebuilding the flow field if the player's last known location has moved, and continues any rebuild in progress. */
+	void UpdateFlowField();
+
+	/** The flow field AIs are currently following. */
+	FEmpathFlowField FlowField;
+
+	/** The flow field being built. Replaces the current field once complete. */
+	FEmpathFlowField PendingFlowField;
+
+	/** The polygons waiting to be expanded in the pending flow field, as a heap ordered by cost to the goal. */
+	TArray<TPair<float, NavNodeRef>> FlowFieldOpenPolys;
+
+	/** Tells the running AIs that the awareness state is now Lost or Searching, investigators first and the rest staggered over the following frames. */
+	void DispatchLostPlayerResponses(EEmpathPlayerAwarenessState NewAwarenessState);
+
+	/** Runs this frame's share of the staggered lost player responses. */
+	void ProcessLostPlayerResponses();
+
+	/** The AIs closest to the player's last known location when the player was lost. */
+	TArray<AEmpathAIController*> LostPlayerInvestigators;
+
+	/** Lost player responses waiting to be run, in order. */
+	TArray<FEmpathLostPlayerResponse> StaggeredLostPlayerResponses;
+
+	/** Finds destinations for the characters that requested one this frame. */
+	void ResolveNavRecoveryRequests();
+
+	/** Searches for points on the nav mesh around the cluster of characters, adding any found to the recent nav recovery points. */
+	void SearchForNavRecoveryPoints(TArray<AEmpathCharacter*> const& Cluster);
+
+	/** 
+	* Sends the character to the closest recent nav recovery point within its search radii that is not claimed by or too close to another character's destination. 
+	* Returns false if there is no such point.
+	*/
+	bool AssignNavRecoveryPoint(AEmpathCharacter* Character);
+
+	/** Characters waiting for a nav recovery destination. */
+	TArray<TWeakObjectPtr<AEmpathCharacter>> PendingNavRecoveryRequests;
+
+	/** Points recently found on the nav mesh by nav recovery searches. */
+	TArray<FEmpathNavRecoveryPoint> NavRecoveryPoints;
+
+	/** The characters still needing a destination after trying the recent points. */
+	TArray<AEmpathCharacter*> UnassignedNavRecoveryCharacters;
+
+	/** The characters in the cluster being searched for. */
+	TArray<AEmpathCharacter*> NavRecoveryCluster;
+
+	/** Resolves the noises reported this frame against the AIs that can hear them. */
+	void ResolveNoises();
+
+	/** Noises reported this frame, waiting to be resolved. */
+	TArray<FEmpathNoiseEvent> PendingNoises;
+
+	/** The location each AI should investigate, from noises it heard that did not reveal the player. */
+	TMap<AEmpathAIController const*, FVector> InvestigationPoints;
+
+	/** AIs that heard the noise being resolved. */
+	TArray<AEmpathAIController*> NoiseListeners;
+
+	/** Moves any AI pawns that changed cells since the last update to their new cell in the spatial grid. */
+	void UpdateSpatialGrid();
+
+	/** Returns the spatial grid cell containing the location. */
+	FIntVector GetSpatialGridCell(FVector const& Location) const;
+
+	/** Runs queued targeting and vision updates until the frame budget is spent. */
+	void ProcessTargetingUpdateQueue();
+
+	/** Scores every queued AI's attack target at once, then commits the results and updates their vision. */
+	void ProcessTargetingUpdateQueueParallel();
+
+	/** The AIs being scored by the parallel targeting update. */
+	TArray<AEmpathAIController*> ParallelScoringAIs;
+
+	/** The attack target chosen for each AI being scored. */
+	TArray<AActor*> ParallelScoringResults;
+
+	/** The smoothed cost of each parallel targeting update, including committing it, in microseconds. Zero until first measured. */
+	float ParallelTargetingMicrosecondsPerAI;
+
+	/** Starts queued reposition queries in order of priority until the maximum number are running. */
+	void ProcessEQSQueue();
+
+	/** Returns how urgently the AI needs a new reposition result. */
+	float GetEQSPriority(AEmpathAIController const* AI, FEmpathAIWorldSnapshot const& Snapshot, float CurrTime) const;
+
+	/** Reposition queries waiting to be run. */
+	TArray<FEmpathEQSRequest> EQSQueue;
+
+	/** The AIs we have started reposition queries for. Pruned of finished queries each frame. */
+	TArray<TWeakObjectPtr<AEmpathAIController>> RunningEQSQueryAIs;
+
+	/** Targeting and vision updates waiting to be run, oldest first. */
+	TArray<FEmpathTargetingUpdateRequest> TargetingUpdateQueue;
+
+	/** The AIs currently in the targeting update queue. */
+	TSet<AEmpathAIController*> QueuedTargetingUpdateAIs;
+
+	/** Tests the vision cones of all queued vision traces together, then dispatches the traces of those that passed. */
+	void DispatchVisionTraces();
+
+	/** Dispatches this frame's vision traces. Ticks after the AIs, so that traces requested this frame don't wait for the next one. */
+	FEmpathVisionTraceTickFunction VisionTraceTickFunction;
+	friend struct FEmpathVisionTraceTickFunction;
+
+	/** Called when a dispatched vision trace completes. Forwards the result to each AI waiting on it. */
+	void OnVisionTraceComplete(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	/** Vision traces waiting to be dispatched this frame. */
+	TArray<FEmpathVisionTraceRequest> PendingVisionTraces;
+
+	/** The vision traces currently being dispatched. Swapped with the pending traces so that requests made while dispatching wait for the next dispatch. */
+	TArray<FEmpathVisionTraceRequest> DispatchingVisionTraces;
+
+	/** Vision cones of the requests being dispatched, laid out for batch testing. */
+	FEmpathVisionConeSnapshot VisionConeSnapshot;
+
+	/** The request index for each entry in the vision cone snapshot. */
+	TArray<int32> VisionConeRequestIndices;
+
+	/** Results of the batched vision cone tests. */
+	TArray<bool> VisionConeResults;
+
+	/** AIs whose targets failed the batched vision cone test this frame. */
+	TArray<AEmpathAIController*> VisionConeFailedAIs;
+
+	/** The AI waiting on each dispatched vision trace, keyed by the ID passed as the trace's user data. */
+	TMap<uint32, TWeakObjectPtr<AEmpathAIController>> VisionTraceListeners;
+
+	/** The ID to give the next dispatched vision trace. */
+	uint32 NextVisionTraceID;
+
+	/** Delegate for when our vision traces complete. */
+	FTraceDelegate OnVisionTraceCompleteDelegate;
+
+	/** Query params reused for every vision trace, so that we only set up the trace tag once. */
+	FCollisionQueryParams VisionTraceParams;
+
+	/** The number of registered AIs currently targeting each actor. Destroyed actors are pruned each tick. */
+	TMap<TWeakObjectPtr<AActor const>, int32> NumAITargetingByTarget;
+
+	/** Removes destroyed actors from the targeting counts, and recounts any AI whose attack target was changed without going through SetAttackTarget. */
+	void UpdateTargetingCounts();
+
+	/** The registered AIs sorted into the spatial grid cells containing their pawns. */
+	TMap<FIntVector, TArray<AEmpathAIController*>> SpatialGridCells;
+
+	/** The spatial grid cell each registered AI is currently sorted into. */
+	TMap<AEmpathAIController*, FIntVector> SpatialGridCellsByAI;
+
 	/** Sets the player awareness state. */
 	void SetPlayerAwarenessState(const EEmpathPlayerAwarenessState NewAwarenessState);
 
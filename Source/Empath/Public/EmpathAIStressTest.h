@@ -0,0 +1,162 @@
+// Copyright 2018 Team Empath All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "EmpathAIStressTest.generated.h"
+
+class AEmpathCharacter;
+class AEmpathAIManager;
+
+/**
+* Benchmark for the AI hot paths. Sets up its own scenario, so it runs in any map: spawn it with the EmpathAIStressTest console command, 
+* pass -AIStress on the command line, or place one in a map. Results are more representative with a nav mesh covering the arena.
+* On begin play, spawns a grid of enemies around itself, drives the player around the arena while making noises, and records the AI manager's frame timings. 
+* Uses the game mode's AI manager if there is one, and otherwise spawns its own. Once done, the timings and a histogram of the per-frame 
+* targeting and vision time are written to CSV files so they can be compared across builds. Runs without a headset or renderer, e.g.:
+* UE4Editor.exe Empath -game -nullrhi -AIStress -AIStressNumAIs=200 -AIStressFrames=1000 -AIStressFlowField=true -AIStressTargetingScheduler=true -AIStressQuit
+*/
+UCLASS()
+class EMPATH_API AEmpathAIStressTest : public AActor
+{
+	GENERATED_BODY()
+	
+public:	
+	// Sets default values for this actor's properties
+	AEmpathAIStressTest();
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	/** Spawns a stress test in the world, centered on the player if there is one. */
+	static AEmpathAIStressTest* SpawnStressTest(UWorld* World);
+
+	/** Reads the command line, sets up the scenario and starts recording. Called on begin play. */
+	void StartStressTest();
+
+	/** Returns whether the stress test has finished, or failed to start. */
+	bool IsFinished() const { return bFinished; }
+
+	/** Returns the number of frames recorded so far. */
+	int32 GetNumRecordedFrames() const { return FMath::Max(RecordedLines.Num() - 1, 0); }
+
+	/** Returns the AI manager being recorded. */
+	AEmpathAIManager* GetAIManager() const { return AIManager; }
+
+	/** The enemy class to spawn. Its AI controller class is replaced with an Empath AI controller if it doesn't use one. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest)
+	TSubclassOf<AEmpathCharacter> EnemyClass;
+
+	/** The number of enemies to spawn. Overridden by -AIStressNumAIs= on the command line. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest, meta = (ClampMin = 1))
+	int32 NumAIs;
+
+	/** The number of frames to record, after warming up. Overridden by -AIStressFrames= on the command line. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest, meta = (ClampMin = 1))
+	int32 NumFrames;
+
+	/** The number of frames to wait after spawning before recording, so that the AIs can settle. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest, meta = (ClampMin = 0))
+	int32 NumWarmUpFrames;
+
+	/** The width of the square arena the enemies are spawned in, centered on this actor. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest)
+	float ArenaSize;
+
+	/** The radius of the circle the player is driven around, centered on this actor. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest)
+	float PlayerPathRadius;
+
+	/** How fast the player is driven around the circle, in degrees per second. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest)
+	float PlayerPathSpeed;
+
+	/** How often the player makes a noise, in seconds. Zero or less for no noises. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest)
+	float NoiseInterval;
+
+	/** How far away the player's noises can be heard from. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest)
+	float NoiseHearingRadius;
+
+	/** The directory to save results to, relative to the project directory. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest)
+	FString SaveDirectory;
+
+	/** The name of the results file. The date is appended. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest)
+	FString FileName;
+
+	/** Whether the AI manager should use flow field navigation during the test. Overridden by -AIStressFlowField= on the command line. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest)
+	bool bUseFlowFieldNavigation;
+
+	/** Whether the AI manager should time slice targeting and vision updates during the test. Overridden by -AIStressTargetingScheduler= on the command line. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest)
+	bool bUseTargetingScheduler;
+
+	/** The width of each bucket in the histogram of per-frame targeting and vision time, in milliseconds. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest, meta = (ClampMin = 0.001))
+	float HistogramBucketMs;
+
+	/** The number of buckets in the histogram. Frames slower than the last bucket are counted in it. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest, meta = (ClampMin = 1))
+	int32 NumHistogramBuckets;
+
+	/** Whether to write the results to file once finished. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest)
+	bool bSaveResults;
+
+	/** Whether to quit the game once the results are saved. Also set by -AIStressQuit on the command line. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathAIStressTest)
+	bool bQuitWhenFinished;
+
+	/** Called when the results have been saved. */
+	UFUNCTION(BlueprintImplementableEvent, Category = EmpathAIStressTest, meta = (DisplayName = "On Stress Test Finished"))
+	void ReceiveStressTestFinished(const FString& SavedFileName);
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+private:
+	/** Spawns the enemies in a grid across the arena. */
+	void SpawnEnemies();
+
+	/** Moves the player along their path, making noises as we go. */
+	void DrivePlayer(float DeltaTime);
+
+	/** Writes the recorded frames to file and cleans up. */
+	void FinishStressTest();
+
+	/** The enemies we spawned. */
+	UPROPERTY(Transient)
+	TArray<AEmpathCharacter*> SpawnedEnemies;
+
+	/** The AI manager we are recording. */
+	UPROPERTY(Transient)
+	AEmpathAIManager* AIManager;
+
+	/** The AI manager we spawned because the game mode didn't have one, if any. */
+	UPROPERTY(Transient)
+	AEmpathAIManager* SpawnedAIManager;
+
+	/** The recorded frames, as CSV lines. */
+	TArray<FString> RecordedLines;
+
+	/** The number of recorded frames whose targeting and vision time fell in each histogram bucket. */
+	TArray<int32> FrameTimeHistogram;
+
+	/** The number of frames ticked since spawning. */
+	int32 FramesTicked;
+
+	/** The player's current angle along their path, in degrees. */
+	float PlayerPathAngle;
+
+	/** Time since the player last made a noise. */
+	float TimeSinceNoise;
+
+	/** Whether the stress test has finished. */
+	bool bFinished;
+};
@@ -11,6 +11,8 @@
 #include "EnvironmentQuery/Tests/EnvQueryTest_Dot.h"
 #include "EmpathEnvQueryTest_Dot.generated.h"
 
+DECLARE_STATS_GROUP(TEXT("EmpathEQS"), STATGROUP_EMPATH_EQS, STATCAT_Advanced);
+
 // This is a clone of the standard Unreal dot test, with some modified behavior of Gather Line Directions
 // that allows us to account for the rotation of VR characters
 
@@ -61,4 +63,18 @@ protected:
 
 	/** helper function: check if contexts are updated per item */
 	bool RequiresPerItemUpdates(TSubclassOf<UEnvQueryContext> LineFrom, TSubclassOf<UEnvQueryContext> LineTo, TSubclassOf<UEnvQueryContext> LineDirection, bool bUseDirectionContext) const;
+
+	/** 
+	* Gathers the directions of a line for every item in the query. Contexts that aren't per item are only prepared once.
+	* If the line is per item, each item's directions are stored contiguously, OutDirsPerItem apart. Otherwise OutDirs is shared by all items.
+	*/
+	void GatherLineDirectionsForAllItems(TArray<FVector>& OutDirs, int32& OutDirsPerItem, bool& bOutPerItem, FEnvQueryInstance& QueryInstance, FEnvDirection const& Line) const;
+
+private:
+
+	/** Scratch buffers reused between runs so that scoring doesn't allocate. EQS tests only run on the game thread. */
+	mutable TArray<FVector> ScratchLocations;
+	mutable TArray<FVector> ScratchLineADirs;
+	mutable TArray<FVector> ScratchLineBDirs;
+	mutable TArray<float> ScratchScores;
 };
@@ -323,6 +323,22 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "EmpathFunctionLibrary|Gestures")
 	static const FString GestureCheckDebugToCSV(UPARAM(ref) FEmpathOneHandGestureConditionCheckDebug& Input);
 
+	/** Returns why a one handed gesture last failed its entry or sustain conditions, or an empty string if it passed. */
+	UFUNCTION(BlueprintCallable, Category = "EmpathFunctionLibrary|Gestures")
+	static const FString GetOneHandGestureFailureReason(UPARAM(ref) FEmpathOneHandGestureData& Gesture, bool bSustain);
+
+	/** Returns why one hand of a two handed gesture last failed its entry or sustain conditions, or an empty string if it passed. */
+	UFUNCTION(BlueprintCallable, Category = "EmpathFunctionLibrary|Gestures")
+	static const FString GetTwoHandGestureFailureReason(UPARAM(ref) FEmpathTwoHandGestureData& Gesture, bool bSustain, EEmpathBinaryHand Hand);
+
+	/** Compiles the conditions of a one handed gesture again. Call after changing its conditions in place. */
+	UFUNCTION(BlueprintCallable, Category = "EmpathFunctionLibrary|Gestures")
+	static void CompileOneHandGestureConditions(UPARAM(ref) FEmpathOneHandGestureData& Gesture);
+
+	/** Recalculates the left hand conditions of a two handed gesture and compiles the conditions of both hands. Call after changing its right hand conditions in place. */
+	UFUNCTION(BlueprintCallable, Category = "EmpathFunctionLibrary|Gestures")
+	static void CompileTwoHandGestureConditions(UPARAM(ref) FEmpathTwoHandGestureData& Gesture);
+
 	/** Flattens a vector on the Z plane. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "EmpathFunctionLibrary|Utility")
 	static const FVector FlattenVector(const FVector& Input);
@@ -43,6 +43,14 @@ public:
 	UFUNCTION(Exec)
 	void EmpathJumpToProgress(int32 NewPlayerProgressIdx);
 
+	/** Times the batched kinematic velocity update over the inputted number of frames for two hands, and logs the nanoseconds per hand update. */
+	UFUNCTION(Exec)
+	void EmpathBenchmarkKinematics(int32 NumIterations);
+
+	/** Spawns an AI stress test around the player, which records the AI frame timings and saves them to file. */
+	UFUNCTION(Exec)
+	void EmpathAIStressTest();
+
 	/** Set the current player progress and reload the level. */
 	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent, Category = EmpathGameInstance)
 	void JumpToProgress(int32 NewPlayerProgressIdx);
@@ -90,5 +98,11 @@ public:
 	virtual void Init() override;
 	virtual void Shutdown() override;
 
+protected:
+	/** Starts the AI stress test if -AIStress is on the command line. */
+	virtual void OnStart() override;
+
+public:
+
 	UEmpathGameInstance();
 };
@@ -369,6 +369,36 @@ public:
 	/** Gets the results of all possible one handed conditions checks. */
 	void UpdateGestureConditionChecks();
 
+	/** Returns the time used for gesture timing. Real time, or the recorded time while the owning player is replaying a gesture stream. */
+	float GetGestureTimeSeconds() const;
+
+	/** Returns the distance this hand traveled this frame, as used by gestures. */
+	float GetGestureDeltaDistance() const;
+
+	/** Returns the time the active one handed gesture began entering, or -1 if there is no active one handed gesture. */
+	float GetActiveOneHandGestureEntryStartTime() const;
+
+	/** Captures the current gesture inputs of this hand for a gesture stream. */
+	void RecordGestureStreamFrame(FEmpathGestureStreamHandFrame& OutHandFrame) const;
+
+	/** Replaces the gesture inputs of this hand with those of a gesture stream frame. */
+	void ApplyGestureStreamFrame(const FEmpathGestureStreamHandFrame& HandFrame);
+
+	/** Clears any active or entering one handed gestures and blocking. */
+	void ResetGestureState();
+
+	/** Returns whether this hand is neither in a one handed gesture nor blocking. */
+	bool IsGestureIdle() const;
+
+	/** Captures the gesture inputs, gesture state, transform caches, and cooldowns of this hand before replaying a gesture stream. */
+	void SaveReplayedGestureState(FEmpathGestureReplayHandState& OutState) const;
+
+	/** Restores the gesture state captured before replaying a gesture stream. The hand should be idle, as no gesture events are fired. */
+	void RestoreReplayedGestureState(const FEmpathGestureReplayHandState& State);
+
+	/** Sets whether the one handed gestures and blocking of this hand fill their last failure reasons every time their conditions fail. */
+	void SetDescribeGestureFailures(const bool bNewDescribeFailures);
+
 	// ---------------------------------------------------------
 	//	Charging
 
@@ -611,4 +641,7 @@ private:
 
 	/** Whether this hand is currently charged. */
 	bool bIsPowerCharged;
+
+	/** The distance traveled this frame by the gesture stream being replayed. */
+	float ReplayedDeltaDistance;
 };
@@ -26,6 +26,13 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathKinematicVelocityComponent)
 		float SampleTime;
 
+	/** 
+	* The highest frame rate we expect to run at, used to size the velocity history so that it never allocates. 
+	* If we run faster than this, the oldest frames are dropped early and we average over slightly less than the sample time.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EmpathKinematicVelocityComponent, meta = (ClampMin = 1))
+		float MaxExpectedFrameRate;
+
 	// Called every frame
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 	virtual void Activate(bool bReset) override;
@@ -33,153 +40,153 @@ public:
 
 	/** Our location on the last frame, used to calculate our kinematic velocity. Expressed in world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetLastLocation() const { return LastLocation; }
+		const FVector GetLastLocation() const { return FVector(Samples.LastLocation[0], Samples.LastLocation[1], Samples.LastLocation[2]); }
 
 	/** Our rotation on the last frame, used to calculate our kinematic angular velocity. Expressed in world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FRotator GetLastRotation() const { return LastRotation.Rotator(); }
+		const FRotator GetLastRotation() const { return Samples.LastRotation.Rotator(); }
 
 	/** Our spherical location on the last frame, with respect to our owning player's center of mass. Expressed in world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetLastSphericalLocation() const { return LastSphericalLocation; }
+		const FVector GetLastSphericalLocation() const { return Samples.LastSphericalLocation; }
 
 	/** Our spherical dist the last frame, used to calculation our spherical velocity. Expressed in world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetLastSphericalDist() const { return LastSphericalDist; }
+		const float GetLastSphericalDist() const { return Samples.LastDists[EmpathKinematicChannel::Spherical]; }
 
 	/** Our Radial dist the last frame, used to calculation our Radial velocity. Expressed in world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetLastRadialDist() const { return LastRadialDist; }
+		const float GetLastRadialDist() const { return Samples.LastDists[EmpathKinematicChannel::Radial]; }
 
 	/** Our Vertical dist the last frame, used to calculation our Vertical velocity. Expressed in world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetLastVerticalDist() const { return LastVerticalDist; }
+		const float GetLastVerticalDist() const { return Samples.LastDists[EmpathKinematicChannel::Vertical]; }
 
 	/** Our change in location since the last frame, used to calculation our kinematic velocity. Expressed in world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetDeltaLocation() const { return DeltaLocation; }
+		const FVector GetDeltaLocation() const { return FVector(Samples.DeltaLocation[0], Samples.DeltaLocation[1], Samples.DeltaLocation[2]); }
 
 	/** Our change in rotation since the last frame, used to calculation our kinematic angular velocity. Expressed in world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FRotator GetDeltaRotation() const { return DeltaRotation.Rotator(); }
+		const FRotator GetDeltaRotation() const { return Samples.DeltaRotation.Rotator(); }
 
 	/** Our change in spherical dist the last frame, used to calculation our spherical velocity. Expressed in world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetDeltaSphericalDist() const { return DeltaSphericalDist; }
+		const float GetDeltaSphericalDist() const { return Samples.DeltaDists[EmpathKinematicChannel::Spherical]; }
 
 	/** Our change in radial dist the last frame, used to calculation our radial velocity. Expressed in world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetDeltaRadialDist() const { return DeltaRadialDist; }
+		const float GetDeltaRadialDist() const { return Samples.DeltaDists[EmpathKinematicChannel::Radial]; }
 
 	/** Our change in vertical dist the last frame, used to calculation our Vertical velocity. Expressed in world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetDeltaVerticalDist() const { return DeltaVerticalDist; }
+		const float GetDeltaVerticalDist() const { return Samples.DeltaDists[EmpathKinematicChannel::Vertical]; }
 
 	/** The kinematic velocity of this component, averaged from all the recorded velocities within the same time. Expressed in world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetKinematicVelocity() const { return KinematicVelocity; }
+		const FVector GetKinematicVelocity() const { return Samples.GetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::Velocity); }
 
 	/** The kinematic velocity of this component on the last frame, averaged from all the recorded velocities within the same time. Expressed in world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetLastKinematicVelocity() const { return LastVelocity; }
+		const FVector GetLastKinematicVelocity() const { return Samples.GetVector(EmpathKinematicSample::Last, EmpathKinematicChannel::Velocity); }
 
 	/** The kinematic velocity of this component, calculated with respect to this frame only. Expressed in world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetFrameVelocity() const { return FrameVelocity; }
+		const FVector GetFrameVelocity() const { return Samples.GetVector(EmpathKinematicSample::Frame, EmpathKinematicChannel::Velocity); }
 
 	/** The last kinematic velocity of this component, calculated with respect to the last frame only. Expressed in world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetLastFrameVelocity() const { return LastFrameVelocity; }
+		const FVector GetLastFrameVelocity() const { return Samples.GetVector(EmpathKinematicSample::LastFrame, EmpathKinematicChannel::Velocity); }
 
 	/** The kinematic angular velocity of this component, averaged from all the recorded velocities within the same time. Expressed in Radians and world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetKinematicAngularVelocityRads() const { return FVector::DegreesToRadians(KinematicAngularVelocity); }
+		const FVector GetKinematicAngularVelocityRads() const { return FVector::DegreesToRadians(Samples.GetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::AngularVelocity)); }
 
 	/** The kinematic angular velocity of this component on the last frame, averaged from all the recorded velocities within the same time. Expressed in Radians and world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetLastKinematicAngularVelocityRads() const { return FVector::DegreesToRadians(LastAngularVelocity); }
+		const FVector GetLastKinematicAngularVelocityRads() const { return FVector::DegreesToRadians(Samples.GetVector(EmpathKinematicSample::Last, EmpathKinematicChannel::AngularVelocity)); }
 
 	/** The kinematic angular velocity of this component, calculated with respect to this frame only. Expressed in Radians and world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetFrameAngularVelocityRads() const { return FVector::DegreesToRadians(FrameAngularVelocity); }
+		const FVector GetFrameAngularVelocityRads() const { return FVector::DegreesToRadians(Samples.GetVector(EmpathKinematicSample::Frame, EmpathKinematicChannel::AngularVelocity)); }
 
 	/** The last kinematic angular velocity of this component, calculated with respect to the last frame only. Expressed in Radians and world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetLastFrameAngularVelocityRads() const { return FVector::DegreesToRadians(LastFrameAngularVelocity); }
+		const FVector GetLastFrameAngularVelocityRads() const { return FVector::DegreesToRadians(Samples.GetVector(EmpathKinematicSample::LastFrame, EmpathKinematicChannel::AngularVelocity)); }
 
 	/** The kinematic angular velocity of this component, averaged from all the recorded velocities within the same time. Expressed in degrees and world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetKAngularVelocity() const { return AngVelFixedWorld; }
+		const FVector GetKAngularVelocity() const { return Samples.GetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::AngVelFixedWorld); }
 
 	/** The kinematic angular velocity of this component, averaged from all the recorded velocities within the same time. Expressed in degrees and local space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetKAngularVelocityLocal() const { return AngVelFixedLocal; }
+		const FVector GetKAngularVelocityLocal() const { return Samples.GetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::AngVelFixedLocal); }
 
 	/** The kinematic angular velocity of this component on the last frame, averaged from all the recorded velocities within the same time. Expressed in degrees and world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetLastKAngularVelocity() const { return LastAngVelFixedWorld; }
+		const FVector GetLastKAngularVelocity() const { return Samples.GetVector(EmpathKinematicSample::Last, EmpathKinematicChannel::AngVelFixedWorld); }
 
 	/** The kinematic angular velocity of this component on the last frame, averaged from all the recorded velocities within the same time. Expressed in degrees and local space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetLastKAngularVelocityLocal() const { return LastAngVelFixedLocal; }
+		const FVector GetLastKAngularVelocityLocal() const { return Samples.GetVector(EmpathKinematicSample::Last, EmpathKinematicChannel::AngVelFixedLocal); }
 
 	/** The kinematic angular velocity of this component, calculated with respect to this frame only. Expressed in degrees and world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetFrameAngularVelocity() const { return FrameAngVelFixedWorld; }
+		const FVector GetFrameAngularVelocity() const { return Samples.GetVector(EmpathKinematicSample::Frame, EmpathKinematicChannel::AngVelFixedWorld); }
 
 	/** The kinematic angular velocity of this component, calculated with respect to this frame only. Expressed in degrees and local space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetFrameAngularVelocityLocal() const { return FrameAngVelFixedLocal; }
+		const FVector GetFrameAngularVelocityLocal() const { return Samples.GetVector(EmpathKinematicSample::Frame, EmpathKinematicChannel::AngVelFixedLocal); }
 
 	/** The last kinematic angular velocity of this component, calculated with respect to the last frame only. Expressed in degrees and world space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetLastFrameAngularVelocity() const { return LastFrameAngVelFixedWorld; }
+		const FVector GetLastFrameAngularVelocity() const { return Samples.GetVector(EmpathKinematicSample::LastFrame, EmpathKinematicChannel::AngVelFixedWorld); }
 
 	/** The last kinematic angular velocity of this component, calculated with respect to the last frame only. Expressed in degrees and local space. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const FVector GetLastFrameAngularVelocityLocal() const { return LastFrameAngVelFixedLocal; }
+		const FVector GetLastFrameAngularVelocityLocal() const { return Samples.GetVector(EmpathKinematicSample::LastFrame, EmpathKinematicChannel::AngVelFixedLocal); }
 
 	/** The acceleration of this component, averaged from all the recorded velocities within the same time. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-	const FVector GetKinematicAcceleration() const { return KinematicAcceleration; }
+	const FVector GetKinematicAcceleration() const { return Samples.GetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::Acceleration); }
 
 	/** The world angular acceleration of this component, averaged from all the recorded velocities within the same time. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-	const FVector GetAngularAccelWorld() const { return AngularAccelWorld; }
+	const FVector GetAngularAccelWorld() const { return Samples.GetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::AngularAccelWorld); }
 
 	/** The local angular acceleration of this component, averaged from all the recorded velocities within the same time. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-	const FVector GetAngularAccelLocal() const { return AngularAccelLocal; }
+	const FVector GetAngularAccelLocal() const { return Samples.GetVector(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::AngularAccelLocal); }
 
 	/** The last acceleration of this component, averaged from all the recorded velocities within the same time. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-	const FVector GetLastAcceleration() const { return LastAcceleration; }
+	const FVector GetLastAcceleration() const { return Samples.GetVector(EmpathKinematicSample::Last, EmpathKinematicChannel::Acceleration); }
 
 	/** The last world angular acceleration of this component, averaged from all the recorded velocities within the same time. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-	const FVector GetLastAngularAccelWorld() const { return LastAngularAccelWorld; }
+	const FVector GetLastAngularAccelWorld() const { return Samples.GetVector(EmpathKinematicSample::Last, EmpathKinematicChannel::AngularAccelWorld); }
 
 	/** The last local angular acceleration of this component, averaged from all the recorded velocities within the same time. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-	const FVector GetLastAngularAccelLocal() const { return LastAngularAccelLocal; }
+	const FVector GetLastAngularAccelLocal() const { return Samples.GetVector(EmpathKinematicSample::Last, EmpathKinematicChannel::AngularAccelLocal); }
 
 	/** The acceleration of this component, calculated with respect to this frame only. */
-	const FVector GetFrameAcceleration() const { return FrameAcceleration; }
+	const FVector GetFrameAcceleration() const { return Samples.GetVector(EmpathKinematicSample::Frame, EmpathKinematicChannel::Acceleration); }
 
 	/** The world angular acceleration of this component, calculated with respect to this frame only. */
-	const FVector GetFrameAngularAccelWorld() const { return FrameAngularAccelWorld; }
+	const FVector GetFrameAngularAccelWorld() const { return Samples.GetVector(EmpathKinematicSample::Frame, EmpathKinematicChannel::AngularAccelWorld); }
 
 	/** The last local angular acceleration of this component, calculated with respect to this frame only. */
-	const FVector GetFrameAngularAccelLocal() const { return FrameAngularAccelLocal; }
+	const FVector GetFrameAngularAccelLocal() const { return Samples.GetVector(EmpathKinematicSample::Frame, EmpathKinematicChannel::AngularAccelLocal); }
 
 	/** The last acceleration of this component, calculated with respect to the last frame only. */
-	const FVector GetLastFrameAcceleration() const { return LastFrameAcceleration; }
+	const FVector GetLastFrameAcceleration() const { return Samples.GetVector(EmpathKinematicSample::LastFrame, EmpathKinematicChannel::Acceleration); }
 
 	/** The last world angular acceleration of this component, calculated with respect to the last frame only. */
-	const FVector GetLastFrameAngularAccelWorld() const { return LastFrameAngularAccelWorld; }
+	const FVector GetLastFrameAngularAccelWorld() const { return Samples.GetVector(EmpathKinematicSample::LastFrame, EmpathKinematicChannel::AngularAccelWorld); }
 
 	/** The last last local angular acceleration of this component, calculated with respect to the last frame only. */
-	const FVector GetLastFrameAngularAccelLocal() const { return LastFrameAngularAccelLocal; }
+	const FVector GetLastFrameAngularAccelLocal() const { return Samples.GetVector(EmpathKinematicSample::LastFrame, EmpathKinematicChannel::AngularAccelLocal); }
 
 	/*
 	* The spherical velocity magnitude of this component, averaged from all the recorded velocities within the same time.
@@ -187,7 +194,7 @@ public:
 	* Positive if moving away.
 	*/
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-	const float GetSphericalVelocity() const { return SphericalVelocity; }
+	const float GetSphericalVelocity() const { return Samples.GetDist(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::DistVelocity, EmpathKinematicChannel::Spherical); }
 
 
 	/*
@@ -196,7 +203,7 @@ public:
 	* Positive if moving away.
 	*/
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-	const float GetLastSphericalVelocity() const { return LastSphericalVelocity; }
+	const float GetLastSphericalVelocity() const { return Samples.GetDist(EmpathKinematicSample::Last, EmpathKinematicChannel::DistVelocity, EmpathKinematicChannel::Spherical); }
 
 	/*
 	* The spherical velocity of this component, calculated with respect to this frame only.
@@ -204,7 +211,7 @@ public:
 	* Positive if moving away.
 	*/
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-	const float GetFrameSphericalVelocity() const { return FrameSphericalVelocity; }
+	const float GetFrameSphericalVelocity() const { return Samples.GetDist(EmpathKinematicSample::Frame, EmpathKinematicChannel::DistVelocity, EmpathKinematicChannel::Spherical); }
 
 	/*
 	* The spherical velocity magnitude of this component, calculated with respect to last frame only.
@@ -212,7 +219,7 @@ public:
 	* Positive if moving away.
 	*/
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-	const float GetLastFrameSphericalVelocity() const { return LastFrameSphericalVelocity; }
+	const float GetLastFrameSphericalVelocity() const { return Samples.GetDist(EmpathKinematicSample::LastFrame, EmpathKinematicChannel::DistVelocity, EmpathKinematicChannel::Spherical); }
 
 	/*
 	* The Radial velocity magnitude of this component, averaged from all the recorded velocities within the same time.
@@ -220,7 +227,7 @@ public:
 	* Positive if moving away.
 	*/
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-	const float GetRadialVelocity() const { return RadialVelocity; }
+	const float GetRadialVelocity() const { return Samples.GetDist(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::DistVelocity, EmpathKinematicChannel::Radial); }
 
 
 	/*
@@ -229,7 +236,7 @@ public:
 	* Positive if moving away.
 	*/
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-	const float GetLastRadialVelocity() const { return LastRadialVelocity; }
+	const float GetLastRadialVelocity() const { return Samples.GetDist(EmpathKinematicSample::Last, EmpathKinematicChannel::DistVelocity, EmpathKinematicChannel::Radial); }
 
 	/*
 	* The Radial velocity of this component, calculated with respect to this frame only.
@@ -237,7 +244,7 @@ public:
 	* Positive if moving away.
 	*/
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-	const float GetFrameRadialVelocity() const { return FrameRadialVelocity; }
+	const float GetFrameRadialVelocity() const { return Samples.GetDist(EmpathKinematicSample::Frame, EmpathKinematicChannel::DistVelocity, EmpathKinematicChannel::Radial); }
 
 	/*
 	* The Radial velocity magnitude of this component, calculated with respect to last frame only.
@@ -245,7 +252,7 @@ public:
 	* Positive if moving away.
 	*/
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-	const float GetLastFrameRadialVelocity() const { return LastFrameRadialVelocity; }
+	const float GetLastFrameRadialVelocity() const { return Samples.GetDist(EmpathKinematicSample::LastFrame, EmpathKinematicChannel::DistVelocity, EmpathKinematicChannel::Radial); }
 
 	/*
 	* The Vertical velocity magnitude of this component, averaged from all the recorded velocities within the same time.
@@ -253,7 +260,7 @@ public:
 	* Positive if moving away.
 	*/
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetVerticalVelocity() const { return VerticalVelocity; }
+		const float GetVerticalVelocity() const { return Samples.GetDist(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::DistVelocity, EmpathKinematicChannel::Vertical); }
 
 
 	/*
@@ -262,7 +269,7 @@ public:
 	* Positive if moving away.
 	*/
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetLastVerticalVelocity() const { return LastVerticalVelocity; }
+		const float GetLastVerticalVelocity() const { return Samples.GetDist(EmpathKinematicSample::Last, EmpathKinematicChannel::DistVelocity, EmpathKinematicChannel::Vertical); }
 
 	/*
 	* The Vertical velocity of this component, calculated with respect to this frame only.
@@ -270,7 +277,7 @@ public:
 	* Positive if moving away.
 	*/
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetFrameVerticalVelocity() const { return FrameVerticalVelocity; }
+		const float GetFrameVerticalVelocity() const { return Samples.GetDist(EmpathKinematicSample::Frame, EmpathKinematicChannel::DistVelocity, EmpathKinematicChannel::Vertical); }
 
 	/*
 	* The Vertical velocity magnitude of this component, calculated with respect to last frame only.
@@ -278,55 +285,55 @@ public:
 	* Positive if moving away.
 	*/
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetLastFrameVerticalVelocity() const { return LastFrameVerticalVelocity; }
+		const float GetLastFrameVerticalVelocity() const { return Samples.GetDist(EmpathKinematicSample::LastFrame, EmpathKinematicChannel::DistVelocity, EmpathKinematicChannel::Vertical); }
 
 	/** The spherical acceleration of this component, averaged from all the recorded velocities within the same time. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetSphericalAccel() const { return SphericalAccel; }
+		const float GetSphericalAccel() const { return Samples.GetDist(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::DistAccel, EmpathKinematicChannel::Spherical); }
 
 	/** The radial acceleration of this component, averaged from all the recorded velocities within the same time. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetRadialAccel() const { return RadialAccel; }
+		const float GetRadialAccel() const { return Samples.GetDist(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::DistAccel, EmpathKinematicChannel::Radial); }
 
 	/** The Vertical acceleration of this component, averaged from all the recorded velocities within the same time. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetVerticalAccel() const { return VerticalAccel; }
+		const float GetVerticalAccel() const { return Samples.GetDist(EmpathKinematicSample::Kinematic, EmpathKinematicChannel::DistAccel, EmpathKinematicChannel::Vertical); }
 
 	/** The last spherical acceleration of this component, averaged from all the recorded velocities within the same time. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-	const float GetLastSphericalAccel() const { return LastSphericalAccel; }
+	const float GetLastSphericalAccel() const { return Samples.GetDist(EmpathKinematicSample::Last, EmpathKinematicChannel::DistAccel, EmpathKinematicChannel::Spherical); }
 
 	/** The last radial acceleration of this component, averaged from all the recorded velocities within the same time. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetLastRadialAccel() const { return LastRadialAccel; }
+		const float GetLastRadialAccel() const { return Samples.GetDist(EmpathKinematicSample::Last, EmpathKinematicChannel::DistAccel, EmpathKinematicChannel::Radial); }
 
 	/** The last Vertical acceleration of this component, averaged from all the recorded velocities within the same time. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetLastVerticalAccel() const { return LastVerticalAccel; }
+		const float GetLastVerticalAccel() const { return Samples.GetDist(EmpathKinematicSample::Last, EmpathKinematicChannel::DistAccel, EmpathKinematicChannel::Vertical); }
 
 	/** The spherical acceleration of this component, calculated with respect to this frame only. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetFrameSphericalAccel() const { return FrameSphericalAccel; }
+		const float GetFrameSphericalAccel() const { return Samples.GetDist(EmpathKinematicSample::Frame, EmpathKinematicChannel::DistAccel, EmpathKinematicChannel::Spherical); }
 
 	/** The radial acceleration of this component, calculated with respect to this frame only. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetFrameRadialAccel() const { return FrameRadialAccel; }
+		const float GetFrameRadialAccel() const { return Samples.GetDist(EmpathKinematicSample::Frame, EmpathKinematicChannel::DistAccel, EmpathKinematicChannel::Radial); }
 
 	/** The Vertical acceleration of this component, calculated with respect to this frame only. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetFrameVerticalAccel() const { return FrameVerticalAccel; }
+		const float GetFrameVerticalAccel() const { return Samples.GetDist(EmpathKinematicSample::Frame, EmpathKinematicChannel::DistAccel, EmpathKinematicChannel::Vertical); }
 
 	/** The last spherical acceleration of this component, calculated with respect to the last frame only. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetLastFrameSphericalAccel() const { return LastFrameSphericalAccel; }
+		const float GetLastFrameSphericalAccel() const { return Samples.GetDist(EmpathKinematicSample::LastFrame, EmpathKinematicChannel::DistAccel, EmpathKinematicChannel::Spherical); }
 
 	/** The last radial acceleration of this component, calculated with respect to the last frame only. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetLastFrameRadialAccel() const { return LastFrameRadialAccel; }
+		const float GetLastFrameRadialAccel() const { return Samples.GetDist(EmpathKinematicSample::LastFrame, EmpathKinematicChannel::DistAccel, EmpathKinematicChannel::Radial); }
 
 	/** The last vertical acceleration of this component, calculated with respect to the last frame only. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathKinematicVelocityComponent)
-		const float GetLastFrameVerticalAccel() const { return LastFrameVerticalAccel; }
+		const float GetLastFrameVerticalAccel() const { return Samples.GetDist(EmpathKinematicSample::LastFrame, EmpathKinematicChannel::DistAccel, EmpathKinematicChannel::Vertical); }
 
 	
 	/** The player that owns this kinematic velocity component. */
@@ -336,273 +343,37 @@ public:
 	/** Safe getter for the time dilator. */
 	const AEmpathTimeDilator* GetTimeDilator();
 
-private:
-	/** Our location on the last frame, used to calculation our kinematic velocity. */
-	FVector LastLocation;
-
-	/** Our rotation on the last frame, used to calculation our kinematic angular velocity. */
-	FQuat LastRotation;
-
-	/** Our spherical distance on the last frame, used to calculation our spherical velocity. */
-	float LastSphericalDist;;
-
-	/** Our radial distance on the last frame, used to calculation our radial velocity. */
-	float LastRadialDist;
-
-	/** Our vertical distance on the last frame, used to calculation our vertical velocity. */
-	float LastVerticalDist;
-
-	/** Our spherical location on the last frame, used to calculation our spherical velocity. */
-	FVector LastSphericalLocation;
-
-	/** Our change in location since the last frame, used to calculation our kinematic velocity. */
-	FVector DeltaLocation;
-
-	/** Our change in rotation since the last frame, used to calculation our kinematic angular velocity. */
-	FQuat DeltaRotation;
-
-	/** Our change in spherical distance on the last frame, used to calculation our spherical velocity. */
-	float DeltaSphericalDist;
-
-	/** Our change in radial distance on the last frame, used to calculation our radial velocity. */
-	float DeltaRadialDist;
-
-	/** Our change in vertical distance on the last frame, used to calculation our vertical velocity. */
-	float DeltaVerticalDist;
-
-	/** Per-frame record of kinematic velocity. */
-	TArray<FEmpathVelocityFrame> VelocityHistory;
-
-	/** The kinematic velocity of this component, averaged from all the recorded velocities within the same time. */
-	FVector KinematicVelocity;
-
-	/** The kinematic velocity of this component on the last frame, averaged from all the recorded velocities within the same time. */
-	FVector LastVelocity;
-
-	/** The kinematic velocity of this component, calculated with respect to this frame only. */
-	FVector FrameVelocity;
-
-	/** The last kinematic velocity of this component, calculated with respect to last frame only. */
-	FVector LastFrameVelocity;
-
-	/** The kinematic angular velocity of this component, averaged from all the recorded velocities within the same time. Expressed in degrees. */
-	FVector KinematicAngularVelocity;
-
-	/*
-	* The kinematic angular velocity of this component, averaged from all the recorded velocities within the same time. Expressed in degrees. 
-	* Has the Z fixed for world space.
-	*/
-	FVector AngVelFixedWorld;
-
-	/*
-	* The kinematic angular velocity of this component, averaged from all the recorded velocities within the same time. Expressed in degrees.
-	* Has the Z fixed for local space.
-	*/
-	FVector AngVelFixedLocal;
-
-	/*
-	* The spherical velocity magnitude of this component, averaged from all the recorded velocities within the same time.
-	* Negative if towards owning player's center of mass.
-	* Positive if moving away.
-	*/
-	float SphericalVelocity;
-
-	/*
-	* The radial velocity magnitude of this component, averaged from all the recorded velocities within the same time.
-	* Negative if towards owning player's center of mass.
-	* Positive if moving away.
-	*/
-	float RadialVelocity;
-
-	/*
-	* The vertical velocity magnitude of this component, averaged from all the recorded velocities within the same time.
-	* Negative if towards owning player's center of mass.
-	* Positive if moving away.
-	*/
-	float VerticalVelocity;
-
-	/** The acceleration of this component, averaged from all the recorded velocities within the same time. */
-	FVector KinematicAcceleration;
-
-	/** The world angular acceleration of this component, averaged from all the recorded velocities within the same time. */
-	FVector AngularAccelWorld;
-
-	/** The local angular acceleration of this component, averaged from all the recorded velocities within the same time. */
-	FVector AngularAccelLocal;
-
-	/** The spherical acceleration of this component, averaged from all the recorded velocities within the same time. */
-	float SphericalAccel;
-
-	/** The radial acceleration of this component, averaged from all the recorded velocities within the same time. */
-	float RadialAccel;
-
-	/** The Vertical acceleration of this component, averaged from all the recorded velocities within the same time. */
-	float VerticalAccel;
-
-	/** The kinematic angular velocity of this component on the last frame, averaged from all the recorded velocities within the same time. Expressed in degrees. */
-	FVector LastAngularVelocity;
-
-	/*
-	* The kinematic angular velocity of this component on the last frame, averaged from all the recorded velocities within the same time. Expressed in degrees. 
-	* Has the Z fixed for world space.
-	*/
-	FVector LastAngVelFixedWorld;
-
-	/*
-	* The kinematic angular velocity of this component on the last frame, averaged from all the recorded velocities within the same time. Expressed in degrees.
-	* Has the Z fixed for local space.
-	*/
-	FVector LastAngVelFixedLocal;
-
-	/*
-	* The last spherical velocity magnitude of this component, averaged from all the recorded velocities within the same time.
-	* Negative if towards owning player's center of mass.
-	* Positive if moving away.
-	*/
-	float LastSphericalVelocity;
-
-	/*
-	* The last radial velocity magnitude of this component, averaged from all the recorded velocities within the same time.
-	* Negative if towards owning player's center of mass.
-	* Positive if moving away.
-	*/
-	float LastRadialVelocity;
-
-	/*
-	* The last vertical velocity magnitude of this component, averaged from all the recorded velocities within the same time.
-	* Negative if towards owning player's center of mass.
-	* Positive if moving away.
-	*/
-	float LastVerticalVelocity;
-
-	/** The last acceleration of this component, averaged from all the recorded velocities within the same time. */
-	FVector LastAcceleration;
-
-	/** The last world angular acceleration of this component, averaged from all the recorded velocities within the same time. */
-	FVector LastAngularAccelWorld;
-
-	/** The last local angular acceleration of this component, averaged from all the recorded velocities within the same time. */
-	FVector LastAngularAccelLocal;
-
-	/** The last spherical acceleration of this component, averaged from all the recorded velocities within the same time. */
-	float LastSphericalAccel;
-
-	/** The last radial acceleration of this component, averaged from all the recorded velocities within the same time. */
-	float LastRadialAccel;
-
-	/** The last Vertical acceleration of this component, averaged from all the recorded velocities within the same time. */
-	float LastVerticalAccel;
-
-	/** The kinematic angular velocity of this component, calculated with respect to this frame only. Expressed in degrees. */
-	FVector FrameAngularVelocity;
-
-	/*
-	* The kinematic angular velocity of this component, calculated with respect to this frame only. Expressed in degrees. 
-	* Has the Z fixed for world space.
-	*/
-	FVector FrameAngVelFixedWorld;
-
-	/*
-	* The kinematic angular velocity of this component, calculated with respect to this frame only. Expressed in degrees.
-	* Has the Z fixed for local space.
-	*/
-	FVector FrameAngVelFixedLocal;
-
-	/*
-	* The spherical velocity magnitude of this component, calculated with respect to this frame only.
-	* Negative if towards owning player's center of mass.
-	* Positive if moving away. 
-	*/
-	float FrameSphericalVelocity;
-
-	/*
-	* The radial velocity magnitude of this component, calculated with respect to this frame only.
-	* Negative if towards owning player's center of mass.
-	* Positive if moving away.
-	*/
-	float FrameRadialVelocity;
-
-	/*
-	* The radial velocity magnitude of this component, calculated with respect to this frame only.
-	* Negative if towards owning player's center of mass.
-	* Positive if moving away.
-	*/
-	float FrameVerticalVelocity;
-
-	/** The acceleration of this component, calculated with respect to this frame only. */
-	FVector FrameAcceleration;
-
-	/** The world angular acceleration of this component, calculated with respect to this frame only. */
-	FVector FrameAngularAccelWorld;
-
-	/** The last local angular acceleration of this component, calculated with respect to this frame only. */
-	FVector FrameAngularAccelLocal;
-
-	/** The spherical acceleration of this component, calculated with respect to this frame only. */
-	float FrameSphericalAccel;
-
-	/** The radial acceleration of this component, calculated with respect to this frame only. */
-	float FrameRadialAccel;
-
-	/** The Vertical acceleration of this component, calculated with respect to this frame only. */
-	float FrameVerticalAccel;
-
-	/** The last angular kinematic velocity of this component, calculated with respect to the last frame only. Expressed in degrees. */
-	FVector LastFrameAngularVelocity;
-
-	/*
-	* The last angular kinematic velocity of this component, calculated with respect to the last frame only. Expressed in degrees. 
-	* Has the Z fixed for world space
+	/** 
+	* Pairs this component with another, normally the other hand's, so that whichever ticks first updates both in one batch.
+	* Also makes this component tick after the other component's owner, so that both hands have moved before the update.
 	*/
-	FVector LastFrameAngVelFixedWorld;
+	void SetBatchedComponent(UEmpathKinematicVelocityComponent* InBatchedComponent);
 
-	/*
-	* The last angular kinematic velocity of this component, calculated with respect to the last frame only. Expressed in degrees.
-	* Has the Z fixed for local space
-	*/
-	FVector LastFrameAngVelFixedLocal;
+	/** Updates the kinematic velocity of every listed component together. */
+	static void CalculateKinematicVelocities(UEmpathKinematicVelocityComponent* const* Components, int32 NumComponents);
 
-	/*
-	* The spherical velocity magnitude of this component, calculated with respect to the last frame only.
-	* Negative if towards owning player's center of mass.
-	* Positive if moving away.
-	*/
-	float LastFrameSphericalVelocity;
-
-	/*
-	* The Radial velocity magnitude of this component, calculated with respect to the last frame only.
-	* Negative if towards owning player's center of mass.
-	* Positive if moving away.
-	*/
-	float LastFrameRadialVelocity;
-
-	/*
-	* The Radial velocity magnitude of this component, calculated with respect to the last frame only.
-	* Negative if towards owning player's center of mass.
-	* Positive if moving away.
+private:
+	/** 
+	* Every kinematic value of this component, as well as our location and rotation on the last frame.
+	* Kept in one block so that it can be archived, reset, and updated alongside other hands as a whole.
 	*/
-	float LastFrameVerticalVelocity;
+	FEmpathKinematicSamples Samples;
 
-	/** The last acceleration of this component, calculated with respect to the last frame only. */
-	FVector LastFrameAcceleration;
+	/** Component that is updated in the same batch as this one, normally the other hand. */
+	UPROPERTY()
+	UEmpathKinematicVelocityComponent* BatchedComponent;
 
-	/** The last world angular acceleration of this component, calculated with respect to the last frame only. */
-	FVector LastFrameAngularAccelWorld;
+	/** The frame on which we were last updated, so that batched components are not updated twice. */
+	uint64 LastUpdateFrame;
 
-	/** The last last local angular acceleration of this component, calculated with respect to the last frame only. */
-	FVector LastFrameAngularAccelLocal;
+	/** Per-frame record of kinematic velocity over the sample time, with running totals for averaging. */
+	FEmpathVelocityHistory VelocityHistory;
 
-	/** The last spherical acceleration of this component, calculated with respect to the last frame only. */
-	float LastFrameSphericalAccel;
-
-	/** The last radial acceleration of this component, calculated with respect to the last frame only. */
-	float LastFrameRadialAccel;
-
-	/** The last vertical acceleration of this component, calculated with respect to the last frame only. */
-	float LastFrameVerticalAccel;
+	/** Resizes the velocity history to fit the sample time at the max expected frame rate, if it doesn't already. */
+	void UpdateVelocityHistoryCapacity();
 
-	/** Uses our last position to calculate the kinematic velocity for this frame. */
-	void CalculateKinematicVelocity();
+	/** Sizes the velocity history, then averages our samples over the sample time from the current transform. Runs after the batched frame update. */
+	void UpdateAveragedSamples(float DeltaSeconds);
 
 	/** Reference to the time dilator for optimization. */
 	AEmpathTimeDilator* TimeDilator;
@@ -31,10 +31,17 @@ public:
 	bool bRegisteredCallbacks;
 #endif // WITH_EDITOR
 
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	bool IsClaimed() const { return ClaimedBy != nullptr; };
+	bool IsClaimedBy(AEmpathAIController const* ClaimHolder) const { return ClaimedBy == ClaimHolder; };
 	void Claim(AEmpathAIController* ClaimHolder);
 	void BeginReleaseClaim(bool bImmediate = false);
 
+	/** Returns the Empath nav link that owns the custom link with this ID, or nullptr if there is none. Avoids going through the navigation system. */
+	static AEmpathNavLinkProxy* FindByCustomLinkId(uint32 CustomLinkId);
+
 protected:
 
 #if WITH_EDITORONLY_DATA
@@ -53,6 +60,14 @@ protected:
 	void ReleaseClaim();
 	FTimerHandle ReleaseClaimTimerHandle;
 	float ClaimReleaseDelay;
+
+private:
+
+	/** All playing Empath nav links, keyed by the ID of their custom link. Link IDs are unique across worlds. */
+	static TMap<uint32, AEmpathNavLinkProxy*> CustomLinkRegistry;
+
+	/** The custom link ID we were registered with, in case it changes while we're playing. 0 if not registered. */
+	uint32 RegisteredCustomLinkId;
 	
 	
 };
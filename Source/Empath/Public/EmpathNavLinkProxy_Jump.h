@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Kismet/GameplayStatics.h"
 #include "EmpathNavLinkProxy.h"
+#include "EmpathTypes.h"
 #include "EmpathNavLinkProxy_Jump.generated.h"
 
 /**
@@ -57,6 +58,33 @@ public:
 #endif // WITH_EDITORONLY_DATA
 
 
+	/** The jump from the link's start point to its end point. Baked in the editor and when cooking. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = JumpBake)
+	FEmpathJumpTrajectory BakedForwardJump;
+
+	/** The jump from the link's end point back to its start point. Baked in the editor and when cooking. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = JumpBake)
+	FEmpathJumpTrajectory BakedReverseJump;
+
+	/** How far a jump's offset from its start to its end may be from a baked jump's for the baked jump to be used instead of computing a new one. Any mismatch lands the jumper that far off. */
+	UPROPERTY(EditAnywhere, Category = JumpBake)
+	float BakedJumpTolerance;
+
+	/** Computes the jump trajectories between the link's end points, so that AIs don't need to when they take the link. */
+	void BakeJumpTrajectories();
+
+	/** 
+	* Returns the baked jump with the same offset from start to end as this jump, or nullptr if there is none and the jump must be computed. 
+	* Jumps are baked between the link's points on the navmesh, so the start and end should both be at the jumper's feet.
+	* The baked launch velocity and timings apply from the jump's own start location, but the baked locations must be moved there. 
+	*/
+	FEmpathJumpTrajectory const* FindBakedJumpTrajectory(FVector const& StartLocation, FVector const& EndLocation, float Arc) const;
+
+	/** Returns the baked jump for the jumper to jump from where it stands to a destination on the navmesh, or nullptr if the jump must be computed. */
+	FEmpathJumpTrajectory const* FindBakedJumpTrajectoryForJumper(const class APawn* Jumper, FVector const& Destination, float Arc) const;
+
+	virtual void BeginPlay() override;
+
 	/**
 	* Data about the trace result.
 	*/
@@ -89,6 +117,7 @@ public:
 
 #if WITH_EDITOR
 	virtual void PostEditImport() override;
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
 
 
 	/** Predicts the path of the jump. */
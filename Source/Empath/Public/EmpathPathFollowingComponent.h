@@ -41,6 +41,7 @@ protected:
 	virtual bool HasReachedCurrentTarget(const FVector& CurrentLocation) const override;
 	virtual void FollowPathSegment(float DeltaTime) override;
 	virtual void Reset() override;
+	virtual void OnPathUpdated() override;
 
 	void AdjustMove(UPathFollowingComponent* PathFollowComp, FVector& Velocity);
 
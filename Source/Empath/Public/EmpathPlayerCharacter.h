@@ -16,6 +16,7 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FOnPlayerCharacterTeleportDelegate
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_FiveParams(FOnPlayerCharacterDeathDelegate, FHitResult const&, KillingHitInfo, FVector, KillingHitImpulseDir, const AController*, DeathInstigator, const AActor*, DeathCauser, const UDamageType*, DeathDamageType);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnPlayerCharacterStunnedDelegate, const AController*, StunInstigator, const AActor*, StunCauser, const float, StunDuration);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnGestureStateChangedDelegate, const EEmpathGestureType, OldGestureState, const EEmpathGestureType, NewGestureState, const EEmpathBinaryHand, Hand);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnGestureConditionsCheckedDelegate);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnCastingPoseChangedDelegate, const EEmpathCastingPose, OldPose, const EEmpathCastingPose, NewPose);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnNewChargedStateDelegate, const bool, bNewChargedState, const EEmpathBinaryHand, Hand);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnNewBlockingStateDelegate, const bool, bNewBlockingState, const EEmpathBinaryHand, Hand);
@@ -315,6 +316,9 @@ public:
 	UFUNCTION(Category = EmpathPlayerCharacter, BlueprintImplementableEvent)
 	void OnHandsRegistered();
 
+	/** Registers the hand actors with each other and with this character. Called on BeginPlay with the spawned hands. */
+	void RegisterHands(AEmpathHandActor* InRightHandActor, AEmpathHandActor* InLeftHandActor);
+
 
 	// ---------------------------------------------------------
 	//	 Team Agent Interface
@@ -926,6 +930,13 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "EmpathPlayerCharacter|Combat")
 		FOnGestureStateChangedDelegate OnGestureStateChangedDelegate;
 
+	/** 
+	* Called once the gesture conditions have been checked each frame. While anything is bound, the gestures of both hands 
+	* and Cannon Shot fill their last failure reasons every time their conditions fail, so that debug visualizers can read them.
+	*/
+	UPROPERTY(BlueprintAssignable, Category = "EmpathPlayerCharacter|Gestures")
+	FOnGestureConditionsCheckedDelegate OnGestureConditionsChecked;
+
 	/** Returns whether both hands are valid and can currently gesture cast. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = EmpathPlayerCharacter)
 	const bool CanGestureCast() const;
@@ -986,6 +997,38 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EmpathPlayerCharacter|Gestures")
 	FEmpathPoseData CannonShotData;
 
+	/** Starts recording the gesture inputs of both hands to a gesture stream file in Saved/GestureStreams. */
+	UFUNCTION(Exec)
+	void EmpathRecordGestures(FString FileName);
+
+	/** Stops recording gesture inputs and saves the gesture stream. */
+	UFUNCTION(Exec)
+	void EmpathStopRecordingGestures();
+
+	/** 
+	* Replays a gesture stream file through the hands and gesture state without needing a headset,
+	* and logs the recognized gestures, their latency, and evaluation throughput.
+	* Gameplay events are not fired for replayed gestures.
+	*/
+	UFUNCTION(Exec)
+	void EmpathReplayGestures(FString FileName, int32 NumIterations);
+
+	/**
+	* Replays a gesture stream through the hands and gesture state, recording the gestures recognized on the first iteration.
+	* Refuses to replay unless both hands are idle and there is no casting pose, and restores the gesture state of both hands and
+	* Cannon Shot afterwards, so that the replay does not affect gameplay. Returns whether the stream was replayed.
+	*/
+	bool ReplayGestureStream(const FEmpathGestureStream& Stream, int32 NumIterations = 1);
+
+	/** Returns the gestures recognized by the last gesture stream replay. */
+	const TArray<FEmpathGestureReplayEvent>& GetGestureReplayEvents() const { return GestureReplayEvents; }
+
+	/** Returns whether we are currently replaying a gesture stream. */
+	bool IsReplayingGestures() const { return bReplayingGestures; }
+
+	/** Returns the time used for gesture timing. Real time, or the recorded time while replaying a gesture stream. */
+	float GetGestureTimeSeconds() const;
+
 	/** The last time in real seconds the player exited the Cannon Shot Static state without entering the Dynamic state. */
 	UPROPERTY(BlueprintReadOnly, Category = EmpathPlayerCharacter)
 		float LastCannonShotStaticcExitTimeStamp;
@@ -1319,6 +1362,45 @@ private:
 	UPROPERTY(BlueprintReadOnly, Category = EmpathPlayerCharacter, meta = (AllowPrivateAccess = "true"))
 		EEmpathCastingPose CastingPose;
 
+	/** Resets the casting pose and the gesture state of both hands before restoring the state kept while replaying a gesture stream. */
+	void ResetReplayedGestureState();
+
+	/** Records a gesture recognized during the current replay, if we are recording them. */
+	void RecordGestureReplayEvent(const EEmpathGestureType GestureType, const bool bBlocking, const EEmpathBinaryHand Hand, const float EntryStartTime);
+
+	/** Sets whether the gestures of both hands and Cannon Shot fill their last failure reasons every time their conditions fail. */
+	void SetDescribeGestureFailures(const bool bNewDescribeFailures);
+
+	/** Whether gesture failures were being described last frame. */
+	bool bDescribingGestureFailures;
+
+	/** Whether we are currently recording gesture inputs. */
+	bool bRecordingGestures;
+
+	/** The real time in seconds that the current gesture recording started. */
+	float GestureRecordingStartTime;
+
+	/** The file name to save the current gesture recording to. */
+	FString GestureRecordingFileName;
+
+	/** The gesture inputs recorded so far. */
+	FEmpathGestureStream GestureRecording;
+
+	/** Whether we are currently replaying a gesture stream. */
+	bool bReplayingGestures;
+
+	/** The gesture time of the frame being replayed. */
+	float GestureReplayTimeSeconds;
+
+	/** The gesture time that the current replay iteration started at. */
+	float GestureReplayStartTimeSeconds;
+
+	/** Whether to record the gestures recognized during the current replay iteration. */
+	bool bRecordGestureReplayEvents;
+
+	/** The gestures recognized during the first iteration of the current or last replay. */
+	TArray<FEmpathGestureReplayEvent> GestureReplayEvents;
+
 	/** Whether the Charge Right key is pressed. */
 	UPROPERTY(Category = "EmpathPlayerCharacter|Input", BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
 		bool bChargeRightPressed;
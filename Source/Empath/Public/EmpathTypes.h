@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Engine/DataTable.h"
+#include "AI/Navigation/NavigationTypes.h"
 #include "EmpathTypes.generated.h"
 
 class AEmpathHandActor;
@@ -13,6 +14,12 @@ class UCurveFloat;
 class UEmpathSpeakerComponent;
 class AEmpathEnemySpawner;
 class AEmpathCharacter;
+class AEmpathAIController;
+class AEmpathPlayerCharacter;
+class AEmpathNavLinkProxy;
+class AEmpathNavLinkProxy_Jump;
+class APawn;
+class UEnvQuery;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnTimeDilationEndDelegate, uint8, RequestID, bool, bAborted);
 
@@ -119,6 +126,511 @@ enum class EEmpathBehaviorMode : uint8
 	Flee
 };
 
+USTRUCT(BlueprintType)
+struct FEmpathPerceptionLODSettings
+{
+	GENERATED_USTRUCT_BODY();
+
+	/** The furthest the AI may be from the player to use this tier. Ignored if <= 0. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxDistanceToPlayer;
+
+	/** Whether the AI must be inside the player's view to use this tier. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bRequiresInPlayerView;
+
+	/** Whether the AI must be in combat (able to see its target, or aware of its location) to use this tier. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bRequiresCombat;
+
+	/** The minimum time between vision updates at this tier. Updates requested sooner are skipped. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+	float MinVisionUpdateInterval;
+
+	/** Whether to evaluate the vision cone at this tier. If false, the AI reuses its last vision cone result. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bTestVisionCone;
+
+	/** Whether to trace for line of sight at this tier. If false, the AI keeps its last line of sight result. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bTraceLineOfSight;
+
+	FEmpathPerceptionLODSettings()
+		:MaxDistanceToPlayer(0.0f),
+		bRequiresInPlayerView(false),
+		bRequiresCombat(false),
+		MinVisionUpdateInterval(0.0f),
+		bTestVisionCone(true),
+		bTraceLineOfSight(true)
+	{}
+};
+
+struct FEmpathTargetingUpdateRequest
+{
+public:
+
+	/** The AI waiting for its targeting and vision update. */
+	AEmpathAIController* AI;
+
+	/** The time the update was requested. */
+	float RequestTime;
+
+	FEmpathTargetingUpdateRequest(AEmpathAIController* InAI = nullptr, float InRequestTime = 0.0f)
+		: AI(InAI),
+		RequestTime(InRequestTime)
+	{}
+};
+
+struct FEmpathEQSRequest
+{
+public:
+
+	/** The AI waiting to run the query. */
+	AEmpathAIController* AI;
+
+	/** The query to run. */
+	TWeakObjectPtr<UEnvQuery> Query;
+
+	/** The time the query was requested. */
+	float RequestTime;
+
+	/** How urgently the AI needs a result. Higher runs first. */
+	float Priority;
+
+	FEmpathEQSRequest(AEmpathAIController* InAI = nullptr, UEnvQuery* InQuery = nullptr, float InRequestTime = 0.0f)
+		: AI(InAI),
+		Query(InQuery),
+		RequestTime(InRequestTime),
+		Priority(0.0f)
+	{}
+};
+
+struct FEmpathAIFrameTimings
+{
+public:
+
+	/** Time spent choosing attack targets, in milliseconds. */
+	double AttackTargetMs;
+
+	/** Time spent updating vision, in milliseconds. */
+	double VisionMs;
+
+	/** Time spent resolving noises, in milliseconds. */
+	double HearingMs;
+
+	/** Time spent testing vision cones and dispatching vision traces, in milliseconds. */
+	double VisionDispatchMs;
+
+	/** The number of targeting and vision updates run. */
+	int32 NumTargetingUpdates;
+
+	/** Time spent building the flow field, in milliseconds. */
+	double FlowFieldMs;
+
+	/** The number of move requests that ran a pathfinding query. */
+	int32 NumPathRequests;
+
+	/** The number of move requests that followed the flow field instead of pathfinding. */
+	int32 NumFlowFieldPaths;
+
+	/** The number of EQS context values served from the AI manager's cache. */
+	int32 NumEQSContextCacheHits;
+
+	/** The number of EQS context values that had to be computed. */
+	int32 NumEQSContextCacheMisses;
+
+	/** Time spent starting queued reposition queries, in milliseconds. The queries themselves run in the EQS manager's tick. */
+	double RepositionQueryMs;
+
+	/** The number of queued reposition queries started. */
+	int32 NumRepositionQueries;
+
+	/** The number of queued reposition requests given the AI's previous result instead of running. */
+	int32 NumStaleRepositionResults;
+
+	/** Time spent finding nav recovery destinations, in milliseconds. */
+	double NavRecoveryMs;
+
+	/** The number of nav recovery searches run, one per cluster of characters. */
+	int32 NumNavRecoverySearches;
+
+	/** The number of nav recovery destinations given out from recently found points without searching. */
+	int32 NumNavRecoveryPointsReused;
+
+	FEmpathAIFrameTimings()
+		: AttackTargetMs(0.0),
+		VisionMs(0.0),
+		HearingMs(0.0),
+		VisionDispatchMs(0.0),
+		NumTargetingUpdates(0),
+		FlowFieldMs(0.0),
+		NumPathRequests(0),
+		NumFlowFieldPaths(0),
+		NumEQSContextCacheHits(0),
+		NumEQSContextCacheMisses(0),
+		RepositionQueryMs(0.0),
+		NumRepositionQueries(0),
+		NumStaleRepositionResults(0),
+		NavRecoveryMs(0.0),
+		NumNavRecoverySearches(0),
+		NumNavRecoveryPointsReused(0)
+	{}
+};
+
+struct FEmpathLostPlayerResponse
+{
+public:
+
+	/** The AI that should respond. */
+	AEmpathAIController* AI;
+
+	/** The awareness state the AI is responding to: Lost or Searching. */
+	EEmpathPlayerAwarenessState AwarenessState;
+
+	FEmpathLostPlayerResponse(AEmpathAIController* InAI = nullptr, 
+		EEmpathPlayerAwarenessState InAwarenessState = EEmpathPlayerAwarenessState::Lost)
+		: AI(InAI),
+		AwarenessState(InAwarenessState)
+	{}
+};
+
+struct FEmpathPathNavLink
+{
+public:
+
+	/** The index of the path point that starts the nav link. */
+	int32 PathIndex;
+
+	/** The Empath nav link at this path point. */
+	TWeakObjectPtr<AEmpathNavLinkProxy> NavLink;
+
+	/** The same nav link if it is a jump link, so users don't need to cast. */
+	TWeakObjectPtr<AEmpathNavLinkProxy_Jump> JumpLink;
+
+	/** The angle between the path going into the link and the link itself, in degrees. */
+	float EntryAngle;
+
+	/** The angle between the link and the path coming out of it, in degrees. */
+	float ExitAngle;
+
+	FEmpathPathNavLink(int32 InPathIndex = INDEX_NONE)
+		: PathIndex(InPathIndex),
+		EntryAngle(0.0f),
+		ExitAngle(0.0f)
+	{}
+};
+
+struct FEmpathFlowFieldNode
+{
+public:
+
+	/** The next polygon towards the goal. INVALID_NAVNODEREF for the goal polygon. */
+	NavNodeRef NextPoly;
+
+	/** Where to cross into the next polygon. The goal location for the goal polygon. */
+	FVector NextPortal;
+
+	/** The cost of reaching the goal from where we cross into the next polygon, using the nav mesh's area costs. */
+	float CostToGoal;
+
+	FEmpathFlowFieldNode(NavNodeRef InNextPoly = INVALID_NAVNODEREF,
+		FVector InNextPortal = FVector::ZeroVector,
+		float InCostToGoal = 0.0f)
+		: NextPoly(InNextPoly),
+		NextPortal(InNextPortal),
+		CostToGoal(InCostToGoal)
+	{}
+};
+
+struct FEmpathFlowField
+{
+public:
+
+	/** The location the field leads to. */
+	FVector GoalLocation;
+
+	/** The nav mesh polygon containing the goal. */
+	NavNodeRef GoalPoly;
+
+	/** The route to the goal from every polygon reached so far. */
+	TMap<NavNodeRef, FEmpathFlowFieldNode> Nodes;
+
+	FEmpathFlowField()
+		: GoalLocation(FVector::ZeroVector),
+		GoalPoly(INVALID_NAVNODEREF)
+	{}
+
+	/** Returns whether the field leads anywhere. */
+	bool IsValid() const { return GoalPoly != INVALID_NAVNODEREF; }
+
+	/** Clears the field while keeping its memory. */
+	void Reset()
+	{
+		GoalLocation = FVector::ZeroVector;
+		GoalPoly = INVALID_NAVNODEREF;
+		Nodes.Reset();
+	}
+};
+
+struct FEmpathNoiseEvent
+{
+public:
+
+	/** The player that caused the noise. Weak, as noises may wait across a garbage collection before being resolved. */
+	TWeakObjectPtr<AEmpathPlayerCharacter> Instigator;
+
+	/** Where the noise occurred. */
+	FVector Location;
+
+	/** Where the instigator was when the noise was reported. */
+	FVector InstigatorLocation;
+
+	/** How far away the noise can be heard from. */
+	float HearingRadius;
+
+	FEmpathNoiseEvent(AEmpathPlayerCharacter* InInstigator = nullptr,
+		FVector InLocation = FVector::ZeroVector,
+		FVector InInstigatorLocation = FVector::ZeroVector,
+		float InHearingRadius = 0.0f)
+		: Instigator(InInstigator),
+		Location(InLocation),
+		InstigatorLocation(InInstigatorLocation),
+		HearingRadius(InHearingRadius)
+	{}
+};
+
+struct FEmpathCurveLUT
+{
+public:
+
+	/** Curve values at evenly spaced sample keys across the baked range. */
+	TArray<float> Samples;
+
+	/** The curve that was baked. Evaluated directly outside the baked range. */
+	UCurveFloat const* SourceCurve;
+
+	/** 
+	* Whether the table is keyed by the cosine of an angle in degrees, rather than by the curve's own time. 
+	* Cosines change very slowly near 0 and 180 degrees, so they are warped into sample keys that are close to linear in the angle.
+	*/
+	bool bKeyedByCosine;
+
+	/** The range of sample keys covered by the samples. */
+	float MinKey;
+	float MaxKey;
+
+	/** The reciprocal of the spacing between samples. */
+	float InvKeyStep;
+
+	/** The largest difference between the table and the source curve found when baking, tested halfway between samples. */
+	float MaxError;
+
+	FEmpathCurveLUT()
+		: SourceCurve(nullptr),
+		bKeyedByCosine(false),
+		MinKey(0.0f),
+		MaxKey(0.0f),
+		InvKeyStep(0.0f),
+		MaxError(0.0f)
+	{}
+
+	/** Bakes the curve over its time range. Returns the largest error found against the curve between samples. */
+	float Bake(UCurveFloat const* Curve, int32 NumSamples);
+
+	/** Bakes a curve of angles in degrees, keyed by the cosine of the angle. Returns the largest error found against the curve between samples. */
+	float BakeByCosine(UCurveFloat const* Curve, int32 NumSamples);
+
+	/** 
+	* Returns a baked table for the curve that is shared with everyone else using the same curve and settings, baking it if nobody holds one yet. 
+	* Returns null if there is no curve.
+	*/
+	static TSharedPtr<FEmpathCurveLUT const> FindOrBake(UCurveFloat const* Curve, int32 NumSamples, bool bInKeyedByCosine);
+
+	/** Returns whether the table has been baked. */
+	bool IsBaked() const { return Samples.Num() > 1; }
+
+	/** Returns the curve value at the key, interpolating between samples. */
+	float Evaluate(float Key) const;
+
+private:
+
+	/** Samples the source curve across the sample key range. */
+	float BakeSamples(int32 NumSamples);
+
+	/** Converts a key into a sample key. */
+	float ToSampleKey(float Key) const;
+
+	/** Converts a sample key back into a key. */
+	float FromSampleKey(float SampleKey) const;
+
+	/** Returns the table value at the sample key, interpolating between samples. */
+	float EvaluateSampleKey(float SampleKey) const;
+
+	/** Returns the value of the source curve at the key. */
+	float EvaluateSourceCurve(float Key) const;
+
+	/** Returns the largest difference between the table and the source curve, tested halfway between samples. */
+	float GetMaxError() const;
+};
+
+struct FEmpathVisionCone
+{
+public:
+
+	/** The normalized forward vector of the eyes. */
+	FVector EyesForward;
+
+	/** Range at which targets are automatically seen. */
+	float AutoSeeDistance;
+
+	/** Range of the peripheral vision. */
+	float PeripheralVisionDistance;
+
+	/** Cosine of the peripheral vision angle. */
+	float PeripheralVisionCos;
+
+	/** Cosine of the forward vision angle. */
+	float ForwardVisionCos;
+
+	FEmpathVisionCone(FVector InEyesForward = FVector::ForwardVector,
+		float InAutoSeeDistance = 0.0f,
+		float InPeripheralVisionDistance = 0.0f,
+		float InPeripheralVisionCos = 1.0f,
+		float InForwardVisionCos = 1.0f)
+		: EyesForward(InEyesForward),
+		AutoSeeDistance(InAutoSeeDistance),
+		PeripheralVisionDistance(InPeripheralVisionDistance),
+		PeripheralVisionCos(InPeripheralVisionCos),
+		ForwardVisionCos(InForwardVisionCos)
+	{}
+
+	/** Returns whether the target location is inside the vision cone when looking from the eye location. Reference for the vectorized snapshot test. */
+	bool IsInVisionCone(FVector const& EyesLocation, FVector const& TargetLocation) const;
+};
+
+struct FEmpathVisionConeSnapshot
+{
+public:
+
+	/** Eye locations. */
+	TArray<float> EyesX;
+	TArray<float> EyesY;
+	TArray<float> EyesZ;
+
+	/** Normalized eye forward vectors. */
+	TArray<float> ForwardX;
+	TArray<float> ForwardY;
+	TArray<float> ForwardZ;
+
+	/** Target locations. */
+	TArray<float> TargetX;
+	TArray<float> TargetY;
+	TArray<float> TargetZ;
+
+	/** Squared auto see and peripheral vision distances. */
+	TArray<float> AutoSeeDistanceSq;
+	TArray<float> PeripheralVisionDistanceSq;
+
+	/** Cosines of the peripheral and forward vision angles. */
+	TArray<float> PeripheralVisionCos;
+	TArray<float> ForwardVisionCos;
+
+	/** Clears the snapshot while keeping its memory. */
+	void Reset();
+
+	/** Adds a vision cone test to the snapshot and returns its index. */
+	int32 Add(FVector const& EyesLocation, FVector const& TargetLocation, FEmpathVisionCone const& VisionCone);
+
+	/** Returns the number of vision cone tests in the snapshot. */
+	int32 Num() const { return EyesX.Num(); }
+
+	/** Tests every vision cone in the snapshot, four at a time. */
+	void ComputeVisionCones(TArray<bool>& OutInVisionCone) const;
+};
+
+struct FEmpathVisionTraceRequest
+{
+public:
+
+	/** The AI waiting for the result of the trace. */
+	AEmpathAIController* AI;
+
+	/** The start of the trace, normally the AI's eyes. */
+	FVector Start;
+
+	/** The end of the trace, normally the aim location on the target. */
+	FVector End;
+
+	/** The target the AI is trying to see. Ignored by the trace. */
+	AActor* Target;
+
+	/** Whether the end must be inside the vision cone before we trace. */
+	bool bTestVisionCone;
+
+	/** The vision cone to test, looking from the start of the trace. */
+	FEmpathVisionCone VisionCone;
+
+	FEmpathVisionTraceRequest(AEmpathAIController* InAI = nullptr,
+		FVector InStart = FVector::ZeroVector,
+		FVector InEnd = FVector::ZeroVector,
+		AActor* InTarget = nullptr,
+		bool bInTestVisionCone = false,
+		FEmpathVisionCone const& InVisionCone = FEmpathVisionCone())
+		: AI(InAI),
+		Start(InStart),
+		End(InEnd),
+		Target(InTarget),
+		bTestVisionCone(bInTestVisionCone),
+		VisionCone(InVisionCone)
+	{}
+};
+
+USTRUCT(BlueprintType)
+struct FEmpathJumpTrajectory
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+
+	/** Whether a launch velocity could be found for this jump. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = EmpathJumpTrajectory)
+	bool bValid;
+
+	/** Where the jump starts. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = EmpathJumpTrajectory)
+	FVector StartLocation;
+
+	/** Where the jump lands. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = EmpathJumpTrajectory)
+	FVector EndLocation;
+
+	/** The arc the trajectory was computed with. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = EmpathJumpTrajectory)
+	float Arc;
+
+	/** The velocity to launch with. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = EmpathJumpTrajectory)
+	FVector LaunchVelocity;
+
+	/** How long the jump rises for. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = EmpathJumpTrajectory)
+	float AscendingTime;
+
+	/** How long the jump falls for. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = EmpathJumpTrajectory)
+	float DescendingTime;
+
+	FEmpathJumpTrajectory()
+		: bValid(false),
+		StartLocation(FVector::ZeroVector),
+		EndLocation(FVector::ZeroVector),
+		Arc(0.0f),
+		LaunchVelocity(FVector::ZeroVector),
+		AscendingTime(0.0f),
+		DescendingTime(0.0f)
+	{}
+};
+
 USTRUCT(BlueprintType)
 struct FEmpathPerBoneDamageScale
 {
@@ -261,6 +773,253 @@ public:
 	{}
 };
 
+struct FEmpathVelocityHistory
+{
+public:
+
+	FEmpathVelocityHistory()
+		: Head(0),
+		Count(0),
+		PushesSinceResum(0)
+	{}
+
+	/** Clears the history and sets how many frames it can hold. Only allocates if the capacity changes. */
+	void Init(int32 Capacity);
+
+	/** Clears the history while keeping its memory. */
+	void Reset();
+
+	/** Adds a frame to the history. If the history is full, the oldest frame is dropped to make room. */
+	void Push(FEmpathVelocityFrame const& Frame);
+
+	/** Drops every frame recorded more than SampleTime before CurrentTime. */
+	void RemoveExpired(float CurrentTime, float SampleTime);
+
+	/** Returns the average of every frame in the history. The time stamp is left at zero. */
+	FEmpathVelocityFrame GetAverage() const;
+
+	/** Returns the average of every frame in the history by summing them all. Slower, but used to verify the running totals. */
+	FEmpathVelocityFrame GetAverageBruteForce() const;
+
+	/** Returns the number of frames in the history. */
+	int32 Num() const { return Count; }
+
+	/** Returns how many frames the history can hold. */
+	int32 GetCapacity() const { return Frames.Num(); }
+
+private:
+
+	/** Drops the oldest frame from the history. */
+	void PopOldest();
+
+	/** Recalculates the running totals from the frames in the history, clearing any accumulated rounding error. */
+	void Resum();
+
+	/** Adds the frame to the totals, scaled by Sign. */
+	void AddToTotals(FEmpathVelocityFrame const& Frame, float Sign);
+
+	/** Fixed size storage for the frames. */
+	TArray<FEmpathVelocityFrame> Frames;
+
+	/** The index of the oldest frame. */
+	int32 Head;
+
+	/** The number of frames in the history. */
+	int32 Count;
+
+	/** Running totals of every frame in the history. */
+	FEmpathVelocityFrame Totals;
+
+	/** The number of frames pushed since the totals were last recalculated. */
+	int32 PushesSinceResum;
+};
+
+namespace EmpathKinematicSample
+{
+	/** Which sample of a kinematic value a row of an FEmpathKinematicSamples block holds. */
+	enum Type
+	{
+		/** Averaged from all the recorded frames within the sample time. */
+		Kinematic,
+
+		/** The averaged sample from the last frame. */
+		Last,
+
+		/** Calculated with respect to this frame only. */
+		Frame,
+
+		/** Calculated with respect to the last frame only. */
+		LastFrame,
+
+		Num
+	};
+}
+
+namespace EmpathKinematicChannel
+{
+	/** Which kinematic value a channel of an FEmpathKinematicSamples block holds. Every channel is four floats wide. */
+	enum Type
+	{
+		/** Velocity in world space. */
+		Velocity,
+
+		/** Acceleration in world space. */
+		Acceleration,
+
+		/** Angular velocity in degrees and world space, as calculated by UE4. */
+		AngularVelocity,
+
+		/** Angular velocity in degrees, with the Z fixed for world space. */
+		AngVelFixedWorld,
+
+		/** Angular velocity in degrees, with the Z fixed for local space. */
+		AngVelFixedLocal,
+
+		/** Angular acceleration in degrees, with the Z fixed for world space. */
+		AngularAccelWorld,
+
+		/** Angular acceleration in degrees, with the Z fixed for local space. */
+		AngularAccelLocal,
+
+		/** Spherical, radial, and vertical velocity magnitudes with respect to the owning player's center of mass. */
+		DistVelocity,
+
+		/** Spherical, radial, and vertical acceleration magnitudes with respect to the owning player's center of mass. */
+		DistAccel,
+
+		Num
+	};
+
+	/** Lanes of the DistVelocity and DistAccel channels. */
+	enum DistLane
+	{
+		Spherical,
+		Radial,
+		Vertical
+	};
+}
+
+struct FEmpathKinematicSampleInput
+{
+public:
+
+	/** Location of the tracked component. Relative to the owning player's VR location if there is one, otherwise in world space. */
+	FVector Location;
+
+	/** Location of the tracked component relative to the owning player's center of mass. */
+	FVector SphericalLocation;
+
+	/** Whether there is an owning player, and so whether to update the spherical, radial, and vertical values. */
+	bool bHasOwningPlayer;
+
+	FEmpathKinematicSampleInput(FVector InLocation = FVector::ZeroVector,
+		FVector InSphericalLocation = FVector::ZeroVector,
+		bool bInHasOwningPlayer = false)
+		: Location(InLocation),
+		SphericalLocation(InSphericalLocation),
+		bHasOwningPlayer(bInHasOwningPlayer)
+	{}
+};
+
+struct FEmpathKinematicSamples
+{
+public:
+
+	/** 
+	* Every kinematic value of a tracked component, one row per sample and one channel per value.
+	* Channels are padded to four floats so the frame update can load them straight into vector registers,
+	* and archiving the last samples is a single copy of a row.
+	*/
+	float Values[EmpathKinematicSample::Num][EmpathKinematicChannel::Num][4];
+
+	/** Location on the last frame. Same space as FEmpathKinematicSampleInput::Location. The fourth lane is always zero. */
+	float LastLocation[4];
+
+	/** Change in location since the last frame. The fourth lane is always zero. */
+	float DeltaLocation[4];
+
+	/** Spherical, radial, and vertical distances on the last frame. The fourth lane is always zero. */
+	float LastDists[4];
+
+	/** Change in spherical, radial, and vertical distances since the last frame. The fourth lane is always zero. */
+	float DeltaDists[4];
+
+	/** Spherical location on the last frame, with respect to the owning player's center of mass. */
+	FVector LastSphericalLocation;
+
+	/** Rotation on the last frame. */
+	FQuat LastRotation;
+
+	/** Change in rotation since the last frame. */
+	FQuat DeltaRotation;
+
+	FEmpathKinematicSamples()
+	{
+		Reset();
+	}
+
+	/** Zeroes every value and resets the rotations to identity. */
+	void Reset();
+
+	/** Returns the first three lanes of a channel as a vector. */
+	FVector GetVector(EmpathKinematicSample::Type Sample, EmpathKinematicChannel::Type Channel) const
+	{
+		float const* Lanes = Values[Sample][Channel];
+		return FVector(Lanes[0], Lanes[1], Lanes[2]);
+	}
+
+	/** Sets the first three lanes of a channel from a vector. */
+	void SetVector(EmpathKinematicSample::Type Sample, EmpathKinematicChannel::Type Channel, FVector const& Vector)
+	{
+		float* Lanes = Values[Sample][Channel];
+		Lanes[0] = Vector.X;
+		Lanes[1] = Vector.Y;
+		Lanes[2] = Vector.Z;
+	}
+
+	/** Returns one lane of the DistVelocity or DistAccel channels. */
+	float GetDist(EmpathKinematicSample::Type Sample, EmpathKinematicChannel::Type Channel, EmpathKinematicChannel::DistLane Lane) const
+	{
+		return Values[Sample][Channel][Lane];
+	}
+
+	/** Sets the spherical, radial, and vertical lanes of a channel. */
+	void SetDists(EmpathKinematicSample::Type Sample, EmpathKinematicChannel::Type Channel, float Spherical, float Radial, float Vertical)
+	{
+		float* Lanes = Values[Sample][Channel];
+		Lanes[EmpathKinematicChannel::Spherical] = Spherical;
+		Lanes[EmpathKinematicChannel::Radial] = Radial;
+		Lanes[EmpathKinematicChannel::Vertical] = Vertical;
+	}
+
+	/** 
+	* Moves the kinematic and frame samples of each block into the last samples, ahead of a new frame. 
+	* Runs even when no time has passed, so that the last samples always describe the previous tick.
+	*/
+	static void ArchiveSamples(FEmpathKinematicSamples* const* Samples, int32 NumSamples);
+
+	/** 
+	* Updates the frame velocity, acceleration, and spherical, radial, and vertical derivatives of each block from its input.
+	* Every hand of a player can be updated in the same call. Samples should already be archived.
+	*/
+	static void UpdateFrameSamples(FEmpathKinematicSamples* const* Samples, FEmpathKinematicSampleInput const* Inputs, int32 NumSamples, float DeltaSeconds);
+
+	/**
+	* Calculates the frame angular velocity from the component's current transform, then averages the frame samples over the sample time.
+	* Runs after the batched frame update. The history should already be sized for the sample time. A sample time of zero or less uses the frame samples as they are.
+	*/
+	void UpdateAveragedSamples(FTransform const& ComponentTransform, FEmpathVelocityHistory& VelocityHistory, float SampleTime, float CurrentTime, float DeltaSeconds);
+
+	/** Updates the kinematic and frame angular accelerations of each block from its fixed angular velocities. */
+	static void UpdateAngularAccelerations(FEmpathKinematicSamples* const* Samples, int32 NumSamples, float DeltaSeconds);
+
+	/**
+	* Runs the full kinematic update over two hands of generated input: archiving, the frame update, averaging over the sample time, and angular accelerations.
+	* Returns the average time of one hand update in nanoseconds.
+	*/
+	static double BenchmarkFrameUpdate(int32 NumIterations);
+};
+
 namespace EmpathNavAreaFlags
 {
 	const int16 Navigable = (1 << 1);		// this one is defined by the system
@@ -355,6 +1114,132 @@ enum class EEmpathTeleportState : uint8
 	EndingTeleport
 };
 
+struct FEmpathNavRecoveryPoint
+{
+public:
+
+	/** The point on the nav mesh. */
+	FVector Location;
+
+	/** The time the point was found. */
+	float FoundTime;
+
+	/** The character that was sent to this point, if any. */
+	TWeakObjectPtr<AEmpathCharacter> ClaimedBy;
+
+	FEmpathNavRecoveryPoint(FVector InLocation = FVector::ZeroVector, float InFoundTime = 0.0f)
+		: Location(InLocation),
+		FoundTime(InFoundTime)
+	{}
+};
+
+struct FEmpathAIWorldSnapshot
+{
+public:
+
+	/** The frame the snapshot was taken on. */
+	uint64 FrameNumber;
+
+	/** The player's pawn, whether or not it is a VR character. */
+	APawn* PlayerPawn;
+
+	/** The player's pawn, if it is a VR character. */
+	AEmpathPlayerCharacter* Player;
+
+	/** The player's VR location. */
+	FVector PlayerVRLocation;
+
+	/** Whether we found a player controller to take the view point from. */
+	bool bHasPlayerView;
+
+	/** The player's view point. */
+	FVector PlayerViewLocation;
+	FRotator PlayerViewRotation;
+
+	/** The player's teleport state. */
+	EEmpathTeleportState PlayerTeleportState;
+
+	/** Whether the player is dead. */
+	bool bPlayerDead;
+
+	/** The valid secondary attack targets. */
+	TArray<FSecondaryAttackTarget> SecondaryTargets;
+
+	FEmpathAIWorldSnapshot()
+		: FrameNumber(0),
+		PlayerPawn(nullptr),
+		Player(nullptr),
+		PlayerVRLocation(FVector::ZeroVector),
+		bHasPlayerView(false),
+		PlayerViewLocation(FVector::ZeroVector),
+		PlayerViewRotation(FRotator::ZeroRotator),
+		PlayerTeleportState(EEmpathTeleportState::NotTeleporting),
+		bPlayerDead(false)
+	{}
+};
+
+struct FEmpathEQSContextCacheKey
+{
+public:
+
+	/** The class of the context that provided the value. */
+	UClass const* ContextClass;
+
+	/** The actor running the query. */
+	AActor const* Querier;
+
+	FEmpathEQSContextCacheKey(UClass const* InContextClass = nullptr, AActor const* InQuerier = nullptr)
+		: ContextClass(InContextClass),
+		Querier(InQuerier)
+	{}
+
+	bool operator==(FEmpathEQSContextCacheKey const& Other) const
+	{
+		return ContextClass == Other.ContextClass && Querier == Other.Querier;
+	}
+
+	friend uint32 GetTypeHash(FEmpathEQSContextCacheKey const& Key)
+	{
+		return HashCombine(GetTypeHash(Key.ContextClass), GetTypeHash(Key.Querier));
+	}
+};
+
+struct FEmpathEQSContextCacheEntry
+{
+public:
+
+	/** The frame the value was provided on. */
+	uint64 FrameNumber;
+
+	/** Whether the context provides an actor rather than a location. */
+	bool bIsActor;
+
+	/** The actor provided, if the context provides an actor. */
+	TWeakObjectPtr<AActor> Actor;
+
+	/** The location provided, if the context provides a location. */
+	FVector Location;
+
+	FEmpathEQSContextCacheEntry()
+		: FrameNumber(0),
+		bIsActor(false),
+		Location(FVector::ZeroVector)
+	{}
+
+	FEmpathEQSContextCacheEntry(AActor* InActor)
+		: FrameNumber(0),
+		bIsActor(true),
+		Actor(InActor),
+		Location(FVector::ZeroVector)
+	{}
+
+	FEmpathEQSContextCacheEntry(FVector const& InLocation)
+		: FrameNumber(0),
+		bIsActor(false),
+		Location(InLocation)
+	{}
+};
+
 USTRUCT(BlueprintType)
 struct FEmpathTeleportTraceSettings
 {
@@ -695,6 +1580,10 @@ public:
 	/** The time since we began debugging. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float TimeSinceStart;
+
+	/** Optional reason the gesture failed on this frame. Always added as the final column when converted to CSV, so that every row has the same columns. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FString FailureReason;
 };
 
 USTRUCT(BlueprintType)
@@ -937,12 +1826,168 @@ public:
 	void InvertSubConditions();
 };
 
+enum class EEmpathGestureFailureCode : uint8
+{
+	None,
+	TooLow,
+	TooHigh,
+	NotEqual,
+	InvalidCase,
+	WeakSubConditions
+};
+
+enum class EEmpathGestureOpcode : uint8
+{
+	AutoSuccess,
+	AutoFail,
+	GreaterThan,
+	GreaterThanEqual,
+	LessThan,
+	LessThanEqual,
+	Equal
+};
+
+struct FEmpathGestureInstruction
+{
+public:
+
+	/** Byte offset of the checked value inside FEmpathGestureCheck. */
+	uint16 OperandOffset;
+
+	/** Which gesture check to read the value from. 0 for the buffered average, 1 for the last frame only. */
+	uint8 CheckIdx;
+
+	/** The test to perform on the value. */
+	EEmpathGestureOpcode Opcode;
+
+	/** The value to test against. */
+	float Threshold;
+
+	/** The strong sub-conditions of this condition, as a contiguous span of instructions. Each must pass. */
+	int32 StrongStart;
+	int32 StrongNum;
+
+	/** The weak sub-conditions of this condition, as a contiguous span of instructions. One must pass, if there are any. */
+	int32 WeakStart;
+	int32 WeakNum;
+
+	FEmpathGestureInstruction()
+		: OperandOffset(0),
+		CheckIdx(0),
+		Opcode(EEmpathGestureOpcode::AutoSuccess),
+		Threshold(0.0f),
+		StrongStart(0),
+		StrongNum(0),
+		WeakStart(0),
+		WeakNum(0)
+	{}
+};
+
+struct FEmpathGestureConditionProgram
+{
+public:
+
+	/** 
+	* Every condition in the tree, in breadth first order, so that sub-conditions always come after their parent.
+	* The first instruction is the root condition.
+	*/
+	TArray<FEmpathGestureInstruction> Instructions;
+
+	/** The check type of each instruction's condition. Only read when describing failures, so it is kept apart from the instructions. */
+	TArray<EEmpathGestureConditionCheckType> ConditionCheckTypes;
+
+	FEmpathGestureConditionProgram()
+	{}
+
+	/** 
+	* Copies start out uncompiled. Gesture data is copied whole when Blueprints write to it, 
+	* so the copied program may no longer match the conditions it sits next to.
+	*/
+	FEmpathGestureConditionProgram(const FEmpathGestureConditionProgram&)
+	{}
+
+	FEmpathGestureConditionProgram& operator=(const FEmpathGestureConditionProgram&)
+	{
+		Reset();
+		return *this;
+	}
+
+	/** Flattens the condition tree into instructions. */
+	void Compile(const FEmpathGestureCondition01& Conditions);
+
+	/** Clears the program, so that it is compiled again before it is next evaluated. Call whenever the conditions change. */
+	void Reset();
+
+	/** Returns whether there is a compiled program to evaluate. */
+	bool IsCompiled() const { return Instructions.Num() > 0; }
+
+	/** Returns whether the conditions are met. Always gives the same result as FEmpathGestureCondition01::AreAllConditionsMet. */
+	bool Evaluate(const FEmpathGestureCheck& GestureConditionCheck, const FEmpathGestureCheck& FrameConditionCheck);
+
+	/** Compiles a single condition, without any sub-conditions. */
+	static FEmpathGestureInstruction CompileCondition(const FEmpathGestureCondition& Condition);
+
+	/** 
+	* Finds why the last evaluation failed, by following failed conditions down from the root the same way the condition tree does.
+	* Returns the index of the instruction responsible, or INDEX_NONE if the last evaluation passed.
+	*/
+	int32 GetLastFailure(EEmpathGestureFailureCode& OutFailureCode) const;
+
+private:
+
+	/** Per-instruction results of the condition alone, kept between evaluations so that evaluating does not allocate. */
+	TArray<uint8> TestResults;
+
+	/** Per-instruction results of the condition and its sub-conditions. */
+	TArray<uint8> Results;
+};
+
+struct FEmpathGestureConditionFailure
+{
+public:
+
+	/** Why the conditions failed, or None if they passed. */
+	EEmpathGestureFailureCode FailureCode;
+
+	/** The index of the compiled instruction responsible for the failure. */
+	int32 InstructionIdx;
+
+	/** A copy of the instruction responsible for the failure, so that the reason can still be built if the program is compiled again. */
+	FEmpathGestureInstruction Instruction;
+
+	/** The check type of the condition responsible for the failure. */
+	EEmpathGestureConditionCheckType ConditionCheckType;
+
+	/** The value the failed instruction tested. */
+	float Value;
+
+	FEmpathGestureConditionFailure()
+		: FailureCode(EEmpathGestureFailureCode::None),
+		InstructionIdx(INDEX_NONE),
+		ConditionCheckType(EEmpathGestureConditionCheckType::AutoSuccess),
+		Value(0.0f)
+	{}
+
+	/** Returns whether the conditions failed. */
+	bool HasFailed() const { return FailureCode != EEmpathGestureFailureCode::None; }
+
+	/** Records the last failure of the program, along with the instruction and value that caused it. Does not allocate. */
+	void Record(const FEmpathGestureConditionProgram& Program, const FEmpathGestureCheck& GestureConditionCheck, const FEmpathGestureCheck& FrameConditionCheck);
+
+	/** Clears the failure. */
+	void Reset();
+
+	/** Builds a readable failure reason from the failure code and instruction, or returns an empty string if the conditions passed. */
+	FString GetFailureReason() const;
+};
+
 USTRUCT(BlueprintType)
 struct FEmpathOneHandGestureData
 {
 	FEmpathOneHandGestureData()
 		:LastEntryFailureReason(""),
-		LastSustainFailureReason("")
+		LastSustainFailureReason(""),
+		bDescribeFailures(false)
 	{}
 	GENERATED_USTRUCT_BODY();
 
@@ -953,7 +1998,7 @@ struct FEmpathOneHandGestureData
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FEmpathGestureCondition01 EntryConditions;
 
-	/** The last failure reason for entering this gesture. */
+	/** The last failure reason for entering this gesture. Only kept up to date while bDescribeFailures is set, otherwise use GetEntryFailureReason. */
 	UPROPERTY(BlueprintReadOnly)
 	FString LastEntryFailureReason;
 
@@ -969,7 +2014,7 @@ struct FEmpathOneHandGestureData
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FEmpathGestureCondition01 SustainConditions;
 
-	/** The last failure reason for entering this gesture. */
+	/** The last failure reason for sustaining this gesture. Only kept up to date while bDescribeFailures is set, otherwise use GetSustainFailureReason. */
 	UPROPERTY(BlueprintReadOnly)
 	FString LastSustainFailureReason;
 
@@ -990,6 +2035,34 @@ struct FEmpathOneHandGestureData
 
 	/**	Inverts the gesture to account for differences between the left and right hand. */
 	void InvertHand();
+
+	/** 
+	* Compiles the entry and sustain conditions into programs. Programs are also compiled when first evaluated after being copied or inverted,
+	* but conditions changed in place must be compiled again.
+	*/
+	void CompileConditions();
+
+	/** The compiled entry conditions. */
+	FEmpathGestureConditionProgram EntryProgram;
+
+	/** The compiled sustain conditions. */
+	FEmpathGestureConditionProgram SustainProgram;
+
+	/** Why the compiled entry and sustain conditions last failed. */
+	FEmpathGestureConditionFailure EntryFailure;
+	FEmpathGestureConditionFailure SustainFailure;
+
+	/** Returns the last failure reason for entering this gesture, building it if needed. */
+	FString GetEntryFailureReason();
+
+	/** Returns the last failure reason for sustaining this gesture, building it if needed. */
+	FString GetSustainFailureReason();
+
+	/** 
+	* Whether to fill the last failure reasons every time the conditions fail. 
+	* Set by the player while anything is bound to its OnGestureConditionsChecked delegate.
+	*/
+	bool bDescribeFailures;
 };
 
 USTRUCT(BlueprintType)
@@ -1012,7 +2085,8 @@ struct FEmpathTwoHandGestureData
 		:LastRightHandEntryFailureReason(""),
 		LastRightHandSustainFailureReason(""),
 		LastLeftHandEntryFailureReason(""),
-		LastLeftHandSustainFailureReason("")
+		LastLeftHandSustainFailureReason(""),
+		bDescribeFailures(false)
 	{}
 
 	/**	Returns whether the inputted gesture condition checks pass the entry conditions. */
@@ -1029,11 +2103,11 @@ struct FEmpathTwoHandGestureData
 	UPROPERTY(BlueprintReadWrite)
 	FEmpathGestureCondition01 LeftHandEntryConditions;
 
-	/** The last failure reason for entering this gesture on the right hand. */
+	/** The last failure reason for entering this gesture on the right hand. Only kept up to date while bDescribeFailures is set, otherwise use GetEntryFailureReason. */
 	UPROPERTY(BlueprintReadOnly)
 	FString LastRightHandEntryFailureReason;
 
-	/** The last failure reason for entering this gesture on the left hand. */
+	/** The last failure reason for entering this gesture on the left hand. Only kept up to date while bDescribeFailures is set, otherwise use GetEntryFailureReason. */
 	UPROPERTY(BlueprintReadOnly)
 	FString LastLeftHandEntryFailureReason;
 
@@ -1053,11 +2127,11 @@ struct FEmpathTwoHandGestureData
 	UPROPERTY(BlueprintReadWrite)
 	FEmpathGestureCondition01 LeftHandSustainConditions;
 
-	/** The last failure reason for sustaining this gesture on the right hand. */
+	/** The last failure reason for sustaining this gesture on the right hand. Only kept up to date while bDescribeFailures is set, otherwise use GetSustainFailureReason. */
 	UPROPERTY(BlueprintReadOnly)
 	FString LastRightHandSustainFailureReason;
 
-	/** The last failure reason for sustaining this gesture on the left hand. */
+	/** The last failure reason for sustaining this gesture on the left hand. Only kept up to date while bDescribeFailures is set, otherwise use GetSustainFailureReason. */
 	UPROPERTY(BlueprintReadOnly)
 	FString LastLeftHandSustainFailureReason;
 
@@ -1071,12 +2145,36 @@ struct FEmpathTwoHandGestureData
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float MinExitTime;
 
-	/**	Calculates the left hand conditions by flipping the right hand conditions. */
+	/**	Calculates the left hand conditions by flipping the right hand conditions, then compiles the conditions of both hands. */
 	void CalculateLeftHandConditions();
 
 	/** The current state of the gesture on both hands. */
 	UPROPERTY(BlueprintReadOnly)
 	FEmpathTwoHandGestureState GestureState;
+
+	/** The compiled entry and sustain conditions of each hand. */
+	FEmpathGestureConditionProgram RightHandEntryProgram;
+	FEmpathGestureConditionProgram LeftHandEntryProgram;
+	FEmpathGestureConditionProgram RightHandSustainProgram;
+	FEmpathGestureConditionProgram LeftHandSustainProgram;
+
+	/** Why the compiled entry and sustain conditions of each hand last failed. */
+	FEmpathGestureConditionFailure RightHandEntryFailure;
+	FEmpathGestureConditionFailure LeftHandEntryFailure;
+	FEmpathGestureConditionFailure RightHandSustainFailure;
+	FEmpathGestureConditionFailure LeftHandSustainFailure;
+
+	/** Returns the last failure reason for entering this gesture on the inputted hand, building it if needed. */
+	FString GetEntryFailureReason(EEmpathBinaryHand Hand);
+
+	/** Returns the last failure reason for sustaining this gesture on the inputted hand, building it if needed. */
+	FString GetSustainFailureReason(EEmpathBinaryHand Hand);
+
+	/** 
+	* Whether to fill the last failure reasons every time the conditions fail. 
+	* Set by the player while anything is bound to its OnGestureConditionsChecked delegate.
+	*/
+	bool bDescribeFailures;
 };
 
 USTRUCT(BlueprintType)
@@ -1142,6 +2240,129 @@ struct FEmpathGestureTransformCache
 		FVector LastExitStartVelocity;
 };
 
+/** The gesture inputs of one hand on a single frame of a gesture stream. */
+struct FEmpathGestureStreamHandFrame
+{
+public:
+
+	/** The buffered gesture condition check of the hand. */
+	FEmpathGestureCheck GestureConditionCheck;
+
+	/** The gesture condition check of the hand for this frame only. */
+	FEmpathGestureCheck FrameConditionCheck;
+
+	/** The distance the hand traveled this frame. */
+	float DeltaDistance;
+
+	/** Whether the hand was charged. */
+	bool bIsPowerCharged;
+
+	FEmpathGestureStreamHandFrame()
+		: DeltaDistance(0.0f),
+		bIsPowerCharged(false)
+	{}
+};
+
+/** The gesture state of one hand, kept while replaying a gesture stream so that it can be restored afterwards. */
+struct FEmpathGestureReplayHandState
+{
+public:
+
+	/** The gesture inputs of the hand. */
+	FEmpathGestureStreamHandFrame Inputs;
+
+	/** The state of each one handed gesture, in the same order as the hand's gestures. */
+	TArray<FEmpathOneHandGestureState> OneHandGestureStates;
+
+	/** The state of blocking. */
+	FEmpathOneHandGestureState BlockingState;
+
+	/** The entry and exit transforms of each gesture. */
+	TMap<EEmpathGestureType, FEmpathGestureTransformCache> GestureTransformCaches;
+
+	/** The entry and exit transforms of blocking. */
+	FEmpathGestureTransformCache BlockingTransformCache;
+
+	/** The index of the previously active one handed gesture. */
+	int32 LastActiveOneHandGestureIdx;
+
+	/** The last time in real seconds that the hand exited the Punch state. */
+	float LastPunchExitTimeStamp;
+
+	/** The last time in real seconds that the hand exited the Slash state. */
+	float LastSlashExitTimeStamp;
+
+	FEmpathGestureReplayHandState()
+		: LastActiveOneHandGestureIdx(-1),
+		LastPunchExitTimeStamp(0.0f),
+		LastSlashExitTimeStamp(0.0f)
+	{}
+};
+
+/** The gesture inputs of both hands on a single frame of a gesture stream. */
+struct FEmpathGestureStreamFrame
+{
+public:
+
+	/** The time in seconds since the recording started. */
+	float TimeSeconds;
+
+	/** The inputs of each hand, indexed by EEmpathBinaryHand. */
+	FEmpathGestureStreamHandFrame Hands[2];
+
+	FEmpathGestureStreamFrame()
+		: TimeSeconds(0.0f)
+	{}
+};
+
+/** 
+* A recording of the per-frame gesture inputs of both hands. 
+* Saved as a compact binary file so that gesture recognition can be replayed and benchmarked without a headset.
+*/
+struct FEmpathGestureStream
+{
+public:
+
+	/** The recorded frames, in order. */
+	TArray<FEmpathGestureStreamFrame> Frames;
+
+	/** Clears all recorded frames. */
+	void Reset() { Frames.Reset(); }
+
+	/** Returns the recorded duration in seconds. */
+	float GetDuration() const { return (Frames.Num() > 0 ? Frames.Last().TimeSeconds : 0.0f); }
+
+	/** Saves the stream to a gesture stream file. Returns whether the file was written. */
+	bool SaveToFile(const FString& FileName) const;
+
+	/** Loads the stream from a gesture stream file. Returns false if the file is missing or was written with a different layout. */
+	bool LoadFromFile(const FString& FileName);
+
+	/** Returns the full path of a gesture stream file, which are kept in Saved/GestureStreams. */
+	static FString GetFilePath(const FString& FileName);
+};
+
+/** A gesture recognized while replaying a gesture stream. */
+struct FEmpathGestureReplayEvent
+{
+public:
+
+	/** The time in seconds since the start of the stream. */
+	float TimeSeconds;
+
+	/** The gesture state that was entered, or NoGesture for blocking. */
+	EEmpathGestureType GestureType;
+
+	/** Whether this was the hand starting to block. */
+	bool bBlocking;
+
+	/** The hand that entered the gesture. */
+	EEmpathBinaryHand Hand;
+
+	/** The time in seconds between the entry conditions first being met and the gesture activating. */
+	float LatencySeconds;
+};
+
 USTRUCT(BlueprintType)
 struct FEmpathTargetingDirection
 {